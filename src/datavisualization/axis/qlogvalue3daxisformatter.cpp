@@ -203,7 +203,9 @@ bool QLogValue3DAxisFormatter::showEdgeLabels() const
  */
 QValue3DAxisFormatter *QLogValue3DAxisFormatter::createNewInstance() const
 {
-    return new QLogValue3DAxisFormatter();
+    QLogValue3DAxisFormatter *instance = new QLogValue3DAxisFormatter();
+    instance->d_ptr->m_defaultMapping = true;
+    return instance;
 }
 
 /*!
@@ -415,6 +417,14 @@ float QLogValue3DAxisFormatterPrivate::positionAt(float value) const
     return retval;
 }
 
+void QLogValue3DAxisFormatterPrivate::mapPositions(const float *values, float *positions,
+                                                   qsizetype count) const
+{
+    Utils::logValues(values, positions, count);
+    for (qsizetype i = 0; i < count; i++)
+        positions[i] = float((qreal(positions[i]) - m_logMin) / m_logRangeNormalizer);
+}
+
 float QLogValue3DAxisFormatterPrivate::valueAt(float position) const
 {
     qreal logValue = (qreal(position) * m_logRangeNormalizer) + m_logMin;
@@ -32,6 +32,8 @@ public:
     void populateCopy(QValue3DAxisFormatter &copy) const;
 
     float positionAt(float value) const;
+    void mapPositions(const float *values, float *positions, qsizetype count) const override;
+    bool hasLinearMapping() const override { return false; }
     float valueAt(float position) const;
 
 protected:
@@ -105,7 +105,9 @@ bool QValue3DAxisFormatter::allowZero() const
  */
 QValue3DAxisFormatter *QValue3DAxisFormatter::createNewInstance() const
 {
-    return new QValue3DAxisFormatter();
+    QValue3DAxisFormatter *instance = new QValue3DAxisFormatter();
+    instance->d_ptr->m_defaultMapping = true;
+    return instance;
 }
 
 /*!
@@ -291,6 +293,7 @@ QValue3DAxisFormatterPrivate::QValue3DAxisFormatterPrivate(QValue3DAxisFormatter
     : QObject(0),
       q_ptr(q),
       m_needsRecalculate(true),
+      m_defaultMapping(false),
       m_min(0.0f),
       m_max(0.0f),
       m_rangeNormalizer(0.0f),
@@ -402,6 +405,30 @@ float QValue3DAxisFormatterPrivate::positionAt(float value) const
     return ((value - m_min) / m_rangeNormalizer);
 }
 
+// Batched positionAt(). The values and positions may point to the same array. Only the
+// instances created by the built-in formatters map without calling positionAt(), as any
+// subclass may have reimplemented it.
+void QValue3DAxisFormatterPrivate::positionsAt(const float *values, float *positions,
+                                               qsizetype count) const
+{
+    if (m_defaultMapping) {
+        mapPositions(values, positions, count);
+    } else {
+        for (qsizetype i = 0; i < count; i++)
+            positions[i] = q_ptr->positionAt(values[i]);
+    }
+}
+
+void QValue3DAxisFormatterPrivate::mapPositions(const float *values, float *positions,
+                                                qsizetype count) const
+{
+    // Same arithmetic as positionAt(), so that batched and single results are identical
+    const float min = m_min;
+    const float rangeNormalizer = m_rangeNormalizer;
+    for (qsizetype i = 0; i < count; i++)
+        positions[i] = (values[i] - min) / rangeNormalizer;
+}
+
 float QValue3DAxisFormatterPrivate::valueAt(float position) const
 {
     return ((position * m_rangeNormalizer) + m_min);
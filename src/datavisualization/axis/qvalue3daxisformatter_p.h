@@ -38,6 +38,10 @@ public:
 
     QString stringForValue(qreal value, const QString &format);
     float positionAt(float value) const;
+    void positionsAt(const float *values, float *positions, qsizetype count) const;
+    virtual void mapPositions(const float *values, float *positions, qsizetype count) const;
+    // True if positions are known to be a linear function of the values
+    virtual bool hasLinearMapping() const { return m_defaultMapping; }
     float valueAt(float position) const;
 
     void setAxis(QValue3DAxis *axis);
@@ -50,6 +54,8 @@ protected:
     QValue3DAxisFormatter *q_ptr;
 
     bool m_needsRecalculate;
+    // Set for the instances created by createNewInstance() of the built-in formatters
+    bool m_defaultMapping;
 
     float m_min;
     float m_max;
@@ -77,6 +83,8 @@ protected:
     bool m_cLocaleInUse;
 
     friend class QValue3DAxisFormatter;
+    friend class QLogValue3DAxisFormatter;
+    friend class AxisRenderCache;
 };
 
 QT_END_NAMESPACE
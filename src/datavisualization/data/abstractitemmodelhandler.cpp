@@ -2,9 +2,12 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "abstractitemmodelhandler_p.h"
+#include "utils_p.h"
 
 QT_BEGIN_NAMESPACE
 
+const int minItemsPerTask = 4096;
+
 AbstractItemModelHandler::AbstractItemModelHandler(QObject *parent)
     : QObject(parent),
       resolvePending(0),
@@ -211,4 +214,140 @@ void AbstractItemModelHandler::handlePendingResolve()
     m_fullReset = false;
 }
 
+// Changes to the model can be applied directly to the proxy array only when no resolve is
+// pending, as the resolve reads the whole model anyway.
+bool AbstractItemModelHandler::canUpdateIncrementally(const QModelIndex &parent) const
+{
+    return !m_itemModel.isNull() && !parent.isValid() && !m_resolveTimer.isActive();
+}
+
+// Reads the data of the given roles from all model items in row major order, readBlockSize items
+// at a time. Models are not thread-safe, so the data is read on the calling thread, but convert
+// is run for the items of each block on worker threads. It gets the item, its index in the
+// block, and the data of the roles in the given order. Then finish gets the first item and the
+// item count of the block on the calling thread.
+void AbstractItemModelHandler::readItemData(
+        const QList<int> &roles, const std::function<void(int, int, const QVariant *)> &convert,
+        const std::function<void(int, int)> &finish)
+{
+    const int columnCount = m_itemModel->columnCount();
+    const int itemCount = m_itemModel->rowCount() * columnCount;
+    const int roleCount = roles.size();
+
+    QList<QModelRoleData> roleData;
+    roleData.reserve(roleCount);
+    for (int role : roles)
+        roleData.append(QModelRoleData(role));
+    QList<QVariant> data(qMin(itemCount, readBlockSize) * roleCount);
+    QVariant *blockData = data.data();
+
+    for (int first = 0; first < itemCount; first += readBlockSize) {
+        const int count = qMin(readBlockSize, itemCount - first);
+        for (int i = 0; i < count; i++) {
+            const int item = first + i;
+            // Fetching all roles with one call avoids a lookup per role in most models
+            m_itemModel->multiData(m_itemModel->index(item / columnCount, item % columnCount),
+                                   QModelRoleDataSpan(roleData));
+            for (int j = 0; j < roleCount; j++)
+                blockData[i * roleCount + j] = std::move(roleData[j].data());
+        }
+        Utils::parallelFor(count, minItemsPerTask, [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+                convert(first + i, i, blockData + i * roleCount);
+        });
+        if (finish)
+            finish(first, count);
+    }
+}
+
+// Returns whether the pattern should be applied, and compiles it in advance, so that it can be
+// matched concurrently without each thread compiling it.
+bool AbstractItemModelHandler::preparePattern(QRegularExpression &pattern)
+{
+    const bool havePattern = !pattern.namedCaptureGroups().isEmpty() && pattern.isValid();
+    if (havePattern)
+        pattern.optimize();
+    return havePattern;
+}
+
+int AbstractItemModelHandler::rowCategoryId(const QString &category)
+{
+    int id = m_rowCategoryIds.value(category, -1);
+    if (id < 0) {
+        id = m_rowCategoryNames.size();
+        m_rowCategoryIds.insert(category, id);
+        m_rowCategoryNames.append(category);
+    }
+    return id;
+}
+
+int AbstractItemModelHandler::columnCategoryId(const QString &category)
+{
+    int id = m_columnCategoryIds.value(category, -1);
+    if (id < 0) {
+        id = m_columnCategoryNames.size();
+        m_columnCategoryIds.insert(category, id);
+        m_columnCategoryNames.append(category);
+    }
+    return id;
+}
+
+void AbstractItemModelHandler::clearCategoryIds()
+{
+    m_rowCategoryNames.clear();
+    m_columnCategoryNames.clear();
+    m_rowCategoryIds.clear();
+    m_columnCategoryIds.clear();
+    m_categoryRows.clear();
+    m_categoryColumns.clear();
+}
+
+void AbstractItemModelHandler::updateCategoryIndexes(const QStringList &rowList,
+                                                     const QStringList &columnList)
+{
+    m_categoryRows.fill(-1, m_rowCategoryNames.size());
+    for (int i = 0; i < rowList.size(); i++) {
+        const int id = m_rowCategoryIds.value(rowList.at(i), -1);
+        // Categories given by the user may not match any item
+        if (id >= 0)
+            m_categoryRows[id] = i;
+    }
+    m_categoryColumns.fill(-1, m_columnCategoryNames.size());
+    for (int i = 0; i < columnList.size(); i++) {
+        const int id = m_columnCategoryIds.value(columnList.at(i), -1);
+        if (id >= 0)
+            m_categoryColumns[id] = i;
+    }
+}
+
+// Finds the removals from oldList and insertions to it that produce newList. Returns false if
+// newList also reorders the categories. The removed indexes refer to oldList in descending
+// order and the inserted ones to newList in ascending order, so that they can be applied one
+// at a time.
+bool AbstractItemModelHandler::diffCategories(const QStringList &oldList,
+                                              const QStringList &newList,
+                                              QList<int> &removed, QList<int> &inserted)
+{
+    QSet<QString> oldSet(oldList.cbegin(), oldList.cend());
+    QSet<QString> newSet(newList.cbegin(), newList.cend());
+
+    QStringList kept;
+    for (int i = 0; i < oldList.size(); i++) {
+        if (newSet.contains(oldList.at(i)))
+            kept.append(oldList.at(i));
+    }
+    for (int i = oldList.size() - 1; i >= 0; i--) {
+        if (!newSet.contains(oldList.at(i)))
+            removed.append(i);
+    }
+    int keptIndex = 0;
+    for (int i = 0; i < newList.size(); i++) {
+        if (!oldSet.contains(newList.at(i)))
+            inserted.append(i);
+        else if (kept.at(keptIndex++) != newList.at(i))
+            return false;
+    }
+    return true;
+}
+
 QT_END_NAMESPACE
@@ -16,8 +16,13 @@
 
 #include "datavisualizationglobal_p.h"
 #include <QtCore/QAbstractItemModel>
+#include <QtCore/QHash>
 #include <QtCore/QPointer>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
+#include <algorithm>
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 
@@ -56,10 +61,50 @@ Q_SIGNALS:
 protected:
     virtual void resolveModel() = 0;
 
+    bool canUpdateIncrementally(const QModelIndex &parent) const;
+
+    void readItemData(const QList<int> &roles,
+                      const std::function<void(int, int, const QVariant *)> &convert,
+                      const std::function<void(int, int)> &finish = nullptr);
+    static bool preparePattern(QRegularExpression &pattern);
+    static inline float toFloat(const QVariant &data, bool havePattern,
+                                const QRegularExpression &pattern, const QString &replace)
+    {
+        return havePattern ? data.toString().replace(pattern, replace).toFloat()
+                           : data.toFloat();
+    }
+    static inline QString toString(const QVariant &data, bool havePattern,
+                                   const QRegularExpression &pattern, const QString &replace)
+    {
+        return havePattern ? data.toString().replace(pattern, replace) : data.toString();
+    }
+
+    // Role mapped proxies intern the row and column categories of the model items, so that the
+    // items can be sorted into proxy rows and columns without comparing strings.
+    int rowCategoryId(const QString &category);
+    int columnCategoryId(const QString &category);
+    void clearCategoryIds();
+    void updateCategoryIndexes(const QStringList &rowList, const QStringList &columnList);
+    inline int categoryRow(int rowId) const { return m_categoryRows.value(rowId, -1); }
+    inline int categoryColumn(int columnId) const { return m_categoryColumns.value(columnId, -1); }
+    static inline qint64 cellKey(int rowId, int columnId)
+    {
+        return (qint64(rowId) << 32) | quint32(columnId);
+    }
+    static bool diffCategories(const QStringList &oldList, const QStringList &newList,
+                               QList<int> &removed, QList<int> &inserted);
+
     QPointer<QAbstractItemModel> m_itemModel;  // Not owned
     bool resolvePending;
     QTimer m_resolveTimer;
     bool m_fullReset;
+    static constexpr int readBlockSize = 65536;
+    QStringList m_rowCategoryNames;
+    QStringList m_columnCategoryNames;
+    QHash<QString, int> m_rowCategoryIds;
+    QHash<QString, int> m_columnCategoryIds;
+    QList<int> m_categoryRows; // Proxy row of each row category id, -1 if not in the array
+    QList<int> m_categoryColumns; // Proxy column of each column category id
 
 private:
     Q_DISABLE_COPY(AbstractItemModelHandler)
@@ -67,6 +112,500 @@ private:
 
 static constexpr int noRoleIndex = -1;
 
+// Handler of the proxies that can also sort the model items into rows and columns by the
+// categories of their row and column roles. Item is the item type of the proxy array. With role
+// mapping, the mapped items and the cells combining the items of each row and column are kept,
+// so that changes to the model can be applied without resolving the whole model again.
+template <typename Proxy, typename Item>
+class MappedItemModelHandler : public AbstractItemModelHandler
+{
+public:
+    typedef QList<Item> Row;
+    typedef QList<Row *> Array;
+
+    MappedItemModelHandler(Proxy *proxy, QObject *parent = 0);
+
+    void handleDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                           const QList<int> &roles = QList<int>()) override;
+    void handleRowsInserted(const QModelIndex &parent, int start, int end) override;
+    void handleRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd,
+                         const QModelIndex &destinationParent, int destinationRow) override;
+    void handleRowsRemoved(const QModelIndex &parent, int start, int end) override;
+
+protected:
+    // Model item sorted into row and column category ids by the role mapping
+    struct MappedItem
+    {
+        int row;
+        int column;
+        Item item;
+    };
+
+    // Combination of the mapped items that share a row and a column
+    struct MappedCell
+    {
+        int count = 0;
+        Item item;
+    };
+
+    virtual Item readItem(const QModelIndex &index) const = 0;
+    virtual void addToCell(MappedCell &cell, const Item &item) const = 0;
+    virtual Item cellItem(const MappedCell &cell) const = 0;
+    // Sets the item to the proxy array, unless it is already there
+    virtual void setChangedItem(int row, int column, const Item &item) = 0;
+    // Generated categories are stored without emitting the category change signals
+    virtual void setGeneratedRowCategories(const QStringList &categories) = 0;
+    virtual void setGeneratedColumnCategories(const QStringList &categories) = 0;
+    virtual void resetMappedArray() = 0;
+    virtual void addMappedRows(const Array &rows, int first) = 0;
+    virtual void insertMappedRow(int row, Row *newRow) = 0;
+
+    // Apply model changes to the proxy array when using model categories. Returning false
+    // resolves the whole model instead.
+    virtual void setModelItems(int startRow, int endRow, int startColumn, int endColumn) = 0;
+    virtual bool insertModelRows(int start, int end) = 0;
+    virtual void setModelRows(int first, int last) = 0;
+    virtual bool removeModelRows(int start, int end) = 0;
+
+    inline bool isArrayUnchanged() const { return m_proxyArray == m_proxy->array(); }
+    void clearMappedItems();
+    void resolveMappedItems(const QList<int> &itemRoles,
+                            const std::function<Item(const QVariant *)> &convert);
+    MappedItem readMappedItem(const QModelIndex &index);
+    void readMappedRows(int start, int end);
+    Item mappedCellItem(int rowId, int columnId) const;
+    Row *mappedRow(int rowId) const;
+    void recalculateCells(const QSet<qint64> &cells);
+    void generateCategories();
+    void fillMappedArray();
+    void appendMappedItems(int first);
+    void applyMappedCells(const QSet<qint64> &cells, bool categoriesChanged);
+
+    Proxy *m_proxy; // Not owned
+    Array *m_proxyArray; // Not owned
+    int m_rowRole;
+    int m_columnRole;
+    QRegularExpression m_rowPattern;
+    QRegularExpression m_columnPattern;
+    QString m_rowReplace;
+    QString m_columnReplace;
+    bool m_haveRowPattern;
+    bool m_haveColumnPattern;
+
+    // Role mapping state kept for applying model changes without resolving the whole model
+    bool m_mappedItemsValid;
+    int m_mappedColumnCount;
+    QList<MappedItem> m_mappedItems; // In model order
+    QHash<qint64, MappedCell> m_mappedCells;
+    QStringList m_rowList; // Categories of the proxy array
+    QStringList m_columnList;
+};
+
+template <typename Proxy, typename Item>
+MappedItemModelHandler<Proxy, Item>::MappedItemModelHandler(Proxy *proxy, QObject *parent)
+    : AbstractItemModelHandler(parent),
+      m_proxy(proxy),
+      m_proxyArray(0),
+      m_rowRole(noRoleIndex),
+      m_columnRole(noRoleIndex),
+      m_haveRowPattern(false),
+      m_haveColumnPattern(false),
+      m_mappedItemsValid(false),
+      m_mappedColumnCount(0)
+{
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::handleDataChanged(const QModelIndex &topLeft,
+                                                            const QModelIndex &bottomRight,
+                                                            const QList<int> &roles)
+{
+    // Do nothing if full reset already pending
+    if (m_fullReset)
+        return;
+
+    const int startRow = qMin(topLeft.row(), bottomRight.row());
+    const int endRow = qMax(topLeft.row(), bottomRight.row());
+    const int startCol = qMin(topLeft.column(), bottomRight.column());
+    const int endCol = qMax(topLeft.column(), bottomRight.column());
+
+    if (m_proxy->useModelCategories()) {
+        setModelItems(startRow, endRow, startCol, endCol);
+    } else if (m_mappedItemsValid && canUpdateIncrementally(topLeft.parent())
+               && isArrayUnchanged()) {
+        // Cells that only had the changed item can be set directly, as long as no item
+        // moves to another row or column
+        QSet<qint64> cells;
+        bool categoriesChanged = false;
+        bool singleItemCells = true;
+        for (int i = startRow; i <= endRow; i++) {
+            for (int j = startCol; j <= endCol; j++) {
+                MappedItem &mapped = m_mappedItems[i * m_mappedColumnCount + j];
+                const qint64 oldKey = cellKey(mapped.row, mapped.column);
+                mapped = readMappedItem(m_itemModel->index(i, j));
+                const qint64 key = cellKey(mapped.row, mapped.column);
+                if (key != oldKey) {
+                    categoriesChanged = true;
+                    cells.insert(oldKey);
+                } else if (m_mappedCells.value(key).count != 1) {
+                    singleItemCells = false;
+                }
+                cells.insert(key);
+            }
+        }
+        if (m_categoryRows.size() != m_rowCategoryNames.size()
+                || m_categoryColumns.size() != m_columnCategoryNames.size()) {
+            updateCategoryIndexes(m_rowList, m_columnList);
+        }
+
+        if (!categoriesChanged && singleItemCells) {
+            for (int i = startRow; i <= endRow; i++) {
+                for (int j = startCol; j <= endCol; j++) {
+                    const MappedItem &mapped = m_mappedItems.at(i * m_mappedColumnCount + j);
+                    MappedCell &cell = m_mappedCells[cellKey(mapped.row, mapped.column)];
+                    cell = MappedCell();
+                    addToCell(cell, mapped.item);
+                }
+            }
+        } else {
+            recalculateCells(cells);
+        }
+        applyMappedCells(cells, categoriesChanged);
+    } else {
+        // If the data model doesn't directly map rows and columns, we cannot optimize
+        AbstractItemModelHandler::handleDataChanged(topLeft, bottomRight, roles);
+    }
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::handleRowsInserted(const QModelIndex &parent,
+                                                             int start, int end)
+{
+    if (!canUpdateIncrementally(parent) || !isArrayUnchanged()) {
+        AbstractItemModelHandler::handleRowsInserted(parent, start, end);
+    } else if (m_proxy->useModelCategories()) {
+        if (!insertModelRows(start, end))
+            AbstractItemModelHandler::handleRowsInserted(parent, start, end);
+    } else if (m_mappedItemsValid) {
+        const int first = start * m_mappedColumnCount;
+        const bool append = first == m_mappedItems.size();
+        readMappedRows(start, end);
+        if (append) {
+            appendMappedItems(first);
+        } else {
+            QSet<qint64> cells;
+            for (int i = first; i < (end + 1) * m_mappedColumnCount; i++)
+                cells.insert(cellKey(m_mappedItems.at(i).row, m_mappedItems.at(i).column));
+            recalculateCells(cells);
+            // Items inserted before the first items of some categories change their order
+            applyMappedCells(cells, true);
+        }
+    } else {
+        AbstractItemModelHandler::handleRowsInserted(parent, start, end);
+    }
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::handleRowsMoved(const QModelIndex &sourceParent,
+                                                          int sourceStart, int sourceEnd,
+                                                          const QModelIndex &destinationParent,
+                                                          int destinationRow)
+{
+    if (!canUpdateIncrementally(sourceParent) || destinationParent.isValid()
+            || !isArrayUnchanged()) {
+        AbstractItemModelHandler::handleRowsMoved(sourceParent, sourceStart, sourceEnd,
+                                                  destinationParent, destinationRow);
+    } else if (m_proxy->useModelCategories()) {
+        // Only the rows between the source and the destination change
+        setModelRows(qMin(sourceStart, destinationRow), qMax(sourceEnd, destinationRow - 1));
+    } else if (m_mappedItemsValid) {
+        const int columns = m_mappedColumnCount;
+        QSet<qint64> cells;
+        for (int i = sourceStart * columns; i < (sourceEnd + 1) * columns; i++)
+            cells.insert(cellKey(m_mappedItems.at(i).row, m_mappedItems.at(i).column));
+        auto items = m_mappedItems.begin();
+        if (destinationRow > sourceEnd) {
+            std::rotate(items + sourceStart * columns, items + (sourceEnd + 1) * columns,
+                        items + destinationRow * columns);
+        } else {
+            std::rotate(items + destinationRow * columns, items + sourceStart * columns,
+                        items + (sourceEnd + 1) * columns);
+        }
+        // Only the cells of the moved items can have their items in a different order
+        recalculateCells(cells);
+        applyMappedCells(cells, true);
+    } else {
+        AbstractItemModelHandler::handleRowsMoved(sourceParent, sourceStart, sourceEnd,
+                                                  destinationParent, destinationRow);
+    }
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::handleRowsRemoved(const QModelIndex &parent,
+                                                            int start, int end)
+{
+    if (!canUpdateIncrementally(parent) || !isArrayUnchanged()) {
+        AbstractItemModelHandler::handleRowsRemoved(parent, start, end);
+    } else if (m_proxy->useModelCategories()) {
+        if (!removeModelRows(start, end))
+            AbstractItemModelHandler::handleRowsRemoved(parent, start, end);
+    } else if (m_mappedItemsValid) {
+        const int first = start * m_mappedColumnCount;
+        const int count = (end - start + 1) * m_mappedColumnCount;
+        QSet<qint64> cells;
+        for (int i = first; i < first + count; i++)
+            cells.insert(cellKey(m_mappedItems.at(i).row, m_mappedItems.at(i).column));
+        m_mappedItems.remove(first, count);
+        recalculateCells(cells);
+        applyMappedCells(cells, true);
+    } else {
+        AbstractItemModelHandler::handleRowsRemoved(parent, start, end);
+    }
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::clearMappedItems()
+{
+    m_mappedItemsValid = false;
+    m_mappedItems.clear();
+    m_mappedCells.clear();
+    clearCategoryIds();
+}
+
+// Sorts all model items into rows and columns and fills the proxy array with the cells. The
+// row and column roles are read before the given item roles, and convert gets the data of the
+// item roles on worker threads.
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::resolveMappedItems(
+        const QList<int> &itemRoles, const std::function<Item(const QVariant *)> &convert)
+{
+    const int rowCount = m_itemModel->rowCount();
+    const int columnCount = m_itemModel->columnCount();
+    m_mappedColumnCount = columnCount;
+    m_mappedItems.resize(rowCount * columnCount);
+    MappedItem *items = m_mappedItems.data();
+    // Categories are converted on worker threads, but interned in model order here
+    QStringList rowCategories(qMin(rowCount * columnCount, readBlockSize));
+    QStringList columnCategories(rowCategories.size());
+    QString *rowCategory = rowCategories.data();
+    QString *columnCategory = columnCategories.data();
+    readItemData(QList<int>({m_rowRole, m_columnRole}) + itemRoles,
+                 [&](int item, int index, const QVariant *data) {
+        rowCategory[index] = toString(data[0], m_haveRowPattern, m_rowPattern, m_rowReplace);
+        columnCategory[index] = toString(data[1], m_haveColumnPattern, m_columnPattern,
+                                         m_columnReplace);
+        items[item].item = convert(data + 2);
+    }, [&](int first, int count) {
+        for (int i = 0; i < count; i++) {
+            items[first + i].row = rowCategoryId(rowCategory[i]);
+            items[first + i].column = columnCategoryId(columnCategory[i]);
+        }
+    });
+    for (const MappedItem &mapped : std::as_const(m_mappedItems))
+        addToCell(m_mappedCells[cellKey(mapped.row, mapped.column)], mapped.item);
+
+    generateCategories();
+    fillMappedArray();
+    m_mappedItemsValid = true;
+}
+
+template <typename Proxy, typename Item>
+typename MappedItemModelHandler<Proxy, Item>::MappedItem
+MappedItemModelHandler<Proxy, Item>::readMappedItem(const QModelIndex &index)
+{
+    MappedItem mapped;
+    mapped.row = rowCategoryId(toString(index.data(m_rowRole), m_haveRowPattern, m_rowPattern,
+                                        m_rowReplace));
+    mapped.column = columnCategoryId(toString(index.data(m_columnRole), m_haveColumnPattern,
+                                              m_columnPattern, m_columnReplace));
+    mapped.item = readItem(index);
+    return mapped;
+}
+
+// Inserts the items of the given model rows to the mapped items
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::readMappedRows(int start, int end)
+{
+    m_mappedItems.insert(start * m_mappedColumnCount, (end - start + 1) * m_mappedColumnCount,
+                         MappedItem());
+    for (int i = start; i <= end; i++) {
+        for (int j = 0; j < m_mappedColumnCount; j++) {
+            m_mappedItems[i * m_mappedColumnCount + j] =
+                    readMappedItem(m_itemModel->index(i, j));
+        }
+    }
+    // New categories may be among the categories given by the user
+    if (m_categoryRows.size() != m_rowCategoryNames.size()
+            || m_categoryColumns.size() != m_columnCategoryNames.size()) {
+        updateCategoryIndexes(m_rowList, m_columnList);
+    }
+}
+
+template <typename Proxy, typename Item>
+Item MappedItemModelHandler<Proxy, Item>::mappedCellItem(int rowId, int columnId) const
+{
+    if (rowId < 0 || columnId < 0)
+        return Item();
+
+    const MappedCell cell = m_mappedCells.value(cellKey(rowId, columnId));
+    return cell.count ? cellItem(cell) : Item();
+}
+
+template <typename Proxy, typename Item>
+typename MappedItemModelHandler<Proxy, Item>::Row *
+MappedItemModelHandler<Proxy, Item>::mappedRow(int rowId) const
+{
+    Row *row = new Row(m_columnList.size());
+    for (int j = 0; j < m_columnList.size(); j++)
+        (*row)[j] = mappedCellItem(rowId, m_columnCategoryIds.value(m_columnList.at(j), -1));
+    return row;
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::recalculateCells(const QSet<qint64> &cells)
+{
+    for (qint64 key : cells)
+        m_mappedCells.remove(key);
+    for (const MappedItem &mapped : std::as_const(m_mappedItems)) {
+        const qint64 key = cellKey(mapped.row, mapped.column);
+        if (cells.contains(key))
+            addToCell(m_mappedCells[key], mapped.item);
+    }
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::generateCategories()
+{
+    const bool generateRows = m_proxy->autoRowCategories();
+    const bool generateColumns = m_proxy->autoColumnCategories();
+
+    if (generateRows || generateColumns) {
+        // Categories are generated in the order they first appear in the model
+        QStringList rowList;
+        QStringList columnList;
+        QList<bool> rowFound(m_rowCategoryNames.size(), false);
+        QList<bool> columnFound(m_columnCategoryNames.size(), false);
+        for (const MappedItem &mapped : std::as_const(m_mappedItems)) {
+            if (!rowFound.at(mapped.row)) {
+                rowFound[mapped.row] = true;
+                rowList << m_rowCategoryNames.at(mapped.row);
+            }
+            if (!columnFound.at(mapped.column)) {
+                columnFound[mapped.column] = true;
+                columnList << m_columnCategoryNames.at(mapped.column);
+            }
+        }
+        if (generateRows)
+            setGeneratedRowCategories(rowList);
+        if (generateColumns)
+            setGeneratedColumnCategories(columnList);
+    }
+
+    m_rowList = m_proxy->rowCategories();
+    m_columnList = m_proxy->columnCategories();
+    updateCategoryIndexes(m_rowList, m_columnList);
+}
+
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::fillMappedArray()
+{
+    // If dimensions have changed, recreate the array
+    if (m_proxyArray != m_proxy->array() || m_rowList.size() != m_proxyArray->size()
+            || (!m_rowList.isEmpty() && m_columnList.size() != m_proxyArray->at(0)->size())) {
+        m_proxyArray = new Array;
+        m_proxyArray->reserve(m_rowList.size());
+        for (int i = 0; i < m_rowList.size(); i++)
+            m_proxyArray->append(new Row(m_columnList.size()));
+    }
+
+    QList<int> columnIds(m_columnList.size());
+    for (int j = 0; j < m_columnList.size(); j++)
+        columnIds[j] = m_columnCategoryIds.value(m_columnList.at(j), -1);
+    for (int i = 0; i < m_rowList.size(); i++) {
+        const int rowId = m_rowCategoryIds.value(m_rowList.at(i), -1);
+        Row &newProxyRow = *m_proxyArray->at(i);
+        for (int j = 0; j < m_columnList.size(); j++)
+            newProxyRow[j] = mappedCellItem(rowId, columnIds.at(j));
+    }
+}
+
+// Items appended to the end of the model cannot change the order of the existing categories,
+// so the cells can be updated without going through all the items.
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::appendMappedItems(int first)
+{
+    const bool generateRows = m_proxy->autoRowCategories();
+    const bool generateColumns = m_proxy->autoColumnCategories();
+    const int oldRowCount = m_rowList.size();
+    QSet<qint64> cells;
+    bool newColumns = false;
+    for (int i = first; i < m_mappedItems.size(); i++) {
+        const MappedItem &mapped = m_mappedItems.at(i);
+        if (generateRows && categoryRow(mapped.row) < 0) {
+            m_categoryRows[mapped.row] = m_rowList.size();
+            m_rowList << m_rowCategoryNames.at(mapped.row);
+        }
+        if (generateColumns && categoryColumn(mapped.column) < 0)
+            newColumns = true;
+        const qint64 key = cellKey(mapped.row, mapped.column);
+        addToCell(m_mappedCells[key], mapped.item);
+        cells.insert(key);
+    }
+
+    if (newColumns) {
+        // Every row gets the new columns
+        generateCategories();
+        resetMappedArray();
+        return;
+    }
+
+    if (m_rowList.size() > oldRowCount) {
+        setGeneratedRowCategories(m_rowList);
+        Array rows;
+        rows.reserve(m_rowList.size() - oldRowCount);
+        for (int i = oldRowCount; i < m_rowList.size(); i++)
+            rows.append(mappedRow(m_rowCategoryIds.value(m_rowList.at(i))));
+        addMappedRows(rows, oldRowCount);
+    }
+    applyMappedCells(cells, false);
+}
+
+// Applies recalculated cells to the proxy array. If the categories have changed, the rows of
+// the new categories are inserted and the rows of the removed ones removed, unless the change
+// also reorders the categories, in which case the whole array is reset.
+template <typename Proxy, typename Item>
+void MappedItemModelHandler<Proxy, Item>::applyMappedCells(const QSet<qint64> &cells,
+                                                           bool categoriesChanged)
+{
+    QList<int> removedRows;
+    QList<int> insertedRows;
+    if (categoriesChanged) {
+        const QStringList oldRowList = m_rowList;
+        const QStringList oldColumnList = m_columnList;
+        generateCategories();
+        if (m_columnList != oldColumnList
+                || !diffCategories(oldRowList, m_rowList, removedRows, insertedRows)) {
+            resetMappedArray();
+            return;
+        }
+    }
+
+    for (int row : std::as_const(removedRows))
+        m_proxy->removeRows(row, 1);
+    for (int row : std::as_const(insertedRows))
+        insertMappedRow(row, mappedRow(m_rowCategoryIds.value(m_rowList.at(row))));
+
+    for (qint64 key : cells) {
+        const int rowId = int(key >> 32);
+        const int columnId = int(quint32(key));
+        const int row = categoryRow(rowId);
+        const int column = categoryColumn(columnId);
+        if (row < 0 || column < 0 || insertedRows.contains(row))
+            continue;
+        setChangedItem(row, column, mappedCellItem(rowId, columnId));
+    }
+}
+
 QT_END_NAMESPACE
 
 #endif
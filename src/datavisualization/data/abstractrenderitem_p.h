@@ -28,7 +28,7 @@ public:
     AbstractRenderItem();
     AbstractRenderItem(const AbstractRenderItem &other);
     AbstractRenderItem &operator=(const AbstractRenderItem &other) = default;
-    virtual ~AbstractRenderItem();
+    ~AbstractRenderItem();
 
     // Position in 3D scene
     inline void setTranslation(const QVector3D &translation) { m_translation = translation; }
@@ -6,9 +6,7 @@
 QT_BEGIN_NAMESPACE
 
 BarItemModelHandler::BarItemModelHandler(QItemModelBarDataProxy *proxy, QObject *parent)
-    : AbstractItemModelHandler(parent),
-      m_proxy(proxy),
-      m_proxyArray(0),
+    : MappedItemModelHandler(proxy, parent),
       m_columnCount(0),
       m_valueRole(noRoleIndex),
       m_rotationRole(noRoleIndex),
@@ -21,52 +19,11 @@ BarItemModelHandler::~BarItemModelHandler()
 {
 }
 
-void BarItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
-                                            const QModelIndex &bottomRight, const QList<int> &roles)
-{
-    // Do nothing if full reset already pending
-    if (!m_fullReset) {
-        if (!m_proxy->useModelCategories()) {
-            // If the data model doesn't directly map rows and columns, we cannot optimize
-            AbstractItemModelHandler::handleDataChanged(topLeft, bottomRight, roles);
-        } else {
-            int startRow = qMin(topLeft.row(), bottomRight.row());
-            int endRow = qMax(topLeft.row(), bottomRight.row());
-            int startCol = qMin(topLeft.column(), bottomRight.column());
-            int endCol = qMax(topLeft.column(), bottomRight.column());
-
-            for (int i = startRow; i <= endRow; i++) {
-                for (int j = startCol; j <= endCol; j++) {
-                    QModelIndex index = m_itemModel->index(i, j);
-                    QBarDataItem item;
-                    QVariant valueVar = index.data(m_valueRole);
-                    float value;
-                    if (m_haveValuePattern)
-                        value = valueVar.toString().replace(m_valuePattern, m_valueReplace).toFloat();
-                    else
-                        value = valueVar.toFloat();
-                    item.setValue(value);
-                    if (m_rotationRole != noRoleIndex) {
-                        QVariant rotationVar = index.data(m_rotationRole);
-                        float rotation;
-                        if (m_haveRotationPattern) {
-                            rotation = rotationVar.toString().replace(m_rotationPattern,
-                                                                      m_rotationReplace).toFloat();
-                        } else {
-                            rotation = rotationVar.toFloat();
-                        }
-                        item.setRotation(rotation);
-                    }
-                    m_proxy->setItem(i, j, item);
-                }
-            }
-        }
-    }
-}
-
 // Resolve entire item model into QBarDataArray.
 void BarItemModelHandler::resolveModel()
 {
+    clearMappedItems();
+
     if (m_itemModel.isNull()) {
         m_proxy->resetArray(0);
         return;
@@ -78,20 +35,19 @@ void BarItemModelHandler::resolveModel()
         return;
     }
 
-    // Value and rotation patterns can be reused on single item changes,
-    // so store them to member variables.
-    QRegularExpression rowPattern(m_proxy->rowRolePattern());
-    QRegularExpression colPattern(m_proxy->columnRolePattern());
+    // Patterns can be reused on single item changes, so store them to member variables.
+    m_rowPattern = m_proxy->rowRolePattern();
+    m_columnPattern = m_proxy->columnRolePattern();
     m_valuePattern = m_proxy->valueRolePattern();
     m_rotationPattern = m_proxy->rotationRolePattern();
-    QString rowReplace = m_proxy->rowRoleReplace();
-    QString colReplace = m_proxy->columnRoleReplace();
+    m_rowReplace = m_proxy->rowRoleReplace();
+    m_columnReplace = m_proxy->columnRoleReplace();
     m_valueReplace = m_proxy->valueRoleReplace();
     m_rotationReplace = m_proxy->rotationRoleReplace();
-    bool haveRowPattern = !rowPattern.namedCaptureGroups().isEmpty() && rowPattern.isValid();
-    bool haveColPattern = !colPattern.namedCaptureGroups().isEmpty() && colPattern.isValid();
-    m_haveValuePattern = !m_valuePattern.namedCaptureGroups().isEmpty() && m_valuePattern.isValid();
-    m_haveRotationPattern = !m_rotationPattern.namedCaptureGroups().isEmpty() && m_rotationPattern.isValid();
+    m_haveRowPattern = preparePattern(m_rowPattern);
+    m_haveColumnPattern = preparePattern(m_columnPattern);
+    m_haveValuePattern = preparePattern(m_valuePattern);
+    m_haveRotationPattern = preparePattern(m_rotationPattern);
 
     QStringList rowLabels;
     QStringList columnLabels;
@@ -103,6 +59,8 @@ void BarItemModelHandler::resolveModel()
     m_rotationRole = roleHash.key(m_proxy->rotationRole().toLatin1(), noRoleIndex);
     int rowCount = m_itemModel->rowCount();
     int columnCount = m_itemModel->columnCount();
+    const QList<int> roles = itemRoles();
+    const bool haveRotation = m_rotationRole != noRoleIndex;
 
     if (m_proxy->useModelCategories()) {
         // If dimensions have changed, recreate the array
@@ -113,30 +71,14 @@ void BarItemModelHandler::resolveModel()
             for (int i = 0; i < rowCount; i++)
                 m_proxyArray->append(new QBarDataRow(columnCount));
         }
-        for (int i = 0; i < rowCount; i++) {
-            QBarDataRow &newProxyRow = *m_proxyArray->at(i);
-            for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QVariant valueVar = index.data(m_valueRole);
-                float value;
-                if (m_haveValuePattern)
-                    value = valueVar.toString().replace(m_valuePattern, m_valueReplace).toFloat();
-                else
-                    value = valueVar.toFloat();
-                newProxyRow[j].setValue(value);
-                if (m_rotationRole != noRoleIndex) {
-                    QVariant rotationVar = index.data(m_rotationRole);
-                    float rotation;
-                    if (m_haveRotationPattern) {
-                        rotation = rotationVar.toString().replace(m_rotationPattern,
-                                                                  m_rotationReplace).toFloat();
-                    } else {
-                        rotation = rotationVar.toFloat();
-                    }
-                    newProxyRow[j].setRotation(rotation);
-                }
-            }
-        }
+        // Detach the rows here, as the items are written on worker threads
+        QList<QBarDataItem *> rowItems(rowCount);
+        for (int i = 0; i < rowCount; i++)
+            rowItems[i] = m_proxyArray->at(i)->data();
+        readItemData(roles, [&](int item, int, const QVariant *data) {
+            rowItems.at(item / columnCount)[item % columnCount] =
+                    readItem(data[0], haveRotation ? data[1] : QVariant());
+        });
         // Generate labels from headers if using model rows/columns
         for (int i = 0; i < rowCount; i++)
             rowLabels << m_itemModel->headerData(i, Qt::Vertical).toString();
@@ -144,131 +86,173 @@ void BarItemModelHandler::resolveModel()
             columnLabels << m_itemModel->headerData(i, Qt::Horizontal).toString();
         m_columnCount = columnCount;
     } else {
-        int rowRole = roleHash.key(m_proxy->rowRole().toLatin1());
-        int columnRole = roleHash.key(m_proxy->columnRole().toLatin1());
-
-        bool generateRows = m_proxy->autoRowCategories();
-        bool generateColumns = m_proxy->autoColumnCategories();
-        QStringList rowList;
-        QStringList columnList;
-        // For detecting duplicates in categories generation, using QHashes should be faster than
-        // simple QStringList::contains() check.
-        QHash<QString, bool> rowListHash;
-        QHash<QString, bool> columnListHash;
-
-        // Sort values into rows and columns
-        typedef QHash<QString, float> ColumnValueMap;
-        QHash<QString, ColumnValueMap> itemValueMap;
-        QHash<QString, ColumnValueMap> itemRotationMap;
-
-        bool cumulative = m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBAverage
-                || m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBCumulative;
-        bool countMatches = m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBAverage;
-        bool takeFirst = m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBFirst;
-        QHash<QString, QHash<QString, int> > *matchCountMap = 0;
-        if (countMatches)
-            matchCountMap = new QHash<QString, QHash<QString, int> >;
-
-        for (int i = 0; i < rowCount; i++) {
-            for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QString rowRoleStr = index.data(rowRole).toString();
-                if (haveRowPattern)
-                    rowRoleStr.replace(rowPattern, rowReplace);
-                QString columnRoleStr = index.data(columnRole).toString();
-                if (haveColPattern)
-                    columnRoleStr.replace(colPattern, colReplace);
-                QVariant valueVar = index.data(m_valueRole);
-                float value;
-                if (m_haveValuePattern)
-                    value = valueVar.toString().replace(m_valuePattern, m_valueReplace).toFloat();
-                else
-                    value = valueVar.toFloat();
-                if (countMatches)
-                    (*matchCountMap)[rowRoleStr][columnRoleStr]++;
-
-                if (cumulative) {
-                    itemValueMap[rowRoleStr][columnRoleStr] += value;
-                } else {
-                    if (takeFirst && itemValueMap.contains(rowRoleStr)) {
-                        if (itemValueMap.value(rowRoleStr).contains(columnRoleStr))
-                            continue; // We already have a value for this row/column combo
-                    }
-                    itemValueMap[rowRoleStr][columnRoleStr] = value;
-                }
-
-                if (m_rotationRole != noRoleIndex) {
-                    QVariant rotationVar = index.data(m_rotationRole);
-                    float rotation;
-                    if (m_haveRotationPattern) {
-                        rotation = rotationVar.toString().replace(m_rotationPattern,
-                                                                  m_rotationReplace).toFloat();
-                    } else {
-                        rotation = rotationVar.toFloat();
-                    }
-                    if (cumulative) {
-                        itemRotationMap[rowRoleStr][columnRoleStr] += rotation;
-                    } else {
-                        // We know we are in take last mode if we get here,
-                        // as take first mode skips to next loop already earlier
-                        itemRotationMap[rowRoleStr][columnRoleStr] = rotation;
-                    }
-                }
-                if (generateRows && !rowListHash.value(rowRoleStr, false)) {
-                    rowListHash.insert(rowRoleStr, true);
-                    rowList << rowRoleStr;
-                }
-                if (generateColumns && !columnListHash.value(columnRoleStr, false)) {
-                    columnListHash.insert(columnRoleStr, true);
-                    columnList << columnRoleStr;
-                }
-            }
-        }
+        m_rowRole = roleHash.key(m_proxy->rowRole().toLatin1());
+        m_columnRole = roleHash.key(m_proxy->columnRole().toLatin1());
 
-        if (generateRows)
-            m_proxy->dptr()->m_rowCategories = rowList;
-        else
-            rowList = m_proxy->rowCategories();
+        // Sort items into rows and columns. The mapped items are kept, so that later changes
+        // to the model rows can be applied without resolving the whole model again.
+        resolveMappedItems(roles, [&](const QVariant *data) {
+            return readItem(data[0], haveRotation ? data[1] : QVariant());
+        });
+        m_columnCount = m_columnList.size();
 
-        if (generateColumns)
-            m_proxy->dptr()->m_columnCategories = columnList;
-        else
-            columnList = m_proxy->columnCategories();
+        rowLabels = m_rowList;
+        columnLabels = m_columnList;
+    }
 
-        // If dimensions have changed, recreate the array
-        if (m_proxyArray != m_proxy->array() || columnList.size() != m_columnCount
-                || rowList.size() != m_proxyArray->size()) {
-            m_proxyArray = new QBarDataArray;
-            m_proxyArray->reserve(rowList.size());
-            for (int i = 0; i < rowList.size(); i++)
-                m_proxyArray->append(new QBarDataRow(columnList.size()));
-        }
-        // Create new data array from itemValueMap
-        for (int i = 0; i < rowList.size(); i++) {
-            QString rowKey = rowList.at(i);
-            QBarDataRow &newProxyRow = *m_proxyArray->at(i);
-            for (int j = 0; j < columnList.size(); j++) {
-                float value = itemValueMap[rowKey][columnList.at(j)];
-                if (countMatches)
-                    value /= float((*matchCountMap)[rowKey][columnList.at(j)]);
-                newProxyRow[j].setValue(value);
-                if (m_rotationRole != noRoleIndex) {
-                    float angle = itemRotationMap[rowKey][columnList.at(j)];
-                    if (countMatches)
-                        angle /= float((*matchCountMap)[rowKey][columnList.at(j)]);
-                    newProxyRow[j].setRotation(angle);
-                }
-            }
-        }
+    m_proxy->resetArray(m_proxyArray, rowLabels, columnLabels);
+}
 
-        rowLabels = rowList;
-        columnLabels = columnList;
-        m_columnCount = columnList.size();
+QBarDataItem BarItemModelHandler::readItem(const QModelIndex &index) const
+{
+    return readItem(index.data(m_valueRole),
+                    m_rotationRole != noRoleIndex ? index.data(m_rotationRole) : QVariant());
+}
 
-        delete matchCountMap;
+// Safe to call from worker threads, as the patterns are only read
+QBarDataItem BarItemModelHandler::readItem(const QVariant &valueData,
+                                           const QVariant &rotationData) const
+{
+    QBarDataItem item;
+    item.setValue(toFloat(valueData, m_haveValuePattern, m_valuePattern, m_valueReplace));
+    if (m_rotationRole != noRoleIndex) {
+        item.setRotation(toFloat(rotationData, m_haveRotationPattern, m_rotationPattern,
+                                 m_rotationReplace));
     }
+    return item;
+}
 
-    m_proxy->resetArray(m_proxyArray, rowLabels, columnLabels);
+// Roles of the item data, in the order readItem takes them
+QList<int> BarItemModelHandler::itemRoles() const
+{
+    QList<int> roles = {m_valueRole};
+    if (m_rotationRole != noRoleIndex)
+        roles << m_rotationRole;
+    return roles;
+}
+
+// Header labels of the following rows can change when rows are inserted or removed
+void BarItemModelHandler::updateRowLabels()
+{
+    QStringList rowLabels;
+    const int rowCount = m_itemModel->rowCount();
+    for (int i = 0; i < rowCount; i++)
+        rowLabels << m_itemModel->headerData(i, Qt::Vertical).toString();
+    if (rowLabels != m_proxy->rowLabels())
+        m_proxy->setRowLabels(rowLabels);
+}
+
+QBarDataRow *BarItemModelHandler::readRow(int row) const
+{
+    QBarDataRow *newRow = new QBarDataRow(m_columnCount);
+    for (int j = 0; j < m_columnCount; j++)
+        (*newRow)[j] = readItem(m_itemModel->index(row, j));
+    return newRow;
+}
+
+// Items must be added to cells in model order
+void BarItemModelHandler::addToCell(MappedCell &cell, const QBarDataItem &item) const
+{
+    switch (m_proxy->multiMatchBehavior()) {
+    case QItemModelBarDataProxy::MMBFirst:
+        if (!cell.count)
+            cell.item = item;
+        break;
+    case QItemModelBarDataProxy::MMBLast:
+        cell.item = item;
+        break;
+    case QItemModelBarDataProxy::MMBAverage:
+    case QItemModelBarDataProxy::MMBCumulative:
+        cell.item.setValue(cell.item.value() + item.value());
+        cell.item.setRotation(cell.item.rotation() + item.rotation());
+        break;
+    }
+    cell.count++;
+}
+
+QBarDataItem BarItemModelHandler::cellItem(const MappedCell &cell) const
+{
+    QBarDataItem item = cell.item;
+    if (m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBAverage) {
+        item.setValue(item.value() / float(cell.count));
+        item.setRotation(item.rotation() / float(cell.count));
+    }
+    return item;
+}
+
+void BarItemModelHandler::setChangedItem(int row, int column, const QBarDataItem &item)
+{
+    const QBarDataItem *oldItem = m_proxy->itemAt(row, column);
+    if (oldItem->value() != item.value() || oldItem->rotation() != item.rotation())
+        m_proxy->setItem(row, column, item);
+}
+
+void BarItemModelHandler::setGeneratedRowCategories(const QStringList &categories)
+{
+    m_proxy->dptr()->m_rowCategories = categories;
+}
+
+void BarItemModelHandler::setGeneratedColumnCategories(const QStringList &categories)
+{
+    m_proxy->dptr()->m_columnCategories = categories;
+}
+
+void BarItemModelHandler::resetMappedArray()
+{
+    fillMappedArray();
+    m_columnCount = m_columnList.size();
+    m_proxy->resetArray(m_proxyArray, m_rowList, m_columnList);
+}
+
+void BarItemModelHandler::addMappedRows(const QBarDataArray &rows, int first)
+{
+    m_proxy->addRows(rows, m_rowList.mid(first));
+}
+
+void BarItemModelHandler::insertMappedRow(int row, QBarDataRow *newRow)
+{
+    m_proxy->insertRow(row, newRow, m_rowList.at(row));
+}
+
+void BarItemModelHandler::setModelItems(int startRow, int endRow, int startColumn, int endColumn)
+{
+    for (int i = startRow; i <= endRow; i++) {
+        for (int j = startColumn; j <= endColumn; j++)
+            m_proxy->setItem(i, j, readItem(m_itemModel->index(i, j)));
+    }
+}
+
+bool BarItemModelHandler::insertModelRows(int start, int end)
+{
+    QBarDataArray rows;
+    QStringList labels;
+    rows.reserve(end - start + 1);
+    for (int i = start; i <= end; i++) {
+        rows.append(readRow(i));
+        labels << m_itemModel->headerData(i, Qt::Vertical).toString();
+    }
+    m_proxy->insertRows(start, rows, labels);
+    updateRowLabels();
+    return true;
+}
+
+void BarItemModelHandler::setModelRows(int first, int last)
+{
+    QBarDataArray rows;
+    QStringList labels;
+    rows.reserve(last - first + 1);
+    for (int i = first; i <= last; i++) {
+        rows.append(readRow(i));
+        labels << m_itemModel->headerData(i, Qt::Vertical).toString();
+    }
+    m_proxy->setRows(first, rows, labels);
+}
+
+bool BarItemModelHandler::removeModelRows(int start, int end)
+{
+    m_proxy->removeRows(start, end - start + 1);
+    updateRowLabels();
+    return true;
 }
 
 QT_END_NAMESPACE
@@ -19,22 +19,36 @@
 
 QT_BEGIN_NAMESPACE
 
-class BarItemModelHandler : public AbstractItemModelHandler
+class BarItemModelHandler : public MappedItemModelHandler<QItemModelBarDataProxy, QBarDataItem>
 {
     Q_OBJECT
 public:
     BarItemModelHandler(QItemModelBarDataProxy *proxy, QObject *parent = 0);
     virtual ~BarItemModelHandler();
 
-public Q_SLOTS:
-    void handleDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
-                           const QList<int> &roles = QList<int>()) override;
-
 protected:
     void resolveModel() override;
 
-    QItemModelBarDataProxy *m_proxy; // Not owned
-    QBarDataArray *m_proxyArray; // Not owned
+    QBarDataItem readItem(const QModelIndex &index) const override;
+    QBarDataItem readItem(const QVariant &valueData, const QVariant &rotationData) const;
+    QList<int> itemRoles() const;
+    QBarDataRow *readRow(int row) const;
+    void updateRowLabels();
+
+    void addToCell(MappedCell &cell, const QBarDataItem &item) const override;
+    QBarDataItem cellItem(const MappedCell &cell) const override;
+    void setChangedItem(int row, int column, const QBarDataItem &item) override;
+    void setGeneratedRowCategories(const QStringList &categories) override;
+    void setGeneratedColumnCategories(const QStringList &categories) override;
+    void resetMappedArray() override;
+    void addMappedRows(const QBarDataArray &rows, int first) override;
+    void insertMappedRow(int row, QBarDataRow *newRow) override;
+
+    void setModelItems(int startRow, int endRow, int startColumn, int endColumn) override;
+    bool insertModelRows(int start, int end) override;
+    void setModelRows(int first, int last) override;
+    bool removeModelRows(int start, int end) override;
+
     int m_columnCount;
     int m_valueRole;
     int m_rotationRole;
@@ -73,4 +73,56 @@ const QString &BarRenderSliceItem::sliceLabel() const
     return m_sliceLabel;
 }
 
+void BarRenderItemArray::resize(int rowCount, int columnCount)
+{
+    // Old contents are not kept, as the bar indices change with the column count
+    const int size = rowCount * columnCount;
+    m_rowCount = rowCount;
+    m_columnCount = columnCount;
+    m_values.fill(0.0f, size);
+    m_heights.fill(0.0f, size);
+    m_rotations.clear();
+}
+
+void BarRenderItemArray::clear()
+{
+    m_rowCount = 0;
+    m_columnCount = 0;
+    m_values.clear();
+    m_heights.clear();
+    m_rotations.clear();
+}
+
+void BarRenderItemArray::setRotation(int row, int column, const QQuaternion &rotation)
+{
+    if (m_rotations.isEmpty()) {
+        if (rotation.isNull() || rotation.isIdentity())
+            return;
+        m_rotations.resize(m_values.size());
+    }
+
+    if (rotation.isNull())
+        m_rotations[index(row, column)] = identityQuaternion;
+    else
+        m_rotations[index(row, column)] = rotation;
+}
+
+// Drops the rotation array. Used before all bars are updated, so that the array is only
+// recreated if some of the new rotations are not identity.
+void BarRenderItemArray::resetRotations()
+{
+    m_rotations.clear();
+}
+
+// Returns a copy of the bar, for selection labels and slices
+BarRenderItem BarRenderItemArray::item(int row, int column) const
+{
+    BarRenderItem item;
+    item.setValue(value(row, column));
+    item.setHeight(height(row, column));
+    item.setRotation(rotation(row, column));
+    item.setPosition(QPoint(row, column));
+    return item;
+}
+
 QT_END_NAMESPACE
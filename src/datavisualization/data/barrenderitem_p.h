@@ -24,7 +24,7 @@ public:
     BarRenderItem();
     BarRenderItem(const BarRenderItem &other);
     BarRenderItem &operator=(const BarRenderItem &) = default;
-    virtual ~BarRenderItem();
+    ~BarRenderItem();
 
     // Position relative to data window (for bar label generation)
     inline void setPosition(const QPoint &pos) { m_position = pos; }
@@ -52,7 +52,7 @@ public:
     BarRenderSliceItem();
     BarRenderSliceItem(const BarRenderSliceItem &other);
     BarRenderSliceItem &operator=(const BarRenderSliceItem &other) = default;
-    virtual ~BarRenderSliceItem();
+    ~BarRenderSliceItem();
 
     void setItem(const BarRenderItem &renderItem);
 
@@ -69,8 +69,51 @@ protected:
     bool m_isNull;
 };
 
-typedef QList<BarRenderItem> BarRenderItemRow;
-typedef QList<BarRenderItemRow> BarRenderItemArray;
+// Render data of the bars of a series in row-major order. Each field is kept in its own array,
+// so that the draw and buffer update loops only read what they need. Rotations are stored only
+// once some bar has a non-identity rotation. A bar takes 8 bytes, or 24 bytes with rotations.
+// Translations are resolved while drawing, and only selected bars are copied to a BarRenderItem.
+class BarRenderItemArray
+{
+public:
+    inline int rowCount() const { return m_rowCount; }
+    inline int columnCount() const { return m_columnCount; }
+    inline bool isEmpty() const { return m_values.isEmpty(); }
+    void resize(int rowCount, int columnCount);
+    void clear();
+
+    // Actual cached data value of the bar
+    inline float value(int row, int column) const { return m_values.at(index(row, column)); }
+    inline void setValue(int row, int column, float value)
+    {
+        m_values[index(row, column)] = value;
+    }
+
+    // Normalized bar height
+    inline GLfloat height(int row, int column) const { return m_heights.at(index(row, column)); }
+    inline void setHeight(int row, int column, GLfloat height)
+    {
+        m_heights[index(row, column)] = height;
+    }
+
+    inline const QQuaternion &rotation(int row, int column) const
+    {
+        return m_rotations.isEmpty() ? identityQuaternion : m_rotations.at(index(row, column));
+    }
+    void setRotation(int row, int column, const QQuaternion &rotation);
+    void resetRotations();
+
+    BarRenderItem item(int row, int column) const;
+
+private:
+    inline int index(int row, int column) const { return row * m_columnCount + column; }
+
+    int m_rowCount = 0;
+    int m_columnCount = 0;
+    QList<float> m_values;
+    QList<GLfloat> m_heights;
+    QList<QQuaternion> m_rotations;
+};
 
 QT_END_NAMESPACE
 
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "customrenderitem_p.h"
+#include "utils_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -32,8 +33,11 @@ CustomRenderItem::CustomRenderItem()
       m_preserveOpacity(true),
       m_useHighDefShader(true),
       m_drawSlices(false),
-      m_drawSliceFrames(false)
-
+      m_drawSliceFrames(false),
+      m_brickCountX(0),
+      m_brickCountY(0),
+      m_brickCountZ(0),
+      m_brickTexture(0)
 {
 }
 
@@ -64,6 +68,98 @@ void CustomRenderItem::setColorTable(const QList<QRgb> &colors)
     }
 }
 
+void CustomRenderItem::updateBricks(const QList<uchar> *data)
+{
+    updateBricks(data, 0, 0, 0, m_textureWidth + m_textureWidth % 4, m_textureHeight,
+                 m_textureDepth);
+}
+
+void CustomRenderItem::updateBricks(const QList<uchar> *data, int x, int y, int z, int width,
+                                    int height, int depth)
+{
+    // Indexed texture lines are padded, and the padding is a part of the texture
+    const bool indexed = (m_textureFormat == QImage::Format_Indexed8);
+    const int dataWidth = indexed ? m_textureWidth + m_textureWidth % 4 : m_textureWidth;
+    const int countX = (dataWidth + brickSize - 1) / brickSize;
+    const int countY = (m_textureHeight + brickSize - 1) / brickSize;
+    const int countZ = (m_textureDepth + brickSize - 1) / brickSize;
+
+    if (countX != m_brickCountX || countY != m_brickCountY || countZ != m_brickCountZ) {
+        m_brickCountX = countX;
+        m_brickCountY = countY;
+        m_brickCountZ = countZ;
+        m_bricks.fill(0, countX * countY * countZ);
+        if (m_bricks.isEmpty())
+            return;
+        m_brickExtent = QVector3D(float(brickSize) / float(dataWidth),
+                                  float(brickSize) / float(m_textureHeight),
+                                  float(brickSize) / float(m_textureDepth));
+        m_brickScale = QVector3D(float(dataWidth) / float(countX * brickSize),
+                                 float(m_textureHeight) / float(countY * brickSize),
+                                 float(m_textureDepth) / float(countZ * brickSize));
+        // Layout changed, so all bricks need to be checked
+        x = 0;
+        y = 0;
+        z = 0;
+        width = dataWidth;
+        height = m_textureHeight;
+        depth = m_textureDepth;
+    }
+    if (m_bricks.isEmpty() || width <= 0 || height <= 0 || depth <= 0)
+        return;
+
+    const qsizetype pixelWidth = indexed ? 1 : 4;
+    const qsizetype lineSize = dataWidth * pixelWidth;
+    const qsizetype frameSize = lineSize * m_textureHeight;
+    uchar *bricks = m_bricks.data();
+    if (!data || data->size() < frameSize * m_textureDepth) {
+        // Nothing is known about the texture, so no brick can be skipped
+        m_bricks.fill(255);
+        return;
+    }
+
+    bool visibleIndex[256];
+    for (int i = 0; i < 256; i++)
+        visibleIndex[i] = (i < m_colorTable.size() && m_colorTable.at(i).w() > 0.0f);
+
+    // Every brick touched by the changed box is checked as a whole
+    const int firstX = qMax(0, x) / brickSize;
+    const int firstY = qMax(0, y) / brickSize;
+    const int firstZ = qMax(0, z) / brickSize;
+    const int lastX = qMin(countX - 1, (x + width - 1) / brickSize);
+    const int lastY = qMin(countY - 1, (y + height - 1) / brickSize);
+    const int lastZ = qMin(countZ - 1, (z + depth - 1) / brickSize);
+    const uchar *texels = data->constData();
+
+    Utils::parallelFor(lastZ - firstZ + 1, 1, [&](int begin, int end) {
+        for (int bz = firstZ + begin; bz < firstZ + end; bz++) {
+            const int endZ = qMin((bz + 1) * brickSize, m_textureDepth);
+            for (int by = firstY; by <= lastY; by++) {
+                const int endY = qMin((by + 1) * brickSize, m_textureHeight);
+                for (int bx = firstX; bx <= lastX; bx++) {
+                    const int startX = bx * brickSize;
+                    const int endX = qMin(startX + brickSize, dataWidth);
+                    bool visible = false;
+                    for (int tz = bz * brickSize; tz < endZ && !visible; tz++) {
+                        for (int ty = by * brickSize; ty < endY && !visible; ty++) {
+                            const uchar *line = texels + frameSize * tz + lineSize * ty;
+                            for (int tx = startX; tx < endX && !visible; tx++) {
+                                if (indexed) {
+                                    visible = visibleIndex[line[tx]];
+                                } else {
+                                    visible = qAlpha(reinterpret_cast<const QRgb *>(line)[tx])
+                                            > 0;
+                                }
+                            }
+                        }
+                    }
+                    bricks[(bz * countY + by) * countX + bx] = visible ? 255 : 0;
+                }
+            }
+        }
+    });
+}
+
 void CustomRenderItem::setMinBounds(const QVector3D &bounds)
 {
     m_minBounds = bounds;
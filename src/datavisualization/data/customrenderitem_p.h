@@ -124,6 +124,24 @@ public:
     inline void setSliceFrameThicknesses(const QVector3D &thicknesses) { m_sliceFrameThicknesses = thicknesses; }
     inline const QVector3D &sliceFrameThicknesses() const { return m_sliceFrameThicknesses; }
 
+    // Empty space skipping. The texture is divided into bricks of brickSize^3 texels, and
+    // a brick is nonzero if any of its texels is visible.
+    void updateBricks(const QList<uchar> *data);
+    void updateBricks(const QList<uchar> *data, int x, int y, int z, int width, int height,
+                      int depth);
+    inline const QList<uchar> &bricks() const { return m_bricks; }
+    inline int brickCountX() const { return m_brickCountX; }
+    inline int brickCountY() const { return m_brickCountY; }
+    inline int brickCountZ() const { return m_brickCountZ; }
+    // Size of a brick in texture coordinates
+    inline const QVector3D &brickExtent() const { return m_brickExtent; }
+    // Scales texture coordinates to brick texture coordinates
+    inline const QVector3D &brickScale() const { return m_brickScale; }
+    inline void setBrickTexture(GLuint texture) { m_brickTexture = texture; }
+    inline GLuint brickTexture() const { return m_brickTexture; }
+
+    static const int brickSize = 8;
+
 private:
     Q_DISABLE_COPY(CustomRenderItem)
 
@@ -169,6 +187,13 @@ private:
     QVector3D m_sliceFrameWidths;
     QVector3D m_sliceFrameGaps;
     QVector3D m_sliceFrameThicknesses;
+    QList<uchar> m_bricks;
+    int m_brickCountX;
+    int m_brickCountY;
+    int m_brickCountZ;
+    QVector3D m_brickExtent;
+    QVector3D m_brickScale;
+    GLuint m_brickTexture;
 };
 typedef QHash<QCustom3DItem *, CustomRenderItem *> CustomRenderItemArray;
 
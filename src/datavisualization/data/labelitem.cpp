@@ -2,12 +2,15 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "labelitem_p.h"
+#include "glyphatlas_p.h"
+#include "framestatisticscollector_p.h"
 
 QT_BEGIN_NAMESPACE
 
 LabelItem::LabelItem()
     : m_size(QSize(0, 0)),
-      m_textureId(0)
+      m_vertexBuffer(0),
+      m_vertexCount(0)
 {
 }
 
@@ -26,22 +29,34 @@ QSize LabelItem::size() const
     return m_size;
 }
 
-void LabelItem::setTextureId(GLuint textureId)
+void LabelItem::setGlyphData(const QSharedPointer<GlyphAtlasPage> &page,
+                             const QList<GLfloat> &vertices)
 {
-    QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
-    m_textureId = textureId;
+    QOpenGLFunctions *funcs = QOpenGLContext::currentContext()->functions();
+    if (!m_vertexBuffer)
+        funcs->glGenBuffers(1, &m_vertexBuffer);
+    funcs->glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    FrameStatisticsCollector::countBufferUpload(vertices.size() * sizeof(GLfloat));
+    funcs->glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat),
+                        vertices.constData(), GL_STATIC_DRAW);
+    funcs->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_page = page;
+    m_vertexCount = vertices.size() / vertexComponents;
 }
 
 GLuint LabelItem::textureId() const
 {
-    return m_textureId;
+    return m_page ? m_page->textureId() : 0;
 }
 
 void LabelItem::clear()
 {
-    if (m_textureId && QOpenGLContext::currentContext())
-        QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
-    m_textureId = 0;
+    if (m_vertexBuffer && QOpenGLContext::currentContext())
+        QOpenGLContext::currentContext()->functions()->glDeleteBuffers(1, &m_vertexBuffer);
+    m_vertexBuffer = 0;
+    m_vertexCount = 0;
+    m_page.reset();
     m_size = QSize(0, 0);
 }
 
@@ -15,10 +15,16 @@
 #define LABELITEM_P_H
 
 #include <private/datavisualizationglobal_p.h>
+#include <QtCore/QList>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QSize>
 
 QT_BEGIN_NAMESPACE
 
+class GlyphAtlasPage;
+
+// Label geometry built from glyphs of a shared atlas page. The vertex buffer holds triangles
+// with interleaved positions on the label plane and texture coordinates.
 class LabelItem
 {
 public:
@@ -27,15 +33,23 @@ public:
 
     void setSize(const QSize &size);
     QSize size() const;
-    void setTextureId(GLuint textureId);
+    void setGlyphData(const QSharedPointer<GlyphAtlasPage> &page,
+                      const QList<GLfloat> &vertices);
     GLuint textureId() const;
+    inline GLuint vertexBuffer() const { return m_vertexBuffer; }
+    inline int vertexCount() const { return m_vertexCount; }
     void clear();
 
+    static const int vertexComponents = 5;
+    static const int uvOffset = 3;
+
 private:
     Q_DISABLE_COPY(LabelItem)
 
     QSize m_size;
-    GLuint m_textureId;
+    QSharedPointer<GlyphAtlasPage> m_page;
+    GLuint m_vertexBuffer;
+    int m_vertexCount;
 };
 
 QT_END_NAMESPACE
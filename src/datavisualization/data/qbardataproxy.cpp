@@ -528,7 +528,8 @@ const QBarDataProxyPrivate *QBarDataProxy::dptrc() const
 
 QBarDataProxyPrivate::QBarDataProxyPrivate(QBarDataProxy *q)
     : QAbstractDataProxyPrivate(q, QAbstractDataProxy::DataTypeBar),
-      m_dataArray(new QBarDataArray)
+      m_dataArray(new QBarDataArray),
+      m_rowLimitsValid(false)
 {
 }
 
@@ -552,6 +553,9 @@ void QBarDataProxyPrivate::resetArray(QBarDataArray *newArray, const QStringList
         clearArray();
         m_dataArray = newArray;
     }
+
+    m_rowLimits.clear();
+    m_rowLimitsValid = false;
 }
 
 void QBarDataProxyPrivate::setRow(int rowIndex, QBarDataRow *row, const QString *label)
@@ -564,6 +568,7 @@ void QBarDataProxyPrivate::setRow(int rowIndex, QBarDataRow *row, const QString
         clearRow(rowIndex);
         (*m_dataArray)[rowIndex] = row;
     }
+    setRowLimitsDirty(rowIndex, 1);
 }
 
 void QBarDataProxyPrivate::setRows(int rowIndex, const QBarDataArray &rows,
@@ -573,6 +578,7 @@ void QBarDataProxyPrivate::setRows(int rowIndex, const QBarDataArray &rows,
     Q_ASSERT(rowIndex >= 0 && (rowIndex + rows.size()) <= dataArray.size());
     if (labels)
         fixRowLabels(rowIndex, rows.size(), *labels, false);
+    setRowLimitsDirty(rowIndex, rows.size());
     for (int i = 0; i < rows.size(); i++) {
         if (rows.at(i) != dataArray.at(rowIndex)) {
             clearRow(rowIndex);
@@ -588,6 +594,7 @@ void QBarDataProxyPrivate::setItem(int rowIndex, int columnIndex, const QBarData
     QBarDataRow &row = *(*m_dataArray)[rowIndex];
     Q_ASSERT(columnIndex < row.size());
     row[columnIndex] = item;
+    setRowLimitsDirty(rowIndex, 1);
 }
 
 int QBarDataProxyPrivate::addRow(QBarDataRow *row, const QString *label)
@@ -596,6 +603,7 @@ int QBarDataProxyPrivate::addRow(QBarDataRow *row, const QString *label)
     if (label)
         fixRowLabels(currentSize, 1, QStringList(*label), false);
     m_dataArray->append(row);
+    insertRowLimits(currentSize, 1);
     return currentSize;
 }
 
@@ -606,6 +614,7 @@ int QBarDataProxyPrivate::addRows(const QBarDataArray &rows, const QStringList *
         fixRowLabels(currentSize, rows.size(), *labels, false);
     for (int i = 0; i < rows.size(); i++)
         m_dataArray->append(rows.at(i));
+    insertRowLimits(currentSize, rows.size());
     return currentSize;
 }
 
@@ -615,6 +624,7 @@ void QBarDataProxyPrivate::insertRow(int rowIndex, QBarDataRow *row, const QStri
     if (label)
         fixRowLabels(rowIndex, 1, QStringList(*label), true);
     m_dataArray->insert(rowIndex, row);
+    insertRowLimits(rowIndex, 1);
 }
 
 void QBarDataProxyPrivate::insertRows(int rowIndex, const QBarDataArray &rows,
@@ -623,6 +633,7 @@ void QBarDataProxyPrivate::insertRows(int rowIndex, const QBarDataArray &rows,
     Q_ASSERT(rowIndex >= 0 && rowIndex <= m_dataArray->size());
     if (labels)
         fixRowLabels(rowIndex, rows.size(), *labels, true);
+    insertRowLimits(rowIndex, rows.size());
     for (int i = 0; i < rows.size(); i++)
         m_dataArray->insert(rowIndex++, rows.at(i));
 }
@@ -641,6 +652,8 @@ void QBarDataProxyPrivate::removeRows(int rowIndex, int removeCount, bool remove
             labelsChanged = true;
         }
     }
+    if (m_rowLimitsValid && removeCount > 0)
+        m_rowLimits.remove(rowIndex, removeCount);
     if (labelsChanged)
         emit qptr()->rowLabelsChanged();
 }
@@ -741,19 +754,63 @@ QPair<GLfloat, GLfloat> QBarDataProxyPrivate::limitValues(int startRow, int endR
         QBarDataRow *row = m_dataArray->at(i);
         if (row) {
             int lastColumn = qMin(endColumn, row->size() - 1);
-            for (int j = startColumn; j <= lastColumn; j++) {
-                const QBarDataItem &item = row->at(j);
-                float itemValue = item.value();
-                if (limits.second < itemValue)
-                    limits.second = itemValue;
-                if (limits.first > itemValue)
-                    limits.first = itemValue;
+            if (startColumn == 0 && lastColumn == row->size() - 1) {
+                // Whole row is in range, so cached limits of the row can be used
+                const QPair<GLfloat, GLfloat> &cachedLimits = rowLimits(i);
+                limits.first = qMin(limits.first, cachedLimits.first);
+                limits.second = qMax(limits.second, cachedLimits.second);
+            } else {
+                addToLimits(limits, *row, startColumn, lastColumn);
             }
         }
     }
     return limits;
 }
 
+void QBarDataProxyPrivate::addToLimits(QPair<GLfloat, GLfloat> &limits, const QBarDataRow &row,
+                                       int startColumn, int endColumn)
+{
+    for (int j = startColumn; j <= endColumn; j++) {
+        const QBarDataItem &item = row.at(j);
+        float itemValue = item.value();
+        if (limits.second < itemValue)
+            limits.second = itemValue;
+        if (limits.first > itemValue)
+            limits.first = itemValue;
+    }
+}
+
+void QBarDataProxyPrivate::setRowLimitsDirty(int rowIndex, int count)
+{
+    if (m_rowLimitsValid) {
+        for (int i = rowIndex; i < rowIndex + count; i++)
+            m_rowLimits[i].dirty = true;
+    }
+}
+
+void QBarDataProxyPrivate::insertRowLimits(int rowIndex, int count)
+{
+    if (m_rowLimitsValid && count > 0)
+        m_rowLimits.insert(rowIndex, count, RowLimits());
+}
+
+const QPair<GLfloat, GLfloat> &QBarDataProxyPrivate::rowLimits(int rowIndex) const
+{
+    if (!m_rowLimitsValid) {
+        m_rowLimits.resize(m_dataArray->size());
+        m_rowLimitsValid = true;
+    }
+
+    RowLimits &cachedLimits = m_rowLimits[rowIndex];
+    if (cachedLimits.dirty) {
+        cachedLimits.limits = qMakePair(0.0f, 0.0f);
+        if (const QBarDataRow *row = m_dataArray->at(rowIndex))
+            addToLimits(cachedLimits.limits, *row, 0, row->size() - 1);
+        cachedLimits.dirty = false;
+    }
+    return cachedLimits.limits;
+}
+
 void QBarDataProxyPrivate::setSeries(QAbstract3DSeries *series)
 {
     QAbstractDataProxyPrivate::setSeries(series);
@@ -43,14 +43,31 @@ public:
     void setSeries(QAbstract3DSeries *series) override;
 
 private:
+    // Value limits of a whole row, used to avoid rescanning unchanged rows when
+    // recalculating axis ranges
+    struct RowLimits
+    {
+        RowLimits() : limits(0.0f, 0.0f), dirty(true) {}
+
+        QPair<GLfloat, GLfloat> limits;
+        bool dirty;
+    };
+
     QBarDataProxy *qptr();
     void clearRow(int rowIndex);
     void clearArray();
     void fixRowLabels(int startIndex, int count, const QStringList &newLabels, bool isInsert);
+    void setRowLimitsDirty(int rowIndex, int count);
+    void insertRowLimits(int rowIndex, int count);
+    const QPair<GLfloat, GLfloat> &rowLimits(int rowIndex) const;
+    static void addToLimits(QPair<GLfloat, GLfloat> &limits, const QBarDataRow &row,
+                            int startColumn, int endColumn);
 
     QBarDataArray *m_dataArray;
     QStringList m_rowLabels;
     QStringList m_columnLabels;
+    mutable QList<RowLimits> m_rowLimits;
+    mutable bool m_rowLimitsValid;
 
 private:
     friend class QBarDataProxy;
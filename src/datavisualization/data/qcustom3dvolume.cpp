@@ -554,6 +554,7 @@ void QCustom3DVolume::setTextureData(QList<uchar> *data)
     // can be changed unbeknownst to us via the array pointer.
     dptr()->m_textureData = data;
     dptr()->m_dirtyBitsVolume.textureDataDirty = true;
+    dptr()->m_dirtyTextureBoxes.clear();
     emit textureDataChanged(data);
     emit dptr()->needUpdate();
 }
@@ -715,7 +716,15 @@ void QCustom3DVolume::setSubTextureData(Qt::Axis axis, int index, const uchar *d
                 void *subTexPtr = dataPtr + targetIndex;
                 memcpy(subTexPtr, static_cast<const void *>(data), frameSize);
             }
-            dptr()->m_dirtyBitsVolume.textureDataDirty = true;
+            int dataWidth = lineSize / pixelWidth;
+            if (axis == Qt::XAxis) {
+                dptr()->markTextureBoxDirty(index, 0, 0, 1, dptr()->m_textureHeight,
+                                            dptr()->m_textureDepth);
+            } else if (axis == Qt::YAxis) {
+                dptr()->markTextureBoxDirty(0, index, 0, dataWidth, 1, dptr()->m_textureDepth);
+            } else {
+                dptr()->markTextureBoxDirty(0, 0, index, dataWidth, dptr()->m_textureHeight, 1);
+            }
             emit textureDataChanged(dptr()->m_textureData);
             emit dptr()->needUpdate();
         }
@@ -777,6 +786,56 @@ void QCustom3DVolume::setSubTextureData(Qt::Axis axis, int index, const QImage &
     }
 }
 
+/*!
+ * \since 6.6
+ *
+ * Sets a box of the 3D texture. The box starts at the texel specified by \a x, \a y, and \a z,
+ * and its size is \a width, \a height, and \a depth texels.
+ * The texture \a data must be in the format specified by the textureFormat property. It is
+ * ordered like the data in textureData: \a depth subtextures of \a height lines, where each
+ * line holds \a width texels. Unlike in textureData, the lines must not be padded.
+ *
+ * Only the changed part of the texture is uploaded to the graphics hardware. Updating a small
+ * part of a large volume does not cost a reupload of the whole volume.
+ *
+ * \sa textureData, renderSlice()
+ */
+void QCustom3DVolume::setSubTextureData(int x, int y, int z, int width, int height, int depth,
+                                        const uchar *data)
+{
+    if (!data) {
+        qWarning() << __FUNCTION__ << "Tried to set null data.";
+        return;
+    }
+
+    qsizetype lineSize = textureDataWidth();
+    qsizetype frameSize = lineSize * dptr()->m_textureHeight;
+    int pixelWidth = (dptr()->m_textureFormat == QImage::Format_Indexed8) ? 1 : 4;
+    if (!dptr()->m_textureData || x < 0 || y < 0 || z < 0
+            || width <= 0 || height <= 0 || depth <= 0
+            || x + width > dptr()->m_textureWidth
+            || y + height > dptr()->m_textureHeight
+            || z + depth > dptr()->m_textureDepth
+            || frameSize * (z + depth) > dptr()->m_textureData->size()) {
+        qWarning() << __FUNCTION__ << "Attempted to set invalid subtexture.";
+        return;
+    }
+
+    const uchar *sourcePtr = data;
+    uchar *dataPtr = dptr()->m_textureData->data();
+    int boxLineSize = width * pixelWidth;
+    for (int i = z; i < z + depth; i++) {
+        for (int j = y; j < y + height; j++) {
+            memcpy(dataPtr + frameSize * i + lineSize * j + x * pixelWidth, sourcePtr,
+                   boxLineSize);
+            sourcePtr += boxLineSize;
+        }
+    }
+    dptr()->markTextureBoxDirty(x, y, z, width, height, depth);
+    emit textureDataChanged(dptr()->m_textureData);
+    emit dptr()->needUpdate();
+}
+
 // Note: textureFormat is not a Q_PROPERTY to work around an issue in meta object system that
 // doesn't allow QImage::format to be a property type. Qt 5.2.1 at least has this problem.
 
@@ -1208,6 +1267,24 @@ void QCustom3DVolumePrivate::resetDirtyBits()
     m_dirtyBitsVolume.textureFormatDirty = false;
     m_dirtyBitsVolume.alphaDirty = false;
     m_dirtyBitsVolume.shaderDirty = false;
+    m_dirtyTextureBoxes.clear();
+}
+
+void QCustom3DVolumePrivate::markTextureBoxDirty(int x, int y, int z, int width, int height,
+                                                 int depth)
+{
+    // Each box is uploaded separately, so a lot of boxes are cheaper to upload all at once
+    static const int maxDirtyTextureBoxes = 16;
+
+    if (m_dirtyBitsVolume.textureDataDirty)
+        return;
+
+    if (m_dirtyTextureBoxes.size() >= maxDirtyTextureBoxes) {
+        m_dirtyBitsVolume.textureDataDirty = true;
+        m_dirtyTextureBoxes.clear();
+    } else {
+        m_dirtyTextureBoxes.append({x, y, z, width, height, depth});
+    }
 }
 
 QImage QCustom3DVolumePrivate::renderSlice(Qt::Axis axis, int index)
@@ -70,6 +70,8 @@ public:
     QList<uchar> *textureData() const;
     void setSubTextureData(Qt::Axis axis, int index, const uchar *data);
     void setSubTextureData(Qt::Axis axis, int index, const QImage &image);
+    void setSubTextureData(int x, int y, int z, int width, int height, int depth,
+                           const uchar *data);
 
     void setTextureFormat(QImage::Format format);
     QImage::Format textureFormat() const;
@@ -40,6 +40,16 @@ struct QCustomVolumeDirtyBitField {
     }
 };
 
+// Part of the texture data changed since the last sync, in texels
+struct QCustomVolumeTextureBox {
+    int x;
+    int y;
+    int z;
+    int width;
+    int height;
+    int depth;
+};
+
 class QCustom3DVolumePrivate : public QCustom3DItemPrivate
 {
     Q_OBJECT
@@ -53,6 +63,7 @@ public:
     virtual ~QCustom3DVolumePrivate();
 
     void resetDirtyBits();
+    void markTextureBoxDirty(int x, int y, int z, int width, int height, int depth);
     QImage renderSlice(Qt::Axis axis, int index);
 
     QCustom3DVolume *qptr();
@@ -81,6 +92,7 @@ public:
     QVector3D m_sliceFrameThicknesses;
 
     QCustomVolumeDirtyBitField m_dirtyBitsVolume;
+    QList<QCustomVolumeTextureBox> m_dirtyTextureBoxes;
 
 private:
     int multipliedAlphaValue(int alpha);
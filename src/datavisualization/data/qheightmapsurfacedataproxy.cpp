@@ -662,35 +662,16 @@ void QHeightMapSurfaceDataProxyPrivate::handlePendingResolve()
     int widthBits = imageWidth * 4 * bytesInChannel;
     float height = 0;
 
-    // Do not recreate array if dimensions have not changed
-    QSurfaceDataArray *dataArray = m_dataArray;
-    if (imageWidth != qptr()->columnCount() || imageHeight != dataArray->size()) {
-        dataArray = new QSurfaceDataArray;
-        dataArray->reserve(imageHeight);
-        for (int i = 0; i < imageHeight; i++) {
-            QSurfaceDataRow *newProxyRow = new QSurfaceDataRow(imageWidth);
-            dataArray->append(newProxyRow);
-        }
-    }
+    // Heights are stored as a contiguous grid, the x and z values are implied by the value
+    // ranges. The last row and column are exactly at the maximum values.
+    QList<float> heights(imageWidth * imageHeight);
+    float *heightPtr = heights.data();
     yMul *= m_maxYValue - m_minYValue;
-    float xMul = (m_maxXValue - m_minXValue) / float(imageWidth - 1);
-    float zMul = (m_maxZValue - m_minZValue) / float(imageHeight - 1);
-
-    // Last row and column are explicitly set to max values, as relying
-    // on multiplier can cause rounding errors, resulting in the value being
-    // slightly over the specified maximum, which in turn can lead to it not
-    // getting rendered.
-    int lastRow = imageHeight - 1;
+
     int lastCol = imageWidth - 1;
     if (heightImage.isGrayscale()) {
         // Grayscale, it's enough to read Red byte
         for (int i = 0; i < imageHeight; i++, bitCount -= widthBits) {
-            QSurfaceDataRow &newRow = *dataArray->at(i);
-            float zVal;
-            if (i == lastRow)
-                zVal = m_maxZValue;
-            else
-                zVal = (float(i) * zMul) + m_minZValue;
             int j = 0;
             float yVal = 0;
             uchar *pixelptr;
@@ -700,23 +681,13 @@ void QHeightMapSurfaceDataProxyPrivate::handlePendingResolve()
                     yVal = *pixelptr;
                 else
                     yVal = float(*pixelptr) * yMul + m_minYValue;
-                newRow[j].setPosition(QVector3D((float(j) * xMul) + m_minXValue,
-                                                yVal,
-                                                zVal));
+                *heightPtr++ = yVal;
             }
-            newRow[j].setPosition(QVector3D(m_maxXValue,
-                                            yVal,
-                                            zVal));
+            *heightPtr++ = yVal;
         }
     } else {
         // Not grayscale, we'll need to calculate height from RGB
         for (int i = 0; i < imageHeight; i++, bitCount -= widthBits) {
-            QSurfaceDataRow &newRow = *dataArray->at(i);
-            float zVal;
-            if (i == lastRow)
-                zVal = m_maxZValue;
-            else
-                zVal = (float(i) * zMul) + m_minZValue;
             int j = 0;
             float yVal = 0;
             for (; j < lastCol; j++) {
@@ -736,17 +707,14 @@ void QHeightMapSurfaceDataProxyPrivate::handlePendingResolve()
                 else
                     yVal = (height / 3.0f * yMul) + m_minYValue;
 
-                newRow[j].setPosition(QVector3D((float(j) * xMul) + m_minXValue,
-                                                yVal,
-                                                zVal));
+                *heightPtr++ = yVal;
             }
-            newRow[j].setPosition(QVector3D(m_maxXValue,
-                                            yVal,
-                                            zVal));
+            *heightPtr++ = yVal;
         }
     }
 
-    qptr()->resetArray(dataArray);
+    qptr()->resetArrayFromHeights(heights, imageWidth, m_minXValue, m_maxXValue,
+                                  m_minZValue, m_maxZValue);
     emit qptr()->heightMapChanged(m_heightMap);
 }
 
@@ -278,9 +278,13 @@ const QScatterDataProxyPrivate *QScatterDataProxy::dptrc() const
 
 // QScatterDataProxyPrivate
 
+static const int limitBlockSize = 4096;
+
 QScatterDataProxyPrivate::QScatterDataProxyPrivate(QScatterDataProxy *q)
     : QAbstractDataProxyPrivate(q, QAbstractDataProxy::DataTypeScatter),
-      m_dataArray(new QScatterDataArray)
+      m_dataArray(new QScatterDataArray),
+      m_limitBlocksValid(false),
+      m_limitsDirty(true)
 {
 }
 
@@ -300,25 +304,34 @@ void QScatterDataProxyPrivate::resetArray(QScatterDataArray *newArray)
         delete m_dataArray;
         m_dataArray = newArray;
     }
+
+    m_limitBlocks.clear();
+    m_limitBlocksValid = false;
+    m_limitsDirty = true;
 }
 
 void QScatterDataProxyPrivate::setItem(int index, const QScatterDataItem &item)
 {
     Q_ASSERT(index >= 0 && index < m_dataArray->size());
+    removeFromLimits(index, 1);
     (*m_dataArray)[index] = item;
+    addToLimits(index, 1);
 }
 
 void QScatterDataProxyPrivate::setItems(int index, const QScatterDataArray &items)
 {
     Q_ASSERT(index >= 0 && (index + items.size()) <= m_dataArray->size());
+    removeFromLimits(index, items.size());
     for (int i = 0; i < items.size(); i++)
-        (*m_dataArray)[index++] = items[i];
+        (*m_dataArray)[index + i] = items[i];
+    addToLimits(index, items.size());
 }
 
 int QScatterDataProxyPrivate::addItem(const QScatterDataItem &item)
 {
     int currentSize = m_dataArray->size();
     m_dataArray->append(item);
+    insertToLimits(currentSize, 1);
     return currentSize;
 }
 
@@ -326,6 +339,7 @@ int QScatterDataProxyPrivate::addItems(const QScatterDataArray &items)
 {
     int currentSize = m_dataArray->size();
     (*m_dataArray) += items;
+    insertToLimits(currentSize, items.size());
     return currentSize;
 }
 
@@ -333,13 +347,15 @@ void QScatterDataProxyPrivate::insertItem(int index, const QScatterDataItem &ite
 {
     Q_ASSERT(index >= 0 && index <= m_dataArray->size());
     m_dataArray->insert(index, item);
+    insertToLimits(index, 1);
 }
 
 void QScatterDataProxyPrivate::insertItems(int index, const QScatterDataArray &items)
 {
     Q_ASSERT(index >= 0 && index <= m_dataArray->size());
     for (int i = 0; i < items.size(); i++)
-        m_dataArray->insert(index++, items.at(i));
+        m_dataArray->insert(index + i, items.at(i));
+    insertToLimits(index, items.size());
 }
 
 void QScatterDataProxyPrivate::removeItems(int index, int removeCount)
@@ -347,70 +363,209 @@ void QScatterDataProxyPrivate::removeItems(int index, int removeCount)
     Q_ASSERT(index >= 0);
     int maxRemoveCount = m_dataArray->size() - index;
     removeCount = qMin(removeCount, maxRemoveCount);
+    removeFromLimits(index, removeCount);
+    removeLimitBlockItems(index, removeCount);
     m_dataArray->remove(index, removeCount);
 }
 
-void QScatterDataProxyPrivate::limitValues(QVector3D &minValues, QVector3D &maxValues,
-                                           QAbstract3DAxis *axisX, QAbstract3DAxis *axisY,
-                                           QAbstract3DAxis *axisZ) const
+// Adds a position to per-axis limits. Like a full scan, a non-finite coordinate causes
+// the rest of the coordinates of the same item to be skipped.
+void QScatterDataProxyPrivate::addToLimits(ValueLimits *limits, const QVector3D &position)
 {
-    if (m_dataArray->isEmpty())
+    if (qIsNaN(position.x()) || qIsInf(position.x()))
         return;
+    limits[0].add(position.x());
+    if (qIsNaN(position.y()) || qIsInf(position.y()))
+        return;
+    limits[1].add(position.y());
+    limits[2].add(position.z());
+}
 
-    const QVector3D &firstPos = m_dataArray->at(0).position();
+bool QScatterDataProxyPrivate::isLimit(const ValueLimits *limits, const QVector3D &position)
+{
+    if (qIsNaN(position.x()) || qIsInf(position.x()))
+        return false;
+    if (limits[0].isLimit(position.x()))
+        return true;
+    if (qIsNaN(position.y()) || qIsInf(position.y()))
+        return false;
+    return limits[1].isLimit(position.y()) || limits[2].isLimit(position.z());
+}
+
+// Returns the index of the block containing the item at index, or the last block if index
+// is one past the end of the array. Returns -1 if there are no blocks.
+int QScatterDataProxyPrivate::findLimitBlock(int index, int &blockStart) const
+{
+    blockStart = 0;
+    const int blockCount = m_limitBlocks.size();
+    for (int i = 0; i < blockCount; i++) {
+        const int blockEnd = blockStart + m_limitBlocks.at(i).count;
+        if (index < blockEnd || i == blockCount - 1)
+            return i;
+        blockStart = blockEnd;
+    }
+    return -1;
+}
 
-    float minX = firstPos.x();
-    float maxX = minX;
-    float minY = firstPos.y();
-    float maxY = minY;
-    float minZ = firstPos.z();
-    float maxZ = minZ;
-
-    if (m_dataArray->size() > 1) {
-        for (int i = 1; i < m_dataArray->size(); i++) {
-            const QVector3D &pos = m_dataArray->at(i).position();
-
-            float value = pos.x();
-            if (qIsNaN(value) || qIsInf(value))
-                continue;
-            if (isValidValue(minX, value, axisX))
-                minX = value;
-            if (maxX < value)
-                maxX = value;
-
-            value = pos.y();
-            if (qIsNaN(value) || qIsInf(value))
-                continue;
-            if (isValidValue(minY, value, axisY))
-                minY = value;
-            if (maxY < value)
-                maxY = value;
-
-            value = pos.z();
-            if (qIsNaN(value) || qIsInf(value))
-                continue;
-            if (isValidValue(minZ, value, axisZ))
-                minZ = value;
-            if (maxZ < value)
-                maxZ = value;
+// Must be called before items in the range are overwritten or removed
+void QScatterDataProxyPrivate::removeFromLimits(int index, int count)
+{
+    if (count <= 0)
+        return;
+
+    // The limits only need recalculating if one of the old values was a limit
+    if (!m_limitsDirty) {
+        for (int i = index; i < index + count; i++) {
+            if (isLimit(m_limits, m_dataArray->at(i).position())) {
+                m_limitsDirty = true;
+                break;
+            }
         }
     }
 
-    minValues.setX(minX);
-    minValues.setY(minY);
-    minValues.setZ(minZ);
+    if (m_limitBlocksValid) {
+        int blockStart = 0;
+        int block = findLimitBlock(index, blockStart);
+        for (; block < m_limitBlocks.size() && blockStart < index + count; block++) {
+            m_limitBlocks[block].dirty = true;
+            blockStart += m_limitBlocks.at(block).count;
+        }
+    }
+}
 
-    maxValues.setX(maxX);
-    maxValues.setY(maxY);
-    maxValues.setZ(maxZ);
+// Must be called after items in the range are overwritten
+void QScatterDataProxyPrivate::addToLimits(int index, int count)
+{
+    if (!m_limitsDirty) {
+        for (int i = index; i < index + count; i++)
+            addToLimits(m_limits, m_dataArray->at(i).position());
+    }
 }
 
-bool QScatterDataProxyPrivate::isValidValue(float axisValue, float value,
-                                            QAbstract3DAxis *axis) const
+// Must be called after items are inserted to the range
+void QScatterDataProxyPrivate::insertToLimits(int index, int count)
 {
-    return (axisValue > value && (value > 0.0f
-                                  || (value == 0.0f && axis->d_ptr->allowZero())
-                                  || (value < 0.0f && axis->d_ptr->allowNegatives())));
+    if (count <= 0)
+        return;
+
+    addToLimits(index, count);
+
+    if (!m_limitBlocksValid)
+        return;
+
+    int blockStart = 0;
+    int block = findLimitBlock(index, blockStart);
+    if (block < 0 || m_limitBlocks.at(block).count + count > 2 * limitBlockSize) {
+        // Split the affected block and the new items into blocks of regular size
+        int itemCount = count;
+        if (block >= 0) {
+            itemCount += m_limitBlocks.at(block).count;
+            m_limitBlocks.removeAt(block);
+        } else {
+            block = 0;
+        }
+        while (itemCount > 0) {
+            LimitBlock newBlock;
+            newBlock.count = qMin(itemCount, limitBlockSize);
+            newBlock.dirty = true;
+            m_limitBlocks.insert(block++, newBlock);
+            itemCount -= newBlock.count;
+        }
+    } else {
+        LimitBlock &targetBlock = m_limitBlocks[block];
+        targetBlock.count += count;
+        if (!targetBlock.dirty) {
+            for (int i = index; i < index + count; i++)
+                addToLimits(targetBlock.limits, m_dataArray->at(i).position());
+        }
+    }
+}
+
+// Must be called before items in the range are removed
+void QScatterDataProxyPrivate::removeLimitBlockItems(int index, int count)
+{
+    if (!m_limitBlocksValid || count <= 0)
+        return;
+
+    int blockStart = 0;
+    int block = findLimitBlock(index, blockStart);
+    int removeEnd = index + count;
+    while (block >= 0 && block < m_limitBlocks.size() && blockStart < removeEnd) {
+        LimitBlock &currentBlock = m_limitBlocks[block];
+        const int blockEnd = blockStart + currentBlock.count;
+        const int removed = qMin(blockEnd, removeEnd) - qMax(blockStart, index);
+        currentBlock.count -= removed;
+        removeEnd -= removed;
+        blockStart = blockEnd - removed;
+        if (currentBlock.count == 0)
+            m_limitBlocks.removeAt(block);
+        else
+            block++;
+    }
+}
+
+void QScatterDataProxyPrivate::updateLimits() const
+{
+    if (!m_limitsDirty)
+        return;
+
+    const int arraySize = m_dataArray->size();
+    if (!m_limitBlocksValid) {
+        for (int i = 0; i < arraySize; i += limitBlockSize) {
+            LimitBlock block;
+            block.count = qMin(limitBlockSize, arraySize - i);
+            block.dirty = true;
+            m_limitBlocks.append(block);
+        }
+        m_limitBlocksValid = true;
+    }
+
+    for (int i = 0; i < 3; i++)
+        m_limits[i] = ValueLimits();
+
+    int blockStart = 0;
+    for (int i = 0; i < m_limitBlocks.size(); i++) {
+        LimitBlock &block = m_limitBlocks[i];
+        if (block.dirty) {
+            for (int j = 0; j < 3; j++)
+                block.limits[j] = ValueLimits();
+            for (int j = blockStart; j < blockStart + block.count; j++)
+                addToLimits(block.limits, m_dataArray->at(j).position());
+            block.dirty = false;
+        }
+        for (int j = 0; j < 3; j++)
+            m_limits[j].merge(block.limits[j]);
+        blockStart += block.count;
+    }
+
+    m_limitsDirty = false;
+}
+
+void QScatterDataProxyPrivate::limitValues(QVector3D &minValues, QVector3D &maxValues,
+                                           QAbstract3DAxis *axisX, QAbstract3DAxis *axisY,
+                                           QAbstract3DAxis *axisZ) const
+{
+    if (m_dataArray->isEmpty())
+        return;
+
+    updateLimits();
+
+    // The first item is used as the initial limits even if it is not valid for the axis
+    const QVector3D &firstPos = m_dataArray->at(0).position();
+    QAbstract3DAxis *axes[3] = {axisX, axisY, axisZ};
+
+    for (int i = 0; i < 3; i++) {
+        float minValue = firstPos[i];
+        float maxValue = minValue;
+        const float validMin = m_limits[i].validMin(axes[i]->d_ptr->allowZero(),
+                                                    axes[i]->d_ptr->allowNegatives());
+        if (minValue > validMin)
+            minValue = validMin;
+        if (maxValue < m_limits[i].max())
+            maxValue = m_limits[i].max();
+        minValues[i] = minValue;
+        maxValues[i] = maxValue;
+    }
 }
 
 void QScatterDataProxyPrivate::setSeries(QAbstract3DSeries *series)
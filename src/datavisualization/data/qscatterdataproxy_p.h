@@ -17,6 +17,7 @@
 #include "qscatterdataproxy.h"
 #include "qabstractdataproxy_p.h"
 #include "qscatterdataitem.h"
+#include "valuelimits_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -39,12 +40,33 @@ public:
     void removeItems(int index, int removeCount);
     void limitValues(QVector3D &minValues, QVector3D &maxValues, QAbstract3DAxis *axisX,
                      QAbstract3DAxis *axisY, QAbstract3DAxis *axisZ) const;
-    bool isValidValue(float axisValue, float value, QAbstract3DAxis *axis) const;
 
     void setSeries(QAbstract3DSeries *series) override;
 private:
+    // Limits of a contiguous range of items, used to avoid rescanning the whole array
+    // when recalculating axis ranges after partial changes
+    struct LimitBlock
+    {
+        int count;
+        bool dirty;
+        ValueLimits limits[3];
+    };
+
     QScatterDataProxy *qptr();
+    static void addToLimits(ValueLimits *limits, const QVector3D &position);
+    static bool isLimit(const ValueLimits *limits, const QVector3D &position);
+    int findLimitBlock(int index, int &blockStart) const;
+    void removeFromLimits(int index, int count);
+    void addToLimits(int index, int count);
+    void insertToLimits(int index, int count);
+    void removeLimitBlockItems(int index, int count);
+    void updateLimits() const;
+
     QScatterDataArray *m_dataArray;
+    mutable QList<LimitBlock> m_limitBlocks;
+    mutable ValueLimits m_limits[3];
+    mutable bool m_limitBlocksValid;
+    mutable bool m_limitsDirty;
 
     friend class QScatterDataProxy;
 };
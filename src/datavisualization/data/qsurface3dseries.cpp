@@ -3,6 +3,7 @@
 
 #include "qsurface3dseries_p.h"
 #include "surface3dcontroller_p.h"
+#include "qsurfacedataproxy_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -146,6 +147,23 @@ QT_BEGIN_NAMESPACE
  * The color used to draw the gridlines of the surface wireframe.
  */
 
+/*!
+ * \qmlproperty Surface3DSeries.LevelOfDetail Surface3DSeries::levelOfDetail
+ * \since 6.6
+ *
+ * Sets how the surface is decimated when its data has more rows or columns than
+ * fit in the area it covers on screen. Defaults to \c{Surface3DSeries.LevelOfDetailNone}.
+ *
+ * \value Surface3DSeries.LevelOfDetailNone
+ *        The surface is always drawn at full resolution.
+ * \value Surface3DSeries.LevelOfDetailMaximum
+ *        Each reduced point takes the highest value it covers, which preserves peaks.
+ * \value Surface3DSeries.LevelOfDetailAverage
+ *        Each reduced point takes the average of the values it covers.
+ *
+ * Selection and slicing always use the full resolution data.
+ */
+
 /*!
  * \enum QSurface3DSeries::DrawFlag
  *
@@ -160,6 +178,21 @@ QT_BEGIN_NAMESPACE
  *        Both the surface and grid are drawn.
  */
 
+/*!
+ * \enum QSurface3DSeries::LevelOfDetail
+ * \since 6.6
+ *
+ * The decimation mode used when the surface has more data points than fit in
+ * the area it covers on screen.
+ *
+ * \value LevelOfDetailNone
+ *        The surface is always drawn at full resolution.
+ * \value LevelOfDetailMaximum
+ *        Each reduced point takes the highest value it covers, which preserves peaks.
+ * \value LevelOfDetailAverage
+ *        Each reduced point takes the average of the values it covers.
+ */
+
 /*!
  * Constructs a surface 3D series with the parent \a parent.
  */
@@ -396,6 +429,31 @@ QColor QSurface3DSeries::wireframeColor() const
 {
     return dptrc()->m_wireframeColor;
 }
+
+/*!
+ * \property QSurface3DSeries::levelOfDetail
+ * \since 6.6
+ *
+ * \brief How the surface is decimated when it has more rows or columns than fit
+ * in the area it covers on screen.
+ *
+ * The renderer picks a grid stride from the projected size of the graph and draws
+ * a reduced copy of the data, which is updated incrementally when rows change.
+ * Selection and slicing still resolve to the full resolution data points.
+ * Defaults to QSurface3DSeries::LevelOfDetailNone.
+ */
+void QSurface3DSeries::setLevelOfDetail(QSurface3DSeries::LevelOfDetail mode)
+{
+    if (dptr()->m_levelOfDetail != mode) {
+        dptr()->setLevelOfDetail(mode);
+        emit levelOfDetailChanged(mode);
+    }
+}
+
+QSurface3DSeries::LevelOfDetail QSurface3DSeries::levelOfDetail() const
+{
+    return dptrc()->m_levelOfDetail;
+}
 /*!
  * \internal
  */
@@ -419,7 +477,8 @@ QSurface3DSeriesPrivate::QSurface3DSeriesPrivate(QSurface3DSeries *q)
       m_selectedPoint(Surface3DController::invalidSelectionPosition()),
       m_flatShadingEnabled(true),
       m_drawMode(QSurface3DSeries::DrawSurfaceAndWireframe),
-      m_wireframeColor(Qt::black)
+      m_wireframeColor(Qt::black),
+      m_levelOfDetail(QSurface3DSeries::LevelOfDetailNone)
 {
     m_itemLabelFormat = QStringLiteral("@xLabel, @yLabel, @zLabel");
     m_mesh = QAbstract3DSeries::MeshSphere;
@@ -491,7 +550,8 @@ void QSurface3DSeriesPrivate::createItemLabel()
     QValue3DAxis *axisX = static_cast<QValue3DAxis *>(m_controller->axisX());
     QValue3DAxis *axisY = static_cast<QValue3DAxis *>(m_controller->axisY());
     QValue3DAxis *axisZ = static_cast<QValue3DAxis *>(m_controller->axisZ());
-    QVector3D selectedPosition = qptr()->dataProxy()->itemAt(m_selectedPoint)->position();
+    QVector3D selectedPosition = qptr()->dataProxy()->dptrc()->positionAt(m_selectedPoint.x(),
+                                                                           m_selectedPoint.y());
 
     m_itemLabel = m_itemLabelFormat;
 
@@ -559,4 +619,11 @@ void QSurface3DSeriesPrivate::setWireframeColor(const QColor &color)
         m_controller->markSeriesVisualsDirty();
 }
 
+void QSurface3DSeriesPrivate::setLevelOfDetail(QSurface3DSeries::LevelOfDetail mode)
+{
+    m_levelOfDetail = mode;
+    if (m_controller)
+        m_controller->markSeriesVisualsDirty();
+}
+
 QT_END_NAMESPACE
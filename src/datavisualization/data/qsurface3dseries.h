@@ -23,6 +23,7 @@ class Q_DATAVISUALIZATION_EXPORT QSurface3DSeries : public QAbstract3DSeries
     Q_PROPERTY(QImage texture READ texture WRITE setTexture NOTIFY textureChanged)
     Q_PROPERTY(QString textureFile READ textureFile WRITE setTextureFile NOTIFY textureFileChanged)
     Q_PROPERTY(QColor wireframeColor READ wireframeColor WRITE setWireframeColor NOTIFY wireframeColorChanged REVISION(6, 3))
+    Q_PROPERTY(QSurface3DSeries::LevelOfDetail levelOfDetail READ levelOfDetail WRITE setLevelOfDetail NOTIFY levelOfDetailChanged REVISION(6, 6))
 
 public:
     enum DrawFlag {
@@ -33,6 +34,13 @@ public:
     Q_ENUM(DrawFlag)
     Q_DECLARE_FLAGS(DrawFlags, DrawFlag)
 
+    enum LevelOfDetail {
+        LevelOfDetailNone = 0,
+        LevelOfDetailMaximum,
+        LevelOfDetailAverage
+    };
+    Q_ENUM(LevelOfDetail)
+
     explicit QSurface3DSeries(QObject *parent = nullptr);
     explicit QSurface3DSeries(QSurfaceDataProxy *dataProxy, QObject *parent = nullptr);
     virtual ~QSurface3DSeries();
@@ -60,6 +68,9 @@ public:
     void setWireframeColor(const QColor &color);
     QColor wireframeColor() const;
 
+    void setLevelOfDetail(QSurface3DSeries::LevelOfDetail mode);
+    QSurface3DSeries::LevelOfDetail levelOfDetail() const;
+
 Q_SIGNALS:
     void dataProxyChanged(QSurfaceDataProxy *proxy);
     void selectedPointChanged(const QPoint &position);
@@ -69,6 +80,7 @@ Q_SIGNALS:
     void textureChanged(const QImage &image);
     void textureFileChanged(const QString &filename);
     Q_REVISION(6, 3) void wireframeColorChanged(const QColor &color);
+    Q_REVISION(6, 6) void levelOfDetailChanged(QSurface3DSeries::LevelOfDetail mode);
 
 protected:
     explicit QSurface3DSeries(QSurface3DSeriesPrivate *d, QObject *parent = nullptr);
@@ -35,6 +35,7 @@ public:
     void setDrawMode(QSurface3DSeries::DrawFlags mode);
     void setTexture(const QImage &texture);
     void setWireframeColor(const QColor &color);
+    void setLevelOfDetail(QSurface3DSeries::LevelOfDetail mode);
 
 private:
     QSurface3DSeries *qptr();
@@ -45,6 +46,7 @@ private:
     QImage m_texture;
     QString m_textureFile;
     QColor m_wireframeColor;
+    QSurface3DSeries::LevelOfDetail m_levelOfDetail;
 
 private:
     friend class QSurface3DSeries;
@@ -39,6 +39,10 @@ QT_BEGIN_NAMESPACE
  * whole surface does not completely fit within the visible x-axis or z-axis
  * ranges.
  *
+ * Large surfaces with evenly spaced x-values and z-values can alternatively be given as a
+ * contiguous grid of heights with resetArrayFromHeights(), which avoids allocating a separate
+ * item for each position.
+ *
  * \note Surfaces with less than two rows or columns are not considered valid surfaces and will
  * not be rendered.
  *
@@ -149,6 +153,32 @@ void QSurfaceDataProxy::resetArray(QSurfaceDataArray *newArray)
     emit columnCountChanged(columnCount());
 }
 
+/*!
+ * \since 6.6
+ *
+ * Replaces the data with a grid of heights given row by row in \a heights, with
+ * \a columnCount heights on each row. The x-values of the items are evenly spaced
+ * from \a minX to \a maxX along the rows, and the z-values are evenly spaced from
+ * \a minZ to \a maxZ along the columns. Heights left over after the last complete
+ * row are ignored.
+ *
+ * The heights are stored as a single contiguous block, which the graph reads
+ * directly. This uses considerably less memory than an equivalent
+ * \c QSurfaceDataArray. Calling array() or itemAt(), or modifying the data with any
+ * of the row or item based functions, converts the proxy back to storing rows, which
+ * loses the memory savings.
+ *
+ * \sa resetArray()
+ */
+void QSurfaceDataProxy::resetArrayFromHeights(const QList<float> &heights, int columnCount,
+                                              float minX, float maxX, float minZ, float maxZ)
+{
+    dptr()->resetHeights(heights, columnCount, minX, maxX, minZ, maxZ);
+    emit arrayReset();
+    emit rowCountChanged(rowCount());
+    emit columnCountChanged(this->columnCount());
+}
+
 /*!
  * Changes an existing row by replacing the row at the position \a rowIndex
  * with the new row specified by \a row. The new row can be the same as the
@@ -264,10 +294,16 @@ void QSurfaceDataProxy::removeRows(int rowIndex, int removeCount)
 
 /*!
  * Returns the pointer to the data array.
+ *
+ * If the data was set with resetArrayFromHeights(), the first call after the reset
+ * converts the whole grid of heights into rows of items, and the proxy stores the rows
+ * from then on. For large grids this takes time and several times the memory of the
+ * heights, so prefer rowCount(), columnCount() and the data signals when only the
+ * dimensions of the data are needed.
  */
 const QSurfaceDataArray *QSurfaceDataProxy::array() const
 {
-    return dptrc()->m_dataArray;
+    return dptrc()->dataArray();
 }
 
 /*!
@@ -277,7 +313,7 @@ const QSurfaceDataArray *QSurfaceDataProxy::array() const
  */
 const QSurfaceDataItem *QSurfaceDataProxy::itemAt(int rowIndex, int columnIndex) const
 {
-    const QSurfaceDataArray &dataArray = *dptrc()->m_dataArray;
+    const QSurfaceDataArray &dataArray = *dptrc()->dataArray();
     Q_ASSERT(rowIndex >= 0 && rowIndex < dataArray.size());
     const QSurfaceDataRow &dataRow = *dataArray[rowIndex];
     Q_ASSERT(columnIndex >= 0 && columnIndex < dataRow.size());
@@ -301,7 +337,7 @@ const QSurfaceDataItem *QSurfaceDataProxy::itemAt(const QPoint &position) const
  */
 int QSurfaceDataProxy::rowCount() const
 {
-    return dptrc()->m_dataArray->size();
+    return dptrc()->rowCount();
 }
 
 /*!
@@ -311,10 +347,7 @@ int QSurfaceDataProxy::rowCount() const
  */
 int QSurfaceDataProxy::columnCount() const
 {
-    if (dptrc()->m_dataArray->size() > 0)
-        return dptrc()->m_dataArray->at(0)->size();
-    else
-        return 0;
+    return dptrc()->columnCount();
 }
 
 /*!
@@ -393,7 +426,8 @@ const QSurfaceDataProxyPrivate *QSurfaceDataProxy::dptrc() const
 
 QSurfaceDataProxyPrivate::QSurfaceDataProxyPrivate(QSurfaceDataProxy *q)
     : QAbstractDataProxyPrivate(q, QAbstractDataProxy::DataTypeSurface),
-      m_dataArray(new QSurfaceDataArray)
+      m_dataArray(new QSurfaceDataArray),
+      m_rowLimitsValid(false)
 {
 }
 
@@ -411,10 +445,90 @@ void QSurfaceDataProxyPrivate::resetArray(QSurfaceDataArray *newArray)
         clearArray();
         m_dataArray = newArray;
     }
+
+    m_heightGrid = SurfaceHeightGrid();
+    m_rowLimits.clear();
+    m_rowLimitsValid = false;
+}
+
+void QSurfaceDataProxyPrivate::resetHeights(const QList<float> &heights, int columnCount,
+                                            float minX, float maxX, float minZ, float maxZ)
+{
+    resetArray(nullptr);
+
+    const int rowCount = columnCount > 0 ? int(heights.size()) / columnCount : 0;
+    if (!rowCount)
+        return;
+
+    m_heightGrid.heights = heights;
+    if (heights.size() != rowCount * columnCount)
+        m_heightGrid.heights.resize(rowCount * columnCount);
+    m_heightGrid.rowCount = rowCount;
+    m_heightGrid.columnCount = columnCount;
+    m_heightGrid.minX = minX;
+    m_heightGrid.maxX = maxX;
+    m_heightGrid.minZ = minZ;
+    m_heightGrid.maxZ = maxZ;
+}
+
+int QSurfaceDataProxyPrivate::rowCount() const
+{
+    if (hasHeightGrid())
+        return m_heightGrid.rowCount;
+    return m_dataArray->size();
+}
+
+int QSurfaceDataProxyPrivate::columnCount() const
+{
+    if (hasHeightGrid())
+        return m_heightGrid.columnCount;
+    if (m_dataArray->size() > 0)
+        return m_dataArray->at(0)->size();
+    return 0;
+}
+
+// Converts the height grid into rows, as the row based API needs them. The grid is dropped
+// so that the data is not stored twice.
+const QSurfaceDataArray *QSurfaceDataProxyPrivate::dataArray() const
+{
+    if (hasHeightGrid()) {
+        m_dataArray->reserve(m_heightGrid.rowCount);
+        for (int i = 0; i < m_heightGrid.rowCount; i++) {
+            QSurfaceDataRow *row = new QSurfaceDataRow(m_heightGrid.columnCount);
+            for (int j = 0; j < m_heightGrid.columnCount; j++)
+                (*row)[j].setPosition(m_heightGrid.position(i, j));
+            m_dataArray->append(row);
+        }
+        m_heightGrid = SurfaceHeightGrid();
+        m_rowLimits.clear();
+        m_rowLimitsValid = false;
+    }
+    return m_dataArray;
+}
+
+SurfaceDataView QSurfaceDataProxyPrivate::dataView() const
+{
+    if (hasHeightGrid())
+        return SurfaceDataView(m_heightGrid);
+    return SurfaceDataView(*m_dataArray);
+}
+
+QVector3D QSurfaceDataProxyPrivate::positionAt(int rowIndex, int columnIndex) const
+{
+    if (hasHeightGrid())
+        return m_heightGrid.position(rowIndex, columnIndex);
+    return m_dataArray->at(rowIndex)->at(columnIndex).position();
+}
+
+// Converts the height grid into rows before the data is modified with the row based API.
+void QSurfaceDataProxyPrivate::detachHeightGrid()
+{
+    dataArray();
 }
 
 void QSurfaceDataProxyPrivate::setRow(int rowIndex, QSurfaceDataRow *row)
 {
+    detachHeightGrid();
     Q_ASSERT(rowIndex >= 0 && rowIndex < m_dataArray->size());
     Q_ASSERT(m_dataArray->at(rowIndex)->size() == row->size());
 
@@ -422,13 +536,16 @@ void QSurfaceDataProxyPrivate::setRow(int rowIndex, QSurfaceDataRow *row)
         clearRow(rowIndex);
         (*m_dataArray)[rowIndex] = row;
     }
+    setRowLimitsDirty(rowIndex, 1);
 }
 
 void QSurfaceDataProxyPrivate::setRows(int rowIndex, const QSurfaceDataArray &rows)
 {
+    detachHeightGrid();
     QSurfaceDataArray &dataArray = *m_dataArray;
     Q_ASSERT(rowIndex >= 0 && (rowIndex + rows.size()) <= dataArray.size());
 
+    setRowLimitsDirty(rowIndex, rows.size());
     for (int i = 0; i < rows.size(); i++) {
         Q_ASSERT(m_dataArray->at(rowIndex)->size() == rows.at(i)->size());
         if (rows.at(i) != dataArray.at(rowIndex)) {
@@ -441,44 +558,54 @@ void QSurfaceDataProxyPrivate::setRows(int rowIndex, const QSurfaceDataArray &ro
 
 void QSurfaceDataProxyPrivate::setItem(int rowIndex, int columnIndex, const QSurfaceDataItem &item)
 {
+    detachHeightGrid();
     Q_ASSERT(rowIndex >= 0 && rowIndex < m_dataArray->size());
     QSurfaceDataRow &row = *(*m_dataArray)[rowIndex];
     Q_ASSERT(columnIndex < row.size());
     row[columnIndex] = item;
+    setRowLimitsDirty(rowIndex, 1);
 }
 
 int QSurfaceDataProxyPrivate::addRow(QSurfaceDataRow *row)
 {
+    detachHeightGrid();
     Q_ASSERT(m_dataArray->isEmpty()
              || m_dataArray->at(0)->size() == row->size());
     int currentSize = m_dataArray->size();
     m_dataArray->append(row);
+    insertRowLimits(currentSize, 1);
     return currentSize;
 }
 
 int QSurfaceDataProxyPrivate::addRows(const QSurfaceDataArray &rows)
 {
+    detachHeightGrid();
     int currentSize = m_dataArray->size();
     for (int i = 0; i < rows.size(); i++) {
         Q_ASSERT(m_dataArray->isEmpty()
                  || m_dataArray->at(0)->size() == rows.at(i)->size());
         m_dataArray->append(rows.at(i));
     }
+    insertRowLimits(currentSize, rows.size());
     return currentSize;
 }
 
 void QSurfaceDataProxyPrivate::insertRow(int rowIndex, QSurfaceDataRow *row)
 {
+    detachHeightGrid();
     Q_ASSERT(rowIndex >= 0 && rowIndex <= m_dataArray->size());
     Q_ASSERT(m_dataArray->isEmpty()
              || m_dataArray->at(0)->size() == row->size());
     m_dataArray->insert(rowIndex, row);
+    insertRowLimits(rowIndex, 1);
 }
 
 void QSurfaceDataProxyPrivate::insertRows(int rowIndex, const QSurfaceDataArray &rows)
 {
+    detachHeightGrid();
     Q_ASSERT(rowIndex >= 0 && rowIndex <= m_dataArray->size());
 
+    insertRowLimits(rowIndex, rows.size());
     for (int i = 0; i < rows.size(); i++) {
         Q_ASSERT(m_dataArray->isEmpty()
                  || m_dataArray->at(0)->size() == rows.at(i)->size());
@@ -488,6 +615,7 @@ void QSurfaceDataProxyPrivate::insertRows(int rowIndex, const QSurfaceDataArray
 
 void QSurfaceDataProxyPrivate::removeRows(int rowIndex, int removeCount)
 {
+    detachHeightGrid();
     Q_ASSERT(rowIndex >= 0);
     int maxRemoveCount = m_dataArray->size() - rowIndex;
     removeCount = qMin(removeCount, maxRemoveCount);
@@ -495,6 +623,8 @@ void QSurfaceDataProxyPrivate::removeRows(int rowIndex, int removeCount)
         clearRow(rowIndex);
         m_dataArray->removeAt(rowIndex);
     }
+    if (m_rowLimitsValid && removeCount > 0)
+        m_rowLimits.remove(rowIndex, removeCount);
 }
 
 QSurfaceDataProxy *QSurfaceDataProxyPrivate::qptr()
@@ -509,6 +639,33 @@ void QSurfaceDataProxyPrivate::limitValues(QVector3D &minValues, QVector3D &maxV
     float min = 0.0f;
     float max = 0.0f;
 
+    if (hasHeightGrid()) {
+        limitHeightGridValues(min, max, axisY);
+        minValues.setY(min);
+        maxValues.setY(max);
+
+        // The x and z values are evenly spaced, so the range limits are the extremes
+        float xLow = qMin(m_heightGrid.minX, m_heightGrid.maxX);
+        float xHigh = qMax(m_heightGrid.minX, m_heightGrid.maxX);
+        float zLow = qMin(m_heightGrid.minZ, m_heightGrid.maxZ);
+        float zHigh = qMax(m_heightGrid.minZ, m_heightGrid.maxZ);
+        // On axes that do not accept the range limit, such as logarithmic axes starting
+        // at zero, use the next value instead
+        if (!isValidValue(xLow, axisX) && m_heightGrid.columnCount > 1) {
+            xLow = m_heightGrid.minX < m_heightGrid.maxX
+                    ? m_heightGrid.x(1) : m_heightGrid.x(m_heightGrid.columnCount - 2);
+        }
+        if (!isValidValue(zLow, axisZ) && m_heightGrid.rowCount > 1) {
+            zLow = m_heightGrid.minZ < m_heightGrid.maxZ
+                    ? m_heightGrid.z(1) : m_heightGrid.z(m_heightGrid.rowCount - 2);
+        }
+        minValues.setX(xLow);
+        minValues.setZ(zLow);
+        maxValues.setX(xHigh);
+        maxValues.setZ(zHigh);
+        return;
+    }
+
     int rows = m_dataArray->size();
     int columns = 0;
     if (rows)
@@ -517,23 +674,19 @@ void QSurfaceDataProxyPrivate::limitValues(QVector3D &minValues, QVector3D &maxV
     if (rows && columns) {
         min = m_dataArray->at(0)->at(0).y();
         max = m_dataArray->at(0)->at(0).y();
-    }
 
-    for (int i = 0; i < rows; i++) {
-        QSurfaceDataRow *row = m_dataArray->at(i);
-        if (row) {
-            for (int j = 0; j < columns; j++) {
-                float itemValue = m_dataArray->at(i)->at(j).y();
-                if (qIsNaN(itemValue) || qIsInf(itemValue))
-                    continue;
-                if ((min > itemValue || (qIsNaN(min) || qIsInf(min)))
-                        && isValidValue(itemValue, axisY)) {
-                    min = itemValue;
-                }
-                if (max < itemValue  || (qIsNaN(max) || qIsInf(max)))
-                    max = itemValue;
-            }
-        }
+        // Only rows changed since the last call are rescanned
+        updateRowLimits();
+        ValueLimits limits;
+        for (int i = 0; i < rows; i++)
+            limits.merge(m_rowLimits.at(i).limits);
+
+        const float validMin = limits.validMin(axisY->d_ptr->allowZero(),
+                                               axisY->d_ptr->allowNegatives());
+        if (!qIsInf(validMin) && (min > validMin || qIsNaN(min) || qIsInf(min)))
+            min = validMin;
+        if (!limits.isEmpty())
+            max = limits.max();
     }
 
     minValues.setY(min);
@@ -617,6 +770,28 @@ bool QSurfaceDataProxyPrivate::isValidValue(float value, QAbstract3DAxis *axis)
             || (value < 0.0f && axis->d_ptr->allowNegatives()));
 }
 
+// Calculates the y-value limits of the height grid with a single pass over the contiguous
+// heights.
+void QSurfaceDataProxyPrivate::limitHeightGridValues(float &minY, float &maxY,
+                                                     QAbstract3DAxis *axisY) const
+{
+    const float *heights = m_heightGrid.heights.constData();
+    const qsizetype count = m_heightGrid.heights.size();
+
+    ValueLimits limits;
+    for (qsizetype i = 0; i < count; i++)
+        limits.add(heights[i]);
+
+    minY = heights[0];
+    maxY = heights[0];
+    const float validMin = limits.validMin(axisY->d_ptr->allowZero(),
+                                           axisY->d_ptr->allowNegatives());
+    if (!qIsInf(validMin) && (minY > validMin || qIsNaN(minY) || qIsInf(minY)))
+        minY = validMin;
+    if (!limits.isEmpty())
+        maxY = limits.max();
+}
+
 void QSurfaceDataProxyPrivate::clearRow(int rowIndex)
 {
     if (m_dataArray->at(rowIndex)) {
@@ -633,6 +808,40 @@ void QSurfaceDataProxyPrivate::clearArray()
     delete m_dataArray;
 }
 
+void QSurfaceDataProxyPrivate::setRowLimitsDirty(int rowIndex, int count)
+{
+    if (m_rowLimitsValid) {
+        for (int i = rowIndex; i < rowIndex + count; i++)
+            m_rowLimits[i].dirty = true;
+    }
+}
+
+void QSurfaceDataProxyPrivate::insertRowLimits(int rowIndex, int count)
+{
+    if (m_rowLimitsValid && count > 0)
+        m_rowLimits.insert(rowIndex, count, RowLimits());
+}
+
+void QSurfaceDataProxyPrivate::updateRowLimits() const
+{
+    if (!m_rowLimitsValid) {
+        m_rowLimits.resize(m_dataArray->size());
+        m_rowLimitsValid = true;
+    }
+
+    for (int i = 0; i < m_rowLimits.size(); i++) {
+        RowLimits &rowLimits = m_rowLimits[i];
+        if (rowLimits.dirty) {
+            rowLimits.limits = ValueLimits();
+            if (const QSurfaceDataRow *row = m_dataArray->at(i)) {
+                for (int j = 0; j < row->size(); j++)
+                    rowLimits.limits.add(row->at(j).y());
+            }
+            rowLimits.dirty = false;
+        }
+    }
+}
+
 void QSurfaceDataProxyPrivate::setSeries(QAbstract3DSeries *series)
 {
     QAbstractDataProxyPrivate::setSeries(series);
@@ -37,6 +37,8 @@ public:
     const QSurfaceDataItem *itemAt(const QPoint &position) const;
 
     void resetArray(QSurfaceDataArray *newArray);
+    void resetArrayFromHeights(const QList<float> &heights, int columnCount,
+                               float minX, float maxX, float minZ, float maxZ);
 
     void setRow(int rowIndex, QSurfaceDataRow *row);
     void setRows(int rowIndex, const QSurfaceDataArray &rows);
@@ -73,6 +75,8 @@ private:
     Q_DISABLE_COPY(QSurfaceDataProxy)
 
     friend class Surface3DController;
+    friend class Surface3DRenderer;
+    friend class QSurface3DSeriesPrivate;
 };
 
 QT_END_NAMESPACE
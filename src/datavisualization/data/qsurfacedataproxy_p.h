@@ -16,6 +16,8 @@
 
 #include "qsurfacedataproxy.h"
 #include "qabstractdataproxy_p.h"
+#include "valuelimits_p.h"
+#include "surfacedataview_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -29,6 +31,8 @@ public:
     virtual ~QSurfaceDataProxyPrivate();
 
     void resetArray(QSurfaceDataArray *newArray);
+    void resetHeights(const QList<float> &heights, int columnCount,
+                      float minX, float maxX, float minZ, float maxZ);
     void setRow(int rowIndex, QSurfaceDataRow *row);
     void setRows(int rowIndex, const QSurfaceDataArray &rows);
     void setItem(int rowIndex, int columnIndex, const QSurfaceDataItem &item);
@@ -41,15 +45,45 @@ public:
                      QAbstract3DAxis *axisY, QAbstract3DAxis *axisZ) const;
     bool isValidValue(float value, QAbstract3DAxis *axis) const;
 
+    int rowCount() const;
+    int columnCount() const;
+    const QSurfaceDataArray *dataArray() const;
+    inline bool hasHeightGrid() const { return !m_heightGrid.isNull(); }
+    inline const SurfaceHeightGrid &heightGrid() const { return m_heightGrid; }
+    SurfaceDataView dataView() const;
+    QVector3D positionAt(int rowIndex, int columnIndex) const;
+
     void setSeries(QAbstract3DSeries *series) override;
 
 protected:
     QSurfaceDataArray *m_dataArray;
 
 private:
+    // Y-value limits of a single row, used to avoid rescanning unchanged rows when
+    // recalculating axis ranges
+    struct RowLimits
+    {
+        RowLimits() : dirty(true) {}
+
+        ValueLimits limits;
+        bool dirty;
+    };
+
     QSurfaceDataProxy *qptr();
     void clearRow(int rowIndex);
     void clearArray();
+    void setRowLimitsDirty(int rowIndex, int count);
+    void insertRowLimits(int rowIndex, int count);
+    void updateRowLimits() const;
+    void limitHeightGridValues(float &minY, float &maxY, QAbstract3DAxis *axisY) const;
+    void detachHeightGrid();
+
+    mutable QList<RowLimits> m_rowLimits;
+    mutable bool m_rowLimitsValid;
+
+    // When set, the data is stored in the height grid and m_dataArray is empty. The grid is
+    // converted into rows on demand for the row based API.
+    mutable SurfaceHeightGrid m_heightGrid;
 
     friend class QSurfaceDataProxy;
 };
@@ -121,38 +121,29 @@ void ScatterItemModelHandler::modelPosToScatterItem(int modelRow, int modelColum
                                                     QScatterDataItem &item)
 {
     QModelIndex index = m_itemModel->index(modelRow, modelColumn);
-    float xPos;
-    float yPos;
-    float zPos;
-    if (m_xPosRole != noRoleIndex) {
-        QVariant xValueVar = index.data(m_xPosRole);
-        if (m_haveXPosPattern)
-            xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
-        else
-            xPos = xValueVar.toFloat();
-    } else {
-        xPos = 0.0f;
-    }
-    if (m_yPosRole != noRoleIndex) {
-        QVariant yValueVar = index.data(m_yPosRole);
-        if (m_haveYPosPattern)
-            yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
-        else
-            yPos = yValueVar.toFloat();
-    } else {
-        yPos = 0.0f;
-    }
-    if (m_zPosRole != noRoleIndex) {
-        QVariant zValueVar = index.data(m_zPosRole);
-        if (m_haveZPosPattern)
-            zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-        else
-            zPos = zValueVar.toFloat();
-    } else {
-        zPos = 0.0f;
-    }
+    const QList<int> roles = itemRoles();
+    QVariant data[4];
+    for (int i = 0; i < roles.size(); i++)
+        data[i] = index.data(roles.at(i));
+    readItem(data, item);
+}
+
+// Takes the data of the mapped roles in the order itemRoles gives them. Safe to call from worker
+// threads, as the patterns are only read.
+void ScatterItemModelHandler::readItem(const QVariant *data, QScatterDataItem &item) const
+{
+    int i = 0;
+    float xPos = 0.0f;
+    float yPos = 0.0f;
+    float zPos = 0.0f;
+    if (m_xPosRole != noRoleIndex)
+        xPos = toFloat(data[i++], m_haveXPosPattern, m_xPosPattern, m_xPosReplace);
+    if (m_yPosRole != noRoleIndex)
+        yPos = toFloat(data[i++], m_haveYPosPattern, m_yPosPattern, m_yPosReplace);
+    if (m_zPosRole != noRoleIndex)
+        zPos = toFloat(data[i++], m_haveZPosPattern, m_zPosPattern, m_zPosReplace);
     if (m_rotationRole != noRoleIndex) {
-        QVariant rotationVar = index.data(m_rotationRole);
+        const QVariant &rotationVar = data[i++];
         if (m_haveRotationPattern) {
             item.setRotation(
                         toQuaternion(
@@ -166,6 +157,16 @@ void ScatterItemModelHandler::modelPosToScatterItem(int modelRow, int modelColum
     item.setPosition(QVector3D(xPos, yPos, zPos));
 }
 
+QList<int> ScatterItemModelHandler::itemRoles() const
+{
+    QList<int> roles;
+    for (int role : {m_xPosRole, m_yPosRole, m_zPosRole, m_rotationRole}) {
+        if (role != noRoleIndex)
+            roles << role;
+    }
+    return roles;
+}
+
 // Resolve entire item model into QScatterDataArray.
 void ScatterItemModelHandler::resolveModel()
 {
@@ -183,10 +184,10 @@ void ScatterItemModelHandler::resolveModel()
     m_yPosReplace = m_proxy->yPosRoleReplace();
     m_zPosReplace = m_proxy->zPosRoleReplace();
     m_rotationReplace = m_proxy->rotationRoleReplace();
-    m_haveXPosPattern = !m_xPosPattern.namedCaptureGroups().isEmpty() && m_xPosPattern.isValid();
-    m_haveYPosPattern = !m_yPosPattern.namedCaptureGroups().isEmpty() && m_yPosPattern.isValid();
-    m_haveZPosPattern = !m_zPosPattern.namedCaptureGroups().isEmpty() && m_zPosPattern.isValid();
-    m_haveRotationPattern = !m_rotationPattern.namedCaptureGroups().isEmpty() && m_rotationPattern.isValid();
+    m_haveXPosPattern = preparePattern(m_xPosPattern);
+    m_haveYPosPattern = preparePattern(m_yPosPattern);
+    m_haveZPosPattern = preparePattern(m_zPosPattern);
+    m_haveRotationPattern = preparePattern(m_rotationPattern);
 
     QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
     m_xPosRole = roleHash.key(m_proxy->xPosRole().toLatin1(), noRoleIndex);
@@ -196,19 +197,16 @@ void ScatterItemModelHandler::resolveModel()
     const int columnCount = m_itemModel->columnCount();
     const int rowCount = m_itemModel->rowCount();
     const int totalCount = rowCount * columnCount;
-    int runningCount = 0;
 
     // If dimensions have changed, recreate the array
     if (m_proxyArray != m_proxy->array() || totalCount != m_proxyArray->size())
         m_proxyArray = new QScatterDataArray(totalCount);
 
-    // Parse data into newProxyArray
-    for (int i = 0; i < rowCount; i++) {
-        for (int j = 0; j < columnCount; j++) {
-            modelPosToScatterItem(i, j, (*m_proxyArray)[runningCount]);
-            runningCount++;
-        }
-    }
+    // Parse data into newProxyArray. Detach it here, as the items are written on worker threads.
+    QScatterDataItem *items = m_proxyArray->data();
+    readItemData(itemRoles(), [&](int item, int, const QVariant *data) {
+        readItem(data, items[item]);
+    });
 
     m_proxy->resetArray(m_proxyArray);
 }
@@ -37,6 +37,8 @@ protected:
 
 private:
     void modelPosToScatterItem(int modelRow, int modelColumn, QScatterDataItem &item);
+    void readItem(const QVariant *data, QScatterDataItem &item) const;
+    QList<int> itemRoles() const;
 
     QItemModelScatterDataProxy *m_proxy; // Not owned
     QScatterDataArray *m_proxyArray; // Not owned
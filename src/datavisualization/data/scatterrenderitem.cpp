@@ -5,21 +5,47 @@
 
 QT_BEGIN_NAMESPACE
 
-ScatterRenderItem::ScatterRenderItem()
-    : AbstractRenderItem(),
-      m_visible(false)
+void ScatterRenderItemArray::resize(int size)
 {
+    m_positions.resize(size);
+    m_translations.resize(size);
+    if (!m_rotations.isEmpty())
+        m_rotations.resize(size);
+    // Items dropped from the end may have been visible
+    const bool shrinking = size < m_visible.size();
+    m_visible.resize(size);
+    if (shrinking)
+        m_visibleCount = int(m_visible.count(true));
 }
 
-ScatterRenderItem::ScatterRenderItem(const ScatterRenderItem &other)
-    : AbstractRenderItem(other)
+void ScatterRenderItemArray::clear()
 {
-    m_position = other.m_position;
-    m_visible = other.m_visible;
+    m_positions.clear();
+    m_translations.clear();
+    m_rotations.clear();
+    m_visible.clear();
+    m_visibleCount = 0;
 }
 
-ScatterRenderItem::~ScatterRenderItem()
+void ScatterRenderItemArray::setRotation(int index, const QQuaternion &rotation)
 {
+    if (m_rotations.isEmpty()) {
+        if (rotation.isNull() || rotation.isIdentity())
+            return;
+        m_rotations.resize(size());
+    }
+
+    if (rotation.isNull())
+        m_rotations[index] = identityQuaternion;
+    else
+        m_rotations[index] = rotation;
+}
+
+// Drops the rotation array. Used before all items are updated, so that the array is only
+// recreated if some of the new rotations are not identity.
+void ScatterRenderItemArray::resetRotations()
+{
+    m_rotations.clear();
 }
 
 QT_END_NAMESPACE
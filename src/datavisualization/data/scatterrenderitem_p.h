@@ -15,32 +15,62 @@
 #define SCATTERRENDERITEM_P_H
 
 #include "abstractrenderitem_p.h"
+#include <QtCore/QBitArray>
 
 QT_BEGIN_NAMESPACE
 
-class ScatterRenderItem : public AbstractRenderItem
+// Render data of the items of a scatter series. Each field is kept in its own array, so
+// that the draw and buffer update loops only read what they need. Rotations are stored only
+// once some item has a non-identity rotation. An item takes 24 bytes and one bit, or 40 bytes
+// and one bit with rotations.
+class ScatterRenderItemArray
 {
 public:
-    ScatterRenderItem();
-    ScatterRenderItem(const ScatterRenderItem &other);
-    ScatterRenderItem &operator=(const ScatterRenderItem &) = default;
-    virtual ~ScatterRenderItem();
+    inline int size() const { return m_positions.size(); }
+    inline bool isEmpty() const { return m_positions.isEmpty(); }
+    void resize(int size);
+    void clear();
 
-    inline const QVector3D &position() const { return m_position; }
-    inline void setPosition(const QVector3D &pos)
+    // Data position of the item
+    inline const QVector3D &position(int index) const { return m_positions.at(index); }
+    inline void setPosition(int index, const QVector3D &position)
     {
-        if (m_position != pos)
-            m_position = pos;
+        m_positions[index] = position;
     }
 
-    inline bool isVisible() const { return m_visible; }
-    inline void setVisible(bool visible) { m_visible = visible; }
+    // Position in 3D scene
+    inline const QVector3D &translation(int index) const { return m_translations.at(index); }
+    inline void setTranslation(int index, const QVector3D &translation)
+    {
+        m_translations[index] = translation;
+    }
+    inline const QVector3D *translations() const { return m_translations.constData(); }
+
+    inline const QQuaternion &rotation(int index) const
+    {
+        return m_rotations.isEmpty() ? identityQuaternion : m_rotations.at(index);
+    }
+    void setRotation(int index, const QQuaternion &rotation);
+    inline bool hasRotations() const { return !m_rotations.isEmpty(); }
+    void resetRotations();
+
+    inline bool isVisible(int index) const { return m_visible.testBit(index); }
+    inline void setVisible(int index, bool visible)
+    {
+        if (m_visible.testBit(index) != visible) {
+            m_visible.setBit(index, visible);
+            m_visibleCount += visible ? 1 : -1;
+        }
+    }
+    inline bool hasVisibleItems() const { return m_visibleCount > 0; }
 
-protected:
-    QVector3D m_position;
-    bool m_visible;
+private:
+    QList<QVector3D> m_positions;
+    QList<QVector3D> m_translations;
+    QList<QQuaternion> m_rotations;
+    QBitArray m_visible;
+    int m_visibleCount = 0;
 };
-typedef QList<ScatterRenderItem> ScatterRenderItemArray;
 
 QT_END_NAMESPACE
 
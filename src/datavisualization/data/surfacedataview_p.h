@@ -0,0 +1,180 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SURFACEDATAVIEW_P_H
+#define SURFACEDATAVIEW_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "qsurfacedataproxy.h"
+#include <QtCore/QRect>
+
+QT_BEGIN_NAMESPACE
+
+// Row-major grid of heights with regularly spaced x and z values, stored in a single
+// contiguous block. The first and last columns and rows are exactly at the range limits.
+struct SurfaceHeightGrid
+{
+    QList<float> heights;
+    int rowCount = 0;
+    int columnCount = 0;
+    float minX = 0.0f;
+    float maxX = 0.0f;
+    float minZ = 0.0f;
+    float maxZ = 0.0f;
+
+    inline bool isNull() const { return !columnCount; }
+    inline float x(int column) const
+    {
+        if (column == columnCount - 1)
+            return maxX;
+        return float(column) * ((maxX - minX) / float(columnCount - 1)) + minX;
+    }
+    inline float z(int row) const
+    {
+        if (row == rowCount - 1)
+            return maxZ;
+        return float(row) * ((maxZ - minZ) / float(rowCount - 1)) + minZ;
+    }
+    inline float y(int row, int column) const { return heights.at(row * columnCount + column); }
+    inline QVector3D position(int row, int column) const
+    {
+        return QVector3D(x(column), y(row, column), z(row));
+    }
+};
+
+// Read-only access to a rectangular part of surface data, which is stored as a
+// QSurfaceDataArray, a SurfaceHeightGrid, or a row-major block of positions.
+// Does not own or copy the data.
+class SurfaceDataView
+{
+public:
+    SurfaceDataView(const QSurfaceDataArray &array)
+        : m_array(&array),
+          m_rowCount(array.size()),
+          m_columnCount(array.size() ? array.at(0)->size() : 0)
+    {
+    }
+
+    SurfaceDataView(const SurfaceHeightGrid &grid)
+        : m_grid(&grid),
+          m_rowCount(grid.rowCount),
+          m_columnCount(grid.columnCount)
+    {
+    }
+
+    SurfaceDataView(const SurfaceHeightGrid &grid, const QRect &space)
+        : m_grid(&grid),
+          m_rowCount(space.height()),
+          m_columnCount(space.width()),
+          m_rowOffset(space.y()),
+          m_columnOffset(space.x())
+    {
+    }
+
+    SurfaceDataView(const QVector3D *positions, int rowCount, int columnCount)
+        : m_positions(positions),
+          m_rowCount(rowCount),
+          m_columnCount(columnCount)
+    {
+    }
+
+    inline int rowCount() const { return m_rowCount; }
+    inline int columnCount() const { return m_columnCount; }
+    inline bool isEmpty() const { return !m_rowCount || !m_columnCount; }
+    inline bool isHeightGrid() const { return m_grid; }
+
+    inline QVector3D position(int row, int column) const
+    {
+        if (m_array)
+            return m_array->at(row)->at(column).position();
+        if (m_positions)
+            return m_positions[row * m_columnCount + column];
+        return m_grid->position(row + m_rowOffset, column + m_columnOffset);
+    }
+    // Returns the contiguous heights of the row, or null if the view is not on a height grid
+    inline const float *heightRow(int row) const
+    {
+        if (!m_grid)
+            return nullptr;
+        return m_grid->heights.constData() + (row + m_rowOffset) * m_grid->columnCount
+                + m_columnOffset;
+    }
+    inline QSurfaceDataItem item(int row, int column) const
+    {
+        return QSurfaceDataItem(position(row, column));
+    }
+
+private:
+    friend class SurfaceDataSnapshot;
+
+    const QSurfaceDataArray *m_array = nullptr;
+    const SurfaceHeightGrid *m_grid = nullptr;
+    const QVector3D *m_positions = nullptr;
+    int m_rowCount = 0;
+    int m_columnCount = 0;
+    int m_rowOffset = 0;
+    int m_columnOffset = 0;
+};
+
+// Copy of the data seen through a view that stays valid when the original data changes, so
+// that it can be read on another thread. Rows and height grids are implicitly shared, so only
+// blocks of positions are actually copied.
+class SurfaceDataSnapshot
+{
+public:
+    SurfaceDataSnapshot() = default;
+
+    void take(const SurfaceDataView &view)
+    {
+        clear();
+        m_view = view;
+        if (view.m_array) {
+            m_rows.reserve(view.m_array->size());
+            for (const QSurfaceDataRow *row : *view.m_array)
+                m_rows.append(*row);
+            m_rowPointers.reserve(m_rows.size());
+            for (QSurfaceDataRow &row : m_rows)
+                m_rowPointers.append(&row);
+            m_view.m_array = &m_rowPointers;
+        } else if (view.m_grid) {
+            m_grid = *view.m_grid;
+            m_view.m_grid = &m_grid;
+        } else if (view.m_positions) {
+            m_positions = QList<QVector3D>(view.m_positions,
+                                           view.m_positions + view.m_rowCount * view.m_columnCount);
+            m_view.m_positions = m_positions.constData();
+        }
+    }
+    void clear()
+    {
+        m_view = SurfaceDataView(nullptr, 0, 0);
+        m_rowPointers.clear();
+        m_rows.clear();
+        m_grid = SurfaceHeightGrid();
+        m_positions.clear();
+    }
+    inline const SurfaceDataView &view() const { return m_view; }
+
+private:
+    Q_DISABLE_COPY(SurfaceDataSnapshot)
+
+    SurfaceDataView m_view = SurfaceDataView(nullptr, 0, 0);
+    QList<QSurfaceDataRow> m_rows;
+    QSurfaceDataArray m_rowPointers;
+    SurfaceHeightGrid m_grid;
+    QList<QVector3D> m_positions;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -6,9 +6,7 @@
 QT_BEGIN_NAMESPACE
 
 SurfaceItemModelHandler::SurfaceItemModelHandler(QItemModelSurfaceDataProxy *proxy, QObject *parent)
-    : AbstractItemModelHandler(parent),
-      m_proxy(proxy),
-      m_proxyArray(0),
+    : MappedItemModelHandler(proxy, parent),
       m_xPosRole(noRoleIndex),
       m_yPosRole(noRoleIndex),
       m_zPosRole(noRoleIndex),
@@ -22,65 +20,11 @@ SurfaceItemModelHandler::~SurfaceItemModelHandler()
 {
 }
 
-void SurfaceItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
-                                                const QModelIndex &bottomRight,
-                                                const QList<int> &roles)
-{
-    // Do nothing if full reset already pending
-    if (!m_fullReset) {
-        if (!m_proxy->useModelCategories()) {
-            // If the data model doesn't directly map rows and columns, we cannot optimize
-            AbstractItemModelHandler::handleDataChanged(topLeft, bottomRight, roles);
-        } else {
-            int startRow = qMin(topLeft.row(), bottomRight.row());
-            int endRow = qMax(topLeft.row(), bottomRight.row());
-            int startCol = qMin(topLeft.column(), bottomRight.column());
-            int endCol = qMax(topLeft.column(), bottomRight.column());
-
-            for (int i = startRow; i <= endRow; i++) {
-                for (int j = startCol; j <= endCol; j++) {
-                    QModelIndex index = m_itemModel->index(i, j);
-                    QSurfaceDataItem item;
-                    QVariant xValueVar = index.data(m_xPosRole);
-                    QVariant yValueVar = index.data(m_yPosRole);
-                    QVariant zValueVar = index.data(m_zPosRole);
-                    const QSurfaceDataItem *oldItem = m_proxy->itemAt(i, j);
-                    float xPos;
-                    float yPos;
-                    float zPos;
-                    if (m_xPosRole != noRoleIndex) {
-                        if (m_haveXPosPattern)
-                            xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
-                        else
-                            xPos = xValueVar.toFloat();
-                    } else {
-                        xPos = oldItem->x();
-                    }
-
-                    if (m_haveYPosPattern)
-                        yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
-                    else
-                        yPos = yValueVar.toFloat();
-
-                    if (m_zPosRole != noRoleIndex) {
-                        if (m_haveZPosPattern)
-                            zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-                        else
-                            zPos = zValueVar.toFloat();
-                    } else {
-                        zPos = oldItem->z();
-                    }
-                    item.setPosition(QVector3D(xPos, yPos, zPos));
-                    m_proxy->setItem(i, j, item);
-                }
-            }
-        }
-    }
-}
-
 // Resolve entire item model into QSurfaceDataArray.
 void SurfaceItemModelHandler::resolveModel()
 {
+    clearMappedItems();
+
     if (m_itemModel.isNull()) {
         m_proxy->resetArray(0);
         m_proxyArray = 0;
@@ -94,22 +38,22 @@ void SurfaceItemModelHandler::resolveModel()
         return;
     }
 
-    // Position patterns can be reused on single item changes, so store them to member variables.
-    QRegularExpression rowPattern(m_proxy->rowRolePattern());
-    QRegularExpression colPattern(m_proxy->columnRolePattern());
+    // Patterns can be reused on single item changes, so store them to member variables.
+    m_rowPattern = m_proxy->rowRolePattern();
+    m_columnPattern = m_proxy->columnRolePattern();
     m_xPosPattern = m_proxy->xPosRolePattern();
     m_yPosPattern = m_proxy->yPosRolePattern();
     m_zPosPattern = m_proxy->zPosRolePattern();
-    QString rowReplace = m_proxy->rowRoleReplace();
-    QString colReplace = m_proxy->columnRoleReplace();
+    m_rowReplace = m_proxy->rowRoleReplace();
+    m_columnReplace = m_proxy->columnRoleReplace();
     m_xPosReplace = m_proxy->xPosRoleReplace();
     m_yPosReplace = m_proxy->yPosRoleReplace();
     m_zPosReplace = m_proxy->zPosRoleReplace();
-    bool haveRowPattern = !rowPattern.namedCaptureGroups().isEmpty() && rowPattern.isValid();
-    bool haveColPattern = !colPattern.namedCaptureGroups().isEmpty() && colPattern.isValid();
-    m_haveXPosPattern = !m_xPosPattern.namedCaptureGroups().isEmpty() && m_xPosPattern.isValid();
-    m_haveYPosPattern = !m_yPosPattern.namedCaptureGroups().isEmpty() && m_yPosPattern.isValid();
-    m_haveZPosPattern = !m_zPosPattern.namedCaptureGroups().isEmpty() && m_zPosPattern.isValid();
+    m_haveRowPattern = preparePattern(m_rowPattern);
+    m_haveColumnPattern = preparePattern(m_columnPattern);
+    m_haveXPosPattern = preparePattern(m_xPosPattern);
+    m_haveYPosPattern = preparePattern(m_yPosPattern);
+    m_haveZPosPattern = preparePattern(m_zPosPattern);
 
     QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
 
@@ -129,180 +73,249 @@ void SurfaceItemModelHandler::resolveModel()
             for (int i = 0; i < rowCount; i++)
                 m_proxyArray->append(new QSurfaceDataRow(columnCount));
         }
-        for (int i = 0; i < rowCount; i++) {
-            QSurfaceDataRow &newProxyRow = *m_proxyArray->at(i);
-            for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QVariant xValueVar = index.data(m_xPosRole);
-                QVariant yValueVar = index.data(m_yPosRole);
-                QVariant zValueVar = index.data(m_zPosRole);
-                float xPos;
-                float yPos;
-                float zPos;
-                if (m_xPosRole != noRoleIndex) {
-                    if (m_haveXPosPattern)
-                        xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
-                    else
-                        xPos = xValueVar.toFloat();
-                } else {
-                    QString header = m_itemModel->headerData(j, Qt::Horizontal).toString();
-                    bool ok = false;
-                    float headerValue = header.toFloat(&ok);
-                    if (ok)
-                        xPos = headerValue;
-                    else
-                        xPos = float(j);
-                }
-
-                if (m_haveYPosPattern)
-                    yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
-                else
-                    yPos = yValueVar.toFloat();
-
-                if (m_zPosRole != noRoleIndex) {
-                    if (m_haveZPosPattern)
-                        zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-                    else
-                        zPos = zValueVar.toFloat();
-                } else {
-                    QString header = m_itemModel->headerData(i, Qt::Vertical).toString();
-                    bool ok = false;
-                    float headerValue = header.toFloat(&ok);
-                    if (ok)
-                        zPos = headerValue;
-                    else
-                        zPos = float(i);
-                }
-
-                newProxyRow[j].setPosition(QVector3D(xPos, yPos, zPos));
-            }
+        // Positions of unmapped coordinates come from the headers, so read them once
+        QList<float> columnPositions(columnCount, 0.0f);
+        QList<float> rowPositions(rowCount, 0.0f);
+        if (m_xPosRole == noRoleIndex) {
+            for (int j = 0; j < columnCount; j++)
+                columnPositions[j] = headerPosition(j, Qt::Horizontal);
+        }
+        if (m_zPosRole == noRoleIndex) {
+            for (int i = 0; i < rowCount; i++)
+                rowPositions[i] = headerPosition(i, Qt::Vertical);
         }
+        // Detach the rows here, as the items are written on worker threads
+        QList<QSurfaceDataItem *> rowItems(rowCount);
+        for (int i = 0; i < rowCount; i++)
+            rowItems[i] = m_proxyArray->at(i)->data();
+        readItemData(positionRoles(), [&](int item, int, const QVariant *data) {
+            const int row = item / columnCount;
+            const int column = item % columnCount;
+            rowItems.at(row)[column].setPosition(
+                        readPosition(data, columnPositions.at(column), rowPositions.at(row)));
+        });
     } else {
-        int rowRole = roleHash.key(m_proxy->rowRole().toLatin1());
-        int columnRole = roleHash.key(m_proxy->columnRole().toLatin1());
+        m_rowRole = roleHash.key(m_proxy->rowRole().toLatin1());
+        m_columnRole = roleHash.key(m_proxy->columnRole().toLatin1());
         if (m_xPosRole == noRoleIndex)
-            m_xPosRole = columnRole;
+            m_xPosRole = m_columnRole;
         if (m_zPosRole == noRoleIndex)
-            m_zPosRole = rowRole;
-
-        bool generateRows = m_proxy->autoRowCategories();
-        bool generateColumns = m_proxy->autoColumnCategories();
-
-        QStringList rowList;
-        QStringList columnList;
-        // For detecting duplicates in categories generation, using QHashes should be faster than
-        // simple QStringList::contains() check.
-        QHash<QString, bool> rowListHash;
-        QHash<QString, bool> columnListHash;
-
-        bool cumulative = m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBAverage
-                || m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBCumulativeY;
-        bool average = m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBAverage;
-        bool takeFirst = m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBFirst;
-        QHash<QString, QHash<QString, int> > *matchCountMap = 0;
-        if (cumulative)
-            matchCountMap = new QHash<QString, QHash<QString, int> >;
-
-        // Sort values into rows and columns
-        typedef QHash<QString, QVector3D> ColumnValueMap;
-        QHash <QString, ColumnValueMap> itemValueMap;
-        for (int i = 0; i < rowCount; i++) {
-            for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QString rowRoleStr = index.data(rowRole).toString();
-                if (haveRowPattern)
-                    rowRoleStr.replace(rowPattern, rowReplace);
-                QString columnRoleStr = index.data(columnRole).toString();
-                if (haveColPattern)
-                    columnRoleStr.replace(colPattern, colReplace);
-                QVariant xValueVar = index.data(m_xPosRole);
-                QVariant yValueVar = index.data(m_yPosRole);
-                QVariant zValueVar = index.data(m_zPosRole);
-                float xPos;
-                float yPos;
-                float zPos;
+            m_zPosRole = m_rowRole;
+
+        // Sort items into rows and columns. The mapped items are kept, so that later changes
+        // to the model rows can be applied without resolving the whole model again.
+        resolveMappedItems(positionRoles(), [&](const QVariant *data) {
+            // X and Z are always mapped to roles here
+            return QSurfaceDataItem(readPosition(data, 0.0f, 0.0f));
+        });
+    }
+
+    m_proxy->resetArray(m_proxyArray);
+}
+
+QSurfaceDataItem SurfaceItemModelHandler::readItem(const QModelIndex &index) const
+{
+    return QSurfaceDataItem(readPosition(index));
+}
+
+QVector3D SurfaceItemModelHandler::readPosition(const QModelIndex &index) const
+{
+    const bool haveX = m_xPosRole != noRoleIndex;
+    const bool haveZ = m_zPosRole != noRoleIndex;
+    QVariant data[3];
+    int count = 0;
+    if (haveX)
+        data[count++] = index.data(m_xPosRole);
+    data[count++] = index.data(m_yPosRole);
+    if (haveZ)
+        data[count++] = index.data(m_zPosRole);
+    return readPosition(data,
+                        haveX ? 0.0f : headerPosition(index.column(), Qt::Horizontal),
+                        haveZ ? 0.0f : headerPosition(index.row(), Qt::Vertical));
+}
+
+// Takes the data of the position roles in the order positionRoles gives them. The header
+// positions are used for the coordinates that are not mapped to roles. Safe to call from worker
+// threads, as the patterns are only read.
+QVector3D SurfaceItemModelHandler::readPosition(const QVariant *data, float headerX,
+                                                float headerZ) const
+{
+    int i = 0;
+    const float xPos = m_xPosRole != noRoleIndex
+            ? toFloat(data[i++], m_haveXPosPattern, m_xPosPattern, m_xPosReplace) : headerX;
+    const float yPos = toFloat(data[i++], m_haveYPosPattern, m_yPosPattern, m_yPosReplace);
+    const float zPos = m_zPosRole != noRoleIndex
+            ? toFloat(data[i++], m_haveZPosPattern, m_zPosPattern, m_zPosReplace) : headerZ;
+    return QVector3D(xPos, yPos, zPos);
+}
+
+QList<int> SurfaceItemModelHandler::positionRoles() const
+{
+    QList<int> roles;
+    if (m_xPosRole != noRoleIndex)
+        roles << m_xPosRole;
+    roles << m_yPosRole;
+    if (m_zPosRole != noRoleIndex)
+        roles << m_zPosRole;
+    return roles;
+}
+
+float SurfaceItemModelHandler::headerPosition(int section, Qt::Orientation orientation) const
+{
+    bool ok = false;
+    const QString header = m_itemModel->headerData(section, orientation).toString();
+    const float headerValue = header.toFloat(&ok);
+    return ok ? headerValue : float(section);
+}
+
+QSurfaceDataRow *SurfaceItemModelHandler::readRow(int row) const
+{
+    const int columnCount = m_itemModel->columnCount();
+    QSurfaceDataRow *newRow = new QSurfaceDataRow(columnCount);
+    for (int j = 0; j < columnCount; j++)
+        (*newRow)[j].setPosition(readPosition(m_itemModel->index(row, j)));
+    return newRow;
+}
+
+// Items must be added to cells in model order
+void SurfaceItemModelHandler::addToCell(MappedCell &cell, const QSurfaceDataItem &item) const
+{
+    switch (m_proxy->multiMatchBehavior()) {
+    case QItemModelSurfaceDataProxy::MMBFirst:
+        if (!cell.count)
+            cell.item = item;
+        break;
+    case QItemModelSurfaceDataProxy::MMBLast:
+        cell.item = item;
+        break;
+    case QItemModelSurfaceDataProxy::MMBAverage:
+    case QItemModelSurfaceDataProxy::MMBCumulativeY:
+        cell.item.setPosition(cell.item.position() + item.position());
+        break;
+    }
+    cell.count++;
+}
+
+QSurfaceDataItem SurfaceItemModelHandler::cellItem(const MappedCell &cell) const
+{
+    QVector3D position = cell.item.position();
+    const float divisor = float(cell.count);
+    if (m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBAverage) {
+        position /= divisor;
+    } else if (m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBCumulativeY) {
+        position.setX(position.x() / divisor);
+        position.setZ(position.z() / divisor);
+    }
+    return QSurfaceDataItem(position);
+}
+
+void SurfaceItemModelHandler::setChangedItem(int row, int column, const QSurfaceDataItem &item)
+{
+    if (m_proxy->itemAt(row, column)->position() != item.position())
+        m_proxy->setItem(row, column, item);
+}
+
+void SurfaceItemModelHandler::setGeneratedRowCategories(const QStringList &categories)
+{
+    m_proxy->dptr()->m_rowCategories = categories;
+}
+
+void SurfaceItemModelHandler::setGeneratedColumnCategories(const QStringList &categories)
+{
+    m_proxy->dptr()->m_columnCategories = categories;
+}
+
+void SurfaceItemModelHandler::resetMappedArray()
+{
+    fillMappedArray();
+    m_proxy->resetArray(m_proxyArray);
+}
+
+void SurfaceItemModelHandler::addMappedRows(const QSurfaceDataArray &rows, int first)
+{
+    Q_UNUSED(first);
+
+    m_proxy->addRows(rows);
+}
+
+void SurfaceItemModelHandler::insertMappedRow(int row, QSurfaceDataRow *newRow)
+{
+    m_proxy->insertRow(row, newRow);
+}
+
+void SurfaceItemModelHandler::setModelItems(int startRow, int endRow, int startColumn,
+                                            int endColumn)
+{
+    for (int i = startRow; i <= endRow; i++) {
+        for (int j = startColumn; j <= endColumn; j++) {
+            QModelIndex index = m_itemModel->index(i, j);
+            QSurfaceDataItem item;
+            QVariant xValueVar = index.data(m_xPosRole);
+            QVariant yValueVar = index.data(m_yPosRole);
+            QVariant zValueVar = index.data(m_zPosRole);
+            const QSurfaceDataItem *oldItem = m_proxy->itemAt(i, j);
+            float xPos;
+            float yPos;
+            float zPos;
+            if (m_xPosRole != noRoleIndex) {
                 if (m_haveXPosPattern)
                     xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
                 else
                     xPos = xValueVar.toFloat();
-                if (m_haveYPosPattern)
-                    yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
-                else
-                    yPos = yValueVar.toFloat();
+            } else {
+                xPos = oldItem->x();
+            }
+
+            if (m_haveYPosPattern)
+                yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
+            else
+                yPos = yValueVar.toFloat();
+
+            if (m_zPosRole != noRoleIndex) {
                 if (m_haveZPosPattern)
                     zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
                 else
                     zPos = zValueVar.toFloat();
-
-                QVector3D itemPos(xPos, yPos, zPos);
-
-                if (cumulative)
-                    (*matchCountMap)[rowRoleStr][columnRoleStr]++;
-
-                if (cumulative) {
-                    itemValueMap[rowRoleStr][columnRoleStr] += itemPos;
-                } else {
-                    if (takeFirst && itemValueMap.contains(rowRoleStr)) {
-                        if (itemValueMap.value(rowRoleStr).contains(columnRoleStr))
-                            continue; // We already have a value for this row/column combo
-                    }
-                    itemValueMap[rowRoleStr][columnRoleStr] = itemPos;
-                }
-
-                if (generateRows && !rowListHash.value(rowRoleStr, false)) {
-                    rowListHash.insert(rowRoleStr, true);
-                    rowList << rowRoleStr;
-                }
-                if (generateColumns && !columnListHash.value(columnRoleStr, false)) {
-                    columnListHash.insert(columnRoleStr, true);
-                    columnList << columnRoleStr;
-                }
+            } else {
+                zPos = oldItem->z();
             }
+            item.setPosition(QVector3D(xPos, yPos, zPos));
+            m_proxy->setItem(i, j, item);
         }
+    }
+}
 
-        if (generateRows)
-            m_proxy->dptr()->m_rowCategories = rowList;
-        else
-            rowList = m_proxy->rowCategories();
+bool SurfaceItemModelHandler::insertModelRows(int start, int end)
+{
+    // Without a z position role the positions of the following rows depend on their index
+    if (m_zPosRole == noRoleIndex && end != m_itemModel->rowCount() - 1)
+        return false;
 
-        if (generateColumns)
-            m_proxy->dptr()->m_columnCategories = columnList;
-        else
-            columnList = m_proxy->columnCategories();
+    QSurfaceDataArray rows;
+    rows.reserve(end - start + 1);
+    for (int i = start; i <= end; i++)
+        rows.append(readRow(i));
+    m_proxy->insertRows(start, rows);
+    return true;
+}
 
-        // If dimensions have changed, recreate the array
-        if (m_proxyArray != m_proxy->array() || columnList.size() != m_proxy->columnCount()
-                || rowList.size() != m_proxyArray->size()) {
-            m_proxyArray = new QSurfaceDataArray;
-            m_proxyArray->reserve(rowList.size());
-            for (int i = 0; i < rowList.size(); i++)
-                m_proxyArray->append(new QSurfaceDataRow(columnList.size()));
-        }
-        // Create data array from itemValueMap
-        for (int i = 0; i < rowList.size(); i++) {
-            QString rowKey = rowList.at(i);
-            QSurfaceDataRow &newProxyRow = *m_proxyArray->at(i);
-            for (int j = 0; j < columnList.size(); j++) {
-                QVector3D &itemPos = itemValueMap[rowKey][columnList.at(j)];
-                if (cumulative) {
-                    float divisor = float((*matchCountMap)[rowKey][columnList.at(j)]);
-                    if (divisor) {
-                        if (average) {
-                            itemPos /= divisor;
-                        } else { // cumulativeY
-                            itemPos.setX(itemPos.x() / divisor);
-                            itemPos.setZ(itemPos.z() / divisor);
-                        }
-                    }
-                }
-                newProxyRow[j].setPosition(itemPos);
-            }
-        }
+void SurfaceItemModelHandler::setModelRows(int first, int last)
+{
+    QSurfaceDataArray rows;
+    rows.reserve(last - first + 1);
+    for (int i = first; i <= last; i++)
+        rows.append(readRow(i));
+    m_proxy->setRows(first, rows);
+}
 
-        delete matchCountMap;
-    }
+bool SurfaceItemModelHandler::removeModelRows(int start, int end)
+{
+    // Without a z position role the positions of the following rows depend on their index
+    if (m_zPosRole == noRoleIndex && start != m_itemModel->rowCount())
+        return false;
 
-    m_proxy->resetArray(m_proxyArray);
+    m_proxy->removeRows(start, end - start + 1);
+    return true;
 }
 
 QT_END_NAMESPACE
@@ -19,22 +19,38 @@
 
 QT_BEGIN_NAMESPACE
 
-class SurfaceItemModelHandler : public AbstractItemModelHandler
+class SurfaceItemModelHandler
+        : public MappedItemModelHandler<QItemModelSurfaceDataProxy, QSurfaceDataItem>
 {
     Q_OBJECT
 public:
     SurfaceItemModelHandler(QItemModelSurfaceDataProxy *proxy, QObject *parent = 0);
     virtual ~SurfaceItemModelHandler();
 
-public Q_SLOTS:
-    void handleDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
-                           const QList<int> &roles = QList<int>()) override;
-
 protected:
     void resolveModel() override;
 
-    QItemModelSurfaceDataProxy *m_proxy; // Not owned
-    QSurfaceDataArray *m_proxyArray; // Not owned
+    QSurfaceDataItem readItem(const QModelIndex &index) const override;
+    QVector3D readPosition(const QModelIndex &index) const;
+    QVector3D readPosition(const QVariant *data, float headerX, float headerZ) const;
+    QList<int> positionRoles() const;
+    float headerPosition(int section, Qt::Orientation orientation) const;
+    QSurfaceDataRow *readRow(int row) const;
+
+    void addToCell(MappedCell &cell, const QSurfaceDataItem &item) const override;
+    QSurfaceDataItem cellItem(const MappedCell &cell) const override;
+    void setChangedItem(int row, int column, const QSurfaceDataItem &item) override;
+    void setGeneratedRowCategories(const QStringList &categories) override;
+    void setGeneratedColumnCategories(const QStringList &categories) override;
+    void resetMappedArray() override;
+    void addMappedRows(const QSurfaceDataArray &rows, int first) override;
+    void insertMappedRow(int row, QSurfaceDataRow *newRow) override;
+
+    void setModelItems(int startRow, int endRow, int startColumn, int endColumn) override;
+    bool insertModelRows(int start, int end) override;
+    void setModelRows(int first, int last) override;
+    bool removeModelRows(int start, int end) override;
+
     int m_xPosRole;
     int m_yPosRole;
     int m_zPosRole;
@@ -0,0 +1,87 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef VALUELIMITS_P_H
+#define VALUELIMITS_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/qnumeric.h>
+
+QT_BEGIN_NAMESPACE
+
+// Minimum and maximum of a set of values, in a form that can be merged with other sets.
+// Minimums are kept separately for positive values and for all values, so that the smallest
+// value valid for any axis can be resolved later. Non-finite values are ignored.
+class ValueLimits
+{
+public:
+    inline ValueLimits()
+        : m_min(qInf()),
+          m_minPositive(qInf()),
+          m_max(-qInf()),
+          m_hasZero(false)
+    {
+    }
+
+    inline void add(float value)
+    {
+        if (qIsNaN(value) || qIsInf(value))
+            return;
+        if (value < m_min)
+            m_min = value;
+        if (value > m_max)
+            m_max = value;
+        if (value > 0.0f && value < m_minPositive)
+            m_minPositive = value;
+        else if (value == 0.0f)
+            m_hasZero = true;
+    }
+
+    inline void merge(const ValueLimits &other)
+    {
+        m_min = qMin(m_min, other.m_min);
+        m_minPositive = qMin(m_minPositive, other.m_minPositive);
+        m_max = qMax(m_max, other.m_max);
+        m_hasZero = m_hasZero || other.m_hasZero;
+    }
+
+    // Returns true if removing the value could change the limits
+    inline bool isLimit(float value) const
+    {
+        return value == m_min || value == m_minPositive || value == m_max
+                || (value == 0.0f && m_hasZero);
+    }
+
+    inline bool isEmpty() const { return m_max == -qInf(); }
+    inline float max() const { return m_max; }
+
+    // Smallest value accepted by an axis, or positive infinity if there is none
+    inline float validMin(bool allowZero, bool allowNegatives) const
+    {
+        if (allowNegatives && m_min < 0.0f)
+            return m_min;
+        if (allowZero && m_hasZero)
+            return 0.0f;
+        return m_minPositive;
+    }
+
+private:
+    float m_min;
+    float m_minPositive;
+    float m_max;
+    bool m_hasZero;
+};
+
+QT_END_NAMESPACE
+
+#endif
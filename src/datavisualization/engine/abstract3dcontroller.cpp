@@ -18,6 +18,9 @@
 
 QT_BEGIN_NAMESPACE
 
+// Largest shadow map size accepted, the maximum texture size of current hardware
+static const int maxShadowMapSize = 16384;
+
 Abstract3DController::Abstract3DController(QRect initialViewport, Q3DScene *scene,
                                            QObject *parent) :
     QObject(parent),
@@ -42,15 +45,20 @@ Abstract3DController::Abstract3DController(QRect initialViewport, Q3DScene *scen
     m_isCustomItemDirty(true),
     m_isSeriesVisualsDirty(true),
     m_renderPending(false),
+    m_isSelectionPassDirty(true),
     m_isPolar(false),
     m_radialLabelOffset(1.0f),
     m_measureFps(false),
     m_numFrames(0),
     m_currentFps(0.0),
+    m_frameStatisticsEnabled(false),
     m_clickedType(QAbstract3DGraph::ElementNone),
     m_selectedLabelIndex(-1),
     m_selectedCustomItemIndex(-1),
-    m_margin(-1.0)
+    m_margin(-1.0),
+    m_asynchronousDataPreparation(false),
+    m_maxDataLatency(-1),
+    m_shadowMapSize(0)
 {
     if (!m_scene)
         m_scene = new Q3DScene;
@@ -70,7 +78,7 @@ Abstract3DController::Abstract3DController(QRect initialViewport, Q3DScene *scen
     inputHandler->d_ptr->m_isDefaultHandler = true;
     setActiveInputHandler(inputHandler);
     connect(m_scene->d_ptr.data(), &Q3DScenePrivate::needRender, this,
-            &Abstract3DController::emitNeedRender);
+            &Abstract3DController::emitNeedRedraw);
 }
 
 Abstract3DController::~Abstract3DController()
@@ -179,6 +187,11 @@ void Abstract3DController::synchDataToRenderer()
     if (m_renderer->isClickQueryResolved())
         handlePendingClick();
 
+    if (m_isSelectionPassDirty) {
+        m_renderer->markFrameChanged(Abstract3DRenderer::FrameChangeContent);
+        m_isSelectionPassDirty = false;
+    }
+
     startRecordingRemovesAndInserts();
 
     if (m_scene->d_ptr->m_sceneDirty)
@@ -486,6 +499,16 @@ void Abstract3DController::synchDataToRenderer()
         m_changeTracker.marginChanged = false;
     }
 
+    if (m_changeTracker.dataPreparationChanged) {
+        m_renderer->updateDataPreparation(m_asynchronousDataPreparation, m_maxDataLatency);
+        m_changeTracker.dataPreparationChanged = false;
+    }
+
+    if (m_changeTracker.shadowMapSizeChanged) {
+        m_renderer->updateShadowMapSize(m_shadowMapSize);
+        m_changeTracker.shadowMapSizeChanged = false;
+    }
+
     if (m_changedSeriesList.size()) {
         m_renderer->modifiedSeriesList(m_changedSeriesList);
         m_changedSeriesList.clear();
@@ -499,8 +522,12 @@ void Abstract3DController::synchDataToRenderer()
     if (m_isDataDirty) {
         // Series list supplied above in updateSeries() is used to access the data,
         // so no data needs to be passed in updateData()
+        FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseUpdateData);
         m_renderer->updateData();
         m_isDataDirty = false;
+        // Otherwise the renderer signals once the prepared data has been taken into use
+        if (!m_renderer->isPreparingData())
+            emit dataReady();
     }
 
     if (m_isCustomDataDirty) {
@@ -533,10 +560,39 @@ void Abstract3DController::render(const GLuint defaultFboHandle)
             m_frameTimer.restart();
         }
         // To get meaningful framerate, don't just do render on demand.
-        emitNeedRender();
+        emitNeedRedraw();
     }
 
-    m_renderer->render(defaultFboHandle);
+    renderFrame(defaultFboHandle);
+}
+
+void Abstract3DController::renderFrame(const GLuint fboHandle)
+{
+    FrameStatisticsCollector *collector = frameStatisticsCollector();
+    if (collector)
+        collector->beginGpuTimer();
+    {
+        // Rendering not attributed to any other phase is counted as the main pass
+        FrameStatisticsCollector::Scope statisticsScope(collector,
+                                                        FrameStatisticsCollector::PhaseMainPass);
+        m_renderer->render(fboHandle);
+    }
+    if (collector) {
+        collector->endGpuTimer();
+        const Q3DFrameStatistics statistics = collector->takeStatistics();
+        {
+            QMutexLocker statisticsLocker(&m_frameStatisticsMutex);
+            m_frameStatistics = statistics;
+        }
+        emit frameStatisticsChanged(statistics);
+    }
+}
+
+FrameStatisticsCollector *Abstract3DController::frameStatisticsCollector()
+{
+    if (!m_frameStatisticsEnabled || !m_renderer)
+        return nullptr;
+    return m_renderer->frameStatisticsCollector();
 }
 
 void Abstract3DController::mouseDoubleClickEvent(QMouseEvent *event)
@@ -973,10 +1029,21 @@ void Abstract3DController::markSeriesVisualsDirty()
     emitNeedRender();
 }
 
+// Schedules a full data reload of a single series, used when so many of its items have
+// changed that updating them individually would be slower.
+void Abstract3DController::markSeriesDataDirty(QAbstract3DSeries *series)
+{
+    if (series->isVisible())
+        m_isDataDirty = true;
+    if (!m_changedSeriesList.contains(series))
+        m_changedSeriesList.append(series);
+    series->d_ptr->markItemLabelDirty();
+}
+
 void Abstract3DController::requestRender(QOpenGLFramebufferObject *fbo)
 {
     QMutexLocker mutexLocker(&m_renderMutex);
-    m_renderer->render(fbo->handle());
+    renderFrame(fbo->handle());
 }
 
 int Abstract3DController::addCustomItem(QCustom3DItem *item)
@@ -1208,13 +1275,13 @@ void Abstract3DController::handleInputViewChanged(QAbstract3DInputHandler::Input
         setSlicingActive(false);
     }
 
-    emitNeedRender();
+    emitNeedRedraw();
 }
 
 void Abstract3DController::handleInputPositionChanged(const QPoint &position)
 {
     Q_UNUSED(position);
-    emitNeedRender();
+    emitNeedRedraw();
 }
 
 void Abstract3DController::handleSeriesVisibilityChanged(bool visible)
@@ -1244,6 +1311,20 @@ void Abstract3DController::setMeasureFps(bool enable)
     }
 }
 
+void Abstract3DController::setFrameStatisticsEnabled(bool enable)
+{
+    if (m_frameStatisticsEnabled != enable) {
+        m_frameStatisticsEnabled = enable;
+        emit frameStatisticsEnabledChanged(enable);
+    }
+}
+
+Q3DFrameStatistics Abstract3DController::frameStatistics() const
+{
+    QMutexLocker statisticsLocker(&m_frameStatisticsMutex);
+    return m_frameStatistics;
+}
+
 void Abstract3DController::handleAxisLabelFormatChangedBySender(QObject *sender)
 {
     // Label format changing needs to dirty the data so that labels are reset.
@@ -1482,6 +1563,12 @@ void Abstract3DController::startRecordingRemovesAndInserts()
 }
 
 void Abstract3DController::emitNeedRender()
+{
+    m_isSelectionPassDirty = true;
+    emitNeedRedraw();
+}
+
+void Abstract3DController::emitNeedRedraw()
 {
     if (!m_renderPending) {
         emit needRender();
@@ -1727,5 +1814,35 @@ qreal Abstract3DController::margin() const
     return m_margin;
 }
 
+void Abstract3DController::setAsynchronousDataPreparation(bool enable)
+{
+    if (m_asynchronousDataPreparation != enable) {
+        m_asynchronousDataPreparation = enable;
+        m_changeTracker.dataPreparationChanged = true;
+        emit asynchronousDataPreparationChanged(enable);
+    }
+}
+
+void Abstract3DController::setMaxDataLatency(int msecs)
+{
+    msecs = qMax(msecs, -1);
+    if (m_maxDataLatency != msecs) {
+        m_maxDataLatency = msecs;
+        m_changeTracker.dataPreparationChanged = true;
+        emit maxDataLatencyChanged(msecs);
+    }
+}
+
+void Abstract3DController::setShadowMapSize(int size)
+{
+    size = qBound(0, size, maxShadowMapSize);
+    if (m_shadowMapSize != size) {
+        m_shadowMapSize = size;
+        m_changeTracker.shadowMapSizeChanged = true;
+        emit shadowMapSizeChanged(size);
+        emitNeedRender();
+    }
+}
+
 
 QT_END_NAMESPACE
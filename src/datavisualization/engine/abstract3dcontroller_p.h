@@ -22,6 +22,7 @@
 #include "qabstract3dgraph.h"
 #include "q3dscene_p.h"
 #include "qcustom3ditem.h"
+#include "q3dframestatistics.h"
 #include <QtGui/QLinearGradient>
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QLocale>
@@ -34,6 +35,7 @@ QT_BEGIN_NAMESPACE
 class AbstractDeclarativeInterface;
 class AbstractDeclarative;
 class Abstract3DRenderer;
+class FrameStatisticsCollector;
 class QAbstract3DSeries;
 class ThemeManager;
 
@@ -86,6 +88,8 @@ struct Abstract3DChangeBitField {
     bool reflectionChanged             : 1;
     bool reflectivityChanged           : 1;
     bool marginChanged                 : 1;
+    bool dataPreparationChanged        : 1;
+    bool shadowMapSizeChanged          : 1;
 
     Abstract3DChangeBitField() :
         themeChanged(true),
@@ -182,6 +186,7 @@ protected:
     bool m_isCustomItemDirty;
     bool m_isSeriesVisualsDirty;
     bool m_renderPending;
+    bool m_isSelectionPassDirty;
     bool m_isPolar;
     float m_radialLabelOffset;
 
@@ -192,6 +197,10 @@ protected:
     int m_numFrames;
     qreal m_currentFps;
 
+    bool m_frameStatisticsEnabled;
+    Q3DFrameStatistics m_frameStatistics;
+    mutable QMutex m_frameStatisticsMutex;
+
     QList<QAbstract3DSeries *> m_changedSeriesList;
 
     QList<QCustom3DItem *> m_customItems;
@@ -200,6 +209,9 @@ protected:
     int m_selectedLabelIndex;
     int m_selectedCustomItemIndex;
     qreal m_margin;
+    bool m_asynchronousDataPreparation;
+    int m_maxDataLatency;
+    int m_shadowMapSize;
 
     QMutex m_renderMutex;
     AbstractDeclarativeInterface *m_qml = nullptr;
@@ -210,6 +222,8 @@ public:
     virtual ~Abstract3DController();
 
     inline bool isInitialized() { return (m_renderer != 0); }
+    // Null if frame statistics are disabled
+    FrameStatisticsCollector *frameStatisticsCollector();
     virtual void synchDataToRenderer();
     virtual void render(const GLuint defaultFboHandle = 0);
     virtual void initializeOpenGL() = 0;
@@ -261,6 +275,7 @@ public:
 
     void markDataDirty();
     void markSeriesVisualsDirty();
+    void markSeriesDataDirty(QAbstract3DSeries *series);
 
     void requestRender(QOpenGLFramebufferObject *fbo);
 
@@ -283,6 +298,10 @@ public:
     inline bool measureFps() const { return m_measureFps; }
     inline qreal currentFps() const { return m_currentFps; }
 
+    void setFrameStatisticsEnabled(bool enable);
+    inline bool isFrameStatisticsEnabled() const { return m_frameStatisticsEnabled; }
+    Q3DFrameStatistics frameStatistics() const;
+
     QAbstract3DGraph::ElementType selectedElement() const;
 
     void setAspectRatio(qreal ratio);
@@ -308,7 +327,17 @@ public:
     void setMargin(qreal margin);
     qreal margin() const;
 
+    void setAsynchronousDataPreparation(bool enable);
+    inline bool asynchronousDataPreparation() const { return m_asynchronousDataPreparation; }
+    void setMaxDataLatency(int msecs);
+    inline int maxDataLatency() const { return m_maxDataLatency; }
+    void setShadowMapSize(int size);
+    inline int shadowMapSize() const { return m_shadowMapSize; }
+
     void emitNeedRender();
+    // For changes that do not affect what the selection pass draws, such as camera, input and
+    // selection changes
+    void emitNeedRedraw();
 
     virtual void clearSelection() = 0;
 
@@ -387,6 +416,8 @@ Q_SIGNALS:
     void elementSelected(QAbstract3DGraph::ElementType type);
     void measureFpsChanged(bool enabled);
     void currentFpsChanged(qreal fps);
+    void frameStatisticsEnabledChanged(bool enabled);
+    void frameStatisticsChanged(const Q3DFrameStatistics &statistics);
     void orthoProjectionChanged(bool enabled);
     void aspectRatioChanged(qreal ratio);
     void horizontalAspectRatioChanged(qreal ratio);
@@ -398,6 +429,10 @@ Q_SIGNALS:
     void localeChanged(const QLocale &locale);
     void queriedGraphPositionChanged(const QVector3D &data);
     void marginChanged(qreal margin);
+    void asynchronousDataPreparationChanged(bool enabled);
+    void maxDataLatencyChanged(int msecs);
+    void dataReady();
+    void shadowMapSizeChanged(int size);
 
 protected:
     virtual QAbstract3DAxis *createDefaultAxis(QAbstract3DAxis::AxisOrientation orientation);
@@ -408,6 +443,8 @@ protected:
 private:
     void setAxisHelper(QAbstract3DAxis::AxisOrientation orientation, QAbstract3DAxis *axis,
                        QAbstract3DAxis **axisPtr);
+    // Renders a frame and reports its statistics, if enabled. Render mutex must be locked.
+    void renderFrame(const GLuint fboHandle);
 
     friend class AbstractDeclarative;
     friend class Bars3DController;
@@ -11,11 +11,14 @@
 #include "qcustom3dlabel_p.h"
 #include "qcustom3dvolume_p.h"
 #include "scatter3drenderer_p.h"
+#include "selectionreadback_p.h"
 
 #include <QtCore/qmath.h>
 #include <QtGui/QOffscreenSurface>
 #include <QtCore/QThread>
 
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
 // Defined in shaderhelper.cpp
@@ -38,9 +41,14 @@ Abstract3DRenderer::Abstract3DRenderer(Abstract3DController *controller)
       m_cachedOptimizationHint(QAbstract3DGraph::OptimizationDefault),
       m_textureHelper(0),
       m_depthTexture(0),
+      m_shadowMapSize(0),
+      m_depthPassDirty(true),
       m_cachedScene(new Q3DScene()),
       m_selectionDirty(true),
       m_selectionState(SelectNone),
+      m_selectionPassDirty(true),
+      m_frameChanges(FrameChangeContent),
+      m_selectionReadback(0),
       m_devicePixelRatio(1.0f),
       m_selectionLabelDirty(true),
       m_clickResolved(false),
@@ -84,6 +92,8 @@ Abstract3DRenderer::Abstract3DRenderer(Abstract3DController *controller)
       m_xFlipRotation(QQuaternion::fromAxisAndAngle(1.0f, 0.0f, 0.0f, -180.0f)),
       m_zFlipRotation(QQuaternion::fromAxisAndAngle(0.0f, 0.0f, 1.0f, -180.0f)),
       m_requestedMargin(-1.0f),
+      m_asynchronousDataPreparation(false),
+      m_maxDataLatency(-1),
       m_vBackgroundMargin(0.1f),
       m_hBackgroundMargin(0.1f),
       m_scaleXWithBackground(0.0f),
@@ -122,6 +132,8 @@ Abstract3DRenderer::Abstract3DRenderer(Abstract3DController *controller)
                      &Abstract3DController::needRender, Qt::QueuedConnection);
     QObject::connect(this, &Abstract3DRenderer::requestShadowQuality, controller,
                      &Abstract3DController::handleRequestShadowQuality, Qt::QueuedConnection);
+    QObject::connect(this, &Abstract3DRenderer::dataReady, controller,
+                     &Abstract3DController::dataReady, Qt::QueuedConnection);
 }
 
 Abstract3DRenderer::~Abstract3DRenderer()
@@ -131,6 +143,7 @@ Abstract3DRenderer::~Abstract3DRenderer()
     delete m_cachedScene;
     delete m_cachedTheme;
     delete m_selectionLabelItem;
+    delete m_selectionReadback;
     delete m_customItemShader;
     delete m_volumeTextureShader;
     delete m_volumeTextureLowDefShader;
@@ -148,6 +161,8 @@ Abstract3DRenderer::~Abstract3DRenderer()
     foreach (CustomRenderItem *item, m_customRenderCache) {
         GLuint texture = item->texture();
         m_textureHelper->deleteTexture(&texture);
+        texture = item->brickTexture();
+        m_textureHelper->deleteTexture(&texture);
         delete item;
     }
     m_customRenderCache.clear();
@@ -197,6 +212,7 @@ void Abstract3DRenderer::initializeOpenGL()
 #endif
 
     m_textureHelper = new TextureHelper();
+    m_selectionReadback = new SelectionReadback();
     m_drawer->initializeOpenGL();
 
     axisCacheForOrientation(QAbstract3DAxis::AxisOrientationX).setDrawer(m_drawer);
@@ -530,6 +546,18 @@ void Abstract3DRenderer::updateMargin(float margin)
     m_requestedMargin = margin;
 }
 
+void Abstract3DRenderer::updateDataPreparation(bool asynchronous, int maxLatency)
+{
+    m_asynchronousDataPreparation = asynchronous;
+    m_maxDataLatency = maxLatency;
+}
+
+void Abstract3DRenderer::updateShadowMapSize(int size)
+{
+    m_shadowMapSize = size;
+    updateDepthBuffer();
+}
+
 void Abstract3DRenderer::updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint)
 {
     m_cachedOptimizationHint = hint;
@@ -735,6 +763,8 @@ void Abstract3DRenderer::updateCustomData(const QList<QCustom3DItem *> &customIt
             m_customRenderCache.remove(renderItem->itemPointer());
             GLuint texture = renderItem->texture();
             m_textureHelper->deleteTexture(&texture);
+            texture = renderItem->brickTexture();
+            m_textureHelper->deleteTexture(&texture);
             delete renderItem;
         }
     }
@@ -1177,6 +1207,11 @@ CustomRenderItem *Abstract3DRenderer::addCustomItem(QCustom3DItem *item)
                                                    volumeItem->textureHeight(),
                                                    volumeItem->textureDepth(),
                                                    volumeItem->textureFormat());
+        newItem->updateBricks(volumeItem->textureData());
+        newItem->setBrickTexture(m_textureHelper->createBrickTexture(newItem->bricks(),
+                                                                     newItem->brickCountX(),
+                                                                     newItem->brickCountY(),
+                                                                     newItem->brickCountZ()));
         newItem->setSliceIndexX(volumeItem->sliceIndexX());
         newItem->setSliceIndexY(volumeItem->sliceIndexY());
         newItem->setSliceIndexZ(volumeItem->sliceIndexZ());
@@ -1365,9 +1400,12 @@ void Abstract3DRenderer::updateCustomItem(CustomRenderItem *renderItem)
         }
     } else if (item->d_ptr->m_isVolumeItem && !m_isOpenGLES) {
         QCustom3DVolume *volumeItem = static_cast<QCustom3DVolume *>(item);
+        // Indexed texels change visibility with the color table
+        bool bricksDirty = false;
         if (volumeItem->dptr()->m_dirtyBitsVolume.colorTableDirty) {
             renderItem->setColorTable(volumeItem->colorTable());
             volumeItem->dptr()->m_dirtyBitsVolume.colorTableDirty = false;
+            bricksDirty = (renderItem->textureFormat() == QImage::Format_Indexed8);
         }
         if (volumeItem->dptr()->m_dirtyBitsVolume.textureDimensionsDirty
                 || volumeItem->dptr()->m_dirtyBitsVolume.textureDataDirty
@@ -1384,9 +1422,51 @@ void Abstract3DRenderer::updateCustomItem(CustomRenderItem *renderItem)
             renderItem->setTextureHeight(volumeItem->textureHeight());
             renderItem->setTextureDepth(volumeItem->textureDepth());
             renderItem->setTextureFormat(volumeItem->textureFormat());
+            GLuint oldBrickTexture = renderItem->brickTexture();
+            m_textureHelper->deleteTexture(&oldBrickTexture);
+            renderItem->updateBricks(volumeItem->textureData());
+            renderItem->setBrickTexture(
+                        m_textureHelper->createBrickTexture(renderItem->bricks(),
+                                                            renderItem->brickCountX(),
+                                                            renderItem->brickCountY(),
+                                                            renderItem->brickCountZ()));
+            bricksDirty = false;
             volumeItem->dptr()->m_dirtyBitsVolume.textureDimensionsDirty = false;
             volumeItem->dptr()->m_dirtyBitsVolume.textureDataDirty = false;
             volumeItem->dptr()->m_dirtyBitsVolume.textureFormatDirty = false;
+            volumeItem->dptr()->m_dirtyTextureBoxes.clear();
+        } else if (!volumeItem->dptr()->m_dirtyTextureBoxes.isEmpty()) {
+            // Only upload the changed parts of the texture
+            const auto &boxes = volumeItem->dptr()->m_dirtyTextureBoxes;
+            for (const QCustomVolumeTextureBox &box : boxes) {
+                m_textureHelper->update3DTexture(renderItem->texture(),
+                                                 volumeItem->textureData(),
+                                                 volumeItem->textureWidth(),
+                                                 volumeItem->textureHeight(),
+                                                 volumeItem->textureFormat(),
+                                                 box.x, box.y, box.z,
+                                                 box.width, box.height, box.depth);
+                if (!bricksDirty) {
+                    renderItem->updateBricks(volumeItem->textureData(), box.x, box.y, box.z,
+                                             box.width, box.height, box.depth);
+                }
+            }
+            volumeItem->dptr()->m_dirtyTextureBoxes.clear();
+            if (!bricksDirty) {
+                m_textureHelper->updateBrickTexture(renderItem->brickTexture(),
+                                                    renderItem->bricks(),
+                                                    renderItem->brickCountX(),
+                                                    renderItem->brickCountY(),
+                                                    renderItem->brickCountZ());
+            }
+        }
+        if (bricksDirty) {
+            renderItem->updateBricks(volumeItem->textureData());
+            m_textureHelper->updateBrickTexture(renderItem->brickTexture(),
+                                                renderItem->bricks(),
+                                                renderItem->brickCountX(),
+                                                renderItem->brickCountY(),
+                                                renderItem->brickCountZ());
         }
         if (volumeItem->dptr()->m_dirtyBitsVolume.slicesDirty) {
             renderItem->setDrawSlices(volumeItem->drawSlices());
@@ -1430,6 +1510,7 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
     if (m_customRenderCache.isEmpty())
         return;
 
+    FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseCustomItems);
     ShaderHelper *shader = regularShader;
     shader->bind();
 
@@ -1611,6 +1692,21 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
                             }
                             shader->setUniformValue(shader->textureDimensions(), textureDimensions);
                             shader->setUniformValue(shader->sampleCount(), sampleCount);
+#if !QT_CONFIG(opengles2)
+                            // Zero extent disables empty space skipping in the shader
+                            if (item->brickTexture()) {
+                                glActiveTexture(GL_TEXTURE3);
+                                glBindTexture(GL_TEXTURE_3D, item->brickTexture());
+                                glActiveTexture(GL_TEXTURE0);
+                                shader->setUniformValue(shader->brickSampler(), 3);
+                                shader->setUniformValue(shader->brickExtent(),
+                                                        item->brickExtent());
+                                shader->setUniformValue(shader->brickScale(),
+                                                        item->brickScale());
+                            } else {
+                                shader->setUniformValue(shader->brickExtent(), zeroVector);
+                            }
+#endif
                         }
                         if (item->drawSliceFrames()) {
                             // Set up the slice frame shader
@@ -1631,6 +1727,13 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
                             shader->bind();
                         }
                         m_drawer->drawObject(shader, item->mesh(), 0, 0, item->texture());
+#if !QT_CONFIG(opengles2)
+                        if (item->brickTexture() && shader != m_volumeTextureSliceShader) {
+                            glActiveTexture(GL_TEXTURE3);
+                            glBindTexture(GL_TEXTURE_3D, 0);
+                            glActiveTexture(GL_TEXTURE0);
+                        }
+#endif
                     } else {
                         shader->setUniformValue(shader->lightS(), m_cachedTheme->lightStrength());
                         m_drawer->drawObject(shader, item->mesh(), item->texture());
@@ -1820,11 +1923,154 @@ void Abstract3DRenderer::queriedGraphPosition(const QMatrix4x4 &projectionViewMa
     m_graphPositionQueryPending = false;
 }
 
+bool Abstract3DRenderer::isSelectionPassValid(const QMatrix4x4 &projectionViewMatrix) const
+{
+    return !m_selectionPassDirty && m_selectionPassMatrix == projectionViewMatrix;
+}
+
+void Abstract3DRenderer::validateSelectionPass(const QMatrix4x4 &projectionViewMatrix)
+{
+    m_selectionPassDirty = false;
+    m_selectionPassMatrix = projectionViewMatrix;
+
+    // A read from the previous pass is outdated
+    m_selectionReadback->cancel();
+}
+
+bool Abstract3DRenderer::isDepthPassValid(const QMatrix4x4 &projectionViewMatrix,
+                                          const QMatrix4x4 &depthProjectionViewMatrix) const
+{
+    // Custom items facing the camera are drawn into the depth texture as well, so the camera
+    // must not have changed either
+    return !m_depthPassDirty && m_depthPassMatrix == depthProjectionViewMatrix
+            && m_depthPassCameraMatrix == projectionViewMatrix;
+}
+
+void Abstract3DRenderer::validateDepthPass(const QMatrix4x4 &projectionViewMatrix,
+                                           const QMatrix4x4 &depthProjectionViewMatrix)
+{
+    m_depthPassDirty = false;
+    m_depthPassMatrix = depthProjectionViewMatrix;
+    m_depthPassCameraMatrix = projectionViewMatrix;
+}
+
+void Abstract3DRenderer::markFrameChanged(FrameChanges changes)
+{
+    m_frameChanges |= changes;
+
+    // Content changes affect the shadows as well
+    if (changes & FrameChangeContent) {
+        invalidateSelectionPass();
+        invalidateDepthPass();
+    }
+}
+
+// Returns the changes since the previous call, adding camera and viewport changes detected from
+// the matrix and the viewport the frame is drawn with. Moving the light counts as a camera change.
+Abstract3DRenderer::FrameChanges Abstract3DRenderer::takeFrameChanges(
+        const QMatrix4x4 &projectionViewMatrix)
+{
+    const QVector3D lightPosition = m_cachedScene->activeLight()->position();
+    FrameChanges changes = m_frameChanges;
+    if (m_frameMatrix != projectionViewMatrix || m_frameLightPosition != lightPosition)
+        changes |= FrameChangeCamera;
+    if (m_frameViewport != m_primarySubViewport)
+        changes |= FrameChangeViewport;
+
+    m_frameChanges = FrameChangeNone;
+    m_frameMatrix = projectionViewMatrix;
+    m_frameLightPosition = lightPosition;
+    m_frameViewport = m_primarySubViewport;
+    return changes;
+}
+
+// Returns the size of the shadow depth texture. Without a shadow map size the texture is the
+// size of the viewport multiplied by the shadow quality. Otherwise the shadow map size is the
+// size at the highest quality, and lower qualities use proportionally smaller textures.
+QSize Abstract3DRenderer::calculateShadowMapSize(int qualityMultiplier)
+{
+    if (m_shadowMapSize <= 0)
+        return m_primarySubViewport.size() * qualityMultiplier;
+
+    static const int highestQualityMultiplier = 5;
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    int size = qMax(1, m_shadowMapSize * qualityMultiplier / highestQualityMultiplier);
+    if (maxTextureSize > 0)
+        size = qMin(size, int(maxTextureSize));
+    return QSize(size, size);
+}
+
+// Returns the projection matrix of the shadow depth pass. With a shadow map size the light
+// frustum is fitted around the graph box, so that the fixed number of texels is spent on the
+// graph only, whatever the size of the viewport.
+QMatrix4x4 Abstract3DRenderer::calculateDepthProjectionMatrix(const QMatrix4x4 &depthViewMatrix,
+                                                              float fieldOfView,
+                                                              float viewPortRatio) const
+{
+    QMatrix4x4 projectionMatrix;
+    if (m_shadowMapSize > 0) {
+        float left = std::numeric_limits<float>::max();
+        float right = -std::numeric_limits<float>::max();
+        float bottom = std::numeric_limits<float>::max();
+        float top = -std::numeric_limits<float>::max();
+        float nearPlane = std::numeric_limits<float>::max();
+        float farPlane = 0.0f;
+        bool fitted = true;
+        for (int i = 0; i < 8 && fitted; i++) {
+            const QVector3D corner((i & 1) ? m_scaleXWithBackground : -m_scaleXWithBackground,
+                                   (i & 2) ? m_scaleYWithBackground : -m_scaleYWithBackground,
+                                   (i & 4) ? m_scaleZWithBackground : -m_scaleZWithBackground);
+            const QVector3D position = depthViewMatrix.map(corner);
+            const float depth = -position.z();
+            // The light is inside the graph box
+            fitted = depth > 0.0f;
+            if (fitted) {
+                left = qMin(left, position.x() / depth);
+                right = qMax(right, position.x() / depth);
+                bottom = qMin(bottom, position.y() / depth);
+                top = qMax(top, position.y() / depth);
+                nearPlane = qMin(nearPlane, depth);
+                farPlane = qMax(farPlane, depth);
+            }
+        }
+        if (fitted) {
+            // Leave some slack so that the edges of the box are not clipped
+            nearPlane *= 0.9f;
+            farPlane *= 1.1f;
+            projectionMatrix.frustum(left * nearPlane, right * nearPlane,
+                                     bottom * nearPlane, top * nearPlane, nearPlane, farPlane);
+            return projectionMatrix;
+        }
+    }
+    projectionMatrix.perspective(fieldOfView, viewPortRatio, 3.0f, 100.0f);
+    return projectionMatrix;
+}
+
+bool Abstract3DRenderer::readSelection(GLuint frameBuffer, GLuint defaultFboHandle,
+                                       QVector4D &color, bool integerBuffer)
+{
+    if (!m_selectionReadback->isPending() || m_selectionReadback->position() != m_inputPosition) {
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+        m_selectionReadback->request(m_inputPosition, m_viewport.height(), integerBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
+    }
+    return m_selectionReadback->take(color);
+}
+
 void Abstract3DRenderer::calculatePolarXZ(const QVector3D &dataPos, float &x, float &z) const
 {
     // x is angular, z is radial
-    qreal angle = m_axisCacheX.formatter()->positionAt(dataPos.x()) * doublePi;
-    qreal radius = m_axisCacheZ.formatter()->positionAt(dataPos.z());
+    calculatePolarXZ(m_axisCacheX.formatter()->positionAt(dataPos.x()),
+                     m_axisCacheZ.formatter()->positionAt(dataPos.z()), x, z);
+}
+
+// Takes the formatter positions of the data x and z, for callers that resolve them in batches
+void Abstract3DRenderer::calculatePolarXZ(float angularPosition, float radialPosition,
+                                          float &x, float &z) const
+{
+    qreal angle = angularPosition * doublePi;
+    qreal radius = radialPosition;
 
     // Convert angle & radius to X and Z coords
     x = float(radius * qSin(angle)) * m_polarRadius;
@@ -23,6 +23,7 @@
 #include "axisrendercache_p.h"
 #include "seriesrendercache_p.h"
 #include "customrenderitem_p.h"
+#include "framestatisticscollector_p.h"
 
 QT_FORWARD_DECLARE_CLASS(QOffscreenSurface)
 
@@ -31,6 +32,7 @@ QT_BEGIN_NAMESPACE
 class TextureHelper;
 class Theme;
 class Drawer;
+class SelectionReadback;
 
 class Abstract3DRenderer : public QObject, protected QOpenGLFunctions
 {
@@ -51,6 +53,18 @@ protected:
     };
 
 public:
+    // What has changed since the previous frame. Content changes invalidate the selection and
+    // depth passes of all graphs. The full mask is only taken by the surface renderer, which
+    // reuses its cached scene when nothing but the selection has changed.
+    enum FrameChange {
+        FrameChangeNone = 0,
+        FrameChangeContent = 1,
+        FrameChangeCamera = 2,
+        FrameChangeViewport = 4,
+        FrameChangeSelection = 8
+    };
+    Q_DECLARE_FLAGS(FrameChanges, FrameChange)
+
     virtual ~Abstract3DRenderer();
 
     virtual void updateData() = 0;
@@ -128,6 +142,10 @@ public:
     virtual void updatePolar(bool enable);
     virtual void updateRadialLabelOffset(float offset);
     virtual void updateMargin(float margin);
+    virtual void updateDataPreparation(bool asynchronous, int maxLatency);
+    virtual void updateShadowMapSize(int size);
+    // Returns true while data taken in the last synchronization is still being prepared
+    virtual bool isPreparingData() const { return false; }
 
     virtual QVector3D convertPositionToTranslation(const QVector3D &position,
                                                    bool isAbsolute) = 0;
@@ -135,6 +153,14 @@ public:
     void generateBaseColorTexture(const QColor &color, GLuint *texture);
     void fixGradientAndGenerateTexture(QLinearGradient *gradient, GLuint *gradientTexture);
 
+    // The selection pass is rendered again only when the camera or the content of the graph has
+    // changed since the previous one.
+    inline void invalidateSelectionPass() { m_selectionPassDirty = true; }
+    // Likewise, the shadow depth pass is rendered again only when the camera or the content of
+    // the graph has changed.
+    inline void invalidateDepthPass() { m_depthPassDirty = true; }
+    void markFrameChanged(FrameChanges changes);
+
     inline bool isClickQueryResolved() const { return m_clickResolved; }
     inline void clearClickQueryResolved() { m_clickResolved = false; }
     inline QPoint cachedClickQuery() const { return m_cachedScene->selectionQueryPosition(); }
@@ -157,10 +183,17 @@ public:
 
     QVector4D indexToSelectionColor(GLint index);
     void calculatePolarXZ(const QVector3D &dataPos, float &x, float &z) const;
+    void calculatePolarXZ(float angularPosition, float radialPosition, float &x, float &z) const;
+
+    inline FrameStatisticsCollector *frameStatisticsCollector()
+    {
+        return &m_frameStatisticsCollector;
+    }
 
 Q_SIGNALS:
     void needRender(); // Emit this if something in renderer causes need for another render pass.
     void requestShadowQuality(QAbstract3DGraph::ShadowQuality quality); // For automatic quality adjustments
+    void dataReady(); // Emit this when asynchronously prepared data has been taken into use
 
 protected:
     Abstract3DRenderer(Abstract3DController *controller);
@@ -217,6 +250,21 @@ protected:
     void queriedGraphPosition(const QMatrix4x4 &projectionViewMatrix, const QVector3D &scaling,
                               GLuint defaultFboHandle);
 
+    bool isSelectionPassValid(const QMatrix4x4 &projectionViewMatrix) const;
+    void validateSelectionPass(const QMatrix4x4 &projectionViewMatrix);
+    bool isDepthPassValid(const QMatrix4x4 &projectionViewMatrix,
+                          const QMatrix4x4 &depthProjectionViewMatrix) const;
+    void validateDepthPass(const QMatrix4x4 &projectionViewMatrix,
+                           const QMatrix4x4 &depthProjectionViewMatrix);
+    FrameChanges takeFrameChanges(const QMatrix4x4 &projectionViewMatrix);
+    QSize calculateShadowMapSize(int qualityMultiplier);
+    QMatrix4x4 calculateDepthProjectionMatrix(const QMatrix4x4 &depthViewMatrix,
+                                              float fieldOfView, float viewPortRatio) const;
+    // Returns true and the selection buffer texel under the input position in color once it
+    // has been read, which can take until a later frame.
+    bool readSelection(GLuint frameBuffer, GLuint defaultFboHandle, QVector4D &color,
+                       bool integerBuffer = false);
+
     bool m_hasNegativeValues;
     Q3DTheme *m_cachedTheme;
     Drawer *m_drawer;
@@ -232,10 +280,22 @@ protected:
     AxisRenderCache m_axisCacheZ;
     TextureHelper *m_textureHelper;
     GLuint m_depthTexture;
+    QSize m_depthTextureSize;
+    int m_shadowMapSize;
+    bool m_depthPassDirty;
+    QMatrix4x4 m_depthPassMatrix;
+    QMatrix4x4 m_depthPassCameraMatrix;
 
     Q3DScene *m_cachedScene;
     bool m_selectionDirty;
     SelectionState m_selectionState;
+    bool m_selectionPassDirty;
+    QMatrix4x4 m_selectionPassMatrix;
+    FrameChanges m_frameChanges;
+    QMatrix4x4 m_frameMatrix;
+    QVector3D m_frameLightPosition;
+    QRect m_frameViewport;
+    SelectionReadback *m_selectionReadback;
     QPoint m_inputPosition;
     QHash<QAbstract3DSeries *, SeriesRenderCache *> m_renderCacheList;
     CustomRenderItemArray m_customRenderCache;
@@ -295,6 +355,8 @@ protected:
     QQuaternion m_zFlipRotation;
 
     float m_requestedMargin;
+    bool m_asynchronousDataPreparation;
+    int m_maxDataLatency;
     float m_vBackgroundMargin;
     float m_hBackgroundMargin;
     float m_scaleXWithBackground;
@@ -313,10 +375,14 @@ protected:
     QPointer<QOpenGLContext> m_context; // Not owned
     bool m_isOpenGLES;
 
+    FrameStatisticsCollector m_frameStatisticsCollector;
+
 private:
     friend class Abstract3DController;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Abstract3DRenderer::FrameChanges)
+
 QT_END_NAMESPACE
 
 #endif
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "axisrendercache_p.h"
+#include "qvalue3daxisformatter_p.h"
 
 #include <QtGui/QFontMetrics>
 
@@ -142,6 +143,45 @@ void AxisRenderCache::updateAllPositions()
     }
 }
 
+// Returns true if positionAt() is an affine function of the value, which is the case when
+// the axis uses the default linear formatter. The position of a value can then be computed
+// as (value - origin) * multiplier + offset without going through the formatter.
+bool AxisRenderCache::linearMapping(float &origin, float &multiplier, float &offset) const
+{
+    if (!m_formatter || !m_formatter->d_ptr->hasLinearMapping())
+        return false;
+
+    const QValue3DAxisFormatterPrivate *formatter = m_formatter->d_ptr.data();
+    origin = formatter->m_min;
+    multiplier = m_scale / formatter->m_rangeNormalizer;
+    offset = m_translate;
+    if (m_reversed) {
+        multiplier = -multiplier;
+        offset += m_scale;
+    }
+    return true;
+}
+
+// Batched version of positionAt(). The values and positions may point to the same array.
+void AxisRenderCache::positionsAt(const float *values, float *positions, int count) const
+{
+    formatterPositionsAt(values, positions, count);
+    if (m_reversed) {
+        for (int i = 0; i < count; i++)
+            positions[i] = (1.0f - positions[i]) * m_scale + m_translate;
+    } else {
+        for (int i = 0; i < count; i++)
+            positions[i] = positions[i] * m_scale + m_translate;
+    }
+}
+
+// Batched version of formatter()->positionAt()
+void AxisRenderCache::formatterPositionsAt(const float *values, float *positions,
+                                           int count) const
+{
+    m_formatter->d_ptr->positionsAt(values, positions, count);
+}
+
 void AxisRenderCache::updateTextures()
 {
     m_font = m_drawer->font();
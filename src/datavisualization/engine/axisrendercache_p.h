@@ -85,6 +85,9 @@ public:
         else
             return m_formatter->positionAt(value) * m_scale + m_translate;
     }
+    void positionsAt(const float *values, float *positions, int count) const;
+    void formatterPositionsAt(const float *values, float *positions, int count) const;
+    bool linearMapping(float &origin, float &multiplier, float &offset) const;
     inline float labelAutoRotation() const { return m_labelAutoRotation; }
     inline void setLabelAutoRotation(float angle) { m_labelAutoRotation = angle; }
     inline bool isTitleVisible() const { return m_titleVisible; }
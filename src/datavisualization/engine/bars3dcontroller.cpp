@@ -63,6 +63,9 @@ void Bars3DController::synchDataToRenderer()
     if (!isInitialized())
         return;
 
+    FrameStatisticsCollector::Scope statisticsScope(frameStatisticsCollector(),
+                                                    FrameStatisticsCollector::PhaseSynch);
+
     // Background change requires reloading the meshes in bar graphs, so dirty the series visuals
     if (m_themeManager->activeTheme()->d_ptr->m_dirtyBits.backgroundEnabledDirty) {
         m_isSeriesVisualsDirty = true;
@@ -92,15 +95,30 @@ void Bars3DController::synchDataToRenderer()
 
     // Notify changes to renderer
     if (m_changeTracker.rowsChanged) {
-        m_renderer->updateRows(m_changedRows);
+        // Rows of fully updated series are reloaded by the data update already
+        if (m_changedRowTracker.hasFullUpdates()) {
+            m_changedRows.removeIf([this](const ChangeRow &row) {
+                return m_changedRowTracker.isFullUpdate(row.series);
+            });
+        }
+        if (!m_changedRows.isEmpty())
+            m_renderer->updateRows(m_changedRows);
         m_changeTracker.rowsChanged = false;
         m_changedRows.clear();
+        m_changedRowTracker.clear();
     }
 
     if (m_changeTracker.itemChanged) {
-        m_renderer->updateItems(m_changedItems);
+        if (m_changedItemTracker.hasFullUpdates()) {
+            m_changedItems.removeIf([this](const ChangeItem &item) {
+                return m_changedItemTracker.isFullUpdate(item.series);
+            });
+        }
+        if (!m_changedItems.isEmpty())
+            m_renderer->updateItems(m_changedItems);
         m_changeTracker.itemChanged = false;
         m_changedItems.clear();
+        m_changedItemTracker.clear();
     }
 
     if (m_changeTracker.multiSeriesScalingChanged) {
@@ -133,6 +151,7 @@ void Bars3DController::handleArrayReset()
     else
         series = static_cast<QBar3DSeries *>(sender());
 
+    m_changedRowTracker.resize(series, series->dataProxy()->rowCount());
     if (series->isVisible()) {
         adjustAxisRanges();
         m_isDataDirty = true;
@@ -162,25 +181,21 @@ void Bars3DController::handleRowsAdded(int startIndex, int count)
 void Bars3DController::handleRowsChanged(int startIndex, int count)
 {
     QBar3DSeries *series = static_cast<QBarDataProxy *>(sender())->series();
-    int oldChangeCount = m_changedRows.size();
-    if (!oldChangeCount)
-        m_changedRows.reserve(count);
+    const int rowCount = series->dataProxy()->rowCount();
 
     for (int i = 0; i < count; i++) {
-        bool newItem = true;
         int candidate = startIndex + i;
-        for (int j = 0; j < oldChangeCount; j++) {
-            const ChangeRow &oldChangeItem = m_changedRows.at(j);
-            if (oldChangeItem.row == candidate && series == oldChangeItem.series) {
-                newItem = false;
-                break;
-            }
-        }
-        if (newItem) {
+        ChangedItemTracker<QBar3DSeries>::MarkResult result =
+                m_changedRowTracker.mark(series, candidate, rowCount);
+        if (result == ChangedItemTracker<QBar3DSeries>::MarkAdded) {
             ChangeRow newChangeItem = {series, candidate};
             m_changedRows.append(newChangeItem);
             if (series == m_selectedBarSeries && m_selectedBar.x() == candidate)
                 series->d_ptr->markItemLabelDirty();
+        } else if (result == ChangedItemTracker<QBar3DSeries>::MarkFullUpdate) {
+            // Most of the series changed, so reload it fully instead of row by row
+            markSeriesDataDirty(series);
+            break;
         }
     }
     if (count) {
@@ -251,19 +266,21 @@ void Bars3DController::handleRowsInserted(int startIndex, int count)
 void Bars3DController::handleItemChanged(int rowIndex, int columnIndex)
 {
     QBar3DSeries *series = static_cast<QBarDataProxy *>(sender())->series();
+    QBarDataProxy *proxy = series->dataProxy();
+    const QBarDataRow *row = proxy->rowAt(rowIndex);
+    const int itemCount = proxy->rowCount() * (row ? int(row->size()) : 0);
 
-    bool newItem = true;
     QPoint candidate(rowIndex, columnIndex);
-    foreach (ChangeItem item, m_changedItems) {
-        if (item.point == candidate && item.series == series) {
-            newItem = false;
-            break;
+    ChangedItemTracker<QBar3DSeries>::MarkResult result =
+            m_changedItemTracker.mark(series, candidate, itemCount);
+    if (result == ChangedItemTracker<QBar3DSeries>::MarkFullUpdate)
+        markSeriesDataDirty(series);
+
+    if (result != ChangedItemTracker<QBar3DSeries>::MarkIgnored) {
+        if (result == ChangedItemTracker<QBar3DSeries>::MarkAdded) {
+            ChangeItem newItem = {series, candidate};
+            m_changedItems.append(newItem);
         }
-    }
-
-    if (newItem) {
-        ChangeItem newItem = {series, candidate};
-        m_changedItems.append(newItem);
         m_changeTracker.itemChanged = true;
 
         if (series == m_selectedBarSeries && m_selectedBar == candidate)
@@ -389,6 +406,9 @@ void Bars3DController::removeSeries(QAbstract3DSeries *series)
 
     Abstract3DController::removeSeries(series);
 
+    m_changedRowTracker.remove(static_cast<QBar3DSeries *>(series));
+    m_changedItemTracker.remove(static_cast<QBar3DSeries *>(series));
+
     if (m_selectedBarSeries == series)
         setSelectedBar(invalidSelectionPosition(), 0, false);
 
@@ -572,7 +592,7 @@ void Bars3DController::setSelectedBar(const QPoint &position, QBar3DSeries *seri
         } else if (enterSlice) {
             scene()->setSlicingActive(true);
         }
-        emitNeedRender();
+        emitNeedRedraw();
     }
 
     if (pos != m_selectedBar || series != m_selectedBarSeries) {
@@ -593,7 +613,7 @@ void Bars3DController::setSelectedBar(const QPoint &position, QBar3DSeries *seri
         if (seriesChanged)
             emit selectedSeriesChanged(m_selectedBarSeries);
 
-        emitNeedRender();
+        emitNeedRedraw();
     }
 }
 
@@ -16,6 +16,7 @@
 
 #include <private/datavisualizationglobal_p.h>
 #include <private/abstract3dcontroller_p.h>
+#include <private/changeditemtracker_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -61,6 +62,8 @@ private:
     Bars3DChangeBitField m_changeTracker;
     QList<ChangeItem> m_changedItems;
     QList<ChangeRow> m_changedRows;
+    ChangedItemTracker<QBar3DSeries> m_changedItemTracker;
+    ChangedItemTracker<QBar3DSeries> m_changedRowTracker;
 
     // Interaction
     QPoint m_selectedBar;     // Points to row & column in data window.
@@ -7,6 +7,7 @@
 #include "texturehelper_p.h"
 #include "utils_p.h"
 #include "barseriesrendercache_p.h"
+#include "barobjectbufferhelper_p.h"
 
 #include <QtCore/qmath.h>
 
@@ -17,6 +18,8 @@
 QT_BEGIN_NAMESPACE
 
 const bool sliceGridLabels = true;
+// Number of bar values whose axis positions are resolved in one batch
+const int barValueChunkSize = 256;
 
 Bars3DRenderer::Bars3DRenderer(Bars3DController *controller)
     : Abstract3DRenderer(controller),
@@ -24,14 +27,17 @@ Bars3DRenderer::Bars3DRenderer(Bars3DController *controller)
       m_cachedRowCount(0),
       m_cachedColumnCount(0),
       m_cachedBarSeriesMargin(0.0f, 0.0f),
-      m_selectedBar(0),
+      m_selectedLabelBarPos(Bars3DController::invalidSelectionPosition()),
       m_sliceCache(0),
       m_sliceTitleItem(0),
       m_updateLabels(false),
       m_barShader(0),
       m_barGradientShader(0),
+      m_barStaticShader(0),
+      m_barStaticGradientShader(0),
       m_depthShader(0),
       m_selectionShader(0),
+      m_selectionStaticShader(0),
       m_backgroundShader(0),
       m_bgrTexture(0),
       m_selectionTexture(0),
@@ -78,8 +84,11 @@ Bars3DRenderer::~Bars3DRenderer()
     contextCleanup();
     delete m_barShader;
     delete m_barGradientShader;
+    delete m_barStaticShader;
+    delete m_barStaticGradientShader;
     delete m_depthShader;
     delete m_selectionShader;
+    delete m_selectionStaticShader;
     delete m_backgroundShader;
 }
 
@@ -204,13 +213,11 @@ void Bars3DRenderer::updateData()
             const QBar3DSeries *currentSeries = cache->series();
             BarRenderItemArray &renderArray = cache->renderArray();
             bool dimensionsChanged = false;
-            if (newRows != renderArray.size()
-                    || newColumns != renderArray.at(0).size()) {
+            if (newRows != renderArray.rowCount()
+                    || newColumns != renderArray.columnCount()) {
                 // Destroy old render items and reallocate new array
                 dimensionsChanged = true;
-                renderArray.resize(newRows);
-                for (int i = 0; i < newRows; i++)
-                    renderArray[i].resize(newColumns);
+                renderArray.resize(newRows, newColumns);
                 cache->sliceArray().clear();
             }
 
@@ -220,14 +227,15 @@ void Bars3DRenderer::updateData()
                 if (maxDataRowCount < dataRowCount)
                     maxDataRowCount = qMin(dataRowCount, newRows);
                 int dataRowIndex = minRow;
+                renderArray.resetRotations();
                 for (int i = 0; i < newRows; i++) {
-                    BarRenderItemRow &renderRow = renderArray[i];
                     const QBarDataRow *dataRow = 0;
                     if (dataRowIndex < dataRowCount)
                         dataRow = dataProxy->rowAt(dataRowIndex);
-                    updateRenderRow(dataRow, renderRow);
+                    updateRenderRow(dataRow, renderArray, i);
                     dataRowIndex++;
                 }
+                cache->setStaticBufferDirty(true);
                 cache->setDataDirty(false);
             }
         }
@@ -238,31 +246,47 @@ void Bars3DRenderer::updateData()
                       m_selectedSeriesCache ? m_selectedSeriesCache->series() : 0);
 }
 
-void Bars3DRenderer::updateRenderRow(const QBarDataRow *dataRow, BarRenderItemRow &renderRow)
+void Bars3DRenderer::updateRenderRow(const QBarDataRow *dataRow, BarRenderItemArray &renderArray,
+                                     int row)
 {
     int j = 0;
-    int renderRowSize = renderRow.size();
+    int renderRowSize = renderArray.columnCount();
     int startIndex = m_axisCacheX.min();
 
     if (dataRow) {
+        // Heights are resolved a chunk at a time with the batched formatter conversion
         int updateSize = qMin((dataRow->size() - startIndex), renderRowSize);
-        int dataColIndex = startIndex;
-        for (; j < updateSize ; j++) {
-            updateRenderItem(dataRow->at(dataColIndex), renderRow[j]);
-            dataColIndex++;
+        float values[barValueChunkSize];
+        while (j < updateSize) {
+            const QBarDataItem *dataItems = dataRow->constData() + startIndex + j;
+            const int count = qMin(barValueChunkSize, updateSize - j);
+            for (int i = 0; i < count; i++)
+                values[i] = dataItems[i].value();
+            m_axisCacheY.formatterPositionsAt(values, values, count);
+            for (int i = 0; i < count; i++)
+                updateRenderItem(dataItems[i], values[i], renderArray, row, j + i);
+            j += count;
         }
     }
     for (; j < renderRowSize; j++) {
-        renderRow[j].setValue(0.0f);
-        renderRow[j].setHeight(0.0f);
-        renderRow[j].setRotation(identityQuaternion);
+        renderArray.setValue(row, j, 0.0f);
+        renderArray.setHeight(row, j, 0.0f);
+        renderArray.setRotation(row, j, identityQuaternion);
     }
 }
 
-void Bars3DRenderer::updateRenderItem(const QBarDataItem &dataItem, BarRenderItem &renderItem)
+void Bars3DRenderer::updateRenderItem(const QBarDataItem &dataItem,
+                                      BarRenderItemArray &renderArray, int row, int column)
+{
+    updateRenderItem(dataItem, m_axisCacheY.formatter()->positionAt(dataItem.value()),
+                     renderArray, row, column);
+}
+
+// Takes the formatter position of the item value, for callers that resolve them in batches
+void Bars3DRenderer::updateRenderItem(const QBarDataItem &dataItem, float heightValue,
+                                      BarRenderItemArray &renderArray, int row, int column)
 {
     float value = dataItem.value();
-    float heightValue = m_axisCacheY.formatter()->positionAt(value);
     if (m_noZeroInRange) {
         if (m_hasNegativeValues) {
             heightValue = -1.0f + heightValue;
@@ -278,16 +302,16 @@ void Bars3DRenderer::updateRenderItem(const QBarDataItem &dataItem, BarRenderIte
     if (m_axisCacheY.reversed())
         heightValue = -heightValue;
 
-    renderItem.setValue(value);
-    renderItem.setHeight(heightValue);
+    renderArray.setValue(row, column, value);
+    renderArray.setHeight(row, column, heightValue);
 
     float angle = dataItem.rotation();
     if (angle) {
-        renderItem.setRotation(
-                    QQuaternion::fromAxisAndAngle(
-                        upVector, angle));
+        renderArray.setRotation(row, column,
+                                QQuaternion::fromAxisAndAngle(
+                                    upVector, angle));
     } else {
-        renderItem.setRotation(identityQuaternion);
+        renderArray.setRotation(row, column, identityQuaternion);
     }
 }
 
@@ -356,7 +380,12 @@ void Bars3DRenderer::updateRows(const QList<Bars3DController::ChangeRow> &rows)
                 cache->setDataDirty(true);
         }
         if (cache->isVisible()) {
-            updateRenderRow(dataArray->at(row), cache->renderArray()[row - minRow]);
+            updateRenderRow(dataArray->at(row), cache->renderArray(), row - minRow);
+            if (isStaticBatchingActive()) {
+                const int firstSlot = (row - minRow) * m_cachedColumnCount;
+                for (int i = 0; i < m_cachedColumnCount; i++)
+                    cache->updateIndices().append(firstSlot + i);
+            }
             if (m_cachedIsSlicingActivated
                     && cache == m_selectedSeriesCache
                     && m_selectedBarPos.x() == row) {
@@ -392,8 +421,12 @@ void Bars3DRenderer::updateItems(const QList<Bars3DController::ChangeItem> &item
                 cache->setDataDirty(true);
         }
         if (cache->isVisible()) {
-            updateRenderItem(dataArray->at(row)->at(col),
-                             cache->renderArray()[row - minRow][col - minCol]);
+            updateRenderItem(dataArray->at(row)->at(col), cache->renderArray(),
+                             row - minRow, col - minCol);
+            if (isStaticBatchingActive()) {
+                cache->updateIndices().append((row - minRow) * m_cachedColumnCount
+                                              + (col - minCol));
+            }
             if (m_cachedIsSlicingActivated
                     && cache == m_selectedSeriesCache
                     && m_selectedBarPos == QPoint(row, col)) {
@@ -946,6 +979,10 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
 
     const Q3DCamera *activeCamera = m_cachedScene->activeCamera();
 
+    const bool staticBatching = isStaticBatchingActive();
+    if (staticBatching)
+        updateStaticBuffers();
+
     glViewport(m_primarySubViewport.x(),
                m_primarySubViewport.y(),
                m_primarySubViewport.width(),
@@ -1020,9 +1057,24 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
 
     QMatrix4x4 projectionViewMatrix = projectionMatrix * viewMatrix;
 
-    BarRenderItem *selectedBar(0);
+    BarRenderItem selectedBar;
+
+    const bool drawShadows = m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone
+            && !m_isOpenGLES;
+    if (drawShadows) {
+        // Get the depth view matrix
+        // It may be possible to hack lightPos here if we want to make some tweaks to shadow
+        QVector3D depthLightPos = activeCamera->d_ptr->calculatePositionRelativeToCamera(
+                    zeroVector, 0.0f, 3.5f / m_autoScaleAdjustment);
+        depthViewMatrix.lookAt(depthLightPos, zeroVector, upVector);
 
-    if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone && !m_isOpenGLES) {
+        // Set the depth projection matrix
+        depthProjectionMatrix = calculateDepthProjectionMatrix(depthViewMatrix, 10.0f,
+                                                               viewPortRatio);
+        depthProjectionViewMatrix = depthProjectionMatrix * depthViewMatrix;
+    }
+    if (drawShadows && !isDepthPassValid(projectionViewMatrix, depthProjectionViewMatrix)) {
+        FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseDepthPass);
         // Render scene into a depth texture for using with shadow mapping
         // Enable drawing to depth framebuffer
         glBindFramebuffer(GL_FRAMEBUFFER, m_depthFrameBuffer);
@@ -1033,26 +1085,27 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
 
         // Set viewport for depth map rendering. Must match texture size. Larger values give smoother shadows.
         // Depth viewport must always start from 0, 0, as it is rendered into a texture, not screen
-        glViewport(0, 0,
-                   m_primarySubViewport.width() * m_shadowQualityMultiplier,
-                   m_primarySubViewport.height() * m_shadowQualityMultiplier);
-
-        // Get the depth view matrix
-        // It may be possible to hack lightPos here if we want to make some tweaks to shadow
-        QVector3D depthLightPos = activeCamera->d_ptr->calculatePositionRelativeToCamera(
-                    zeroVector, 0.0f, 3.5f / m_autoScaleAdjustment);
-        depthViewMatrix.lookAt(depthLightPos, zeroVector, upVector);
-
-        // Set the depth projection matrix
-        depthProjectionMatrix.perspective(10.0f, viewPortRatio, 3.0f, 100.0f);
-        depthProjectionViewMatrix = depthProjectionMatrix * depthViewMatrix;
+        glViewport(0, 0, m_depthTextureSize.width(), m_depthTextureSize.height());
 
         // Draw bars to depth buffer
         QVector3D shadowScaler(m_scaleX * m_seriesScaleX * 0.9f, 0.0f,
                                m_scaleZ * m_seriesScaleZ * 0.9f);
+        // Static buffers contain the bars on both sides of the floor, so reflections need
+        // the per-bar path
+        const bool batchedShadows = staticBatching
+                && !(m_cachedTheme->isBackgroundEnabled() && m_reflectionEnabled);
         foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
             if (baseCache->isVisible()) {
                 BarSeriesRenderCache *cache = static_cast<BarSeriesRenderCache *>(baseCache);
+                BarObjectBufferHelper *barBuffer = cache->bufferObject();
+                if (batchedShadows && barBuffer && barBuffer->indexCount()) {
+                    // Baked bars have consistent winding regardless of the sign of the height
+                    glCullFace(GL_BACK);
+                    m_depthShader->setUniformValue(m_depthShader->MVP(),
+                                                   depthProjectionViewMatrix);
+                    m_drawer->drawSelectionObject(m_depthShader, barBuffer);
+                    continue;
+                }
                 float seriesPos = m_seriesStart + m_seriesStep
                         * (cache->visualIndex() - (cache->visualIndex()
                                                    * m_cachedBarSeriesMargin.width())) + 0.5f;
@@ -1060,15 +1113,15 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                 QQuaternion seriesRotation(cache->meshRotation());
                 const BarRenderItemArray &renderArray = cache->renderArray();
                 for (int row = startRow; row != stopRow; row += stepRow) {
-                    const BarRenderItemRow &renderRow = renderArray.at(row);
                     for (int bar = startBar; bar != stopBar; bar += stepBar) {
-                        const BarRenderItem &item = renderRow.at(bar);
-                        if (!item.value())
+                        if (!renderArray.value(row, bar))
                             continue;
+                        const GLfloat barHeight = renderArray.height(row, bar);
+                        const QQuaternion &barRotation = renderArray.rotation(row, bar);
                         GLfloat shadowOffset = 0.0f;
                         // Set front face culling for negative valued bars and back face culling
                         // for positive valued bars to remove peter-panning issues
-                        if (item.height() > 0) {
+                        if (barHeight > 0) {
                             glCullFace(GL_BACK);
                             if (m_yFlipped)
                                 shadowOffset = 0.015f;
@@ -1079,8 +1132,8 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                         }
 
                         if (m_cachedTheme->isBackgroundEnabled() && m_reflectionEnabled
-                                && ((m_yFlipped && item.height() > 0.0)
-                                    || (!m_yFlipped && item.height() < 0.0))) {
+                                && ((m_yFlipped && barHeight > 0.0)
+                                    || (!m_yFlipped && barHeight < 0.0))) {
                             continue;
                         }
 
@@ -1093,12 +1146,12 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                         // Draw shadows for bars "on the other side" a bit off ground to avoid
                         // seeing shadows through the ground
                         modelMatrix.translate((colPos - m_rowWidth) / m_scaleFactor,
-                                              item.height() + shadowOffset,
+                                              barHeight + shadowOffset,
                                               (m_columnDepth - rowPos) / m_scaleFactor);
                         // Scale the bars down in X and Z to reduce self-shadowing issues
-                        shadowScaler.setY(item.height());
-                        if (!seriesRotation.isIdentity() || !item.rotation().isIdentity())
-                            modelMatrix.rotate(seriesRotation * item.rotation());
+                        shadowScaler.setY(barHeight);
+                        if (!seriesRotation.isIdentity() || !barRotation.isIdentity())
+                            modelMatrix.rotate(seriesRotation * barRotation);
                         modelMatrix.scale(shadowScaler);
 
                         MVPMatrix = depthProjectionViewMatrix * modelMatrix;
@@ -1115,6 +1168,7 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, barObj->elementBuf());
 
                         // Draw the triangles
+                        FrameStatisticsCollector::countDrawCalls();
                         glDrawElements(GL_TRIANGLES, barObj->indexCount(), GL_UNSIGNED_INT,
                                        (void *)0);
 
@@ -1144,6 +1198,8 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                    m_primarySubViewport.y(),
                    m_primarySubViewport.width(),
                    m_primarySubViewport.height());
+
+        validateDepthPass(projectionViewMatrix, depthProjectionViewMatrix);
     }
 
     // Do position mapping when necessary
@@ -1157,10 +1213,14 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
     }
 
     // Skip selection mode drawing if we're slicing or have no selection mode
-    if (!m_cachedIsSlicingActivated && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
+    const bool selectionQuery = !m_cachedIsSlicingActivated
+            && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
             && m_selectionState == SelectOnScene
             && (m_visibleSeriesCount > 0 || !m_customRenderCache.isEmpty())
-            && m_selectionTexture) {
+            && m_selectionTexture;
+    if (selectionQuery && !isSelectionPassValid(projectionViewMatrix)) {
+        FrameStatisticsCollector::Scope statisticsScope(
+                    FrameStatisticsCollector::PhaseSelectionPass);
         // Bind selection shader
         m_selectionShader->bind();
 
@@ -1177,6 +1237,23 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
         foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
             if (baseCache->isVisible()) {
                 BarSeriesRenderCache *cache = static_cast<BarSeriesRenderCache *>(baseCache);
+                BarObjectBufferHelper *barBuffer = cache->bufferObject();
+                if (staticBatching && barBuffer && barBuffer->indexCount()) {
+                    // Row and column come from the selection UVs of the baked bars
+                    QVector4D seriesColor = QVector4D(0.0f, 0.0f,
+                                                      GLfloat(cache->visualIndex()) / 255.0f,
+                                                      itemAlpha);
+                    glCullFace(GL_BACK);
+                    m_selectionStaticShader->bind();
+                    m_selectionStaticShader->setUniformValue(m_selectionStaticShader->MVP(),
+                                                             projectionViewMatrix);
+                    m_selectionStaticShader->setUniformValue(m_selectionStaticShader->color(),
+                                                             seriesColor);
+                    m_drawer->drawSelectionObject(m_selectionStaticShader, barBuffer,
+                                                  barBuffer->selectionUVBuf());
+                    m_selectionShader->bind();
+                    continue;
+                }
                 float seriesPos = m_seriesStart + m_seriesStep
                         * (cache->visualIndex() - (cache->visualIndex()
                                                    * m_cachedBarSeriesMargin.width())) + 0.5f;
@@ -1184,13 +1261,13 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                 QQuaternion seriesRotation(cache->meshRotation());
                 const BarRenderItemArray &renderArray = cache->renderArray();
                 for (int row = startRow; row != stopRow; row += stepRow) {
-                    const BarRenderItemRow &renderRow = renderArray.at(row);
                     for (int bar = startBar; bar != stopBar; bar += stepBar) {
-                        const BarRenderItem &item = renderRow.at(bar);
-                        if (!item.value())
+                        if (!renderArray.value(row, bar))
                             continue;
+                        const GLfloat barHeight = renderArray.height(row, bar);
+                        const QQuaternion &barRotation = renderArray.rotation(row, bar);
 
-                        if (item.height() < 0)
+                        if (barHeight < 0)
                             glCullFace(GL_FRONT);
                         else
                             glCullFace(GL_BACK);
@@ -1202,12 +1279,12 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                         rowPos = (row + 0.5f) * (m_cachedBarSpacing.height());
 
                         modelMatrix.translate((colPos - m_rowWidth) / m_scaleFactor,
-                                              item.height(),
+                                              barHeight,
                                               (m_columnDepth - rowPos) / m_scaleFactor);
-                        if (!seriesRotation.isIdentity() || !item.rotation().isIdentity())
-                            modelMatrix.rotate(seriesRotation * item.rotation());
+                        if (!seriesRotation.isIdentity() || !barRotation.isIdentity())
+                            modelMatrix.rotate(seriesRotation * barRotation);
                         modelMatrix.scale(QVector3D(m_scaleX * m_seriesScaleX,
-                                                    item.height(),
+                                                    barHeight,
                                                     m_scaleZ * m_seriesScaleZ));
 
                         MVPMatrix = projectionViewMatrix * modelMatrix;
@@ -1234,14 +1311,7 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
         drawBackground(backgroundRotation, depthProjectionViewMatrix, projectionViewMatrix,
                        viewMatrix, false, true);
         glEnable(GL_DITHER);
-
-        // Read color under cursor
-        QVector4D clickedColor = Utils::getSelection(m_inputPosition, m_viewport.height());
-        m_clickedPosition = selectionColorToArrayPosition(clickedColor);
-        m_clickedSeries = selectionColorToSeries(clickedColor);
-        m_clickResolved = true;
-
-        emit needRender();
+        validateSelectionPass(projectionViewMatrix);
 
         // Revert to original render target and viewport
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
@@ -1251,6 +1321,18 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                    m_primarySubViewport.height());
     }
 
+    if (selectionQuery) {
+        // Read color under cursor
+        QVector4D clickedColor;
+        if (readSelection(m_selectionFrameBuffer, defaultFboHandle, clickedColor)) {
+            m_clickedPosition = selectionColorToArrayPosition(clickedColor);
+            m_clickedSeries = selectionColorToSeries(clickedColor);
+            m_clickResolved = true;
+        }
+
+        emit needRender();
+    }
+
     if (m_reflectionEnabled) {
         //
         // Draw reflections
@@ -1333,8 +1415,8 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
         glDisable(GL_DEPTH_TEST);
         // Draw the selection label
         LabelItem &labelItem = selectionLabelItem();
-        if (m_selectedBar != selectedBar || m_updateLabels || !labelItem.textureId()
-                || m_selectionLabelDirty) {
+        if (m_selectedLabelBarPos != selectedBar.position() || m_updateLabels
+                || !labelItem.textureId() || m_selectionLabelDirty) {
             QString labelText = selectionLabel();
             if (labelText.isNull() || m_selectionLabelDirty) {
                 labelText = m_selectedSeriesCache->itemLabel();
@@ -1342,14 +1424,14 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                 m_selectionLabelDirty = false;
             }
             m_drawer->generateLabelItem(labelItem, labelText);
-            m_selectedBar = selectedBar;
+            m_selectedLabelBarPos = selectedBar.position();
         }
 
         Drawer::LabelPosition position =
-                m_selectedBar->height() >= 0 ? Drawer::LabelOver : Drawer::LabelBelow;
+                selectedBar.height() >= 0 ? Drawer::LabelOver : Drawer::LabelBelow;
 
-        m_drawer->drawLabel(*selectedBar, labelItem, viewMatrix, projectionMatrix,
-                            zeroVector, identityQuaternion, selectedBar->height(),
+        m_drawer->drawLabel(selectedBar, labelItem, viewMatrix, projectionMatrix,
+                            zeroVector, identityQuaternion, selectedBar.height(),
                             m_cachedSelectionMode, m_labelShader,
                             m_labelObj, activeCamera, true, false, position);
 
@@ -1358,7 +1440,7 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
 
         glEnable(GL_DEPTH_TEST);
     } else {
-        m_selectedBar = 0;
+        m_selectedLabelBarPos = Bars3DController::invalidSelectionPosition();
     }
 
     glDisable(GL_BLEND);
@@ -1368,7 +1450,7 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
     m_selectionDirty = false;
 }
 
-bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
+bool Bars3DRenderer::drawBars(BarRenderItem *selectedBar,
                               const QMatrix4x4 &depthProjectionViewMatrix,
                               const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &viewMatrix,
                               GLint startRow, GLint stopRow, GLint stepRow,
@@ -1445,7 +1527,7 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
             ObjectHelper *barObj = cache->object();
             QQuaternion seriesRotation(cache->meshRotation());
             Q3DTheme::ColorStyle colorStyle = cache->colorStyle();
-            BarRenderItemArray &renderArray = cache->renderArray();
+            const BarRenderItemArray &renderArray = cache->renderArray();
             bool colorStyleIsUniform = (colorStyle == Q3DTheme::ColorStyleUniform);
             if (sliceReserveAmount)
                 cache->sliceArray().resize(sliceReserveAmount);
@@ -1475,11 +1557,66 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
             }
 
             previousColorStyle = colorStyle;
+
+            // Static optimization draws the whole series from its baked buffers, so only
+            // highlighted bars need the per-bar path. Row colors and reflections are not baked.
+            BarObjectBufferHelper *barBuffer = cache->bufferObject();
+            ShaderHelper *staticShader = colorStyleIsUniform ? m_barStaticShader
+                                                             : m_barStaticGradientShader;
+            const bool batched = reflection == 1.0f && staticShader
+                    && barBuffer && barBuffer->indexCount()
+                    && (m_cachedSelectionMode == QAbstract3DGraph::SelectionNone
+                        || cache->series()->rowColors().isEmpty());
+            if (batched) {
+                GLuint staticGradientTexture = 0;
+                staticShader->bind();
+                staticShader->setUniformValue(staticShader->lightP(), lightPos);
+                staticShader->setUniformValue(staticShader->view(), viewMatrix);
+                staticShader->setUniformValue(staticShader->model(), QMatrix4x4());
+                staticShader->setUniformValue(staticShader->nModel(), QMatrix4x4());
+                staticShader->setUniformValue(staticShader->ambientS(),
+                                              m_cachedTheme->ambientLightStrength());
+                staticShader->setUniformValue(staticShader->lightColor(), lightColor);
+#ifdef SHOW_DEPTH_TEXTURE_SCENE
+                staticShader->setUniformValue(staticShader->MVP(), depthProjectionViewMatrix);
+#else
+                staticShader->setUniformValue(staticShader->MVP(), projectionViewMatrix);
+#endif
+                if (colorStyleIsUniform)
+                    staticShader->setUniformValue(staticShader->color(), cache->baseColor());
+                else
+                    staticGradientTexture = cache->baseGradientTexture();
+
+                glCullFace(GL_BACK);
+                if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone
+                        && !m_isOpenGLES) {
+                    staticShader->setUniformValue(staticShader->shadowQ(),
+                                                  m_shadowQualityToShader);
+                    staticShader->setUniformValue(staticShader->depth(),
+                                                  depthProjectionViewMatrix);
+                    staticShader->setUniformValue(staticShader->lightS(), adjustedLightStrength);
+                    m_drawer->drawObject(staticShader, barBuffer, staticGradientTexture,
+                                         m_depthTexture);
+                } else {
+                    staticShader->setUniformValue(staticShader->lightS(),
+                                                  m_cachedTheme->lightStrength());
+                    m_drawer->drawObject(staticShader, barBuffer, staticGradientTexture);
+                }
+                barShader->bind();
+
+                // Pull highlighted bars in front of their baked counterparts
+                glPolygonOffset(-0.5f, -1.0f);
+            }
+
             for (int row = startRow; row != stopRow; row += stepRow) {
-                BarRenderItemRow &renderRow = renderArray[row];
                 for (int bar = startBar; bar != stopBar; bar += stepBar) {
-                    BarRenderItem &item = renderRow[bar];
-                    float adjustedHeight = reflection * item.height();
+                    if (batched && (!somethingSelected || isSelected(row, bar, cache)
+                                    == Bars3DController::SelectionNone)) {
+                        continue;
+                    }
+                    const GLfloat barHeight = renderArray.height(row, bar);
+                    const QQuaternion &barRotation = renderArray.rotation(row, bar);
+                    float adjustedHeight = reflection * barHeight;
                     if (adjustedHeight < 0)
                         glCullFace(GL_FRONT);
                     else
@@ -1496,8 +1633,8 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
                                           adjustedHeight,
                                           (m_columnDepth - rowPos) / m_scaleFactor);
                     modelScaler.setY(adjustedHeight);
-                    if (!seriesRotation.isIdentity() || !item.rotation().isIdentity()) {
-                        QQuaternion totalRotation = seriesRotation * item.rotation();
+                    if (!seriesRotation.isIdentity() || !barRotation.isIdentity()) {
+                        QQuaternion totalRotation = seriesRotation * barRotation;
                         modelMatrix.rotate(totalRotation);
                         itModelMatrix.rotate(totalRotation);
                     }
@@ -1526,13 +1663,11 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
 
                             lightStrength = m_cachedTheme->highlightLightStrength();
                             shadowLightStrength = adjustedHighlightStrength;
-                            // Insert position data into render item
-                            // We have no ownership, don't delete the previous one
+                            // Copy the bar with its position data for label drawing
                             if (!m_cachedIsSlicingActivated
                                     && m_selectedSeriesCache == cache) {
-                                *selectedBar = &item;
-                                (*selectedBar)->setPosition(QPoint(row, bar));
-                                item.setTranslation(modelMatrix.column(3).toVector3D());
+                                *selectedBar = renderArray.item(row, bar);
+                                selectedBar->setTranslation(modelMatrix.column(3).toVector3D());
                                 barSelectionFound = true;
                             }
                             if (m_selectionDirty && m_cachedIsSlicingActivated) {
@@ -1544,8 +1679,8 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
                                                          * (m_cachedBarSpacing.height())))
                                                      / m_scaleFactor);
                                 }
+                                BarRenderItem item = renderArray.item(row, bar);
                                 item.setTranslation(translation);
-                                item.setPosition(QPoint(row, bar));
                                 if (rowMode)
                                     cache->sliceArray()[bar].setItem(item);
                                 else
@@ -1562,14 +1697,12 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
 
                             lightStrength = m_cachedTheme->highlightLightStrength();
                             shadowLightStrength = adjustedHighlightStrength;
-                            if (m_cachedIsSlicingActivated) {
+                            if (m_cachedIsSlicingActivated && m_selectionDirty) {
+                                BarRenderItem item = renderArray.item(row, bar);
                                 item.setTranslation(modelMatrix.column(3).toVector3D());
-                                item.setPosition(QPoint(row, bar));
-                                if (m_selectionDirty) {
-                                    if (!m_sliceTitleItem && m_axisCacheZ.labelItems().size() > row)
-                                        m_sliceTitleItem = m_axisCacheZ.labelItems().at(row);
-                                    cache->sliceArray()[bar].setItem(item);
-                                }
+                                if (!m_sliceTitleItem && m_axisCacheZ.labelItems().size() > row)
+                                    m_sliceTitleItem = m_axisCacheZ.labelItems().at(row);
+                                cache->sliceArray()[bar].setItem(item);
                             }
                             break;
                         }
@@ -1582,7 +1715,7 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
 
                             lightStrength = m_cachedTheme->highlightLightStrength();
                             shadowLightStrength = adjustedHighlightStrength;
-                            if (m_cachedIsSlicingActivated) {
+                            if (m_cachedIsSlicingActivated && m_selectionDirty) {
                                 QVector3D translation = modelMatrix.column(3).toVector3D();
                                 if (m_visibleSeriesCount > 1) {
                                     translation.setZ((m_columnDepth
@@ -1590,13 +1723,11 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
                                                          * (m_cachedBarSpacing.height())))
                                                      / m_scaleFactor);
                                 }
+                                BarRenderItem item = renderArray.item(row, bar);
                                 item.setTranslation(translation);
-                                item.setPosition(QPoint(row, bar));
-                                if (m_selectionDirty) {
-                                    if (!m_sliceTitleItem && m_axisCacheX.labelItems().size() > bar)
-                                        m_sliceTitleItem = m_axisCacheX.labelItems().at(bar);
-                                    cache->sliceArray()[row].setItem(item);
-                                }
+                                if (!m_sliceTitleItem && m_axisCacheX.labelItems().size() > bar)
+                                    m_sliceTitleItem = m_axisCacheX.labelItems().at(bar);
+                                cache->sliceArray()[row].setItem(item);
                             }
                             break;
                         }
@@ -1618,13 +1749,13 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
                         }
                     }
 
-                    if (item.height() == 0) {
+                    if (barHeight == 0) {
                         continue;
                     } else if ((m_reflectionEnabled
                                 && (reflection == 1.0f
                                     || (reflection != 1.0f
-                                        && ((m_yFlipped && item.height() < 0.0)
-                                            || (!m_yFlipped && item.height() > 0.0)))))
+                                        && ((m_yFlipped && barHeight < 0.0)
+                                            || (!m_yFlipped && barHeight > 0.0)))))
                                || !m_reflectionEnabled) {
                         // Skip drawing of 0-height bars and reflections of bars on the "wrong side"
                         // Set shader bindings
@@ -1636,7 +1767,7 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
                             barShader->setUniformValue(barShader->color(), barColor);
                         } else if (colorStyle == Q3DTheme::ColorStyleRangeGradient) {
                             barShader->setUniformValue(barShader->gradientHeight(),
-                                                       qAbs(item.height()) / m_gradientFraction);
+                                                       qAbs(barHeight) / m_gradientFraction);
                         }
 
                         if (((m_reflectionEnabled && reflection == 1.0f
@@ -1670,6 +1801,8 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
                     }
                 }
             }
+            if (batched)
+                glPolygonOffset(0.5f, 1.0f);
         }
     }
     glDisable(GL_POLYGON_OFFSET_FILL);
@@ -2023,6 +2156,7 @@ void Bars3DRenderer::drawGridLines(const QMatrix4x4 &depthProjectionViewMatrix,
 
 void Bars3DRenderer::drawLabels(bool drawSelection, const Q3DCamera *activeCamera,
                                 const QMatrix4x4 &viewMatrix, const QMatrix4x4 &projectionMatrix) {
+    FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseLabels);
     ShaderHelper *shader = 0;
     GLfloat alphaForValueSelection = labelValueAlpha / 255.0f;
     GLfloat alphaForRowSelection = labelRowAlpha / 255.0f;
@@ -2493,8 +2627,8 @@ void Bars3DRenderer::updateSelectedBar(const QPoint &position, QBar3DSeries *ser
 
     int adjustedZ = m_selectedBarPos.x() - int(m_axisCacheZ.min());
     int adjustedX = m_selectedBarPos.y() - int(m_axisCacheX.min());
-    int maxZ = m_selectedSeriesCache->renderArray().size() - 1;
-    int maxX = maxZ >= 0 ? m_selectedSeriesCache->renderArray().at(0).size() - 1 : -1;
+    int maxZ = m_selectedSeriesCache->renderArray().rowCount() - 1;
+    int maxX = m_selectedSeriesCache->renderArray().columnCount() - 1;
 
     if (m_selectedBarPos == Bars3DController::invalidSelectionPosition()
             || adjustedZ < 0 || adjustedZ > maxZ
@@ -2665,6 +2799,60 @@ void Bars3DRenderer::calculateSeriesStartPosition()
             * (m_seriesStep - (m_seriesStep * m_cachedBarSeriesMargin.width()));
 }
 
+bool Bars3DRenderer::isStaticBatchingActive() const
+{
+    return m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic);
+}
+
+BarBufferLayout Bars3DRenderer::bufferLayout(BarSeriesRenderCache *cache) const
+{
+    const BarRenderItemArray &renderArray = cache->renderArray();
+    BarBufferLayout layout;
+    layout.rowCount = renderArray.rowCount();
+    layout.columnCount = renderArray.columnCount();
+    layout.seriesPos = m_seriesStart + m_seriesStep
+            * (cache->visualIndex() - (cache->visualIndex()
+                                       * m_cachedBarSeriesMargin.width())) + 0.5f;
+    layout.barSpacing = m_cachedBarSpacing;
+    layout.rowWidth = m_rowWidth;
+    layout.columnDepth = m_columnDepth;
+    layout.scaleFactor = m_scaleFactor;
+    layout.scaleX = m_scaleX * m_seriesScaleX;
+    layout.scaleZ = m_scaleZ * m_seriesScaleZ;
+    layout.gradientFraction = m_gradientFraction;
+    layout.seriesRotation = cache->meshRotation();
+    layout.colorStyle = cache->colorStyle();
+    if (cache->object())
+        layout.meshFileName = cache->object()->objectFile();
+    return layout;
+}
+
+void Bars3DRenderer::updateStaticBuffers()
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        BarSeriesRenderCache *cache = static_cast<BarSeriesRenderCache *>(baseCache);
+        if (!cache->isVisible())
+            continue;
+
+        BarObjectBufferHelper *object = cache->bufferObject();
+        if (!object) {
+            object = new BarObjectBufferHelper();
+            cache->setBufferObject(object);
+        }
+
+        // Anything that moves or restyles all bars needs a full reload, while data changes
+        // through item and row updates only patch the slots of the changed bars
+        const BarBufferLayout layout = bufferLayout(cache);
+        if (cache->staticBufferDirty() || object->layout() != layout) {
+            object->fullLoad(cache, layout);
+            cache->updateIndices().clear();
+            cache->setStaticBufferDirty(false);
+        } else if (cache->updateIndices().size()) {
+            object->update(cache);
+        }
+    }
+}
+
 Bars3DController::SelectionType Bars3DRenderer::isSelected(int row, int bar,
                                                            const BarSeriesRenderCache *cache)
 {
@@ -2774,6 +2962,19 @@ void Bars3DRenderer::initShaders(const QString &vertexShader, const QString &fra
         delete m_barShader;
     m_barShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_barShader->initialize();
+
+    // Baked bars are already in world coordinates
+    delete m_barStaticShader;
+    m_barStaticShader = 0;
+    if (isStaticBatchingActive()) {
+        QString staticVertexShader;
+        if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone && !m_isOpenGLES)
+            staticVertexShader = QStringLiteral(":/shaders/vertexShadowNoMatrices");
+        else
+            staticVertexShader = QStringLiteral(":/shaders/vertexNoMatrices");
+        m_barStaticShader = new ShaderHelper(this, staticVertexShader, fragmentShader);
+        m_barStaticShader->initialize();
+    }
 }
 
 void Bars3DRenderer::initGradientShaders(const QString &vertexShader, const QString &fragmentShader)
@@ -2782,6 +2983,26 @@ void Bars3DRenderer::initGradientShaders(const QString &vertexShader, const QStr
         delete m_barGradientShader;
     m_barGradientShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_barGradientShader->initialize();
+
+    // Baked bars carry their gradient positions in UVs
+    delete m_barStaticGradientShader;
+    m_barStaticGradientShader = 0;
+    if (isStaticBatchingActive()) {
+        if (m_isOpenGLES) {
+            m_barStaticGradientShader =
+                    new ShaderHelper(this, QStringLiteral(":/shaders/vertexTexture"),
+                                     QStringLiteral(":/shaders/fragmentTextureES2"));
+        } else if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
+            m_barStaticGradientShader =
+                    new ShaderHelper(this, QStringLiteral(":/shaders/vertexShadow"),
+                                     QStringLiteral(":/shaders/fragmentShadow"));
+        } else {
+            m_barStaticGradientShader =
+                    new ShaderHelper(this, QStringLiteral(":/shaders/vertexTexture"),
+                                     QStringLiteral(":/shaders/fragmentTexture"));
+        }
+        m_barStaticGradientShader->initialize();
+    }
 }
 
 void Bars3DRenderer::initSelectionShader()
@@ -2791,6 +3012,12 @@ void Bars3DRenderer::initSelectionShader()
     m_selectionShader = new ShaderHelper(this, QStringLiteral(":/shaders/vertexPlainColor"),
                                          QStringLiteral(":/shaders/fragmentPlainColor"));
     m_selectionShader->initialize();
+
+    delete m_selectionStaticShader;
+    m_selectionStaticShader =
+            new ShaderHelper(this, QStringLiteral(":/shaders/vertexSelectionBatched"),
+                             QStringLiteral(":/shaders/fragmentSelectionBatched"));
+    m_selectionStaticShader->initialize();
 }
 
 void Bars3DRenderer::initSelectionBuffer()
@@ -2803,6 +3030,7 @@ void Bars3DRenderer::initSelectionBuffer()
     m_selectionTexture = m_textureHelper->createSelectionTexture(m_primarySubViewport.size(),
                                                                  m_selectionFrameBuffer,
                                                                  m_selectionDepthBuffer);
+    invalidateSelectionPass();
 }
 
 void Bars3DRenderer::initDepthShader()
@@ -2825,12 +3053,13 @@ void Bars3DRenderer::updateDepthBuffer()
             return;
 
         if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
+            m_depthTextureSize = calculateShadowMapSize(m_shadowQualityMultiplier);
             m_depthTexture =
-                    m_textureHelper->createDepthTextureFrameBuffer(m_primarySubViewport.size(),
-                                                                   m_depthFrameBuffer,
-                                                                   m_shadowQualityMultiplier);
+                    m_textureHelper->createDepthTextureFrameBuffer(m_depthTextureSize,
+                                                                   m_depthFrameBuffer, 1);
             if (!m_depthTexture)
                 lowerShadowQuality();
+            invalidateDepthPass();
         }
     }
 }
@@ -2883,4 +3112,12 @@ void Bars3DRenderer::updateMargin(float margin)
     calculateSceneScalingFactors();
 }
 
+void Bars3DRenderer::updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint)
+{
+    Abstract3DRenderer::updateOptimizationHint(hint);
+
+    // Static bar shaders are only created when needed
+    Abstract3DRenderer::reInitShaders();
+}
+
 QT_END_NAMESPACE
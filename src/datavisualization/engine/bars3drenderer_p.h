@@ -30,6 +30,7 @@ class ShaderHelper;
 class LabelItem;
 class Q3DScene;
 class BarSeriesRenderCache;
+struct BarBufferLayout;
 
 class Q_DATAVISUALIZATION_EXPORT Bars3DRenderer : public Abstract3DRenderer
 {
@@ -45,14 +46,17 @@ private:
     QSizeF m_cachedBarSeriesMargin;
 
     // Internal state
-    BarRenderItem *m_selectedBar; // points to renderitem array
+    QPoint m_selectedLabelBarPos; // bar the selection label was generated for
     AxisRenderCache *m_sliceCache; // not owned
     const LabelItem *m_sliceTitleItem; // not owned
     bool m_updateLabels;
     ShaderHelper *m_barShader;
     ShaderHelper *m_barGradientShader;
+    ShaderHelper *m_barStaticShader;
+    ShaderHelper *m_barStaticGradientShader;
     ShaderHelper *m_depthShader;
     ShaderHelper *m_selectionShader;
+    ShaderHelper *m_selectionStaticShader;
     ShaderHelper *m_backgroundShader;
     GLuint m_bgrTexture;
     GLuint m_selectionTexture;
@@ -107,6 +111,7 @@ public:
     void updateAspectRatio(float ratio) override;
     void updateFloorLevel(float level);
     void updateMargin(float margin) override;
+    void updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint) override;
 
 protected:
     void contextCleanup() override;
@@ -143,7 +148,7 @@ private:
     void drawLabels(bool drawSelection, const Q3DCamera *activeCamera,
                     const QMatrix4x4 &viewMatrix, const QMatrix4x4 &projectionMatrix);
 
-    bool drawBars(BarRenderItem **selectedBar, const QMatrix4x4 &depthProjectionViewMatrix,
+    bool drawBars(BarRenderItem *selectedBar, const QMatrix4x4 &depthProjectionViewMatrix,
                   const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &viewMatrix,
                   GLint startRow, GLint stopRow, GLint stepRow,
                   GLint startBar, GLint stopBar, GLint stepBar, GLfloat reflection = 1.0f);
@@ -163,13 +168,20 @@ private:
     void calculateSceneScalingFactors();
     void calculateHeightAdjustment();
     void calculateSeriesStartPosition();
+    inline bool isStaticBatchingActive() const;
+    BarBufferLayout bufferLayout(BarSeriesRenderCache *cache) const;
+    void updateStaticBuffers();
     Abstract3DController::SelectionType isSelected(int row, int bar,
                                                    const BarSeriesRenderCache *cache);
     QPoint selectionColorToArrayPosition(const QVector4D &selectionColor);
     QBar3DSeries *selectionColorToSeries(const QVector4D &selectionColor);
 
-    inline void updateRenderRow(const QBarDataRow *dataRow, BarRenderItemRow &renderRow);
-    inline void updateRenderItem(const QBarDataItem &dataItem, BarRenderItem &renderItem);
+    inline void updateRenderRow(const QBarDataRow *dataRow, BarRenderItemArray &renderArray,
+                                int row);
+    inline void updateRenderItem(const QBarDataItem &dataItem, BarRenderItemArray &renderArray,
+                                 int row, int column);
+    inline void updateRenderItem(const QBarDataItem &dataItem, float heightValue,
+                                 BarRenderItemArray &renderArray, int row, int column);
 
     Q_DISABLE_COPY(Bars3DRenderer)
 };
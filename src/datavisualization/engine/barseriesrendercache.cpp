@@ -2,24 +2,29 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "barseriesrendercache_p.h"
+#include "barobjectbufferhelper_p.h"
 
 QT_BEGIN_NAMESPACE
 
 BarSeriesRenderCache::BarSeriesRenderCache(QAbstract3DSeries *series,
                                            Abstract3DRenderer *renderer)
     : SeriesRenderCache(series, renderer),
-      m_visualIndex(-1)
+      m_visualIndex(-1),
+      m_barBufferObj(0),
+      m_staticBufferDirty(true)
 {
 }
 
 BarSeriesRenderCache::~BarSeriesRenderCache()
 {
+    delete m_barBufferObj;
 }
 
 void BarSeriesRenderCache::cleanup(TextureHelper *texHelper)
 {
     m_renderArray.clear();
     m_sliceArray.clear();
+    m_updateIndices.clear();
 
     SeriesRenderCache::cleanup(texHelper);
 }
@@ -21,6 +21,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class BarObjectBufferHelper;
+
 class BarSeriesRenderCache : public SeriesRenderCache
 {
 public:
@@ -34,11 +36,19 @@ public:
     inline QList<BarRenderSliceItem> &sliceArray() { return m_sliceArray; }
     inline void setVisualIndex(int index) { m_visualIndex = index; }
     inline int visualIndex() {return m_visualIndex; }
+    inline void setBufferObject(BarObjectBufferHelper *object) { m_barBufferObj = object; }
+    inline BarObjectBufferHelper *bufferObject() const { return m_barBufferObj; }
+    inline void setStaticBufferDirty(bool state) { m_staticBufferDirty = state; }
+    inline bool staticBufferDirty() const { return m_staticBufferDirty; }
+    inline QList<int> &updateIndices() { return m_updateIndices; }
 
 protected:
     BarRenderItemArray m_renderArray;
     QList<BarRenderSliceItem> m_sliceArray;
     int m_visualIndex; // order of the series is relevant
+    BarObjectBufferHelper *m_barBufferObj;
+    bool m_staticBufferDirty;
+    QList<int> m_updateIndices; // Bar slots changed since the last static buffer update
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,133 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef CHANGEDITEMTRACKER_P_H
+#define CHANGEDITEMTRACKER_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QBitArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPoint>
+#include <QtCore/QSet>
+
+QT_BEGIN_NAMESPACE
+
+// Coalesces item and row change notifications of each series between renderer
+// synchronizations. Each index or point is reported only once, and when more than half of
+// the data of a series has changed, the changes collapse into a single full update.
+// The index bitmap of a series is kept across synchronizations, and only the bits marked
+// since the previous synchronization are cleared, so that a synchronization costs time
+// proportional to the number of changes rather than to the size of the data.
+template <typename Series>
+class ChangedItemTracker
+{
+public:
+    enum MarkResult {
+        MarkIgnored = 0, // Already marked, or the series is already fully updated
+        MarkAdded,       // Newly marked, should be added to the change list
+        MarkFullUpdate   // Series changes just collapsed into a full update
+    };
+
+    MarkResult mark(Series *series, int index, int dataSize)
+    {
+        Changes &changes = m_changes[series];
+        if (changes.fullUpdate)
+            return MarkIgnored;
+        // Only grows when data has been added without an array reset
+        if (changes.indexes.size() <= index)
+            changes.indexes.resize(qMax(index + 1, dataSize));
+        if (changes.indexes.testBit(index))
+            return MarkIgnored;
+        changes.indexes.setBit(index);
+        changes.markedIndexes.append(index);
+        return added(changes, dataSize);
+    }
+
+    MarkResult mark(Series *series, const QPoint &point, int dataSize)
+    {
+        Changes &changes = m_changes[series];
+        if (changes.fullUpdate)
+            return MarkIgnored;
+        if (changes.points.contains(point))
+            return MarkIgnored;
+        changes.points.insert(point);
+        return added(changes, dataSize);
+    }
+
+    // Sizes the index bitmap of the series for a reset array
+    void resize(Series *series, int dataSize)
+    {
+        Changes &changes = m_changes[series];
+        changes.indexes = QBitArray(dataSize);
+        changes.markedIndexes.clear();
+    }
+
+    inline void remove(Series *series)
+    {
+        const Changes changes = m_changes.take(series);
+        if (changes.fullUpdate)
+            m_fullUpdateCount--;
+    }
+
+    inline bool hasFullUpdates() const { return m_fullUpdateCount > 0; }
+    inline bool isFullUpdate(Series *series) const
+    {
+        return m_fullUpdateCount && m_changes.value(series).fullUpdate;
+    }
+
+    void clear()
+    {
+        for (Changes &changes : m_changes) {
+            for (int index : std::as_const(changes.markedIndexes)) {
+                if (index < changes.indexes.size())
+                    changes.indexes.clearBit(index);
+            }
+            changes.markedIndexes.clear();
+            changes.points.clear();
+            changes.count = 0;
+            changes.fullUpdate = false;
+        }
+        m_fullUpdateCount = 0;
+    }
+
+private:
+    struct Changes
+    {
+        QBitArray indexes;
+        QList<int> markedIndexes;
+        QSet<QPoint> points;
+        int count = 0;
+        bool fullUpdate = false;
+    };
+
+    MarkResult added(Changes &changes, int dataSize)
+    {
+        changes.count++;
+        if (dataSize > 1 && changes.count > dataSize / 2) {
+            // The marked bits are cleared on the next clear() like for partial updates
+            changes.fullUpdate = true;
+            changes.points.clear();
+            m_fullUpdateCount++;
+            return MarkFullUpdate;
+        }
+        return MarkAdded;
+    }
+
+    QHash<Series *, Changes> m_changes;
+    int m_fullUpdateCount = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
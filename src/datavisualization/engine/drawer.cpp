@@ -6,10 +6,14 @@
 #include "surfaceobject_p.h"
 #include "utils_p.h"
 #include "texturehelper_p.h"
+#include "glyphatlas_p.h"
 #include "abstract3drenderer_p.h"
 #include "scatterpointbufferhelper_p.h"
+#include "scatterinstancebufferhelper_p.h"
+#include "framestatisticscollector_p.h"
 
 #include <QtGui/QMatrix4x4>
+#include <QtGui/QOpenGLExtraFunctions>
 #include <QtCore/qmath.h>
 
 // Resources need to be explicitly initialized when building as static library
@@ -38,6 +42,7 @@ const GLfloat line_data[] = {
 Drawer::Drawer(Q3DTheme *theme)
     : m_theme(theme),
       m_textureHelper(0),
+      m_glyphAtlas(0),
       m_pointbuffer(0),
       m_linebuffer(0),
       m_scaledFontSize(0.0f)
@@ -47,6 +52,7 @@ Drawer::Drawer(Q3DTheme *theme)
 Drawer::~Drawer()
 {
     delete m_textureHelper;
+    delete m_glyphAtlas;
     if (QOpenGLContext::currentContext()) {
         glDeleteBuffers(1, &m_pointbuffer);
         glDeleteBuffers(1, &m_linebuffer);
@@ -58,6 +64,8 @@ void Drawer::initializeOpenGL()
     initializeOpenGLFunctions();
     if (!m_textureHelper)
         m_textureHelper = new TextureHelper();
+    if (!m_glyphAtlas)
+        m_glyphAtlas = new GlyphAtlas();
 }
 
 void Drawer::setTheme(Q3DTheme *theme)
@@ -128,6 +136,7 @@ void Drawer::drawObject(ShaderHelper *shader, AbstractObjectHelper *object, GLui
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
 
     // Draw the triangles
+    FrameStatisticsCollector::countDrawCalls();
     glDrawElements(GL_TRIANGLES, object->indexCount(), GL_UNSIGNED_INT, (void*)0);
 
     // Free buffers
@@ -157,16 +166,126 @@ void Drawer::drawObject(ShaderHelper *shader, AbstractObjectHelper *object, GLui
     }
 }
 
-void Drawer::drawSelectionObject(ShaderHelper *shader, AbstractObjectHelper *object)
+void Drawer::drawSelectionObject(ShaderHelper *shader, AbstractObjectHelper *object,
+                                 GLuint uvBuffer)
 {
     glEnableVertexAttribArray(shader->posAtt());
     glBindBuffer(GL_ARRAY_BUFFER, object->vertexBuf());
     glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    // Optional per-vertex selection colors
+    const bool useUVs = uvBuffer && shader->uvAtt() >= 0;
+    if (useUVs) {
+        glEnableVertexAttribArray(shader->uvAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, uvBuffer);
+        glVertexAttribPointer(shader->uvAtt(), 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    }
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
+    FrameStatisticsCollector::countDrawCalls();
     glDrawElements(GL_TRIANGLES, object->indexCount(), GL_UNSIGNED_INT, (void *)0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (useUVs)
+        glDisableVertexAttribArray(shader->uvAtt());
+    glDisableVertexAttribArray(shader->posAtt());
+}
+
+void Drawer::drawObjectInstanced(ShaderHelper *shader, AbstractObjectHelper *object,
+                                 ScatterInstanceBufferHelper *instances, GLuint textureId,
+                                 GLuint depthTextureId)
+{
+    QOpenGLExtraFunctions *extraFuncs = QOpenGLContext::currentContext()->extraFunctions();
+
+    if (textureId) {
+        // Activate texture
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        shader->setUniformValue(shader->texture(), 0);
+    }
+
+    if (depthTextureId) {
+        // Activate depth texture
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, depthTextureId);
+        shader->setUniformValue(shader->shadow(), 1);
+    }
+
+    // Per-vertex attributes, shared by all instances
+    glEnableVertexAttribArray(shader->posAtt());
+    glBindBuffer(GL_ARRAY_BUFFER, object->vertexBuf());
+    glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+
+    if (shader->normalAtt() >= 0) {
+        glEnableVertexAttribArray(shader->normalAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, object->normalBuf());
+        glVertexAttribPointer(shader->normalAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    }
+
+    if (shader->uvAtt() >= 0) {
+        glEnableVertexAttribArray(shader->uvAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, object->uvBuf());
+        glVertexAttribPointer(shader->uvAtt(), 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    }
+
+    // Per-instance attributes
+    const GLsizei stride = sizeof(ScatterInstanceData);
+    const GLint instanceAttributes[] = {
+        shader->instancePositionAtt(),
+        shader->instanceRotationAtt(),
+        shader->instanceUVAtt(),
+        shader->instanceIndexAtt()
+    };
+    const GLint instanceAttributeSizes[] = {4, 4, 2, 1};
+    const int instanceAttributeOffsets[] = {
+        ScatterInstanceBufferHelper::positionOffset,
+        ScatterInstanceBufferHelper::rotationOffset,
+        ScatterInstanceBufferHelper::uvOffset,
+        ScatterInstanceBufferHelper::indexOffset
+    };
+    glBindBuffer(GL_ARRAY_BUFFER, instances->instanceBuf());
+    for (int i = 0; i < 4; i++) {
+        if (instanceAttributes[i] >= 0) {
+            glEnableVertexAttribArray(instanceAttributes[i]);
+            glVertexAttribPointer(instanceAttributes[i], instanceAttributeSizes[i], GL_FLOAT,
+                                  GL_FALSE, stride,
+                                  reinterpret_cast<void *>(qintptr(instanceAttributeOffsets[i])));
+            extraFuncs->glVertexAttribDivisor(instanceAttributes[i], 1);
+        }
+    }
+
+    // Index buffer
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
+
+    // Draw all instances with a single call
+    FrameStatisticsCollector::countDrawCalls();
+    extraFuncs->glDrawElementsInstanced(GL_TRIANGLES, object->indexCount(), GL_UNSIGNED_INT,
+                                        (void *)0, instances->indexCount());
+
+    // Free buffers
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Divisors are attribute state, so reset them for the non-instanced draws sharing locations
+    for (int i = 0; i < 4; i++) {
+        if (instanceAttributes[i] >= 0) {
+            extraFuncs->glVertexAttribDivisor(instanceAttributes[i], 0);
+            glDisableVertexAttribArray(instanceAttributes[i]);
+        }
+    }
+    if (shader->uvAtt() >= 0)
+        glDisableVertexAttribArray(shader->uvAtt());
+    if (shader->normalAtt() >= 0)
+        glDisableVertexAttribArray(shader->normalAtt());
     glDisableVertexAttribArray(shader->posAtt());
+
+    // Release textures
+    if (depthTextureId) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (textureId) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
 }
 
 void Drawer::drawSurfaceGrid(ShaderHelper *shader, SurfaceObject *object)
@@ -184,6 +303,7 @@ void Drawer::drawSurfaceGrid(ShaderHelper *shader, SurfaceObject *object)
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->gridElementBuf());
 
     // Draw the lines
+    FrameStatisticsCollector::countDrawCalls();
     glDrawElements(GL_LINES, object->gridIndexCount(), GL_UNSIGNED_INT, (void*)0);
 
     // Free buffers
@@ -201,6 +321,7 @@ void Drawer::drawPoint(ShaderHelper *shader)
     if (!m_pointbuffer) {
         glGenBuffers(1, &m_pointbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
+        FrameStatisticsCollector::countBufferUpload(sizeof(point_data));
         glBufferData(GL_ARRAY_BUFFER, sizeof(point_data), point_data, GL_STATIC_DRAW);
     }
 
@@ -210,6 +331,7 @@ void Drawer::drawPoint(ShaderHelper *shader)
     glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 
     // Draw the point
+    FrameStatisticsCollector::countDrawCalls();
     glDrawArrays(GL_POINTS, 0, 1);
 
     // Free buffers
@@ -240,6 +362,7 @@ void Drawer::drawPoints(ShaderHelper *shader, ScatterPointBufferHelper *object,
     }
 
     // Draw the points
+    FrameStatisticsCollector::countDrawCalls();
     glDrawArrays(GL_POINTS, 0, object->indexCount());
 
     // Free buffers
@@ -262,6 +385,7 @@ void Drawer::drawLine(ShaderHelper *shader)
     if (!m_linebuffer) {
         glGenBuffers(1, &m_linebuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_linebuffer);
+        FrameStatisticsCollector::countBufferUpload(sizeof(line_data));
         glBufferData(GL_ARRAY_BUFFER, sizeof(line_data), line_data, GL_STATIC_DRAW);
     }
 
@@ -271,6 +395,7 @@ void Drawer::drawLine(ShaderHelper *shader)
     glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 
     // Draw the line
+    FrameStatisticsCollector::countDrawCalls();
     glDrawArrays(GL_LINES, 0, 2);
 
     // Free buffers
@@ -279,6 +404,35 @@ void Drawer::drawLine(ShaderHelper *shader)
     glDisableVertexAttribArray(shader->posAtt());
 }
 
+void Drawer::drawLabelGlyphs(ShaderHelper *shader, const LabelItem &labelItem)
+{
+    // Activate atlas texture
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, labelItem.textureId());
+    shader->setUniformValue(shader->texture(), 0);
+
+    // Interleaved vertices and UVs
+    const GLsizei stride = LabelItem::vertexComponents * sizeof(GLfloat);
+    glBindBuffer(GL_ARRAY_BUFFER, labelItem.vertexBuffer());
+    glEnableVertexAttribArray(shader->posAtt());
+    glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glEnableVertexAttribArray(shader->uvAtt());
+    glVertexAttribPointer(shader->uvAtt(), 2, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void *>(LabelItem::uvOffset * sizeof(GLfloat)));
+
+    // Draw the glyphs
+    FrameStatisticsCollector::countDrawCalls();
+    glDrawArrays(GL_TRIANGLES, 0, labelItem.vertexCount());
+
+    // Free buffers
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisableVertexAttribArray(shader->uvAtt());
+    glDisableVertexAttribArray(shader->posAtt());
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Drawer::drawLabel(const AbstractRenderItem &item, const LabelItem &labelItem,
                        const QMatrix4x4 &viewmatrix, const QMatrix4x4 &projectionmatrix,
                        const QVector3D &positionComp, const QQuaternion &rotation,
@@ -395,8 +549,14 @@ void Drawer::drawLabel(const AbstractRenderItem &item, const LabelItem &labelIte
         // Draw the selection object
         drawSelectionObject(shader, object);
     } else {
-        // Draw the object
-        drawObject(shader, object, labelItem.textureId());
+        // Glyphs overlap each other and the background on the label plane, so they are drawn
+        // without writing depth. The label object then writes the depth of the whole label.
+        glDepthMask(GL_FALSE);
+        drawLabelGlyphs(shader, labelItem);
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        drawSelectionObject(shader, object);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     }
 }
 
@@ -410,23 +570,16 @@ void Drawer::generateLabelItem(LabelItem &item, const QString &text, int widestL
 {
     initializeOpenGL();
 
-    item.clear();
-
-    if (!text.isEmpty()) {
-        // Create labels
-        // Print label into a QImage using QPainter
-        QImage label = Utils::printTextToImage(m_theme->font(),
-                                               text,
-                                               m_theme->labelBackgroundColor(),
-                                               m_theme->labelTextColor(),
-                                               m_theme->isLabelBackgroundEnabled(),
-                                               m_theme->isLabelBorderEnabled(),
-                                               widestLabel);
-
-        // Set label size
-        item.setSize(label.size());
-        // Insert text texture into label (also deletes the old texture)
-        item.setTextureId(m_textureHelper->create2DTexture(label, true, true));
+    if (text.isEmpty()) {
+        item.clear();
+    } else {
+        // Build label from cached glyphs, reusing the vertex buffer of the item
+        m_glyphAtlas->setStyle(m_theme->font(),
+                               m_theme->labelBackgroundColor(),
+                               m_theme->labelTextColor(),
+                               m_theme->isLabelBackgroundEnabled(),
+                               m_theme->isLabelBorderEnabled());
+        m_glyphAtlas->generateLabel(item, text, widestLabel);
     }
 }
 
@@ -31,6 +31,8 @@ class TextureHelper;
 class Q3DCamera;
 class Abstract3DRenderer;
 class ScatterPointBufferHelper;
+class ScatterInstanceBufferHelper;
+class GlyphAtlas;
 
 class Drawer : public QObject, public QOpenGLFunctions
 {
@@ -62,11 +64,16 @@ public:
 
     void drawObject(ShaderHelper *shader, AbstractObjectHelper *object, GLuint textureId = 0,
                     GLuint depthTextureId = 0, GLuint textureId3D = 0);
-    void drawSelectionObject(ShaderHelper *shader, AbstractObjectHelper *object);
+    void drawSelectionObject(ShaderHelper *shader, AbstractObjectHelper *object,
+                             GLuint uvBuffer = 0);
+    void drawObjectInstanced(ShaderHelper *shader, AbstractObjectHelper *object,
+                             ScatterInstanceBufferHelper *instances, GLuint textureId = 0,
+                             GLuint depthTextureId = 0);
     void drawSurfaceGrid(ShaderHelper *shader, SurfaceObject *object);
     void drawPoint(ShaderHelper *shader);
     void drawPoints(ShaderHelper *shader, ScatterPointBufferHelper *object, GLuint textureId);
     void drawLine(ShaderHelper *shader);
+    void drawLabelGlyphs(ShaderHelper *shader, const LabelItem &labelItem);
     void drawLabel(const AbstractRenderItem &item, const LabelItem &labelItem,
                    const QMatrix4x4 &viewmatrix, const QMatrix4x4 &projectionmatrix,
                    const QVector3D &positionComp, const QQuaternion &rotation, GLfloat itemHeight,
@@ -85,6 +92,7 @@ Q_SIGNALS:
 private:
     Q3DTheme *m_theme;
     TextureHelper *m_textureHelper;
+    GlyphAtlas *m_glyphAtlas;
     GLuint m_pointbuffer;
     GLuint m_linebuffer;
     GLfloat m_scaledFontSize;
@@ -0,0 +1,183 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "q3dframestatistics_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * \class Q3DFrameStatistics
+ * \inmodule QtDataVisualization
+ * \brief The Q3DFrameStatistics class holds timing and resource statistics of a rendered frame.
+ * \since 6.6
+ * \ingroup shared
+ *
+ * Frame statistics are collected when QAbstract3DGraph::frameStatisticsEnabled is \c true.
+ * A frame covers the synchronization of data to the renderer since the previous frame and the
+ * rendering itself.
+ *
+ * CPU times are exclusive, so nested phases are not included in the time of the enclosing phase.
+ * For example, labels drawn during the selection pass are included in labelTime, not in
+ * selectionPassTime. All times are in microseconds.
+ *
+ * \sa QAbstract3DGraph::frameStatistics
+ */
+
+QT_DEFINE_QSDP_SPECIALIZATION_DTOR(Q3DFrameStatisticsPrivate)
+
+/*!
+ * Constructs frame statistics with all times and counts zero, and the GPU time \c -1.
+ */
+Q3DFrameStatistics::Q3DFrameStatistics()
+    : d_ptr(new Q3DFrameStatisticsPrivate)
+{
+}
+
+/*!
+ * Constructs a copy of \a other.
+ */
+Q3DFrameStatistics::Q3DFrameStatistics(const Q3DFrameStatistics &other) = default;
+
+/*!
+ * \fn Q3DFrameStatistics::Q3DFrameStatistics(Q3DFrameStatistics &&other)
+ *
+ * Move-constructs frame statistics from \a other. The moved-from object can only be
+ * assigned to or destroyed.
+ */
+
+/*!
+ * Deletes the frame statistics.
+ */
+Q3DFrameStatistics::~Q3DFrameStatistics() = default;
+
+/*!
+ * Assigns a copy of \a other to this object.
+ */
+Q3DFrameStatistics &Q3DFrameStatistics::operator=(const Q3DFrameStatistics &other) = default;
+
+/*!
+ * \fn Q3DFrameStatistics &Q3DFrameStatistics::operator=(Q3DFrameStatistics &&other)
+ *
+ * Move-assigns \a other to this object.
+ */
+
+/*!
+ * \fn void Q3DFrameStatistics::swap(Q3DFrameStatistics &other)
+ *
+ * Swaps these statistics with \a other. This operation is very fast and never fails.
+ */
+
+/*!
+ * \property Q3DFrameStatistics::synchTime
+ *
+ * The CPU time spent synchronizing changes from the graph to the renderer, excluding
+ * updateDataTime.
+ */
+qint64 Q3DFrameStatistics::synchTime() const
+{
+    return d_ptr->m_synchTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::updateDataTime
+ *
+ * The CPU time spent updating series data in the renderer.
+ */
+qint64 Q3DFrameStatistics::updateDataTime() const
+{
+    return d_ptr->m_updateDataTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::depthPassTime
+ *
+ * The CPU time spent rendering the shadow depth pass.
+ */
+qint64 Q3DFrameStatistics::depthPassTime() const
+{
+    return d_ptr->m_depthPassTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::selectionPassTime
+ *
+ * The CPU time spent rendering the selection pass and reading the selection back.
+ */
+qint64 Q3DFrameStatistics::selectionPassTime() const
+{
+    return d_ptr->m_selectionPassTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::mainPassTime
+ *
+ * The CPU time spent rendering that is not attributed to any other phase.
+ */
+qint64 Q3DFrameStatistics::mainPassTime() const
+{
+    return d_ptr->m_mainPassTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::labelTime
+ *
+ * The CPU time spent drawing labels.
+ */
+qint64 Q3DFrameStatistics::labelTime() const
+{
+    return d_ptr->m_labelTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::customItemTime
+ *
+ * The CPU time spent drawing custom items.
+ */
+qint64 Q3DFrameStatistics::customItemTime() const
+{
+    return d_ptr->m_customItemTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::gpuTime
+ *
+ * The GPU time of rendering, measured with OpenGL timer queries. Timer query results become
+ * available asynchronously, so this is the time of the latest frame with an available result,
+ * usually one or two frames earlier. The value is \c -1 if timer queries are not supported.
+ */
+qint64 Q3DFrameStatistics::gpuTime() const
+{
+    return d_ptr->m_gpuTime;
+}
+
+/*!
+ * \property Q3DFrameStatistics::drawCallCount
+ *
+ * The number of OpenGL draw calls.
+ */
+int Q3DFrameStatistics::drawCallCount() const
+{
+    return d_ptr->m_drawCallCount;
+}
+
+/*!
+ * \property Q3DFrameStatistics::bufferBytesUploaded
+ *
+ * The number of bytes uploaded to vertex and index buffers.
+ */
+qint64 Q3DFrameStatistics::bufferBytesUploaded() const
+{
+    return d_ptr->m_bufferBytesUploaded;
+}
+
+/*!
+ * \property Q3DFrameStatistics::textureBytesCreated
+ *
+ * The number of bytes of texture storage allocated.
+ */
+qint64 Q3DFrameStatistics::textureBytesCreated() const
+{
+    return d_ptr->m_textureBytesCreated;
+}
+
+QT_END_NAMESPACE
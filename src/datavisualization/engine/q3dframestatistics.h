@@ -0,0 +1,65 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef Q3DFRAMESTATISTICS_H
+#define Q3DFRAMESTATISTICS_H
+
+#include <QtDataVisualization/qdatavisualizationglobal.h>
+#include <QtCore/qobjectdefs.h>
+#include <QtCore/qshareddata.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q3DFrameStatisticsPrivate;
+QT_DECLARE_QSDP_SPECIALIZATION_DTOR_WITH_EXPORT(Q3DFrameStatisticsPrivate,
+                                                Q_DATAVISUALIZATION_EXPORT)
+
+class Q_DATAVISUALIZATION_EXPORT Q3DFrameStatistics
+{
+    Q_GADGET
+    Q_PROPERTY(qint64 synchTime READ synchTime CONSTANT)
+    Q_PROPERTY(qint64 updateDataTime READ updateDataTime CONSTANT)
+    Q_PROPERTY(qint64 depthPassTime READ depthPassTime CONSTANT)
+    Q_PROPERTY(qint64 selectionPassTime READ selectionPassTime CONSTANT)
+    Q_PROPERTY(qint64 mainPassTime READ mainPassTime CONSTANT)
+    Q_PROPERTY(qint64 labelTime READ labelTime CONSTANT)
+    Q_PROPERTY(qint64 customItemTime READ customItemTime CONSTANT)
+    Q_PROPERTY(qint64 gpuTime READ gpuTime CONSTANT)
+    Q_PROPERTY(int drawCallCount READ drawCallCount CONSTANT)
+    Q_PROPERTY(qint64 bufferBytesUploaded READ bufferBytesUploaded CONSTANT)
+    Q_PROPERTY(qint64 textureBytesCreated READ textureBytesCreated CONSTANT)
+
+public:
+    Q3DFrameStatistics();
+    Q3DFrameStatistics(const Q3DFrameStatistics &other);
+    Q3DFrameStatistics(Q3DFrameStatistics &&other) noexcept = default;
+    ~Q3DFrameStatistics();
+
+    Q3DFrameStatistics &operator=(const Q3DFrameStatistics &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(Q3DFrameStatistics)
+
+    void swap(Q3DFrameStatistics &other) noexcept { d_ptr.swap(other.d_ptr); }
+
+    qint64 synchTime() const;
+    qint64 updateDataTime() const;
+    qint64 depthPassTime() const;
+    qint64 selectionPassTime() const;
+    qint64 mainPassTime() const;
+    qint64 labelTime() const;
+    qint64 customItemTime() const;
+    qint64 gpuTime() const;
+    int drawCallCount() const;
+    qint64 bufferBytesUploaded() const;
+    qint64 textureBytesCreated() const;
+
+private:
+    QSharedDataPointer<Q3DFrameStatisticsPrivate> d_ptr;
+
+    friend class FrameStatisticsCollector;
+};
+
+Q_DECLARE_SHARED(Q3DFrameStatistics)
+
+QT_END_NAMESPACE
+
+#endif
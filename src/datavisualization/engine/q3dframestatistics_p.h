@@ -0,0 +1,40 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef Q3DFRAMESTATISTICS_P_H
+#define Q3DFRAMESTATISTICS_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "q3dframestatistics.h"
+
+QT_BEGIN_NAMESPACE
+
+class Q3DFrameStatisticsPrivate : public QSharedData
+{
+public:
+    qint64 m_synchTime = 0;
+    qint64 m_updateDataTime = 0;
+    qint64 m_depthPassTime = 0;
+    qint64 m_selectionPassTime = 0;
+    qint64 m_mainPassTime = 0;
+    qint64 m_labelTime = 0;
+    qint64 m_customItemTime = 0;
+    qint64 m_gpuTime = -1;
+    int m_drawCallCount = 0;
+    qint64 m_bufferBytesUploaded = 0;
+    qint64 m_textureBytesCreated = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
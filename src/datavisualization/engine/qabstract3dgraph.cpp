@@ -37,6 +37,12 @@ QT_BEGIN_NAMESPACE
  * a constructor parameter. You can use the convenience function \c qDefaultSurfaceFormat()
  * to create the surface format object.
  *
+ * Shader programs are shared between graphs whose OpenGL contexts share resources. For graph
+ * windows this requires setting the \c Qt::AA_ShareOpenGLContexts application attribute before
+ * the graphs are created. Linked program binaries are also cached on disk, unless
+ * \c Qt::AA_DisableShaderDiskCache is set. Shader setup timing is logged to the
+ * \c qt.datavisualization.shadercache logging category.
+ *
  * \note QAbstract3DGraph sets window flag \c Qt::FramelessWindowHint on by default. If you want to display
  * graph windows as standalone windows with regular window frame, clear this flag after constructing
  * the graph. For example:
@@ -140,6 +146,10 @@ QT_BEGIN_NAMESPACE
            Provides the full feature set at a reasonable performance.
     \value OptimizationStatic
            Optimizes the rendering of static data sets at the expense of some features.
+    \value OptimizationCachedScene
+           Keeps the rendered scene in an offscreen buffer, so that frames in which only the
+           selection changes redraw just the selection pointer and label. Costs the memory of
+           a color and a depth buffer the size of the graph. Since Qt 6.6.
 */
 
 /*!
@@ -172,6 +182,9 @@ QAbstract3DGraph::QAbstract3DGraph(QAbstract3DGraphPrivate *d, const QSurfaceFor
     create();
 
     d_ptr->m_context->setFormat(requestedFormat());
+    // Share shader programs with other graphs if the application enables context sharing
+    if (QCoreApplication::testAttribute(Qt::AA_ShareOpenGLContexts))
+        d_ptr->m_context->setShareContext(QOpenGLContext::globalShareContext());
     d_ptr->m_context->create();
     bool makeSuccess = d_ptr->m_context->makeCurrent(this);
 
@@ -689,7 +702,11 @@ qreal QAbstract3DGraph::aspectRatio() const
  * performance. The static mode optimizes graph rendering and is ideal for
  * large non-changing data sets. It is slower with dynamic data changes and item rotations.
  * Selection is not optimized, so using the static mode with massive data sets is not advisable.
- * Static optimization works only on scatter graphs.
+ * Static optimization works on scatter and bar graphs. On bar graphs, reflections and row colors
+ * are drawn without it.
+ * The cached scene mode can be combined with either mode. It keeps the rendered scene in an
+ * offscreen buffer, so that hovering and selecting items does not render the whole graph again.
+ * Scene caching works on surface graphs on OpenGL 3.0 and later, excluding OpenGL ES.
  * Defaults to \l{OptimizationDefault}.
  *
  * \note On some environments, large graphs using static optimization may not render, because
@@ -914,6 +931,134 @@ qreal QAbstract3DGraph::margin() const
     return d_ptr->m_visualController->margin();
 }
 
+/*!
+ * \property QAbstract3DGraph::frameStatisticsEnabled
+ * \since 6.6
+ *
+ * \brief Whether per-frame statistics are collected.
+ *
+ * If \c {true}, the time spent in each phase of rendering, the number of draw calls, and the
+ * amount of buffer and texture data uploaded are collected for every rendered frame and
+ * reported in the frameStatistics property. The GPU time is measured with timer queries when
+ * the OpenGL implementation supports them. Collecting the statistics has a small cost, so it
+ * is disabled by default.
+ *
+ * \sa frameStatistics
+ */
+void QAbstract3DGraph::setFrameStatisticsEnabled(bool enable)
+{
+    d_ptr->m_visualController->setFrameStatisticsEnabled(enable);
+}
+
+bool QAbstract3DGraph::isFrameStatisticsEnabled() const
+{
+    return d_ptr->m_visualController->isFrameStatisticsEnabled();
+}
+
+/*!
+ * \property QAbstract3DGraph::frameStatistics
+ * \since 6.6
+ *
+ * \brief The statistics of the last rendered frame.
+ *
+ * This read-only property is updated after each rendered frame when frameStatisticsEnabled
+ * is \c {true}.
+ *
+ * \sa frameStatisticsEnabled, Q3DFrameStatistics
+ */
+Q3DFrameStatistics QAbstract3DGraph::frameStatistics() const
+{
+    return d_ptr->m_visualController->frameStatistics();
+}
+
+/*!
+ * \property QAbstract3DGraph::asynchronousDataPreparation
+ * \since 6.6
+ *
+ * \brief Whether new data is prepared for rendering in a background thread.
+ *
+ * If \c {true}, the meshes of surface series are built from a snapshot of the data in a
+ * background thread, and the graph keeps rendering the previous data until they are ready. This
+ * keeps the graph responsive when large data sets change, but the new data appears with a delay
+ * of one or more frames. The dataReady() signal is emitted when the new data is displayed.
+ *
+ * Only surface series on graphs with value axes that have the default linear formatter are
+ * prepared in the background. Surfaces on polar graphs, and all bar and scatter series, are
+ * always prepared synchronously. Defaults to \c{false}.
+ *
+ * \sa maxDataLatency, dataReady()
+ */
+void QAbstract3DGraph::setAsynchronousDataPreparation(bool enable)
+{
+    d_ptr->m_visualController->setAsynchronousDataPreparation(enable);
+}
+
+bool QAbstract3DGraph::asynchronousDataPreparation() const
+{
+    return d_ptr->m_visualController->asynchronousDataPreparation();
+}
+
+/*!
+ * \property QAbstract3DGraph::maxDataLatency
+ * \since 6.6
+ *
+ * \brief The maximum time in milliseconds that rendering continues with the previous data
+ * while new data is prepared in the background.
+ *
+ * When the preparation takes longer than this, the next frame waits for it to finish. The
+ * value \c{-1} means that frames never wait for the preparation. Only has an effect when
+ * asynchronousDataPreparation is \c {true}. Defaults to \c{-1}.
+ *
+ * \sa asynchronousDataPreparation
+ */
+void QAbstract3DGraph::setMaxDataLatency(int msecs)
+{
+    d_ptr->m_visualController->setMaxDataLatency(msecs);
+}
+
+int QAbstract3DGraph::maxDataLatency() const
+{
+    return d_ptr->m_visualController->maxDataLatency();
+}
+
+/*!
+ * \property QAbstract3DGraph::shadowMapSize
+ * \since 6.6
+ *
+ * \brief The size of the shadow map in pixels.
+ *
+ * By default, the shadow map is the size of the graph on screen multiplied by a factor that
+ * depends on the shadowQuality, which can make it very large on large screens. If the size is
+ * greater than zero, the shadow map is a square of this size at ShadowQualityHigh, and
+ * proportionally smaller at the lower qualities, whatever the size of the graph. The light is
+ * then focused on the graph box, so items positioned outside the graph box cast no shadows.
+ * Negative sizes are set to \c{0}, and sizes greater than \c{16384} are set to \c{16384}.
+ * When rendering, the size is further limited to the maximum texture size of the OpenGL
+ * implementation.
+ *
+ * Defaults to \c{0}.
+ *
+ * \sa shadowQuality
+ */
+void QAbstract3DGraph::setShadowMapSize(int size)
+{
+    d_ptr->m_visualController->setShadowMapSize(size);
+}
+
+int QAbstract3DGraph::shadowMapSize() const
+{
+    return d_ptr->m_visualController->shadowMapSize();
+}
+
+/*!
+ * \fn void QAbstract3DGraph::dataReady()
+ * \since 6.6
+ *
+ * This signal is emitted when data that required reloading, such as a reset data array, has
+ * been prepared for rendering. When asynchronousDataPreparation is \c {true}, this can happen
+ * several frames after the data changed.
+ */
+
 /*!
  * Returns \c{true} if the OpenGL context of the graph has been successfully initialized.
  * Trying to use a graph when the context initialization has failed typically results in a crash.
@@ -1100,6 +1245,19 @@ void QAbstract3DGraphPrivate::setVisualController(Abstract3DController *controll
                      &QAbstract3DGraph::queriedGraphPositionChanged);
     QObject::connect(m_visualController, &Abstract3DController::marginChanged, q_ptr,
                      &QAbstract3DGraph::marginChanged);
+    QObject::connect(m_visualController, &Abstract3DController::frameStatisticsEnabledChanged,
+                     q_ptr, &QAbstract3DGraph::frameStatisticsEnabledChanged);
+    QObject::connect(m_visualController, &Abstract3DController::frameStatisticsChanged, q_ptr,
+                     &QAbstract3DGraph::frameStatisticsChanged);
+    QObject::connect(m_visualController,
+                     &Abstract3DController::asynchronousDataPreparationChanged, q_ptr,
+                     &QAbstract3DGraph::asynchronousDataPreparationChanged);
+    QObject::connect(m_visualController, &Abstract3DController::maxDataLatencyChanged, q_ptr,
+                     &QAbstract3DGraph::maxDataLatencyChanged);
+    QObject::connect(m_visualController, &Abstract3DController::dataReady, q_ptr,
+                     &QAbstract3DGraph::dataReady);
+    QObject::connect(m_visualController, &Abstract3DController::shadowMapSizeChanged, q_ptr,
+                     &QAbstract3DGraph::shadowMapSizeChanged);
 }
 
 void QAbstract3DGraphPrivate::handleDevicePixelRatioChange()
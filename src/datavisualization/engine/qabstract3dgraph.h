@@ -7,6 +7,7 @@
 #include <QtDataVisualization/qdatavisualizationglobal.h>
 #include <QtDataVisualization/q3dtheme.h>
 #include <QtDataVisualization/q3dscene.h>
+#include <QtDataVisualization/q3dframestatistics.h>
 #include <QtDataVisualization/qabstract3dinputhandler.h>
 #include <QtGui/QWindow>
 #include <QtGui/QOpenGLFunctions>
@@ -43,6 +44,11 @@ class Q_DATAVISUALIZATION_EXPORT QAbstract3DGraph : public QWindow, protected QO
     Q_PROPERTY(QLocale locale READ locale WRITE setLocale NOTIFY localeChanged)
     Q_PROPERTY(QVector3D queriedGraphPosition READ queriedGraphPosition NOTIFY queriedGraphPositionChanged)
     Q_PROPERTY(qreal margin READ margin WRITE setMargin NOTIFY marginChanged)
+    Q_PROPERTY(bool frameStatisticsEnabled READ isFrameStatisticsEnabled WRITE setFrameStatisticsEnabled NOTIFY frameStatisticsEnabledChanged REVISION(6, 6))
+    Q_PROPERTY(Q3DFrameStatistics frameStatistics READ frameStatistics NOTIFY frameStatisticsChanged REVISION(6, 6))
+    Q_PROPERTY(bool asynchronousDataPreparation READ asynchronousDataPreparation WRITE setAsynchronousDataPreparation NOTIFY asynchronousDataPreparationChanged REVISION(6, 6))
+    Q_PROPERTY(int maxDataLatency READ maxDataLatency WRITE setMaxDataLatency NOTIFY maxDataLatencyChanged REVISION(6, 6))
+    Q_PROPERTY(int shadowMapSize READ shadowMapSize WRITE setShadowMapSize NOTIFY shadowMapSizeChanged REVISION(6, 6))
 
 protected:
     explicit QAbstract3DGraph(QAbstract3DGraphPrivate *d, const QSurfaceFormat *format,
@@ -87,7 +93,8 @@ public:
 
     enum OptimizationHint {
         OptimizationDefault = 0,
-        OptimizationStatic  = 1
+        OptimizationStatic  = 1,
+        OptimizationCachedScene = 2
     };
     Q_ENUM(OptimizationHint)
     Q_DECLARE_FLAGS(OptimizationHints, OptimizationHint)
@@ -173,6 +180,18 @@ public:
     void setMargin(qreal margin);
     qreal margin() const;
 
+    void setFrameStatisticsEnabled(bool enable);
+    bool isFrameStatisticsEnabled() const;
+    Q3DFrameStatistics frameStatistics() const;
+
+    void setAsynchronousDataPreparation(bool enable);
+    bool asynchronousDataPreparation() const;
+    void setMaxDataLatency(int msecs);
+    int maxDataLatency() const;
+
+    void setShadowMapSize(int size);
+    int shadowMapSize() const;
+
     bool hasContext() const;
 
 protected:
@@ -208,6 +227,12 @@ Q_SIGNALS:
     void localeChanged(const QLocale &locale);
     void queriedGraphPositionChanged(const QVector3D &data);
     void marginChanged(qreal margin);
+    Q_REVISION(6, 6) void frameStatisticsEnabledChanged(bool enabled);
+    Q_REVISION(6, 6) void frameStatisticsChanged(const Q3DFrameStatistics &statistics);
+    Q_REVISION(6, 6) void asynchronousDataPreparationChanged(bool enabled);
+    Q_REVISION(6, 6) void maxDataLatencyChanged(int msecs);
+    Q_REVISION(6, 6) void dataReady();
+    Q_REVISION(6, 6) void shadowMapSizeChanged(int size);
 
 private:
     Q_DISABLE_COPY(QAbstract3DGraph)
@@ -55,13 +55,24 @@ void Scatter3DController::synchDataToRenderer()
     if (!isInitialized())
         return;
 
+    FrameStatisticsCollector::Scope statisticsScope(frameStatisticsCollector(),
+                                                    FrameStatisticsCollector::PhaseSynch);
+
     Abstract3DController::synchDataToRenderer();
 
     // Notify changes to renderer
     if (m_changeTracker.itemChanged) {
-        m_renderer->updateItems(m_changedItems);
+        // Items of fully updated series are reloaded by the data update already
+        if (m_changedItemTracker.hasFullUpdates()) {
+            m_changedItems.removeIf([this](const ChangeItem &item) {
+                return m_changedItemTracker.isFullUpdate(item.series);
+            });
+        }
+        if (!m_changedItems.isEmpty())
+            m_renderer->updateItems(m_changedItems);
         m_changeTracker.itemChanged = false;
         m_changedItems.clear();
+        m_changedItemTracker.clear();
     }
 
     if (m_changeTracker.selectedItemChanged) {
@@ -87,6 +98,8 @@ void Scatter3DController::removeSeries(QAbstract3DSeries *series)
 
     Abstract3DController::removeSeries(series);
 
+    m_changedItemTracker.remove(static_cast<QScatter3DSeries *>(series));
+
     if (m_selectedItemSeries == series)
         setSelectedItem(invalidSelectionIndex(), 0);
 
@@ -115,6 +128,7 @@ void Scatter3DController::handleArrayReset()
     else
         series = static_cast<QScatter3DSeries *>(sender());
 
+    m_changedItemTracker.resize(series, series->dataProxy()->itemCount());
     if (series->isVisible()) {
         adjustAxisRanges();
         m_isDataDirty = true;
@@ -143,25 +157,21 @@ void Scatter3DController::handleItemsAdded(int startIndex, int count)
 void Scatter3DController::handleItemsChanged(int startIndex, int count)
 {
     QScatter3DSeries *series = static_cast<QScatterDataProxy *>(sender())->series();
-    int oldChangeCount = m_changedItems.size();
-    if (!oldChangeCount)
-        m_changedItems.reserve(count);
+    const int itemCount = series->dataProxy()->itemCount();
 
     for (int i = 0; i < count; i++) {
-        bool newItem = true;
         int candidate = startIndex + i;
-        for (int j = 0; j < oldChangeCount; j++) {
-            const ChangeItem &oldChangeItem = m_changedItems.at(j);
-            if (oldChangeItem.index == candidate && series == oldChangeItem.series) {
-                newItem = false;
-                break;
-            }
-        }
-        if (newItem) {
+        ChangedItemTracker<QScatter3DSeries>::MarkResult result =
+                m_changedItemTracker.mark(series, candidate, itemCount);
+        if (result == ChangedItemTracker<QScatter3DSeries>::MarkAdded) {
             ChangeItem newChangeItem = {series, candidate};
             m_changedItems.append(newChangeItem);
             if (series == m_selectedItemSeries && m_selectedItem == candidate)
                 series->d_ptr->markItemLabelDirty();
+        } else if (result == ChangedItemTracker<QScatter3DSeries>::MarkFullUpdate) {
+            // Most of the series changed, so reload it fully instead of item by item
+            markSeriesDataDirty(series);
+            break;
         }
     }
 
@@ -340,7 +350,7 @@ void Scatter3DController::setSelectedItem(int index, QScatter3DSeries *series)
         if (seriesChanged)
             emit selectedSeriesChanged(m_selectedItemSeries);
 
-        emitNeedRender();
+        emitNeedRedraw();
     }
 }
 
@@ -16,6 +16,7 @@
 
 #include <private/datavisualizationglobal_p.h>
 #include <private/abstract3dcontroller_p.h>
+#include <private/changeditemtracker_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -46,6 +47,7 @@ public:
 private:
     Scatter3DChangeBitField m_changeTracker;
     QList<ChangeItem> m_changedItems;
+    ChangedItemTracker<QScatter3DSeries> m_changedItemTracker;
 
     // Rendering
     Scatter3DRenderer *m_renderer;
@@ -9,8 +9,10 @@
 #include "scatterseriesrendercache_p.h"
 #include "scatterobjectbufferhelper_p.h"
 #include "scatterpointbufferhelper_p.h"
+#include "scatterinstancebufferhelper_p.h"
 
 #include <QtCore/qmath.h>
+#include <QtGui/QOpenGLExtraFunctions>
 
 // You can verify that depth buffer drawing works correctly by uncommenting this.
 // You should see the scene from  where the light is
@@ -21,10 +23,12 @@ QT_BEGIN_NAMESPACE
 const GLfloat defaultMinSize = 0.01f;
 const GLfloat defaultMaxSize = 0.1f;
 const GLfloat itemScaler = 3.0f;
+// Number of data items whose axis positions are resolved in one batch
+const int positionChunkSize = 256;
 
 Scatter3DRenderer::Scatter3DRenderer(Scatter3DController *controller)
     : Abstract3DRenderer(controller),
-      m_selectedItem(0),
+      m_selectedLabelIndex(Scatter3DController::invalidSelectionIndex()),
       m_updateLabels(false),
       m_dotShader(0),
       m_dotGradientShader(0),
@@ -35,6 +39,12 @@ Scatter3DRenderer::Scatter3DRenderer(Scatter3DController *controller)
       m_selectionShader(0),
       m_backgroundShader(0),
       m_staticGradientPointShader(0),
+      m_dotInstancedShader(0),
+      m_dotGradientInstancedShader(0),
+      m_depthInstancedShader(0),
+      m_selectionInstancedShader(0),
+      m_selectionIdShader(0),
+      m_selectionIdInstancedShader(0),
       m_bgrTexture(0),
       m_selectionTexture(0),
       m_depthFrameBuffer(0),
@@ -54,7 +64,9 @@ Scatter3DRenderer::Scatter3DRenderer(Scatter3DController *controller)
       m_havePointSeries(false),
       m_haveMeshSeries(false),
       m_haveUniformColorMeshSeries(false),
-      m_haveGradientMeshSeries(false)
+      m_haveGradientMeshSeries(false),
+      m_instancingSupported(false),
+      m_integerSelectionBuffer(false)
 {
     initializeOpenGL();
 }
@@ -70,6 +82,12 @@ Scatter3DRenderer::~Scatter3DRenderer()
     delete m_selectionShader;
     delete m_backgroundShader;
     delete m_staticGradientPointShader;
+    delete m_dotInstancedShader;
+    delete m_dotGradientInstancedShader;
+    delete m_depthInstancedShader;
+    delete m_selectionInstancedShader;
+    delete m_selectionIdShader;
+    delete m_selectionIdInstancedShader;
 }
 
 void Scatter3DRenderer::contextCleanup()
@@ -87,6 +105,13 @@ void Scatter3DRenderer::initializeOpenGL()
 {
     Abstract3DRenderer::initializeOpenGL();
 
+    // Instanced drawing of mesh series needs instanced arrays, which the ES2 compatible shaders
+    // used on OpenGL ES cannot utilize.
+    m_instancingSupported = !m_isOpenGLES
+            && m_context->format().version() >= qMakePair(3, 3);
+    // Integer selection ids lift the 24-bit limit of the selection colors on item count
+    m_integerSelectionBuffer = m_selectionReadback->isAsynchronous();
+
     // Initialize shaders
 
     if (!m_isOpenGLES) {
@@ -99,6 +124,9 @@ void Scatter3DRenderer::initializeOpenGL()
     // Init selection shader
     initSelectionShader();
 
+    if (m_instancingSupported)
+        initInstancedShaders();
+
     // Set view port
     glViewport(m_primarySubViewport.x(),
                m_primarySubViewport.y(),
@@ -174,11 +202,11 @@ void Scatter3DRenderer::updateData()
                 if (dataSize != renderArray.size())
                     renderArray.resize(dataSize);
 
-                for (int i = 0; i < dataSize; i++)
-                    updateRenderItem(dataArray.at(i), renderArray[i]);
+                updateRenderItems(dataArray, renderArray);
 
                 if (m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic))
                     cache->setStaticBufferDirty(true);
+                cache->setInstanceBufferDirty(true);
 
                 cache->setDataDirty(false);
             }
@@ -227,6 +255,8 @@ void Scatter3DRenderer::updateData()
                 cache->setStaticBufferDirty(false);
             }
         }
+    } else if (isInstancingActive()) {
+        updateInstanceBuffers();
     }
 
     updateSelectedItem(m_selectedItemIndex,
@@ -255,6 +285,18 @@ void Scatter3DRenderer::updateSeries(const QList<QAbstract3DSeries *> &seriesLis
         }
     }
 
+    // Instance buffers bake in series rotation and gradient style
+    for (int i = 0; i < seriesCount; i++) {
+        QScatter3DSeries *scatterSeries = static_cast<QScatter3DSeries *>(seriesList[i]);
+        QAbstract3DSeriesChangeBitField &changeTracker = scatterSeries->d_ptr->m_changeTracker;
+        ScatterSeriesRenderCache *cache =
+                static_cast<ScatterSeriesRenderCache *>(m_renderCacheList.value(scatterSeries));
+        if (cache && (changeTracker.meshChanged || changeTracker.meshRotationChanged
+                      || changeTracker.colorStyleChanged)) {
+            cache->setInstanceBufferDirty(true);
+        }
+    }
+
     Abstract3DRenderer::updateSeries(seriesList);
 
     float maxItemSize = 0.0f;
@@ -315,6 +357,9 @@ void Scatter3DRenderer::updateSeries(const QList<QAbstract3DSeries *> &seriesLis
     m_maxItemSize = maxItemSize;
     calculateSceneScalingFactors();
 
+    if (isInstancingActive())
+        updateInstanceBuffers();
+
     if (noSelection) {
         if (!selectionLabel().isEmpty())
             m_selectionLabelDirty = true;
@@ -334,6 +379,7 @@ void Scatter3DRenderer::updateItems(const QList<Scatter3DController::ChangeItem>
     const QScatterDataArray *dataArray = 0;
     const bool optimizationStatic = m_cachedOptimizationHint.testFlag(
                 QAbstract3DGraph::OptimizationStatic);
+    const bool instancing = isInstancingActive();
 
     foreach (Scatter3DController::ChangeItem item, items) {
         QScatter3DSeries *currentSeries = item.series;
@@ -350,14 +396,11 @@ void Scatter3DRenderer::updateItems(const QList<Scatter3DController::ChangeItem>
             const int index = item.index;
             if (index >= cache->renderArray().size())
                 continue; // Items removed from array for same render
-            bool oldVisibility = false;
-            ScatterRenderItem &item = cache->renderArray()[index];
-            if (optimizationStatic)
-                oldVisibility = item.isVisible();
-            updateRenderItem(dataArray->at(index), item);
+            updateRenderItem(dataArray->at(index), cache->renderArray(), index);
             if (optimizationStatic) {
-                if (!cache->visibilityChanged() && oldVisibility != item.isVisible())
-                    cache->setVisibilityChanged(true);
+                cache->updateIndices().append(index);
+            } else if (instancing && cache->mesh() != QAbstract3DSeries::MeshPoint
+                       && !cache->instanceBufferDirty()) {
                 cache->updateIndices().append(index);
             }
         }
@@ -371,20 +414,25 @@ void Scatter3DRenderer::updateItems(const QList<Scatter3DController::ChangeItem>
                     if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
                         cache->bufferPoints()->updateUVs(cache);
                 } else {
-                    if (cache->visibilityChanged()) {
-                        // If any change changes item visibility, full load is needed to
-                        // resize the buffers.
-                        cache->updateIndices().clear();
-                        cache->bufferObject()->fullLoad(cache, m_dotSizeScale);
-                    } else {
-                        cache->bufferObject()->update(cache, m_dotSizeScale);
-                        if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
-                            cache->bufferObject()->updateUVs(cache);
-                    }
+                    // Items keep their buffer slots when hidden, so visibility changes
+                    // do not require a full load.
+                    cache->bufferObject()->update(cache, m_dotSizeScale);
+                    if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
+                        cache->bufferObject()->updateUVs(cache);
                 }
                 cache->updateIndices().clear();
             }
-            cache->setVisibilityChanged(false);
+        }
+    } else if (instancing) {
+        // Instance slots match render array indices, so even visibility changes only need
+        // the changed slots patched.
+        foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+            ScatterSeriesRenderCache *cache = static_cast<ScatterSeriesRenderCache *>(baseCache);
+            if (cache->isVisible() && cache->updateIndices().size()) {
+                cache->bufferInstances()->setScaleY(m_scaleY);
+                cache->bufferInstances()->update(cache);
+                cache->updateIndices().clear();
+            }
         }
     }
 }
@@ -427,6 +475,12 @@ void Scatter3DRenderer::updateOptimizationHint(QAbstract3DGraph::OptimizationHin
         initStaticPointShaders(QStringLiteral(":/shaders/vertexPointES2_UV"),
                                QStringLiteral(":/shaders/fragmentLabel"));
     }
+
+    // Staging storage is only needed for static buffers
+    if (!hint.testFlag(QAbstract3DGraph::OptimizationStatic)) {
+        foreach (SeriesRenderCache *baseCache, m_renderCacheList)
+            static_cast<ScatterSeriesRenderCache *>(baseCache)->stagingArena().clear();
+    }
 }
 
 void Scatter3DRenderer::updateMargin(float margin)
@@ -465,6 +519,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
     // Get the optimization flag
     const bool optimizationDefault =
             !m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic);
+    const bool instancing = isInstancingActive();
 
     const Q3DCamera *activeCamera = m_cachedScene->activeCamera();
 
@@ -534,15 +589,33 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             glEnable(GL_PROGRAM_POINT_SIZE);
         }
 
-        if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
+        const bool drawShadows = m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone;
+        if (drawShadows) {
+            QMatrix4x4 depthViewMatrix;
+            QMatrix4x4 depthProjectionMatrix;
+
+            // Get the depth view matrix
+            // It may be possible to hack lightPos here if we want to make some tweaks to shadow
+            QVector3D depthLightPos = activeCamera->d_ptr->calculatePositionRelativeToCamera(
+                        zeroVector, 0.0f, 2.5f / m_autoScaleAdjustment);
+            depthViewMatrix.lookAt(depthLightPos, zeroVector, upVector);
+            // Set the depth projection matrix
+            depthProjectionMatrix = calculateDepthProjectionMatrix(depthViewMatrix, 15.0f,
+                                                                   viewPortRatio);
+            depthProjectionViewMatrix = depthProjectionMatrix * depthViewMatrix;
+        }
+        if (drawShadows && !isDepthPassValid(projectionViewMatrix, depthProjectionViewMatrix)) {
+            FrameStatisticsCollector::Scope statisticsScope(
+                        FrameStatisticsCollector::PhaseDepthPass);
             // Render scene into a depth texture for using with shadow mapping
             // Bind depth shader
             m_depthShader->bind();
 
             // Set viewport for depth map rendering. Must match texture size. Larger values give smoother shadows.
-            glViewport(0, 0,
-                       m_primarySubViewport.width() * m_shadowQualityMultiplier,
-                       m_primarySubViewport.height() * m_shadowQualityMultiplier);
+            glViewport(0, 0, m_depthTextureSize.width(), m_depthTextureSize.height());
+            // Points are scaled by the resolution of the depth texture relative to the screen
+            const float shadowPointScale = float(m_depthTextureSize.height())
+                    / float(m_primarySubViewport.height());
 
             // Enable drawing to framebuffer
             glBindFramebuffer(GL_FRAMEBUFFER, m_depthFrameBuffer);
@@ -551,18 +624,6 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             // Set front face culling to reduce self-shadowing issues
             glCullFace(GL_FRONT);
 
-            QMatrix4x4 depthViewMatrix;
-            QMatrix4x4 depthProjectionMatrix;
-
-            // Get the depth view matrix
-            // It may be possible to hack lightPos here if we want to make some tweaks to shadow
-            QVector3D depthLightPos = activeCamera->d_ptr->calculatePositionRelativeToCamera(
-                        zeroVector, 0.0f, 2.5f / m_autoScaleAdjustment);
-            depthViewMatrix.lookAt(depthLightPos, zeroVector, upVector);
-            // Set the depth projection matrix
-            depthProjectionMatrix.perspective(15.0f, viewPortRatio, 3.0f, 100.0f);
-            depthProjectionViewMatrix = depthProjectionMatrix * depthViewMatrix;
-
             // Draw dots to depth buffer
             foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
                 if (baseCache->isVisible()) {
@@ -578,7 +639,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                         itemSize = m_dotSizeScale;
                     if (drawingPoints) {
                         // Scale points based on shadow quality for shadows, not by zoom level
-                        m_funcs_2_1->glPointSize(itemSize * 100.0f * m_shadowQualityMultiplier);
+                        m_funcs_2_1->glPointSize(itemSize * 100.0f * shadowPointScale);
                     }
                     QVector3D modelScaler(itemSize, itemSize, itemSize);
 
@@ -588,22 +649,37 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                         continue;
                     }
 
+                    if (instancing && !drawingPoints) {
+                        ScatterInstanceBufferHelper *instances = cache->bufferInstances();
+                        if (instances && instances->indexCount()) {
+                            m_depthInstancedShader->bind();
+                            m_depthInstancedShader->setUniformValue(
+                                        m_depthInstancedShader->MVP(), depthProjectionViewMatrix);
+                            m_depthInstancedShader->setUniformValue(
+                                        m_depthInstancedShader->modelScale(), modelScaler);
+                            m_drawer->drawObjectInstanced(m_depthInstancedShader, dotObj,
+                                                          instances);
+                            m_depthShader->bind();
+                        }
+                        continue;
+                    }
+
                     int loopCount = 1;
                     if (optimizationDefault)
                         loopCount = renderArraySize;
                     for (int dot = 0; dot < loopCount; dot++) {
-                        const ScatterRenderItem &item = renderArray.at(dot);
-                        if (!item.isVisible() && optimizationDefault)
+                        if (optimizationDefault && !renderArray.isVisible(dot))
                             continue;
 
                         QMatrix4x4 modelMatrix;
                         QMatrix4x4 MVPMatrix;
 
                         if (optimizationDefault) {
-                            modelMatrix.translate(item.translation());
+                            modelMatrix.translate(renderArray.translation(dot));
                             if (!drawingPoints) {
-                                if (!seriesRotation.isIdentity() || !item.rotation().isIdentity())
-                                    modelMatrix.rotate(seriesRotation * item.rotation());
+                                const QQuaternion &rotation = renderArray.rotation(dot);
+                                if (!seriesRotation.isIdentity() || !rotation.isIdentity())
+                                    modelMatrix.rotate(seriesRotation * rotation);
                                 modelMatrix.scale(modelScaler);
                             }
                         }
@@ -629,6 +705,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dotObj->elementBuf());
 
                                 // Draw the triangles
+                                FrameStatisticsCollector::countDrawCalls();
                                 glDrawElements(GL_TRIANGLES, dotObj->indexCount(),
                                                GL_UNSIGNED_INT, (void *)0);
 
@@ -649,6 +726,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
 
                                 // Draw the triangles
+                                FrameStatisticsCollector::countDrawCalls();
                                 glDrawElements(GL_TRIANGLES, object->indexCount(),
                                                GL_UNSIGNED_INT, (void *)0);
 
@@ -679,14 +757,16 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                        m_primarySubViewport.y(),
                        m_primarySubViewport.width(),
                        m_primarySubViewport.height());
+
+            validateDepthPass(projectionViewMatrix, depthProjectionViewMatrix);
         }
 #endif
-        pointSelectionShader = m_selectionShader;
+        pointSelectionShader = selectionPassShader();
     } else {
         pointSelectionShader = m_pointShader;
     }
 
-    ShaderHelper *selectionShader = m_selectionShader;
+    ShaderHelper *selectionShader = selectionPassShader();
 
     // Do position mapping when necessary
     if (m_graphPositionQueryPending) {
@@ -696,10 +776,13 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
     }
 
     // Skip selection mode drawing if we have no selection mode
-    if (m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
+    const bool selectionQuery = m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
             && SelectOnScene == m_selectionState
             && (m_visibleSeriesCount > 0 || !m_customRenderCache.isEmpty())
-            && m_selectionTexture) {
+            && m_selectionTexture;
+    if (selectionQuery && !isSelectionPassValid(projectionViewMatrix)) {
+        FrameStatisticsCollector::Scope statisticsScope(
+                    FrameStatisticsCollector::PhaseSelectionPass);
         // Draw dots to selection buffer
         glBindFramebuffer(GL_FRAMEBUFFER, m_selectionFrameBuffer);
         glViewport(0, 0,
@@ -707,8 +790,18 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                    m_primarySubViewport.height());
 
         glEnable(GL_DEPTH_TEST); // Needed, otherwise the depth render buffer is not used
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // Set clear color to white (= skipColor)
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Needed for clearing the frame buffer
+#if !QT_CONFIG(opengles2)
+        if (m_integerSelectionBuffer) {
+            // Integer buffers cannot be cleared with glClear
+            static const GLuint skipId[] = {255, 255, 255, 255};
+            m_context->extraFunctions()->glClearBufferuiv(GL_COLOR, 0, skipId);
+            glClear(GL_DEPTH_BUFFER_BIT);
+        } else
+#endif
+        {
+            glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // Set clear color to white (= skipColor)
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
         glDisable(GL_DITHER); // disable dithering, it may affect colors if enabled
 
         bool previousDrawingPoints = false;
@@ -737,14 +830,38 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     if (drawingPoints)
                         selectionShader = pointSelectionShader;
                     else
-                        selectionShader = m_selectionShader;
+                        selectionShader = selectionPassShader();
 
                     selectionShader->bind();
                 }
                 cache->setSelectionIndexOffset(totalIndex);
+                if (instancing && !drawingPoints) {
+                    ScatterInstanceBufferHelper *instances = cache->bufferInstances();
+                    if (instances && instances->indexCount()) {
+                        ShaderHelper *instancedShader = m_selectionInstancedShader;
+                        if (m_integerSelectionBuffer)
+                            instancedShader = m_selectionIdInstancedShader;
+                        instancedShader->bind();
+                        instancedShader->setUniformValue(instancedShader->MVP(),
+                                                         projectionViewMatrix);
+                        instancedShader->setUniformValue(instancedShader->modelScale(),
+                                                         modelScaler);
+                        if (m_integerSelectionBuffer) {
+                            instancedShader->setUniformValue(
+                                        instancedShader->color(),
+                                        indexToSelectionId(totalIndex) / 255.0f);
+                        } else {
+                            instancedShader->setUniformValue(instancedShader->indexOffset(),
+                                                             GLfloat(totalIndex));
+                        }
+                        m_drawer->drawObjectInstanced(instancedShader, dotObj, instances);
+                        selectionShader->bind();
+                    }
+                    totalIndex += renderArraySize;
+                    continue;
+                }
                 for (int dot = 0; dot < renderArraySize; dot++) {
-                    const ScatterRenderItem &item = renderArray.at(dot);
-                    if (!item.isVisible()) {
+                    if (!renderArray.isVisible(dot)) {
                         totalIndex++;
                         continue;
                     }
@@ -752,16 +869,19 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     QMatrix4x4 modelMatrix;
                     QMatrix4x4 MVPMatrix;
 
-                    modelMatrix.translate(item.translation());
+                    modelMatrix.translate(renderArray.translation(dot));
                     if (!drawingPoints) {
-                        if (!seriesRotation.isIdentity() || !item.rotation().isIdentity())
-                            modelMatrix.rotate(seriesRotation * item.rotation());
+                        const QQuaternion &rotation = renderArray.rotation(dot);
+                        if (!seriesRotation.isIdentity() || !rotation.isIdentity())
+                            modelMatrix.rotate(seriesRotation * rotation);
                         modelMatrix.scale(modelScaler);
                     }
 
                     MVPMatrix = projectionViewMatrix * modelMatrix;
 
-                    QVector4D dotColor = indexToSelectionColor(totalIndex++);
+                    QVector4D dotColor = m_integerSelectionBuffer
+                            ? indexToSelectionId(totalIndex++)
+                            : indexToSelectionColor(totalIndex++);
                     dotColor /= 255.0f;
 
                     selectionShader->setUniformValue(selectionShader->MVP(), MVPMatrix);
@@ -775,7 +895,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             }
         }
 
-        Abstract3DRenderer::drawCustomItems(RenderingSelection, m_selectionShader,
+        Abstract3DRenderer::drawCustomItems(RenderingSelection, selectionPassShader(),
                                             viewMatrix, projectionViewMatrix,
                                             depthProjectionViewMatrix, m_depthTexture,
                                             m_shadowQualityToShader);
@@ -783,14 +903,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
         drawLabels(true, activeCamera, viewMatrix, projectionMatrix);
 
         glEnable(GL_DITHER);
-
-        // Read color under cursor
-        QVector4D clickedColor = Utils::getSelection(m_inputPosition,
-                                                     m_viewport.height());
-        selectionColorToSeriesAndIndex(clickedColor, m_clickedIndex, m_clickedSeries);
-        m_clickResolved = true;
-
-        emit needRender();
+        validateSelectionPass(projectionViewMatrix);
 
         // Revert to original fbo and viewport
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
@@ -800,11 +913,23 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                    m_primarySubViewport.height());
     }
 
+    if (selectionQuery) {
+        // Read color under cursor
+        QVector4D clickedColor;
+        if (readSelection(m_selectionFrameBuffer, defaultFboHandle, clickedColor,
+                          m_integerSelectionBuffer)) {
+            selectionColorToSeriesAndIndex(clickedColor, m_clickedIndex, m_clickedSeries);
+            m_clickResolved = true;
+        }
+
+        emit needRender();
+    }
+
     // Draw dots
     ShaderHelper *dotShader = 0;
     GLuint gradientTexture = 0;
     bool dotSelectionFound = false;
-    ScatterRenderItem *selectedItem(0);
+    AbstractRenderItem selectedItem;
     QVector4D baseColor;
     QVector4D dotColor;
 
@@ -855,6 +980,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             bool useColor = colorStyleIsUniform || drawingPoints;
             bool rangeGradientPoints = drawingPoints
                     && (colorStyle == Q3DTheme::ColorStyleRangeGradient);
+            bool instancedMesh = instancing && !drawingPoints;
             float itemSize = cache->itemSize() / itemScaler;
             if (itemSize == 0.0f)
                 itemSize = m_dotSizeScale;
@@ -871,6 +997,10 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                         || (!drawingPoints && cache->bufferObject()->indexCount() == 0))) {
                 continue;
             }
+            if (instancedMesh
+                    && (!cache->bufferInstances() || cache->bufferInstances()->indexCount() == 0)) {
+                continue;
+            }
 
             // Rebind shader if it has changed
             if (drawingPoints != previousDrawingPoints
@@ -916,13 +1046,61 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                 baseColor = cache->baseColor();
                 dotColor = baseColor;
             }
+            if (instancedMesh) {
+                // Draw all items of the series with a single instanced call
+                ShaderHelper *instancedShader = colorStyleIsUniform
+                        ? m_dotInstancedShader : m_dotGradientInstancedShader;
+                instancedShader->bind();
+                instancedShader->setUniformValue(instancedShader->lightP(), lightPos);
+                instancedShader->setUniformValue(instancedShader->view(), viewMatrix);
+                instancedShader->setUniformValue(instancedShader->ambientS(),
+                                                 m_cachedTheme->ambientLightStrength());
+                instancedShader->setUniformValue(instancedShader->lightColor(), lightColor);
+                instancedShader->setUniformValue(instancedShader->modelScale(), modelScaler);
+#ifdef SHOW_DEPTH_TEXTURE_SCENE
+                instancedShader->setUniformValue(instancedShader->MVP(),
+                                                 depthProjectionViewMatrix);
+#else
+                instancedShader->setUniformValue(instancedShader->MVP(), projectionViewMatrix);
+#endif
+                if (colorStyleIsUniform) {
+                    instancedShader->setUniformValue(instancedShader->color(), baseColor);
+                } else {
+                    // Range gradient positions come in instance UVs, so both gradient styles
+                    // can use the object gradient mapping
+                    instancedShader->setUniformValue(instancedShader->gradientMin(), 0.0f);
+                    instancedShader->setUniformValue(instancedShader->gradientHeight(), 0.5f);
+                    gradientTexture = cache->baseGradientTexture();
+                }
+                if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone && !m_isOpenGLES) {
+                    // Set shadow shader bindings
+                    instancedShader->setUniformValue(instancedShader->shadowQ(),
+                                                     m_shadowQualityToShader);
+                    instancedShader->setUniformValue(instancedShader->depth(),
+                                                     depthProjectionViewMatrix);
+                    instancedShader->setUniformValue(instancedShader->lightS(),
+                                                     m_cachedTheme->lightStrength() / 10.0f);
+                    m_drawer->drawObjectInstanced(instancedShader, dotObj,
+                                                  cache->bufferInstances(), gradientTexture,
+                                                  m_depthTexture);
+                } else {
+                    // Set shadowless shader bindings
+                    instancedShader->setUniformValue(instancedShader->lightS(),
+                                                     m_cachedTheme->lightStrength());
+                    m_drawer->drawObjectInstanced(instancedShader, dotObj,
+                                                  cache->bufferInstances(), gradientTexture);
+                }
+                dotShader->bind();
+            }
+
             int loopCount = 1;
-            if (optimizationDefault)
+            if (instancedMesh)
+                loopCount = 0;
+            else if (optimizationDefault)
                 loopCount = renderArraySize;
 
             for (int i = 0; i < loopCount; i++) {
-                ScatterRenderItem &item = renderArray[i];
-                if (!item.isVisible() && optimizationDefault)
+                if (optimizationDefault && !renderArray.isVisible(i))
                     continue;
 
                 QMatrix4x4 modelMatrix;
@@ -930,10 +1108,11 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                 QMatrix4x4 itModelMatrix;
 
                 if (optimizationDefault) {
-                    modelMatrix.translate(item.translation());
+                    modelMatrix.translate(renderArray.translation(i));
                     if (!drawingPoints) {
-                        if (!seriesRotation.isIdentity() || !item.rotation().isIdentity()) {
-                            QQuaternion totalRotation = seriesRotation * item.rotation();
+                        const QQuaternion &rotation = renderArray.rotation(i);
+                        if (!seriesRotation.isIdentity() || !rotation.isIdentity()) {
+                            QQuaternion totalRotation = seriesRotation * rotation;
                             modelMatrix.rotate(totalRotation);
                             itModelMatrix.rotate(totalRotation);
                         }
@@ -951,7 +1130,8 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     if (rangeGradientPoints) {
                         // Drawing points with range gradient
                         // Get color from gradient based on items y position converted to percent
-                        int position = ((item.translation().y() + m_scaleY) * rangeGradientYScaler) * gradientImageHeight;
+                        int position = ((renderArray.translation(i).y() + m_scaleY)
+                                        * rangeGradientYScaler) * gradientImageHeight;
                         position = qMin(maxGradientPositition, position); // clamp to edge
                         dotColor = Utils::vectorFromColor(
                                     cache->gradientImage().pixel(0, position));
@@ -972,8 +1152,8 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     else
                         gradientTexture = cache->singleHighlightGradientTexture();
                     lightStrength = m_cachedTheme->highlightLightStrength();
-                    // Save the reference to the item to be used in label drawing
-                    selectedItem = &item;
+                    // Save the position of the item to be used in label drawing
+                    selectedItem.setTranslation(renderArray.translation(i));
                     dotSelectionFound = true;
                     // Save selected item size (adjusted with font size) for selection label
                     // positioning
@@ -992,7 +1172,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     dotShader->setUniformValue(dotShader->color(), dotColor);
                 } else if (colorStyle == Q3DTheme::ColorStyleRangeGradient) {
                     dotShader->setUniformValue(dotShader->gradientMin(),
-                                               (item.translation().y() + m_scaleY)
+                                               (renderArray.translation(i).y() + m_scaleY)
                                                * rangeGradientYScaler);
                 }
                 if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone && !m_isOpenGLES) {
@@ -1038,14 +1218,19 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             }
 
 
-            // Draw the selected item on static optimization
-            if (!optimizationDefault && selectedSeries
+            // Draw the selected item on static optimization or on top of instanced items
+            if ((!optimizationDefault || instancedMesh) && selectedSeries
                     && m_selectedItemIndex != Scatter3DController::invalidSelectionIndex()) {
-                ScatterRenderItem &item = renderArray[m_selectedItemIndex];
-                if (item.isVisible()) {
+                const int index = m_selectedItemIndex;
+                if (renderArray.isVisible(index)) {
                     ShaderHelper *selectionShader;
                     if (drawingPoints) {
                         selectionShader = pointSelectionShader;
+                    } else if (instancedMesh) {
+                        if (colorStyleIsUniform)
+                            selectionShader = m_dotShader;
+                        else
+                            selectionShader = m_dotGradientShader;
                     } else {
                         if (colorStyleIsUniform)
                             selectionShader = m_staticSelectedItemShader;
@@ -1059,10 +1244,11 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     QMatrix4x4 modelMatrix;
                     QMatrix4x4 itModelMatrix;
 
-                    modelMatrix.translate(item.translation());
+                    modelMatrix.translate(renderArray.translation(index));
                     if (!drawingPoints) {
-                        if (!seriesRotation.isIdentity() || !item.rotation().isIdentity()) {
-                            QQuaternion totalRotation = seriesRotation * item.rotation();
+                        const QQuaternion &rotation = renderArray.rotation(index);
+                        if (!seriesRotation.isIdentity() || !rotation.isIdentity()) {
+                            QQuaternion totalRotation = seriesRotation * rotation;
                             modelMatrix.rotate(totalRotation);
                             itModelMatrix.rotate(totalRotation);
                         }
@@ -1091,8 +1277,8 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     else
                         gradientTexture = cache->singleHighlightGradientTexture();
                     GLfloat lightStrength = m_cachedTheme->highlightLightStrength();
-                    // Save the reference to the item to be used in label drawing
-                    selectedItem = &item;
+                    // Save the position of the item to be used in label drawing
+                    selectedItem.setTranslation(renderArray.translation(index));
                     dotSelectionFound = true;
                     // Save selected item size (adjusted with font size) for selection label
                     // positioning
@@ -1113,9 +1299,10 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                                 // Each dot is of uniform color according to its Y-coordinate
                                 selectionShader->setUniformValue(selectionShader->gradientHeight(),
                                                                  0.0f);
-                                selectionShader->setUniformValue(selectionShader->gradientMin(),
-                                                                 (item.translation().y() + m_scaleY)
-                                                                 * rangeGradientYScaler);
+                                selectionShader->setUniformValue(
+                                            selectionShader->gradientMin(),
+                                            (renderArray.translation(index).y() + m_scaleY)
+                                            * rangeGradientYScaler);
                             }
                         }
                     }
@@ -1588,13 +1775,12 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
 
     // Handle selection clearing and selection label drawing
     if (!dotSelectionFound) {
-        // We have no ownership, don't delete. Just NULL the pointer.
-        m_selectedItem = NULL;
+        m_selectedLabelIndex = Scatter3DController::invalidSelectionIndex();
     } else {
         glDisable(GL_DEPTH_TEST);
         // Draw the selection label
         LabelItem &labelItem = selectionLabelItem();
-        if (m_selectedItem != selectedItem || m_updateLabels
+        if (m_selectedLabelIndex != m_selectedItemIndex || m_updateLabels
                 || !labelItem.textureId() || m_selectionLabelDirty) {
             QString labelText = selectionLabel();
             if (labelText.isNull() || m_selectionLabelDirty) {
@@ -1603,10 +1789,10 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                 m_selectionLabelDirty = false;
             }
             m_drawer->generateLabelItem(labelItem, labelText);
-            m_selectedItem = selectedItem;
+            m_selectedLabelIndex = m_selectedItemIndex;
         }
 
-        m_drawer->drawLabel(*selectedItem, labelItem, viewMatrix, projectionMatrix,
+        m_drawer->drawLabel(selectedItem, labelItem, viewMatrix, projectionMatrix,
                             zeroVector, identityQuaternion, selectedItemSize, m_cachedSelectionMode,
                             m_labelShader, m_labelObj, activeCamera, true, false,
                             Drawer::LabelOver);
@@ -1627,13 +1813,14 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
 void Scatter3DRenderer::drawLabels(bool drawSelection, const Q3DCamera *activeCamera,
                                    const QMatrix4x4 &viewMatrix,
                                    const QMatrix4x4 &projectionMatrix) {
+    FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseLabels);
     ShaderHelper *shader = 0;
     GLfloat alphaForValueSelection = labelValueAlpha / 255.0f;
     GLfloat alphaForRowSelection = labelRowAlpha / 255.0f;
     GLfloat alphaForColumnSelection = labelColumnAlpha / 255.0f;
     if (drawSelection) {
-        shader = m_selectionShader;
-        // m_selectionShader is already bound
+        shader = selectionPassShader();
+        // Selection shader is already bound
     } else {
         shader = m_labelShader;
         shader->bind();
@@ -2217,10 +2404,10 @@ void Scatter3DRenderer::fixMeshFileName(QString &fileName, QAbstract3DSeries::Me
     }
 }
 
-void Scatter3DRenderer::calculateTranslation(ScatterRenderItem &item)
+void Scatter3DRenderer::calculateTranslation(ScatterRenderItemArray &renderArray, int index)
 {
     // We need to normalize translations
-    const QVector3D &pos = item.position();
+    const QVector3D &pos = renderArray.position(index);
     float xTrans;
     float yTrans = m_axisCacheY.positionAt(pos.y());
     float zTrans;
@@ -2230,7 +2417,7 @@ void Scatter3DRenderer::calculateTranslation(ScatterRenderItem &item)
         xTrans = m_axisCacheX.positionAt(pos.x());
         zTrans = m_axisCacheZ.positionAt(pos.z());
     }
-    item.setTranslation(QVector3D(xTrans, yTrans, zTrans));
+    renderArray.setTranslation(index, QVector3D(xTrans, yTrans, zTrans));
 }
 
 void Scatter3DRenderer::calculateSceneScalingFactors()
@@ -2300,6 +2487,13 @@ void Scatter3DRenderer::initShaders(const QString &vertexShader, const QString &
     delete m_dotShader;
     m_dotShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_dotShader->initialize();
+
+    delete m_dotInstancedShader;
+    m_dotInstancedShader = 0;
+    if (isInstancingActive()) {
+        m_dotInstancedShader = new ShaderHelper(this, instancedVertexShader(), fragmentShader);
+        m_dotInstancedShader->initialize();
+    }
 }
 
 void Scatter3DRenderer::initGradientShaders(const QString &vertexShader,
@@ -2309,6 +2503,13 @@ void Scatter3DRenderer::initGradientShaders(const QString &vertexShader,
     m_dotGradientShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_dotGradientShader->initialize();
 
+    delete m_dotGradientInstancedShader;
+    m_dotGradientInstancedShader = 0;
+    if (isInstancingActive()) {
+        m_dotGradientInstancedShader = new ShaderHelper(this, instancedVertexShader(),
+                                                        fragmentShader);
+        m_dotGradientInstancedShader->initialize();
+    }
 }
 
 void Scatter3DRenderer::initStaticSelectedItemShaders(const QString &vertexShader,
@@ -2332,6 +2533,13 @@ void Scatter3DRenderer::initSelectionShader()
     m_selectionShader = new ShaderHelper(this, QStringLiteral(":/shaders/vertexPlainColor"),
                                          QStringLiteral(":/shaders/fragmentPlainColor"));
     m_selectionShader->initialize();
+
+    if (m_integerSelectionBuffer) {
+        delete m_selectionIdShader;
+        m_selectionIdShader = new ShaderHelper(this, QStringLiteral(":/shaders/vertexSelectionId"),
+                                               QStringLiteral(":/shaders/fragmentSelectionId"));
+        m_selectionIdShader->initialize();
+    }
 }
 
 void Scatter3DRenderer::initSelectionBuffer()
@@ -2343,7 +2551,9 @@ void Scatter3DRenderer::initSelectionBuffer()
 
     m_selectionTexture = m_textureHelper->createSelectionTexture(m_primarySubViewport.size(),
                                                                  m_selectionFrameBuffer,
-                                                                 m_selectionDepthBuffer);
+                                                                 m_selectionDepthBuffer,
+                                                                 m_integerSelectionBuffer);
+    invalidateSelectionPass();
 }
 
 void Scatter3DRenderer::initDepthShader()
@@ -2366,11 +2576,13 @@ void Scatter3DRenderer::updateDepthBuffer()
             return;
 
         if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
-            m_depthTexture = m_textureHelper->createDepthTextureFrameBuffer(m_primarySubViewport.size(),
+            m_depthTextureSize = calculateShadowMapSize(m_shadowQualityMultiplier);
+            m_depthTexture = m_textureHelper->createDepthTextureFrameBuffer(m_depthTextureSize,
                                                                             m_depthFrameBuffer,
-                                                                            m_shadowQualityMultiplier);
+                                                                            1);
             if (!m_depthTexture)
                 lowerShadowQuality();
+            invalidateDepthPass();
         }
     }
 }
@@ -2386,6 +2598,61 @@ void Scatter3DRenderer::initPointShader()
     }
 }
 
+void Scatter3DRenderer::initInstancedShaders()
+{
+    delete m_depthInstancedShader;
+    m_depthInstancedShader = new ShaderHelper(this, QStringLiteral(":/shaders/vertexDepthInstanced"),
+                                              QStringLiteral(":/shaders/fragmentDepth"));
+    m_depthInstancedShader->initialize();
+
+    delete m_selectionInstancedShader;
+    m_selectionInstancedShader =
+            new ShaderHelper(this, QStringLiteral(":/shaders/vertexSelectionInstanced"),
+                             QStringLiteral(":/shaders/fragmentSelectionInstanced"));
+    m_selectionInstancedShader->initialize();
+
+    if (m_integerSelectionBuffer) {
+        delete m_selectionIdInstancedShader;
+        m_selectionIdInstancedShader =
+                new ShaderHelper(this, QStringLiteral(":/shaders/vertexSelectionIdInstanced"),
+                                 QStringLiteral(":/shaders/fragmentSelectionIdInstanced"));
+        m_selectionIdInstancedShader->initialize();
+    }
+}
+
+bool Scatter3DRenderer::isInstancingActive() const
+{
+    // Static optimization already bakes all items into a single buffer
+    return m_instancingSupported
+            && !m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic);
+}
+
+QString Scatter3DRenderer::instancedVertexShader() const
+{
+    if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone)
+        return QStringLiteral(":/shaders/vertexShadowInstanced");
+    else
+        return QStringLiteral(":/shaders/vertexInstanced");
+}
+
+void Scatter3DRenderer::updateInstanceBuffers()
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        ScatterSeriesRenderCache *cache = static_cast<ScatterSeriesRenderCache *>(baseCache);
+        if (cache->isVisible() && cache->instanceBufferDirty()
+                && cache->mesh() != QAbstract3DSeries::MeshPoint) {
+            ScatterInstanceBufferHelper *instances = cache->bufferInstances();
+            if (!instances) {
+                instances = new ScatterInstanceBufferHelper();
+                cache->setBufferInstances(instances);
+            }
+            instances->setScaleY(m_scaleY);
+            instances->load(cache);
+            cache->setInstanceBufferDirty(false);
+        }
+    }
+}
+
 void Scatter3DRenderer::initBackgroundShaders(const QString &vertexShader,
                                               const QString &fragmentShader)
 {
@@ -2404,6 +2671,17 @@ void Scatter3DRenderer::initStaticPointShaders(const QString &vertexShader,
     m_staticGradientPointShader->initialize();
 }
 
+ShaderHelper *Scatter3DRenderer::selectionPassShader() const
+{
+    return m_integerSelectionBuffer ? m_selectionIdShader : m_selectionShader;
+}
+
+// Splits the index into 16-bit halves, which survive the float uniforms intact
+QVector4D Scatter3DRenderer::indexToSelectionId(int index) const
+{
+    return QVector4D(index & 0xffff, (index >> 16) & 0xffff, 0, 0);
+}
+
 void Scatter3DRenderer::selectionColorToSeriesAndIndex(const QVector4D &color,
                                                        int &index,
                                                        QAbstract3DSeries *&series)
@@ -2435,9 +2713,11 @@ void Scatter3DRenderer::selectionColorToSeriesAndIndex(const QVector4D &color,
                     + (int(color.z()) << 16);
             m_clickedType = QAbstract3DGraph::ElementCustomItem;
         } else {
-            int totalIndex = int(color.x())
-                    + (int(color.y()) << 8)
-                    + (int(color.z()) << 16);
+            int totalIndex;
+            if (m_integerSelectionBuffer)
+                totalIndex = int(color.x()) + (int(color.y()) << 16);
+            else
+                totalIndex = int(color.x()) + (int(color.y()) << 8) + (int(color.z()) << 16);
             // Find the series and adjust the index accordingly
             foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
                 if (baseCache->isVisible()) {
@@ -2462,21 +2742,76 @@ void Scatter3DRenderer::selectionColorToSeriesAndIndex(const QVector4D &color,
 }
 
 void Scatter3DRenderer::updateRenderItem(const QScatterDataItem &dataItem,
-                                         ScatterRenderItem &renderItem)
+                                         ScatterRenderItemArray &renderArray, int index)
+{
+    if (updateRenderItemState(dataItem, renderArray, index))
+        calculateTranslation(renderArray, index);
+}
+
+// Updates the position, visibility, and rotation of the item. Returns true if the item is
+// within the axis ranges and needs its translation calculated.
+bool Scatter3DRenderer::updateRenderItemState(const QScatterDataItem &dataItem,
+                                              ScatterRenderItemArray &renderArray, int index)
 {
     QVector3D dotPos = dataItem.position();
     if ((dotPos.x() >= m_axisCacheX.min() && dotPos.x() <= m_axisCacheX.max() )
             && (dotPos.y() >= m_axisCacheY.min() && dotPos.y() <= m_axisCacheY.max())
             && (dotPos.z() >= m_axisCacheZ.min() && dotPos.z() <= m_axisCacheZ.max())) {
-        renderItem.setPosition(dotPos);
-        renderItem.setVisible(true);
+        renderArray.setPosition(index, dotPos);
+        renderArray.setVisible(index, true);
         if (!dataItem.rotation().isIdentity())
-            renderItem.setRotation(dataItem.rotation().normalized());
+            renderArray.setRotation(index, dataItem.rotation().normalized());
         else
-            renderItem.setRotation(identityQuaternion);
-        calculateTranslation(renderItem);
+            renderArray.setRotation(index, identityQuaternion);
+        return true;
     } else {
-        renderItem.setVisible(false);
+        renderArray.setVisible(index, false);
+        return false;
+    }
+}
+
+// Updates all render items of a series. Axis positions are resolved a chunk at a time with
+// the batched formatter conversion instead of one virtual call per coordinate.
+void Scatter3DRenderer::updateRenderItems(const QScatterDataArray &dataArray,
+                                          ScatterRenderItemArray &renderArray)
+{
+    float xValues[positionChunkSize];
+    float yValues[positionChunkSize];
+    float zValues[positionChunkSize];
+    const int dataSize = dataArray.size();
+    renderArray.resetRotations();
+    for (int begin = 0; begin < dataSize; begin += positionChunkSize) {
+        const int count = qMin(positionChunkSize, dataSize - begin);
+        const QScatterDataItem *dataItems = dataArray.constData() + begin;
+        for (int i = 0; i < count; i++) {
+            const QVector3D &position = dataItems[i].position();
+            xValues[i] = position.x();
+            yValues[i] = position.y();
+            zValues[i] = position.z();
+        }
+
+        m_axisCacheY.positionsAt(yValues, yValues, count);
+        if (m_polarGraph) {
+            m_axisCacheX.formatterPositionsAt(xValues, xValues, count);
+            m_axisCacheZ.formatterPositionsAt(zValues, zValues, count);
+        } else {
+            m_axisCacheX.positionsAt(xValues, xValues, count);
+            m_axisCacheZ.positionsAt(zValues, zValues, count);
+        }
+
+        for (int i = 0; i < count; i++) {
+            const int index = begin + i;
+            if (!updateRenderItemState(dataItems[i], renderArray, index))
+                continue;
+            if (m_polarGraph) {
+                float xTrans;
+                float zTrans;
+                calculatePolarXZ(xValues[i], zValues[i], xTrans, zTrans);
+                renderArray.setTranslation(index, QVector3D(xTrans, yValues[i], zTrans));
+            } else {
+                renderArray.setTranslation(index, QVector3D(xValues[i], yValues[i], zValues[i]));
+            }
+        }
     }
 }
 
@@ -34,7 +34,7 @@ class Q_DATAVISUALIZATION_EXPORT Scatter3DRenderer : public Abstract3DRenderer
 
 private:
     // Internal state
-    ScatterRenderItem *m_selectedItem; // points to renderitem array
+    int m_selectedLabelIndex; // index of the item the selection label was generated for
     bool m_updateLabels;
     ShaderHelper *m_dotShader;
     ShaderHelper *m_dotGradientShader;
@@ -45,6 +45,12 @@ private:
     ShaderHelper *m_selectionShader;
     ShaderHelper *m_backgroundShader;
     ShaderHelper *m_staticGradientPointShader;
+    ShaderHelper *m_dotInstancedShader;
+    ShaderHelper *m_dotGradientInstancedShader;
+    ShaderHelper *m_depthInstancedShader;
+    ShaderHelper *m_selectionInstancedShader;
+    ShaderHelper *m_selectionIdShader;
+    ShaderHelper *m_selectionIdInstancedShader;
     GLuint m_bgrTexture;
     GLuint m_selectionTexture;
     GLuint m_depthFrameBuffer;
@@ -59,13 +65,15 @@ private:
     ScatterSeriesRenderCache *m_selectedSeriesCache;
     ScatterSeriesRenderCache *m_oldSelectedSeriesCache;
     GLfloat m_dotSizeScale;
-    ScatterRenderItem m_dummyRenderItem;
+    AbstractRenderItem m_dummyRenderItem;
     GLfloat m_maxItemSize;
     int m_clickedIndex;
     bool m_havePointSeries;
     bool m_haveMeshSeries;
     bool m_haveUniformColorMeshSeries;
     bool m_haveGradientMeshSeries;
+    bool m_instancingSupported;
+    bool m_integerSelectionBuffer;
 
 public:
     explicit Scatter3DRenderer(Scatter3DController *controller);
@@ -122,12 +130,23 @@ private:
     void initDepthShader();
     void updateDepthBuffer() override;
     void initPointShader();
-    void calculateTranslation(ScatterRenderItem &item);
+    void initInstancedShaders();
+    inline bool isInstancingActive() const;
+    QString instancedVertexShader() const;
+    void updateInstanceBuffers();
+    void calculateTranslation(ScatterRenderItemArray &renderArray, int index);
     void calculateSceneScalingFactors();
 
+    inline ShaderHelper *selectionPassShader() const;
+    QVector4D indexToSelectionId(int index) const;
     void selectionColorToSeriesAndIndex(const QVector4D &color, int &index,
                                         QAbstract3DSeries *&series);
-    inline void updateRenderItem(const QScatterDataItem &dataItem, ScatterRenderItem &renderItem);
+    inline void updateRenderItem(const QScatterDataItem &dataItem,
+                                 ScatterRenderItemArray &renderArray, int index);
+    inline bool updateRenderItemState(const QScatterDataItem &dataItem,
+                                      ScatterRenderItemArray &renderArray, int index);
+    void updateRenderItems(const QScatterDataArray &dataArray,
+                           ScatterRenderItemArray &renderArray);
 
     Q_DISABLE_COPY(Scatter3DRenderer)
 };
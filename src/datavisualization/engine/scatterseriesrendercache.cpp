@@ -4,6 +4,7 @@
 #include "scatterseriesrendercache_p.h"
 #include "scatterobjectbufferhelper_p.h"
 #include "scatterpointbufferhelper_p.h"
+#include "scatterinstancebufferhelper_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -17,7 +18,8 @@ ScatterSeriesRenderCache::ScatterSeriesRenderCache(QAbstract3DSeries *series,
       m_oldMeshFileName(QString()),
       m_scatterBufferObj(0),
       m_scatterBufferPoints(0),
-      m_visibilityChanged(false)
+      m_scatterBufferInstances(0),
+      m_instanceBufferDirty(true)
 {
 }
 
@@ -25,13 +27,23 @@ ScatterSeriesRenderCache::~ScatterSeriesRenderCache()
 {
     delete m_scatterBufferObj;
     delete m_scatterBufferPoints;
+    delete m_scatterBufferInstances;
 }
 
 void ScatterSeriesRenderCache::cleanup(TextureHelper *texHelper)
 {
     m_renderArray.clear();
+    m_stagingArena.clear();
 
     SeriesRenderCache::cleanup(texHelper);
 }
 
+void ScatterStagingArena::clear()
+{
+    m_vertices = QList<QVector3D>();
+    m_normals = QList<QVector3D>();
+    m_uvs = QList<QVector2D>();
+    m_indices = QList<GLuint>();
+}
+
 QT_END_NAMESPACE
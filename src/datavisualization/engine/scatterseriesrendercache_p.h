@@ -18,11 +18,40 @@
 #include "seriesrendercache_p.h"
 #include "qscatter3dseries_p.h"
 #include "scatterrenderitem_p.h"
+#include <QtGui/QVector2D>
 
 QT_BEGIN_NAMESPACE
 
 class ScatterObjectBufferHelper;
 class ScatterPointBufferHelper;
+class ScatterInstanceBufferHelper;
+
+// Grow-only scratch storage for building static optimization buffers. Storage is reused
+// between loads, so repeated full loads of the same series do not reallocate.
+class ScatterStagingArena
+{
+public:
+    inline QVector3D *vertices(int count) { return reserve(m_vertices, count); }
+    inline QVector3D *normals(int count) { return reserve(m_normals, count); }
+    inline QVector2D *uvs(int count) { return reserve(m_uvs, count); }
+    inline GLuint *indices(int count) { return reserve(m_indices, count); }
+
+    void clear();
+
+private:
+    template <typename T>
+    T *reserve(QList<T> &list, int count)
+    {
+        if (list.size() < count)
+            list.resize(count);
+        return list.data();
+    }
+
+    QList<QVector3D> m_vertices;
+    QList<QVector3D> m_normals;
+    QList<QVector2D> m_uvs;
+    QList<GLuint> m_indices;
+};
 
 class ScatterSeriesRenderCache : public SeriesRenderCache
 {
@@ -48,10 +77,12 @@ public:
     inline ScatterObjectBufferHelper *bufferObject() const { return m_scatterBufferObj; }
     inline void setBufferPoints(ScatterPointBufferHelper *object) { m_scatterBufferPoints = object; }
     inline ScatterPointBufferHelper *bufferPoints() const { return m_scatterBufferPoints; }
+    inline void setBufferInstances(ScatterInstanceBufferHelper *object) { m_scatterBufferInstances = object; }
+    inline ScatterInstanceBufferHelper *bufferInstances() const { return m_scatterBufferInstances; }
+    inline void setInstanceBufferDirty(bool state) { m_instanceBufferDirty = state; }
+    inline bool instanceBufferDirty() const { return m_instanceBufferDirty; }
     inline QList<int> &updateIndices() { return m_updateIndices; }
-    inline QList<int> &bufferIndices() { return m_bufferIndices; }
-    inline void setVisibilityChanged(bool changed) { m_visibilityChanged = changed; }
-    inline bool visibilityChanged() const { return m_visibilityChanged; }
+    inline ScatterStagingArena &stagingArena() { return m_stagingArena; }
 
 protected:
     ScatterRenderItemArray m_renderArray;
@@ -62,9 +93,10 @@ protected:
     QString m_oldMeshFileName; // Used to detect if full buffer change needed
     ScatterObjectBufferHelper *m_scatterBufferObj;
     ScatterPointBufferHelper *m_scatterBufferPoints;
+    ScatterInstanceBufferHelper *m_scatterBufferInstances;
+    bool m_instanceBufferDirty; // Used to detect if full instance buffer reload is needed
     QList<int> m_updateIndices; // Used as temporary cache during item updates
-    QList<int> m_bufferIndices; // Cache for mapping renderarray to mesh buffer
-    bool m_visibilityChanged; // Used to detect if full buffer change needed
+    ScatterStagingArena m_stagingArena;
 };
 
 QT_END_NAMESPACE
@@ -193,7 +193,7 @@ void SelectionPointer::renderSelectionLabel(GLuint defaultFboHandle, bool useOrt
     m_labelShader->setUniformValue(m_labelShader->MVP(), MVPMatrix);
 
     // Draw the object
-    m_drawer->drawObject(m_labelShader, m_labelObj, m_labelItem.textureId());
+    m_drawer->drawLabelGlyphs(m_labelShader, m_labelItem);
 
     // Release shader
     glUseProgram(0);
@@ -0,0 +1,17 @@
+uniform highp mat4 MVP;
+uniform highp vec3 modelScale;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec4 instancePosition;
+attribute highp vec4 instanceRotation;
+
+highp vec3 rotateByQuaternion(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * modelScale * instancePosition.w;
+    highp vec3 position_wrld = instancePosition.xyz
+            + rotateByQuaternion(instanceRotation, scaledPosition);
+    gl_Position = MVP * vec4(position_wrld, 1.0);
+}
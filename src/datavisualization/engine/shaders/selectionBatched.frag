@@ -0,0 +1,10 @@
+uniform highp vec4 color_mdl;
+
+varying highp vec2 UV;
+
+void main() {
+    // Row and column come per vertex, series index and alpha from the uniform color
+    if (UV.x < 0.0)
+        discard;
+    gl_FragColor = vec4(UV, color_mdl.z, color_mdl.w);
+}
@@ -0,0 +1,10 @@
+#version 330
+
+// Given in the same scale as colors of 8-bit selection buffers, but channels can exceed 255
+uniform highp vec4 color_mdl;
+
+out uvec4 selectionId;
+
+void main() {
+    selectionId = uvec4(round(color_mdl * 255.0));
+}
@@ -0,0 +1,9 @@
+#version 330
+
+uniform highp mat4 MVP;
+
+in highp vec3 vertexPosition_mdl;
+
+void main() {
+    gl_Position = MVP * vec4(vertexPosition_mdl, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 330
+
+flat in uvec4 instanceSelectionId;
+
+out uvec4 selectionId;
+
+void main() {
+    selectionId = instanceSelectionId;
+}
@@ -0,0 +1,28 @@
+#version 330
+
+uniform highp mat4 MVP;
+uniform highp vec3 modelScale;
+// Id of the first instance, see Scatter3DRenderer::indexToSelectionId
+uniform highp vec4 color_mdl;
+
+in highp vec3 vertexPosition_mdl;
+in highp vec4 instancePosition;
+in highp vec4 instanceRotation;
+
+flat out uvec4 instanceSelectionId;
+
+highp vec3 rotateByQuaternion(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * modelScale * instancePosition.w;
+    highp vec3 position_wrld = instancePosition.xyz
+            + rotateByQuaternion(instanceRotation, scaledPosition);
+    gl_Position = MVP * vec4(position_wrld, 1.0);
+
+    // Instances are buffered in item order, so the instance id is the item index
+    uvec4 firstId = uvec4(round(color_mdl * 255.0));
+    uint index = firstId.x + (firstId.y << 16) + uint(gl_InstanceID);
+    instanceSelectionId = uvec4(index & 0xffffu, index >> 16, 0u, 0u);
+}
@@ -0,0 +1,5 @@
+varying highp vec4 selectionColor;
+
+void main() {
+    gl_FragColor = selectionColor;
+}
@@ -0,0 +1,28 @@
+uniform highp mat4 MVP;
+uniform highp vec3 modelScale;
+uniform highp float indexOffset;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec4 instancePosition;
+attribute highp vec4 instanceRotation;
+attribute highp float instanceIndex;
+
+varying highp vec4 selectionColor;
+
+highp vec3 rotateByQuaternion(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * modelScale * instancePosition.w;
+    highp vec3 position_wrld = instancePosition.xyz
+            + rotateByQuaternion(instanceRotation, scaledPosition);
+    gl_Position = MVP * vec4(position_wrld, 1.0);
+
+    // Same encoding as Abstract3DRenderer::indexToSelectionColor
+    highp float index = indexOffset + instanceIndex;
+    highp float red = mod(index, 256.0);
+    highp float green = mod(floor(index / 256.0), 256.0);
+    highp float blue = floor(index / 65536.0);
+    selectionColor = vec4(red, green, blue, 0.0) / 255.0;
+}
@@ -12,12 +12,38 @@ uniform highp float alphaMultiplier;
 uniform highp int preserveOpacity;
 uniform highp vec3 minBounds;
 uniform highp vec3 maxBounds;
+uniform highp sampler3D brickSampler;
+uniform highp vec3 brickExtent; // Zero if there is no brick texture
+uniform highp vec3 brickScale;
 
 // Ray traveling straight through a single 'alpha thickness' applies 100% of the encountered alpha.
 // Rays traveling shorter distances apply a fraction. This is used to normalize the alpha over
 // entire volume, regardless of texture dimensions
 const highp float alphaThicknesses = 32.0;
 
+// Rays stop once the remaining opacity is too small to show
+const highp float opacityThreshold = 0.002;
+
+// Returns the next cell edges along each axis the ray is about to cross, offset slightly past
+// the edges to avoid artifacts from rounding errors.
+highp vec3 edgesAhead(highp vec3 position, highp vec3 ray, highp vec3 extent, highp vec3 offset)
+{
+    highp vec3 edges = floor(position / extent) * extent;
+    if (ray.x > 0.0)
+        edges.x += extent.x + offset.x;
+    else
+        edges.x -= offset.x;
+    if (ray.y > 0.0)
+        edges.y += extent.y + offset.y;
+    else
+        edges.y -= offset.y;
+    if (ray.z > 0.0)
+        edges.z += extent.z + offset.z;
+    else
+        edges.z -= offset.z;
+    return edges;
+}
+
 void main() {
     vec3 rayStart = pos;
 
@@ -67,35 +93,35 @@ void main() {
     highp float extraAlphaMultiplier = fullDist * alphaThicknesses * alphaMultiplier;
 
     // nextEdges vector indicates the next edges of the texel boundaries along each axis that
-    // the ray is about to cross. The first edges are offset by a fraction of a texel to
-    // avoid artifacts from rounding errors later.
-    highp vec3 nextEdges = vec3(floor(curPos.x / textureDimensions.x) * textureDimensions.x,
-                                floor(curPos.y / textureDimensions.y) * textureDimensions.y,
-                                floor(curPos.z / textureDimensions.z) * textureDimensions.z);
+    // the ray is about to cross.
+    highp vec3 textureOffset = textureDimensions * 0.001;
+    highp vec3 nextEdges = edgesAhead(curPos, ray, textureDimensions, textureOffset);
 
     highp vec3 textureSteps = textureDimensions;
-    highp vec3 textureOffset = textureDimensions * 0.001;
-    if (ray.x > 0) {
-        nextEdges.x += textureDimensions.x + textureOffset.x;
-    } else {
-        nextEdges.x -= textureOffset.x;
+    if (ray.x <= 0.0)
         textureSteps.x = -textureDimensions.x;
-    }
-    if (ray.y > 0) {
-        nextEdges.y += textureDimensions.y + textureOffset.y;
-    } else {
-        nextEdges.y -= textureOffset.y;
+    if (ray.y <= 0.0)
         textureSteps.y = -textureDimensions.y;
-    }
-    if (ray.z > 0) {
-        nextEdges.z += textureDimensions.z + textureOffset.z;
-    } else {
-        nextEdges.z -= textureOffset.z;
+    if (ray.z <= 0.0)
         textureSteps.z = -textureDimensions.z;
-    }
+
+    bool skipEmpty = brickExtent.x > 0.0;
 
     // Raytrace into volume, need to sample pixels along the eye ray until we hit opacity 1
     for (int i = 0; i < sampleCount; i++) {
+        if (skipEmpty && texture3D(brickSampler, curPos * brickScale).r == 0.0) {
+            // Nothing visible in this brick, so jump straight to where the ray leaves it
+            highp vec3 brickDelta = abs(edgesAhead(curPos, ray, brickExtent, textureOffset)
+                                        - curPos) * invAbsRay;
+            highp float skipSize = min(brickDelta.x, min(brickDelta.y, brickDelta.z));
+            curPos += skipSize * ray;
+            curLen += skipSize;
+            nextEdges = edgesAhead(curPos, ray, textureDimensions, textureOffset);
+            if (curLen >= 1.0)
+                break;
+            continue;
+        }
+
         curColor = texture3D(textureSampler, curPos);
         if (color8Bit != 0)
             curColor = colorIndex[int(curColor.r * 255.0)];
@@ -139,10 +165,13 @@ void main() {
             destColor.rgb += curRgb;
         }
 
-        if (curLen >= 1.0 || totalOpacity <= 0.0)
+        if (curLen >= 1.0 || totalOpacity <= opacityThreshold)
             break;
     }
 
+    if (totalOpacity <= opacityThreshold)
+        totalOpacity = 0.0;
+
     if (totalOpacity == 1.0)
         discard;
 
@@ -12,6 +12,9 @@ uniform highp float alphaMultiplier;
 uniform highp int preserveOpacity;
 uniform highp vec3 minBounds;
 uniform highp vec3 maxBounds;
+uniform highp sampler3D brickSampler;
+uniform highp vec3 brickExtent; // Zero if there is no brick texture
+uniform highp vec3 brickScale;
 
 // Ray traveling straight through a single 'alpha thickness' applies 100% of the encountered alpha.
 // Rays traveling shorter distances apply a fraction. This is used to normalize the alpha over
@@ -19,6 +22,29 @@ uniform highp vec3 maxBounds;
 const highp float alphaThicknesses = 32.0;
 const highp float SQRT3 = 1.73205081;
 
+// Rays stop once the remaining opacity is too small to show
+const highp float opacityThreshold = 0.002;
+
+// Returns the next cell edges along each axis the ray is about to cross, offset slightly past
+// the edges to avoid artifacts from rounding errors.
+highp vec3 edgesAhead(highp vec3 position, highp vec3 ray, highp vec3 extent, highp vec3 offset)
+{
+    highp vec3 edges = floor(position / extent) * extent;
+    if (ray.x > 0.0)
+        edges.x += extent.x + offset.x;
+    else
+        edges.x -= offset.x;
+    if (ray.y > 0.0)
+        edges.y += extent.y + offset.y;
+    else
+        edges.y -= offset.y;
+    if (ray.z > 0.0)
+        edges.z += extent.z + offset.z;
+    else
+        edges.z -= offset.z;
+    return edges;
+}
+
 void main() {
     vec3 rayStart = pos;
     highp vec3 startBounds = minBounds;
@@ -67,8 +93,25 @@ void main() {
 
     highp float extraAlphaMultiplier = stepSize * alphaThicknesses * alphaMultiplier;
 
+    bool skipEmpty = brickExtent.x > 0.0;
+    highp vec3 invAbsRay = 1.0 / abs(ray);
+    highp vec3 brickOffset = brickExtent * 0.001;
+
     // Raytrace into volume, need to sample pixels along the eye ray until we hit opacity 1
     for (int i = 0; i < sampleCount; i++) {
+        if (skipEmpty && texture3D(brickSampler, curPos * brickScale).r == 0.0) {
+            // Nothing visible in this brick, so advance whole steps until the ray leaves it
+            highp vec3 brickDelta = abs(edgesAhead(curPos, ray, brickExtent, brickOffset)
+                                        - curPos) * invAbsRay;
+            highp float skipSize = min(brickDelta.x, min(brickDelta.y, brickDelta.z));
+            highp float skipSteps = max(1.0, ceil(skipSize * fullDist / stepSize));
+            curPos += skipSteps * step;
+            curLen += skipSteps * stepSize;
+            if (curLen >= fullDist)
+                break;
+            continue;
+        }
+
         curColor = texture3D(textureSampler, curPos);
         if (color8Bit != 0)
             curColor = colorIndex[int(curColor.r * 255.0)];
@@ -93,10 +136,13 @@ void main() {
         }
         curPos += step;
         curLen += stepSize;
-        if (curLen >= fullDist || totalOpacity <= 0.0)
+        if (curLen >= fullDist || totalOpacity <= opacityThreshold)
             break;
     }
 
+    if (totalOpacity <= opacityThreshold)
+        totalOpacity = 0.0;
+
     if (totalOpacity == 1.0)
         discard;
 
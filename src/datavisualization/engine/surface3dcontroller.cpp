@@ -51,19 +51,37 @@ void Surface3DController::synchDataToRenderer()
     if (!isInitialized())
         return;
 
+    FrameStatisticsCollector::Scope statisticsScope(frameStatisticsCollector(),
+                                                    FrameStatisticsCollector::PhaseSynch);
+
     Abstract3DController::synchDataToRenderer();
 
     // Notify changes to renderer
     if (m_changeTracker.rowsChanged) {
-        m_renderer->updateRows(m_changedRows);
+        // Rows of fully updated series are reloaded by the data update already
+        if (m_changedRowTracker.hasFullUpdates()) {
+            m_changedRows.removeIf([this](const ChangeRow &row) {
+                return m_changedRowTracker.isFullUpdate(row.series);
+            });
+        }
+        if (!m_changedRows.isEmpty())
+            m_renderer->updateRows(m_changedRows);
         m_changeTracker.rowsChanged = false;
         m_changedRows.clear();
+        m_changedRowTracker.clear();
     }
 
     if (m_changeTracker.itemChanged) {
-        m_renderer->updateItems(m_changedItems);
+        if (m_changedItemTracker.hasFullUpdates()) {
+            m_changedItems.removeIf([this](const ChangeItem &item) {
+                return m_changedItemTracker.isFullUpdate(item.series);
+            });
+        }
+        if (!m_changedItems.isEmpty())
+            m_renderer->updateItems(m_changedItems);
         m_changeTracker.itemChanged = false;
         m_changedItems.clear();
+        m_changedItemTracker.clear();
     }
 
     if (m_changeTracker.selectedPointChanged) {
@@ -153,6 +171,9 @@ void Surface3DController::removeSeries(QAbstract3DSeries *series)
 
     Abstract3DController::removeSeries(series);
 
+    m_changedRowTracker.remove(static_cast<QSurface3DSeries *>(series));
+    m_changedItemTracker.remove(static_cast<QSurface3DSeries *>(series));
+
     if (m_selectedSeries == series)
         setSelectedPoint(invalidSelectionPosition(), 0, false);
 
@@ -255,15 +276,15 @@ void Surface3DController::setSelectedPoint(const QPoint &position, QSurface3DSer
             float axisMinZ = m_axisZ->min();
             float axisMaxZ = m_axisZ->max();
 
-            QSurfaceDataItem item = proxy->array()->at(pos.x())->at(pos.y());
-            if (item.x() < axisMinX || item.x() > axisMaxX
-                    || item.z() < axisMinZ || item.z() > axisMaxZ) {
+            QVector3D position = proxy->dptrc()->positionAt(pos.x(), pos.y());
+            if (position.x() < axisMinX || position.x() > axisMaxX
+                    || position.z() < axisMinZ || position.z() > axisMaxZ) {
                 scene()->setSlicingActive(false);
             } else if (enterSlice) {
                 scene()->setSlicingActive(true);
             }
         }
-        emitNeedRender();
+        emitNeedRedraw();
     }
 
     if (pos != m_selectedPoint || series != m_selectedSeries) {
@@ -284,7 +305,7 @@ void Surface3DController::setSelectedPoint(const QPoint &position, QSurface3DSer
         if (seriesChanged)
             emit selectedSeriesChanged(m_selectedSeries);
 
-        emitNeedRender();
+        emitNeedRedraw();
     }
 }
 
@@ -301,6 +322,7 @@ void Surface3DController::handleArrayReset()
     else
         series = static_cast<QSurface3DSeries *>(sender());
 
+    m_changedRowTracker.resize(series, series->dataProxy()->rowCount());
     if (series->isVisible()) {
         adjustAxisRanges();
         m_isDataDirty = true;
@@ -330,26 +352,22 @@ void Surface3DController::handleFlatShadingSupportedChange(bool supported)
 void Surface3DController::handleRowsChanged(int startIndex, int count)
 {
     QSurface3DSeries *series = static_cast<QSurfaceDataProxy *>(QObject::sender())->series();
-    int oldChangeCount = m_changedRows.size();
-    if (!oldChangeCount)
-        m_changedRows.reserve(count);
+    const int rowCount = series->dataProxy()->rowCount();
 
     int selectedRow = m_selectedPoint.x();
     for (int i = 0; i < count; i++) {
-        bool newItem = true;
         int candidate = startIndex + i;
-        for (int j = 0; j < oldChangeCount; j++) {
-            const ChangeRow &oldChangeItem = m_changedRows.at(j);
-            if (oldChangeItem.row == candidate && series == oldChangeItem.series) {
-                newItem = false;
-                break;
-            }
-        }
-        if (newItem) {
+        ChangedItemTracker<QSurface3DSeries>::MarkResult result =
+                m_changedRowTracker.mark(series, candidate, rowCount);
+        if (result == ChangedItemTracker<QSurface3DSeries>::MarkAdded) {
             ChangeRow newChangeItem = {series, candidate};
             m_changedRows.append(newChangeItem);
             if (series == m_selectedSeries && selectedRow == candidate)
                 series->d_ptr->markItemLabelDirty();
+        } else if (result == ChangedItemTracker<QSurface3DSeries>::MarkFullUpdate) {
+            // Most of the series changed, so reload it fully instead of row by row
+            markSeriesDataDirty(series);
+            break;
         }
     }
     if (count) {
@@ -365,18 +383,19 @@ void Surface3DController::handleItemChanged(int rowIndex, int columnIndex)
 {
     QSurfaceDataProxy *sender = static_cast<QSurfaceDataProxy *>(QObject::sender());
     QSurface3DSeries *series = sender->series();
+    const int itemCount = sender->rowCount() * sender->columnCount();
 
-    bool newItem = true;
     QPoint candidate(rowIndex, columnIndex);
-    foreach (ChangeItem item, m_changedItems) {
-        if (item.point == candidate && item.series == series) {
-            newItem = false;
-            break;
+    ChangedItemTracker<QSurface3DSeries>::MarkResult result =
+            m_changedItemTracker.mark(series, candidate, itemCount);
+    if (result == ChangedItemTracker<QSurface3DSeries>::MarkFullUpdate)
+        markSeriesDataDirty(series);
+
+    if (result != ChangedItemTracker<QSurface3DSeries>::MarkIgnored) {
+        if (result == ChangedItemTracker<QSurface3DSeries>::MarkAdded) {
+            ChangeItem newItem = {series, candidate};
+            m_changedItems.append(newItem);
         }
-    }
-    if (newItem) {
-        ChangeItem newItem = {series, candidate};
-        m_changedItems.append(newItem);
         m_changeTracker.itemChanged = true;
 
         if (series == m_selectedSeries && m_selectedPoint == candidate)
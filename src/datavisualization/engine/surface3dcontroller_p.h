@@ -15,6 +15,7 @@
 #define SURFACE3DCONTROLLER_P_H
 
 #include <private/abstract3dcontroller_p.h>
+#include <private/changeditemtracker_p.h>
 #include <private/datavisualizationglobal_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -62,6 +63,8 @@ private:
     bool m_flatShadingSupported;
     QList<ChangeItem> m_changedItems;
     QList<ChangeRow> m_changedRows;
+    ChangedItemTracker<QSurface3DSeries> m_changedItemTracker;
+    ChangedItemTracker<QSurface3DSeries> m_changedRowTracker;
     bool m_flipHorizontalGrid;
     QList<QSurface3DSeries *> m_changedTextures;
 
@@ -2,13 +2,18 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "surface3drenderer_p.h"
+#include "qsurfacedataproxy_p.h"
 #include "q3dcamera_p.h"
+#include "scenecache_p.h"
 #include "shaderhelper_p.h"
 #include "texturehelper_p.h"
 #include "utils_p.h"
 
+#include <QtCore/QSet>
 #include <QtCore/qmath.h>
 
+#include <limits>
+
 static const int ID_TO_RGBA_MASK = 0xff;
 
 QT_BEGIN_NAMESPACE
@@ -50,7 +55,8 @@ Surface3DRenderer::Surface3DRenderer(Surface3DController *controller)
       m_selectedSeries(0),
       m_clickedPosition(Surface3DController::invalidSelectionPosition()),
       m_selectionTexturesDirty(false),
-      m_noShadowTexture(0)
+      m_noShadowTexture(0),
+      m_sceneCache(0)
 {
     // Check if flat feature is supported
     ShaderHelper tester(this, QStringLiteral(":/shaders/vertexSurfaceFlat"),
@@ -93,6 +99,8 @@ void Surface3DRenderer::contextCleanup()
         m_textureHelper->deleteTexture(&m_depthTexture);
         m_textureHelper->deleteTexture(&m_selectionResultTexture);
     }
+    delete m_sceneCache;
+    m_sceneCache = 0;
 }
 
 void Surface3DRenderer::initializeOpenGL()
@@ -178,22 +186,24 @@ void Surface3DRenderer::updateData()
         SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
         if (cache->isVisible() && cache->dataDirty()) {
             const QSurface3DSeries *currentSeries = cache->series();
-            QSurfaceDataProxy *dataProxy = currentSeries->dataProxy();
-            const QSurfaceDataArray &array = *dataProxy->array();
+            const QSurfaceDataProxyPrivate *dataProxy = currentSeries->dataProxy()->dptrc();
+            const SurfaceDataView array = dataProxy->dataView();
             QSurfaceDataArray &dataArray = cache->dataArray();
             QRect sampleSpace;
 
             // Need minimum of 2x2 array to draw a surface
-            if (array.size() >= 2 && array.at(0)->size() >= 2)
+            if (array.rowCount() >= 2 && array.columnCount() >= 2)
                 sampleSpace = calculateSampleRect(array);
 
             bool dimensionsChanged = false;
-            if (cache->sampleSpace() != sampleSpace) {
+            if (cache->sampleSpace() != sampleSpace
+                    || cache->hasHeightGrid() != dataProxy->hasHeightGrid()) {
                 if (sampleSpace.width() >= 2)
                     m_selectionTexturesDirty = true;
 
                 dimensionsChanged = true;
                 cache->setSampleSpace(sampleSpace);
+                cache->setHeightGrid(SurfaceHeightGrid());
 
                 for (int i = 0; i < dataArray.size(); i++)
                     delete dataArray.at(i);
@@ -201,22 +211,25 @@ void Surface3DRenderer::updateData()
             }
 
             if (sampleSpace.width() >= 2 && sampleSpace.height() >= 2) {
-                if (dimensionsChanged) {
-                    dataArray.reserve(sampleSpace.height());
-                    for (int i = 0; i < sampleSpace.height(); i++)
-                        dataArray << new QSurfaceDataRow(sampleSpace.width());
-                }
-                for (int i = 0; i < sampleSpace.height(); i++) {
-                    for (int j = 0; j < sampleSpace.width(); j++) {
-                        (*(dataArray.at(i)))[j] = array.at(i + sampleSpace.y())->at(
-                                    j + sampleSpace.x());
+                if (dataProxy->hasHeightGrid()) {
+                    // Height grids are immutable, so the cache just shares the heights
+                    cache->setHeightGrid(dataProxy->heightGrid());
+                } else {
+                    if (dimensionsChanged) {
+                        dataArray.reserve(sampleSpace.height());
+                        for (int i = 0; i < sampleSpace.height(); i++)
+                            dataArray << new QSurfaceDataRow;
                     }
+                    for (int i = 0; i < sampleSpace.height(); i++)
+                        cache->setDataRow(i, *dataProxy->dataArray()->at(i + sampleSpace.y()));
                 }
 
+                cache->rebuildLod();
                 checkFlatSupport(cache);
                 updateObjects(cache, dimensionsChanged);
                 cache->setFlatStatusDirty(false);
             } else {
+                cache->finishPreparation(true);
                 cache->surfaceObject()->clear();
             }
             cache->setDataDirty(false);
@@ -285,13 +298,13 @@ void Surface3DRenderer::updateSurfaceTextures(QList<QSurface3DSeries *> seriesLi
         SurfaceSeriesRenderCache *cache =
                 static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(series));
         if (cache) {
+            finishPreparation(cache);
             GLuint oldTexture = cache->surfaceTexture();
             m_textureHelper->deleteTexture(&oldTexture);
             cache->setSurfaceTexture(0);
 
             const QSurface3DSeries *currentSeries = cache->series();
-            QSurfaceDataProxy *dataProxy = currentSeries->dataProxy();
-            const QSurfaceDataArray &array = *dataProxy->array();
+            const SurfaceDataView array = currentSeries->dataProxy()->dptrc()->dataView();
 
             if (!series->texture().isNull()) {
                 GLuint texId = m_textureHelper->create2DTexture(series->texture(),
@@ -302,9 +315,9 @@ void Surface3DRenderer::updateSurfaceTextures(QList<QSurface3DSeries *> seriesLi
                 cache->setSurfaceTexture(texId);
 
                 if (cache->isFlatShadingEnabled())
-                    cache->surfaceObject()->coarseUVs(array, cache->dataArray());
+                    cache->surfaceObject()->coarseUVs(array, cache->meshView());
                 else
-                    cache->surfaceObject()->smoothUVs(array, cache->dataArray());
+                    cache->surfaceObject()->smoothUVs(array, cache->meshView());
             }
         }
     }
@@ -324,9 +337,19 @@ void Surface3DRenderer::cleanCache(SeriesRenderCache *cache)
 
 void Surface3DRenderer::updateRows(const QList<Surface3DController::ChangeRow> &rows)
 {
+    bool reloadData = false;
+    QSet<SurfaceSeriesRenderCache *> reducedCaches;
     foreach (Surface3DController::ChangeRow item, rows) {
         SurfaceSeriesRenderCache *cache =
                 static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(item.series));
+        // Changes are applied to the buffers of the main object, so it must be up to date
+        finishPreparation(cache);
+        if (cache->hasHeightGrid()) {
+            // Modifying rows converts the proxy data from a height grid to rows
+            cache->setDataDirty(true);
+            reloadData = true;
+            continue;
+        }
         QSurfaceDataArray &dstArray = cache->dataArray();
         const QRect &sampleSpace = cache->sampleSpace();
 
@@ -340,14 +363,16 @@ void Surface3DRenderer::updateRows(const QList<Surface3DController::ChangeRow> &
             bool updateBuffers = false;
             int sampleSpaceTop = sampleSpace.y() + sampleSpace.height();
             int row = item.row;
-            if (row >= sampleSpace.y() && row <= sampleSpaceTop) {
+            if (row >= sampleSpace.y() && row < sampleSpaceTop) {
                 updateBuffers = true;
-                for (int j = 0; j < sampleSpace.width(); j++) {
-                    (*(dstArray.at(row - sampleSpace.y())))[j] =
-                            srcArray->at(row)->at(j + sampleSpace.x());
-                }
-
-                if (cache->isFlatShadingEnabled()) {
+                cache->setDataRow(row - sampleSpace.y(), *srcArray->at(row));
+
+                if (cache->lodLevel()) {
+                    // Reduced meshes are rebuilt once all changed rows are in the pyramid
+                    cache->updateLodRows(row - sampleSpace.y(), row - sampleSpace.y());
+                    reducedCaches.insert(cache);
+                    updateBuffers = false;
+                } else if (cache->isFlatShadingEnabled()) {
                     cache->surfaceObject()->updateCoarseRow(dstArray, row - sampleSpace.y(),
                                                             m_polarGraph);
                 } else {
@@ -360,14 +385,30 @@ void Surface3DRenderer::updateRows(const QList<Surface3DController::ChangeRow> &
         }
     }
 
-    updateSelectedPoint(m_selectedPoint, m_selectedSeries);
+    foreach (SurfaceSeriesRenderCache *cache, reducedCaches)
+        updateObjects(cache, false);
+
+    if (reloadData)
+        updateData();
+    else
+        updateSelectedPoint(m_selectedPoint, m_selectedSeries);
 }
 
 void Surface3DRenderer::updateItems(const QList<Surface3DController::ChangeItem> &points)
 {
+    bool reloadData = false;
+    QSet<SurfaceSeriesRenderCache *> reducedCaches;
     foreach (Surface3DController::ChangeItem item, points) {
         SurfaceSeriesRenderCache *cache =
                 static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(item.series));
+        // Changes are applied to the buffers of the main object, so it must be up to date
+        finishPreparation(cache);
+        if (cache->hasHeightGrid()) {
+            // Modifying items converts the proxy data from a height grid to rows
+            cache->setDataDirty(true);
+            reloadData = true;
+            continue;
+        }
         QSurfaceDataArray &dstArray = cache->dataArray();
         const QRect &sampleSpace = cache->sampleSpace();
 
@@ -384,17 +425,22 @@ void Surface3DRenderer::updateItems(const QList<Surface3DController::ChangeItem>
             // Note: Point is (row, column), samplespace is (columns x rows)
             QPoint point = item.point;
 
-            if (point.x() <= sampleSpaceTop && point.x() >= sampleSpace.y() &&
-                    point.y() <= sampleSpaceRight && point.y() >= sampleSpace.x()) {
+            if (point.x() < sampleSpaceTop && point.x() >= sampleSpace.y() &&
+                    point.y() < sampleSpaceRight && point.y() >= sampleSpace.x()) {
                 updateBuffers = true;
                 int x = point.y() - sampleSpace.x();
                 int y = point.x() - sampleSpace.y();
                 (*(dstArray.at(y)))[x] = srcArray->at(point.x())->at(point.y());
 
-                if (cache->isFlatShadingEnabled())
+                if (cache->lodLevel()) {
+                    cache->updateLodRows(y, y);
+                    reducedCaches.insert(cache);
+                    updateBuffers = false;
+                } else if (cache->isFlatShadingEnabled()) {
                     cache->surfaceObject()->updateCoarseItem(dstArray, y, x, m_polarGraph);
-                else
+                } else {
                     cache->surfaceObject()->updateSmoothItem(dstArray, y, x, m_polarGraph);
+                }
             }
             if (updateBuffers)
                 cache->surfaceObject()->uploadBuffers();
@@ -402,7 +448,13 @@ void Surface3DRenderer::updateItems(const QList<Surface3DController::ChangeItem>
 
     }
 
-    updateSelectedPoint(m_selectedPoint, m_selectedSeries);
+    foreach (SurfaceSeriesRenderCache *cache, reducedCaches)
+        updateObjects(cache, false);
+
+    if (reloadData)
+        updateData();
+    else
+        updateSelectedPoint(m_selectedPoint, m_selectedSeries);
 }
 
 void Surface3DRenderer::updateSliceDataModel(const QPoint &point)
@@ -414,10 +466,9 @@ void Surface3DRenderer::updateSliceDataModel(const QPoint &point)
         // Find axis coordinates for the selected point
         SeriesRenderCache *selectedCache =
                 m_renderCacheList.value(const_cast<QSurface3DSeries *>(m_selectedSeries));
-        QSurfaceDataArray &dataArray =
-                static_cast<SurfaceSeriesRenderCache *>(selectedCache)->dataArray();
-        QSurfaceDataItem item = dataArray.at(point.x())->at(point.y());
-        QPointF coords(item.x(), item.z());
+        QVector3D position = static_cast<SurfaceSeriesRenderCache *>(selectedCache)
+                ->dataView().position(point.x(), point.y());
+        QPointF coords(position.x(), position.z());
 
         foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
             SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
@@ -444,11 +495,11 @@ QPoint Surface3DRenderer::mapCoordsToSampleSpace(SurfaceSeriesRenderCache *cache
 {
     QPoint point(-1, -1);
 
-    QSurfaceDataArray &dataArray = cache->dataArray();
-    int top = dataArray.size() - 1;
-    int right = dataArray.at(top)->size() - 1;
-    QSurfaceDataItem itemBottomLeft = dataArray.at(0)->at(0);
-    QSurfaceDataItem itemTopRight = dataArray.at(top)->at(right);
+    const SurfaceDataView dataArray = cache->dataView();
+    int top = dataArray.rowCount() - 1;
+    int right = dataArray.columnCount() - 1;
+    QSurfaceDataItem itemBottomLeft = dataArray.item(0, 0);
+    QSurfaceDataItem itemTopRight = dataArray.item(top, right);
 
     if (itemBottomLeft.x() <= coords.x() && itemTopRight.x() >= coords.x()) {
         float modelX = coords.x() - itemBottomLeft.x();
@@ -456,7 +507,7 @@ QPoint Surface3DRenderer::mapCoordsToSampleSpace(SurfaceSeriesRenderCache *cache
         float stepX = spanX / float(right);
         int sampleX = int((modelX + (stepX / 2.0f)) / stepX);
 
-        QSurfaceDataItem item = dataArray.at(0)->at(sampleX);
+        QSurfaceDataItem item = dataArray.item(0, sampleX);
         if (!::qFuzzyCompare(float(coords.x()), item.x())) {
             int direction = 1;
             if (item.x() > coords.x())
@@ -475,7 +526,7 @@ QPoint Surface3DRenderer::mapCoordsToSampleSpace(SurfaceSeriesRenderCache *cache
         float stepY = spanY / float(top);
         int sampleY = int((modelY + (stepY / 2.0f)) / stepY);
 
-        QSurfaceDataItem item = dataArray.at(sampleY)->at(0);
+        QSurfaceDataItem item = dataArray.item(sampleY, 0);
         if (!::qFuzzyCompare(float(coords.y()), item.z())) {
             int direction = 1;
             if (item.z() > coords.y())
@@ -492,14 +543,14 @@ QPoint Surface3DRenderer::mapCoordsToSampleSpace(SurfaceSeriesRenderCache *cache
 }
 
 void Surface3DRenderer::findMatchingRow(float z, int &sample, int direction,
-                                        QSurfaceDataArray &dataArray)
+                                        const SurfaceDataView &dataArray)
 {
-    int maxZ = dataArray.size() - 1;
-    QSurfaceDataItem item = dataArray.at(sample)->at(0);
+    int maxZ = dataArray.rowCount() - 1;
+    QSurfaceDataItem item = dataArray.item(sample, 0);
     float distance = qAbs(z - item.z());
     int newSample = sample + direction;
     while (newSample >= 0 && newSample <= maxZ) {
-        item = dataArray.at(newSample)->at(0);
+        item = dataArray.item(newSample, 0);
         float newDist = qAbs(z - item.z());
         if (newDist < distance) {
             sample = newSample;
@@ -512,14 +563,14 @@ void Surface3DRenderer::findMatchingRow(float z, int &sample, int direction,
 }
 
 void Surface3DRenderer::findMatchingColumn(float x, int &sample, int direction,
-                                           QSurfaceDataArray &dataArray)
+                                           const SurfaceDataView &dataArray)
 {
-    int maxX = dataArray.at(0)->size() - 1;
-    QSurfaceDataItem item = dataArray.at(0)->at(sample);
+    int maxX = dataArray.columnCount() - 1;
+    QSurfaceDataItem item = dataArray.item(0, sample);
     float distance = qAbs(x - item.x());
     int newSample = sample + direction;
     while (newSample >= 0 && newSample <= maxX) {
-        item = dataArray.at(0)->at(newSample);
+        item = dataArray.item(0, newSample);
         float newDist = qAbs(x - item.x());
         if (newDist < distance) {
             sample = newSample;
@@ -549,19 +600,20 @@ void Surface3DRenderer::updateSliceObject(SurfaceSeriesRenderCache *cache, const
     sliceDataArray.reserve(2);
 
     QSurfaceDataRow *sliceRow;
-    QSurfaceDataArray &dataArray = cache->dataArray();
+    const SurfaceDataView dataArray = cache->dataView();
     float adjust = (0.025f * m_heightNormalizer) / 2.0f;
     float doubleAdjust = 2.0f * adjust;
     bool flipZX = false;
     float zBack;
     float zFront;
     if (m_cachedSelectionMode.testFlag(QAbstract3DGraph::SelectionRow)) {
-        QSurfaceDataRow *src = dataArray.at(row);
-        sliceRow = new QSurfaceDataRow(src->size());
+        sliceRow = new QSurfaceDataRow(dataArray.columnCount());
         zBack = m_axisCacheZ.min();
         zFront = m_axisCacheZ.max();
-        for (int i = 0; i < sliceRow->size(); i++)
-            (*sliceRow)[i].setPosition(QVector3D(src->at(i).x(), src->at(i).y() + adjust, zFront));
+        for (int i = 0; i < sliceRow->size(); i++) {
+            const QVector3D position = dataArray.position(row, i);
+            (*sliceRow)[i].setPosition(QVector3D(position.x(), position.y() + adjust, zFront));
+        }
     } else {
         flipZX = true;
         const QRect &sampleSpace = cache->sampleSpace();
@@ -569,9 +621,8 @@ void Surface3DRenderer::updateSliceObject(SurfaceSeriesRenderCache *cache, const
         zBack = m_axisCacheX.min();
         zFront = m_axisCacheX.max();
         for (int i = 0; i < sampleSpace.height(); i++) {
-            (*sliceRow)[i].setPosition(QVector3D(dataArray.at(i)->at(column).z(),
-                                                 dataArray.at(i)->at(column).y() + adjust,
-                                                 zFront));
+            const QVector3D position = dataArray.position(i, column);
+            (*sliceRow)[i].setPosition(QVector3D(position.z(), position.y() + adjust, zFront));
         }
     }
     sliceDataArray << sliceRow;
@@ -596,15 +647,15 @@ void Surface3DRenderer::updateSliceObject(SurfaceSeriesRenderCache *cache, const
     }
 }
 
-inline static float getDataValue(const QSurfaceDataArray &array, bool searchRow, int index)
+inline static float getDataValue(const SurfaceDataView &array, bool searchRow, int index)
 {
     if (searchRow)
-        return array.at(0)->at(index).x();
+        return array.position(0, index).x();
     else
-        return array.at(index)->at(0).z();
+        return array.position(index, 0).z();
 }
 
-inline static int binarySearchArray(const QSurfaceDataArray &array, int maxIdx, float limitValue,
+inline static int binarySearchArray(const SurfaceDataView &array, int maxIdx, float limitValue,
                                     bool searchRow, bool lowBound, bool ascending)
 {
     int min = 0;
@@ -654,17 +705,17 @@ inline static int binarySearchArray(const QSurfaceDataArray &array, int maxIdx,
     return retVal;
 }
 
-QRect Surface3DRenderer::calculateSampleRect(const QSurfaceDataArray &array)
+QRect Surface3DRenderer::calculateSampleRect(const SurfaceDataView &array)
 {
     QRect sampleSpace;
 
-    const int maxRow = array.size() - 1;
-    const int maxColumn = array.at(0)->size() - 1;
+    const int maxRow = array.rowCount() - 1;
+    const int maxColumn = array.columnCount() - 1;
 
     // We assume data is ordered sequentially in rows for X-value and in columns for Z-value.
     // Determine if data is ascending or descending in each case.
-    const bool ascendingX = array.at(0)->at(0).x() < array.at(0)->at(maxColumn).x();
-    const bool ascendingZ = array.at(0)->at(0).z() < array.at(maxRow)->at(0).z();
+    const bool ascendingX = array.position(0, 0).x() < array.position(0, maxColumn).x();
+    const bool ascendingZ = array.position(0, 0).z() < array.position(maxRow, 0).z();
 
     int idx = binarySearchArray(array, maxColumn, m_axisCacheX.min(), true, true, ascendingX);
     if (idx != -1) {
@@ -730,6 +781,8 @@ void Surface3DRenderer::render(GLuint defaultFboHandle)
     // Handle GL state setup for FBO buffers and clearing of the render surface
     Abstract3DRenderer::render(defaultFboHandle);
 
+    swapPreparedObjects();
+
     if (m_axisCacheX.positionsDirty())
         m_axisCacheX.updateAllPositions();
     if (m_axisCacheY.positionsDirty())
@@ -1115,6 +1168,8 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
 
     QMatrix4x4 projectionViewMatrix = projectionMatrix * viewMatrix;
 
+    updateLevelOfDetail(projectionViewMatrix);
+
     // Calculate flipping indicators
     if (viewMatrix.row(0).x() > 0)
         m_zFlipped = false;
@@ -1158,8 +1213,24 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
 
     // Draw depth buffer
     GLfloat adjustedLightStrength = m_cachedTheme->lightStrength() / 10.0f;
-    if (!m_isOpenGLES && m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone &&
-            (!m_renderCacheList.isEmpty() || !m_customRenderCache.isEmpty())) {
+    const bool drawShadows = !m_isOpenGLES
+            && m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone
+            && (!m_renderCacheList.isEmpty() || !m_customRenderCache.isEmpty());
+    if (drawShadows) {
+        // Get the depth view matrix
+        // It may be possible to hack lightPos here if we want to make some tweaks to shadow
+        QVector3D depthLightPos = activeCamera->d_ptr->calculatePositionRelativeToCamera(
+                    zeroVector, 0.0f, 4.0f / m_autoScaleAdjustment);
+        depthViewMatrix.lookAt(depthLightPos, zeroVector, upVector);
+
+        // Set the depth projection matrix
+        depthProjectionMatrix = calculateDepthProjectionMatrix(
+                    depthViewMatrix, 10.0f,
+                    (GLfloat)m_primarySubViewport.width() / (GLfloat)m_primarySubViewport.height());
+        depthProjectionViewMatrix = depthProjectionMatrix * depthViewMatrix;
+    }
+    if (drawShadows && !isDepthPassValid(projectionViewMatrix, depthProjectionViewMatrix)) {
+        FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseDepthPass);
         // Render scene into a depth texture for using with shadow mapping
         // Enable drawing to depth framebuffer
         glBindFramebuffer(GL_FRAMEBUFFER, m_depthFrameBuffer);
@@ -1173,20 +1244,7 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         m_depthShader->bind();
 
         // Set viewport for depth map rendering. Must match texture size. Larger values give smoother shadows.
-        glViewport(0, 0,
-                   m_primarySubViewport.width() * m_shadowQualityMultiplier,
-                   m_primarySubViewport.height() * m_shadowQualityMultiplier);
-
-        // Get the depth view matrix
-        // It may be possible to hack lightPos here if we want to make some tweaks to shadow
-        QVector3D depthLightPos = activeCamera->d_ptr->calculatePositionRelativeToCamera(
-                    zeroVector, 0.0f, 4.0f / m_autoScaleAdjustment);
-        depthViewMatrix.lookAt(depthLightPos, zeroVector, upVector);
-
-        // Set the depth projection matrix
-        depthProjectionMatrix.perspective(10.0f, (GLfloat)m_primarySubViewport.width()
-                                          / (GLfloat)m_primarySubViewport.height(), 3.0f, 100.0f);
-        depthProjectionViewMatrix = depthProjectionMatrix * depthViewMatrix;
+        glViewport(0, 0, m_depthTextureSize.width(), m_depthTextureSize.height());
 
         // Surface is not closed, so don't cull anything
         glDisable(GL_CULL_FACE);
@@ -1210,6 +1268,7 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
 
                 // Draw the triangles
+                FrameStatisticsCollector::countDrawCalls();
                 glDrawElements(GL_TRIANGLES, object->indexCount(), GL_UNSIGNED_INT, (void *)0);
             }
         }
@@ -1240,6 +1299,8 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         // Reset culling to normal
         glEnable(GL_CULL_FACE);
         glCullFace(GL_BACK);
+
+        validateDepthPass(projectionViewMatrix, depthProjectionViewMatrix);
     }
 
     // Do position mapping when necessary
@@ -1250,11 +1311,14 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
     }
 
     // Draw selection buffer
-    if (!m_cachedIsSlicingActivated && (!m_renderCacheList.isEmpty()
-                                        || !m_customRenderCache.isEmpty())
+    const bool selectionQuery = !m_cachedIsSlicingActivated
+            && (!m_renderCacheList.isEmpty() || !m_customRenderCache.isEmpty())
             && m_selectionState == SelectOnScene
             && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
-            && m_selectionResultTexture) {
+            && m_selectionResultTexture;
+    if (selectionQuery && !isSelectionPassValid(projectionViewMatrix)) {
+        FrameStatisticsCollector::Scope statisticsScope(
+                    FrameStatisticsCollector::PhaseSelectionPass);
         m_selectionShader->bind();
         glBindFramebuffer(GL_FRAMEBUFFER, m_selectionFrameBuffer);
         glViewport(0,
@@ -1288,22 +1352,10 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         drawLabels(true, activeCamera, viewMatrix, projectionMatrix);
 
         glEnable(GL_DITHER);
-
-        QVector4D clickedColor = Utils::getSelection(m_inputPosition, m_viewport.height());
+        validateSelectionPass(projectionViewMatrix);
 
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
 
-        // Put the RGBA value back to uint
-        uint selectionId = uint(clickedColor.x())
-                + uint(clickedColor.y()) * greenMultiplier
-                + uint(clickedColor.z()) * blueMultiplier
-                + uint(clickedColor.w()) * alphaMultiplier;
-
-        m_clickedPosition = selectionIdToSurfacePoint(selectionId);
-        m_clickResolved = true;
-
-        emit needRender();
-
         // Revert to original viewport
         glViewport(m_primarySubViewport.x(),
                    m_primarySubViewport.y(),
@@ -1311,6 +1363,22 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
                    m_primarySubViewport.height());
     }
 
+    if (selectionQuery) {
+        QVector4D clickedColor;
+        if (readSelection(m_selectionFrameBuffer, defaultFboHandle, clickedColor)) {
+            // Put the RGBA value back to uint
+            uint selectionId = uint(clickedColor.x())
+                    + uint(clickedColor.y()) * greenMultiplier
+                    + uint(clickedColor.z()) * blueMultiplier
+                    + uint(clickedColor.w()) * alphaMultiplier;
+
+            m_clickedPosition = selectionIdToSurfacePoint(selectionId);
+            m_clickResolved = true;
+        }
+
+        emit needRender();
+    }
+
     // Selection handling
     if (m_selectionDirty || m_selectionLabelDirty) {
         QPoint visiblePoint = Surface3DController::invalidSelectionPosition();
@@ -1323,7 +1391,7 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
                 int x = m_selectedPoint.x() - sampleSpace.y();
                 int y = m_selectedPoint.y() - sampleSpace.x();
                 if (x >= 0 && y >= 0 && x < sampleSpace.height() && y < sampleSpace.width()
-                        && cache->dataArray().size()) {
+                        && !cache->dataView().isEmpty()) {
                     visiblePoint = QPoint(x, y);
                 }
             }
@@ -1343,6 +1411,22 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         m_selectionDirty = false;
     }
 
+    // When nothing but the selection has changed, the cached scene is reused and only the
+    // selection is drawn over it
+    const FrameChanges changes = takeFrameChanges(projectionViewMatrix);
+    bool cachingScene = false;
+    if (m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationCachedScene)) {
+        if (!m_sceneCache)
+            m_sceneCache = new SceneCache();
+        if (m_sceneCache->isValid() && !(changes & ~FrameChanges(FrameChangeSelection))) {
+            m_sceneCache->draw(defaultFboHandle);
+            drawSelectionPointers(defaultFboHandle);
+            return;
+        }
+        const QVector4D clearColor = Utils::vectorFromColor(m_cachedTheme->windowColor());
+        cachingScene = m_sceneCache->begin(m_primarySubViewport, clearColor, defaultFboHandle);
+    }
+
     // Draw the surface
     if (!m_renderCacheList.isEmpty()) {
         // For surface we can see glimpses from underneath
@@ -1467,21 +1551,9 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         }
     }
 
-    // Render selection ball
-    if (m_selectionActive
-            && m_cachedSelectionMode.testFlag(QAbstract3DGraph::SelectionItem)) {
-        for (SeriesRenderCache *baseCache: m_renderCacheList) {
-            const SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
-            if (cache->slicePointerActive() && cache->renderable() &&
-                    m_cachedIsSlicingActivated ) {
-                cache->sliceSelectionPointer()->renderSelectionPointer(defaultFboHandle);
-            }
-            if (cache->mainPointerActive() && cache->renderable()) {
-                cache->mainSelectionPointer()->renderSelectionPointer(defaultFboHandle,
-                                                                      m_useOrthoProjection);
-            }
-        }
-    }
+    // Render selection ball. With a cached scene the ball is drawn over the cached scene instead.
+    if (!cachingScene)
+        drawSelectionPointers(defaultFboHandle);
 
     // Bind background shader
     m_backgroundShader->bind();
@@ -1905,12 +1977,36 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
 
     // Release shader
     glUseProgram(0);
+
+    if (cachingScene) {
+        m_sceneCache->end(defaultFboHandle);
+        drawSelectionPointers(defaultFboHandle);
+    }
+}
+
+void Surface3DRenderer::drawSelectionPointers(GLuint defaultFboHandle)
+{
+    if (!m_selectionActive
+            || !m_cachedSelectionMode.testFlag(QAbstract3DGraph::SelectionItem)) {
+        return;
+    }
+
+    for (SeriesRenderCache *baseCache: m_renderCacheList) {
+        const SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
+        if (cache->slicePointerActive() && cache->renderable() && m_cachedIsSlicingActivated)
+            cache->sliceSelectionPointer()->renderSelectionPointer(defaultFboHandle);
+        if (cache->mainPointerActive() && cache->renderable()) {
+            cache->mainSelectionPointer()->renderSelectionPointer(defaultFboHandle,
+                                                                  m_useOrthoProjection);
+        }
+    }
 }
 
 void Surface3DRenderer::drawLabels(bool drawSelection, const Q3DCamera *activeCamera,
                                    const QMatrix4x4 &viewMatrix,
                                    const QMatrix4x4 &projectionMatrix)
 {
+    FrameStatisticsCollector::Scope statisticsScope(FrameStatisticsCollector::PhaseLabels);
     ShaderHelper *shader = 0;
     GLfloat alphaForValueSelection = labelValueAlpha / 255.0f;
     GLfloat alphaForRowSelection = labelRowAlpha / 255.0f;
@@ -2425,6 +2521,18 @@ void Surface3DRenderer::updateSelectionMode(QAbstract3DGraph::SelectionFlags mod
         updateSelectionTextures();
 }
 
+void Surface3DRenderer::updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint)
+{
+    Abstract3DRenderer::updateOptimizationHint(hint);
+
+    // The cache is created when the scene is drawn the next time
+    if (!hint.testFlag(QAbstract3DGraph::OptimizationCachedScene)) {
+        delete m_sceneCache;
+        m_sceneCache = 0;
+    }
+    markFrameChanged(FrameChangeContent);
+}
+
 void Surface3DRenderer::updateSelectionTextures()
 {
     uint lastSelectionId = 1;
@@ -2499,6 +2607,7 @@ void Surface3DRenderer::initSelectionBuffer()
     m_selectionResultTexture = m_textureHelper->createSelectionTexture(m_primarySubViewport.size(),
                                                                        m_selectionFrameBuffer,
                                                                        m_selectionDepthBuffer);
+    invalidateSelectionPass();
 }
 
 void Surface3DRenderer::fillIdCorner(uchar *p, uchar r, uchar g, uchar b, uchar a)
@@ -2594,30 +2703,191 @@ void Surface3DRenderer::checkFlatSupport(SurfaceSeriesRenderCache *cache)
 
 void Surface3DRenderer::updateObjects(SurfaceSeriesRenderCache *cache, bool dimensionChanged)
 {
-    QSurfaceDataArray &dataArray = cache->dataArray();
+    if (cache->isPreparing()) {
+        // The data being prepared is out of date, and the buffers of the main object may no
+        // longer match the data either
+        cache->finishPreparation(true);
+        dimensionChanged = true;
+    }
+    // Level of detail switches change the mesh without a change in the graph
+    markFrameChanged(FrameChangeContent);
+    if (m_asynchronousDataPreparation && !m_polarGraph && prepareObjects(cache))
+        return;
+
+    const SurfaceDataView dataArray = cache->meshView();
     const QRect &sampleSpace = cache->sampleSpace();
+    const int sampleStride = 1 << cache->lodLevel();
 
     const QSurface3DSeries *currentSeries = cache->series();
-    QSurfaceDataProxy *dataProxy = currentSeries->dataProxy();
-    const QSurfaceDataArray &array = *dataProxy->array();
+    const SurfaceDataView array = currentSeries->dataProxy()->dptrc()->dataView();
 
     if (cache->isFlatShadingEnabled()) {
-        cache->surfaceObject()->setUpData(dataArray, sampleSpace, dimensionChanged, m_polarGraph);
+        cache->surfaceObject()->setUpData(dataArray, sampleSpace, dimensionChanged, m_polarGraph,
+                                          false, sampleStride);
         if (cache->surfaceTexture())
             cache->surfaceObject()->coarseUVs(array, dataArray);
     } else {
         cache->surfaceObject()->setUpSmoothData(dataArray, sampleSpace, dimensionChanged,
-                                                m_polarGraph);
+                                                m_polarGraph, false, sampleStride);
         if (cache->surfaceTexture())
             cache->surfaceObject()->smoothUVs(array, dataArray);
     }
 }
 
+// Builds the main surface object on a worker thread. The mesh is set up from a snapshot of the
+// data into a second surface object, which replaces the main object once done, so the previous
+// mesh keeps being drawn meanwhile. Returns false if the axes cannot be captured for the worker.
+bool Surface3DRenderer::prepareObjects(SurfaceSeriesRenderCache *cache)
+{
+    SurfaceObject *surfaceObject = cache->preparedSurfaceObject();
+    if (!surfaceObject->beginPreparation())
+        return false;
+
+    SurfaceDataSnapshot &snapshot = cache->preparationSnapshot();
+    snapshot.take(cache->meshView());
+
+    // Texture coordinates only depend on the corners of the whole data
+    QList<QVector3D> corners;
+    if (cache->surfaceTexture()) {
+        const SurfaceDataView array = cache->series()->dataProxy()->dptrc()->dataView();
+        const int lastRow = array.rowCount() - 1;
+        const int lastColumn = array.columnCount() - 1;
+        corners << array.position(0, 0) << array.position(0, lastColumn)
+                << array.position(lastRow, 0) << array.position(lastRow, lastColumn);
+    }
+
+    const QRect sampleSpace = cache->sampleSpace();
+    const int sampleStride = 1 << cache->lodLevel();
+    const bool flat = cache->isFlatShadingEnabled();
+    cache->startPreparation([this, surfaceObject, &snapshot, corners, sampleSpace,
+                            sampleStride, flat]() {
+        const SurfaceDataView &dataArray = snapshot.view();
+        const SurfaceDataView cornerArray(corners.constData(), 2, 2);
+        if (flat) {
+            surfaceObject->setUpData(dataArray, sampleSpace, true, false, false, sampleStride);
+            if (!corners.isEmpty())
+                surfaceObject->coarseUVs(cornerArray, dataArray);
+        } else {
+            surfaceObject->setUpSmoothData(dataArray, sampleSpace, true, false, false,
+                                           sampleStride);
+            if (!corners.isEmpty())
+                surfaceObject->smoothUVs(cornerArray, dataArray);
+        }
+        emit needRender();
+    });
+    return true;
+}
+
+// Takes the prepared surface object of the cache into use, waiting for it if needed
+void Surface3DRenderer::finishPreparation(SurfaceSeriesRenderCache *cache)
+{
+    if (!cache->isPreparing())
+        return;
+
+    cache->finishPreparation();
+    m_selectionDirty = true;
+    markFrameChanged(FrameChangeContent);
+    if (!isPreparingData())
+        emit dataReady();
+}
+
+// Takes finished preparations into use. Preparations that have been running for longer than
+// the maximum data latency are waited for.
+void Surface3DRenderer::swapPreparedObjects()
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
+        if (!cache->isPreparing())
+            continue;
+
+        const bool overdue = m_maxDataLatency >= 0
+                && cache->preparationTime() >= m_maxDataLatency;
+        if (cache->waitForPreparation(overdue ? -1 : 0))
+            finishPreparation(cache);
+    }
+}
+
+bool Surface3DRenderer::isPreparingData() const
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        if (static_cast<SurfaceSeriesRenderCache *>(baseCache)->isPreparing())
+            return true;
+    }
+    return false;
+}
+
+// Switches the main surface objects to the level of detail that matches their current
+// size on screen. Slices and selection keep using the full resolution data.
+void Surface3DRenderer::updateLevelOfDetail(const QMatrix4x4 &projectionViewMatrix)
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
+        // Switching the level would discard the mesh being prepared
+        if (!cache->isVisible() || cache->isPreparing())
+            continue;
+
+        const bool lodDirty = cache->isLodDirty();
+        const int oldLevel = cache->lodLevel();
+        const int level = calculateLodLevel(cache, projectionViewMatrix);
+        if (level == oldLevel && !lodDirty)
+            continue;
+
+        cache->setLodLevel(level);
+        if ((cache->lodLevel() != oldLevel || lodDirty)
+                && cache->sampleSpace().width() >= 2 && cache->sampleSpace().height() >= 2) {
+            updateObjects(cache, true);
+        }
+    }
+}
+
+// Returns the level of detail that leaves about one sampled data point per pixel along the
+// longer side of the graph on screen. The whole graph box is used as the extent of the
+// surface, which errs on the side of more detail.
+int Surface3DRenderer::calculateLodLevel(const SurfaceSeriesRenderCache *cache,
+                                         const QMatrix4x4 &projectionViewMatrix) const
+{
+    const QRect &sampleSpace = cache->sampleSpace();
+    if (cache->levelOfDetail() == QSurface3DSeries::LevelOfDetailNone
+            || sampleSpace.width() < 2 || sampleSpace.height() < 2) {
+        return 0;
+    }
+
+    float left = std::numeric_limits<float>::max();
+    float right = -std::numeric_limits<float>::max();
+    float bottom = std::numeric_limits<float>::max();
+    float top = -std::numeric_limits<float>::max();
+    for (int i = 0; i < 8; i++) {
+        const QVector4D corner((i & 1) ? m_scaleX : -m_scaleX,
+                               (i & 2) ? m_scaleY : -m_scaleY,
+                               (i & 4) ? m_scaleZ : -m_scaleZ,
+                               1.0f);
+        const QVector4D projected = projectionViewMatrix * corner;
+        // Part of the graph is behind the camera, so its size on screen is unbounded
+        if (projected.w() <= 0.0f)
+            return 0;
+        left = qMin(left, projected.x() / projected.w());
+        right = qMax(right, projected.x() / projected.w());
+        bottom = qMin(bottom, projected.y() / projected.w());
+        top = qMax(top, projected.y() / projected.w());
+    }
+
+    const float pixels = qMax((right - left) * 0.5f * float(m_primarySubViewport.width()),
+                              (top - bottom) * 0.5f * float(m_primarySubViewport.height()));
+    float samples = float(qMax(sampleSpace.width(), sampleSpace.height()));
+    int level = 0;
+    while (pixels > 0.0f && samples >= 2.0f * pixels) {
+        samples *= 0.5f;
+        level++;
+    }
+    return level;
+}
+
 void Surface3DRenderer::updateSelectedPoint(const QPoint &position, QSurface3DSeries *series)
 {
     m_selectedPoint = position;
     m_selectedSeries = series;
     m_selectionDirty = true;
+    markFrameChanged(FrameChangeSelection);
 }
 
 void Surface3DRenderer::updateFlipHorizontalGrid(bool flip)
@@ -2651,9 +2921,8 @@ void Surface3DRenderer::surfacePointSelected(const QPoint &point)
         SurfaceSeriesRenderCache *selectedCache =
                 static_cast<SurfaceSeriesRenderCache *>(
                     m_renderCacheList.value(const_cast<QSurface3DSeries *>(m_selectedSeries)));
-        QSurfaceDataArray &dataArray = selectedCache->dataArray();
-        QSurfaceDataItem item = dataArray.at(point.x())->at(point.y());
-        QPointF coords(item.x(), item.z());
+        QVector3D position = selectedCache->dataView().position(point.x(), point.y());
+        QPointF coords(position.x(), position.z());
 
         foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
             SurfaceSeriesRenderCache *cache =
@@ -2980,11 +3249,13 @@ void Surface3DRenderer::updateDepthBuffer()
             return;
 
         if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
-            m_depthTexture = m_textureHelper->createDepthTextureFrameBuffer(m_primarySubViewport.size(),
+            m_depthTextureSize = calculateShadowMapSize(m_shadowQualityMultiplier);
+            m_depthTexture = m_textureHelper->createDepthTextureFrameBuffer(m_depthTextureSize,
                                                                             m_depthFrameBuffer,
-                                                                            m_shadowQualityMultiplier);
+                                                                            1);
             if (!m_depthTexture)
                 lowerShadowQuality();
+            invalidateDepthPass();
         }
     }
 }
@@ -23,6 +23,7 @@ QT_BEGIN_NAMESPACE
 
 class ShaderHelper;
 class Q3DScene;
+class SceneCache;
 
 class Q_DATAVISUALIZATION_EXPORT Surface3DRenderer : public Abstract3DRenderer
 {
@@ -61,6 +62,7 @@ private:
     bool m_selectionTexturesDirty;
     GLuint m_noShadowTexture;
     bool m_flipHorizontalGrid;
+    SceneCache *m_sceneCache;
 
 public:
     explicit Surface3DRenderer(Surface3DController *controller);
@@ -72,6 +74,7 @@ public:
     SeriesRenderCache *createNewCache(QAbstract3DSeries *series) override;
     void cleanCache(SeriesRenderCache *cache) override;
     void updateSelectionMode(QAbstract3DGraph::SelectionFlags mode) override;
+    void updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint) override;
     void updateRows(const QList<Surface3DController::ChangeRow> &rows);
     void updateItems(const QList<Surface3DController::ChangeItem> &points);
     void updateScene(Q3DScene *scene) override;
@@ -86,6 +89,7 @@ public:
     void updateAxisTitleVisibility(QAbstract3DAxis::AxisOrientation orientation,
                                    bool visible) override;
     void updateMargin(float margin) override;
+    bool isPreparingData() const override;
 
     void render(GLuint defaultFboHandle = 0) override;
 
@@ -101,19 +105,27 @@ Q_SIGNALS:
 private:
     void checkFlatSupport(SurfaceSeriesRenderCache *cache);
     void updateObjects(SurfaceSeriesRenderCache *cache, bool dimensionChanged);
+    bool prepareObjects(SurfaceSeriesRenderCache *cache);
+    void finishPreparation(SurfaceSeriesRenderCache *cache);
+    void swapPreparedObjects();
+    void updateLevelOfDetail(const QMatrix4x4 &projectionViewMatrix);
+    int calculateLodLevel(const SurfaceSeriesRenderCache *cache,
+                          const QMatrix4x4 &projectionViewMatrix) const;
     void updateSliceDataModel(const QPoint &point);
     QPoint mapCoordsToSampleSpace(SurfaceSeriesRenderCache *cache, const QPointF &coords);
-    void findMatchingRow(float z, int &sample, int direction, QSurfaceDataArray &dataArray);
-    void findMatchingColumn(float x, int &sample, int direction, QSurfaceDataArray &dataArray);
+    void findMatchingRow(float z, int &sample, int direction, const SurfaceDataView &dataArray);
+    void findMatchingColumn(float x, int &sample, int direction,
+                            const SurfaceDataView &dataArray);
     void updateSliceObject(SurfaceSeriesRenderCache *cache, const QPoint &point);
     void updateShadowQuality(QAbstract3DGraph::ShadowQuality quality) override;
     void updateTextures() override;
     void initShaders(const QString &vertexShader, const QString &fragmentShader) override;
-    QRect calculateSampleRect(const QSurfaceDataArray &array);
+    QRect calculateSampleRect(const SurfaceDataView &array);
     void loadBackgroundMesh();
 
     void drawSlicedScene();
     void drawScene(GLuint defaultFboHandle);
+    void drawSelectionPointers(GLuint defaultFboHandle);
     void drawLabels(bool drawSelection, const Q3DCamera *activeCamera,
                     const QMatrix4x4 &viewMatrix, const QMatrix4x4 &projectionMatrix);
 
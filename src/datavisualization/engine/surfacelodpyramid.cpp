@@ -0,0 +1,106 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "surfacelodpyramid_p.h"
+#include "utils_p.h"
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+// Minimum number of points reduced by one parallel task
+static const int minPointsPerTask = 16384;
+
+void SurfaceLodPyramid::setReduction(QSurface3DSeries::LevelOfDetail reduction)
+{
+    if (m_reduction != reduction) {
+        m_reduction = reduction;
+        clear();
+    }
+}
+
+void SurfaceLodPyramid::clear()
+{
+    m_levels.clear();
+}
+
+// Adds levels until there are levelCount of them or the data cannot be reduced further.
+// Returns the resulting level count.
+int SurfaceLodPyramid::build(const SurfaceDataView &source, int levelCount)
+{
+    while (m_levels.size() < levelCount) {
+        const SurfaceDataView below = m_levels.isEmpty() ? source : level(m_levels.size());
+        if (below.rowCount() <= 2 && below.columnCount() <= 2)
+            break;
+
+        Level reduced;
+        reduced.rowCount = below.rowCount() / 2 + 1;
+        reduced.columnCount = below.columnCount() / 2 + 1;
+        reduced.positions.resize(reduced.rowCount * reduced.columnCount);
+        reduceRows(below, reduced, 0, reduced.rowCount - 1);
+        m_levels.append(reduced);
+    }
+    return m_levels.size();
+}
+
+// Recalculates the parts of all levels that depend on the given source rows
+void SurfaceLodPyramid::updateRows(const SurfaceDataView &source, int firstRow, int lastRow)
+{
+    for (int i = 0; i < m_levels.size(); i++) {
+        const SurfaceDataView below = i ? level(i) : source;
+        Level &target = m_levels[i];
+        // With an even row count the last row below is also the last row of the level
+        if (lastRow >= below.rowCount() - 1)
+            lastRow = target.rowCount - 1;
+        else
+            lastRow /= 2;
+        firstRow /= 2;
+        reduceRows(below, target, firstRow, lastRow);
+    }
+}
+
+void SurfaceLodPyramid::reduceRows(const SurfaceDataView &source, Level &target, int firstRow,
+                                   int lastRow) const
+{
+    const int sourceRowLimit = source.rowCount() - 1;
+    const int sourceColumnLimit = source.columnCount() - 1;
+    const int columns = target.columnCount;
+    const bool average = m_reduction == QSurface3DSeries::LevelOfDetailAverage;
+    QVector3D *positions = target.positions.data();
+
+    Utils::parallelFor(lastRow - firstRow + 1, qMax(1, minPointsPerTask / columns),
+                       [&](int begin, int end) {
+        for (int row = firstRow + begin; row < firstRow + end; row++) {
+            const int firstSourceRow = qMin(row * 2, sourceRowLimit);
+            const int lastSourceRow = qMin(row * 2 + 1, sourceRowLimit);
+            for (int column = 0; column < columns; column++) {
+                const int firstSourceColumn = qMin(column * 2, sourceColumnLimit);
+                const int lastSourceColumn = qMin(column * 2 + 1, sourceColumnLimit);
+
+                // Holes in the data are skipped unless the whole block is a hole
+                float sum = 0.0f;
+                float maximum = -std::numeric_limits<float>::infinity();
+                int count = 0;
+                for (int i = firstSourceRow; i <= lastSourceRow; i++) {
+                    for (int j = firstSourceColumn; j <= lastSourceColumn; j++) {
+                        const float y = source.position(i, j).y();
+                        if (qIsNaN(y))
+                            continue;
+                        sum += y;
+                        maximum = qMax(y, maximum);
+                        count++;
+                    }
+                }
+
+                QVector3D position = source.position(firstSourceRow, firstSourceColumn);
+                if (!count)
+                    position.setY(qQNaN());
+                else
+                    position.setY(average ? sum / float(count) : maximum);
+                positions[row * columns + column] = position;
+            }
+        }
+    });
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,60 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SURFACELODPYRAMID_P_H
+#define SURFACELODPYRAMID_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "qsurface3dseries.h"
+#include "surfacedataview_p.h"
+
+QT_BEGIN_NAMESPACE
+
+// Reduced copies of surface data for drawing large surfaces. Level n has a stride of 2^n
+// points of the source data. Each point of a level covers a 2x2 block of the level below
+// and is placed at the first point of the block, so the first and last rows and columns
+// stay at the data range limits.
+class Q_DATAVISUALIZATION_EXPORT SurfaceLodPyramid
+{
+public:
+    void setReduction(QSurface3DSeries::LevelOfDetail reduction);
+    void clear();
+    int build(const SurfaceDataView &source, int levelCount);
+    void updateRows(const SurfaceDataView &source, int firstRow, int lastRow);
+
+    inline int levelCount() const { return m_levels.size(); }
+    // Level 0 is the source data itself and is not stored
+    inline SurfaceDataView level(int index) const
+    {
+        const Level &level = m_levels.at(index - 1);
+        return SurfaceDataView(level.positions.constData(), level.rowCount, level.columnCount);
+    }
+
+private:
+    struct Level
+    {
+        QList<QVector3D> positions;
+        int rowCount = 0;
+        int columnCount = 0;
+    };
+
+    void reduceRows(const SurfaceDataView &source, Level &target, int firstRow,
+                    int lastRow) const;
+
+    QList<Level> m_levels;
+    QSurface3DSeries::LevelOfDetail m_reduction = QSurface3DSeries::LevelOfDetailMaximum;
+};
+
+QT_END_NAMESPACE
+
+#endif
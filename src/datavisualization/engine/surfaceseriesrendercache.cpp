@@ -15,6 +15,8 @@ SurfaceSeriesRenderCache::SurfaceSeriesRenderCache(QAbstract3DSeries *series,
       m_surfaceFlatShading(false),
       m_surfaceObj(new SurfaceObject(renderer)),
       m_sliceSurfaceObj(new SurfaceObject(renderer)),
+      m_preparedSurfaceObj(0),
+      m_preparation(0),
       m_sampleSpace(QRect(0, 0, 0, 0)),
       m_selectionTexture(0),
       m_selectionIdStart(0),
@@ -25,7 +27,10 @@ SurfaceSeriesRenderCache::SurfaceSeriesRenderCache(QAbstract3DSeries *series,
       m_mainSelectionPointer(0),
       m_slicePointerActive(false),
       m_mainPointerActive(false),
-      m_surfaceTexture(0)
+      m_surfaceTexture(0),
+      m_levelOfDetail(QSurface3DSeries::LevelOfDetailNone),
+      m_lodLevel(0),
+      m_lodDirty(false)
 {
 }
 
@@ -48,10 +53,91 @@ void SurfaceSeriesRenderCache::populate(bool newSeries)
         m_surfaceFlatShading = series()->isFlatShadingEnabled();
         m_flatStatusDirty = true;
     }
+
+    if (m_levelOfDetail != series()->levelOfDetail()) {
+        // The pyramid is switched over with the surface object in setLodLevel()
+        m_levelOfDetail = series()->levelOfDetail();
+        m_lodDirty = true;
+    }
+}
+
+// Selects the level drawn by the main surface object, building any missing pyramid levels.
+// The level is limited to the levels the sampled data can be reduced to.
+void SurfaceSeriesRenderCache::setLodLevel(int level)
+{
+    if (m_lodDirty) {
+        m_lodPyramid.setReduction(m_levelOfDetail);
+        m_lodDirty = false;
+    }
+    if (level > m_lodPyramid.levelCount())
+        m_lodPyramid.build(dataView(), level);
+    m_lodLevel = qMin(level, m_lodPyramid.levelCount());
+}
+
+// Rebuilds the pyramid for the current level after the sampled data has been reloaded
+void SurfaceSeriesRenderCache::rebuildLod()
+{
+    m_lodPyramid.clear();
+    if (m_lodLevel)
+        setLodLevel(m_lodLevel);
+}
+
+// Takes the sampled part of the source row from the data proxy. When the sample space spans
+// whole rows, the row data is implicitly shared with the proxy instead of copied, so the
+// proxy and the cache hold a single copy of the data until either side modifies the row.
+void SurfaceSeriesRenderCache::setDataRow(int index, const QSurfaceDataRow &sourceRow)
+{
+    QSurfaceDataRow &row = *m_dataArray.at(index);
+    if (m_sampleSpace.x() == 0 && m_sampleSpace.width() == sourceRow.size())
+        row = sourceRow;
+    else
+        row = sourceRow.mid(m_sampleSpace.x(), m_sampleSpace.width());
+}
+
+SurfaceObject *SurfaceSeriesRenderCache::preparedSurfaceObject()
+{
+    if (!m_preparedSurfaceObj)
+        m_preparedSurfaceObj = new SurfaceObject(static_cast<Surface3DRenderer *>(m_renderer));
+    return m_preparedSurfaceObj;
+}
+
+// Runs the function that prepares the prepared surface object on a worker thread. The function
+// must only use the prepared object and the preparation snapshot.
+void SurfaceSeriesRenderCache::startPreparation(const std::function<void()> &function)
+{
+    Q_ASSERT(!m_preparation);
+    m_preparation = new BackgroundTask(function);
+}
+
+// Returns true if the preparation has finished within msecs, or at all if msecs is negative
+bool SurfaceSeriesRenderCache::waitForPreparation(int msecs)
+{
+    return !m_preparation || m_preparation->wait(msecs);
+}
+
+// Waits for the preparation to finish, and swaps the prepared object in unless it has been
+// superseded by newer data.
+void SurfaceSeriesRenderCache::finishPreparation(bool discard)
+{
+    if (!m_preparation)
+        return;
+
+    delete m_preparation;
+    m_preparation = 0;
+    m_preparationSnapshot.clear();
+    if (discard) {
+        m_preparedSurfaceObj->cancelPreparation();
+    } else {
+        m_preparedSurfaceObj->finishPreparation();
+        m_preparedSurfaceObj->setLineColor(m_surfaceObj->wireframeColor());
+        qSwap(m_surfaceObj, m_preparedSurfaceObj);
+    }
 }
 
 void SurfaceSeriesRenderCache::cleanup(TextureHelper *texHelper)
 {
+    finishPreparation(true);
+
     if (QOpenGLContext::currentContext()) {
         texHelper->deleteTexture(&m_selectionTexture);
         texHelper->deleteTexture(&m_surfaceTexture);
@@ -59,9 +145,13 @@ void SurfaceSeriesRenderCache::cleanup(TextureHelper *texHelper)
 
     delete m_surfaceObj;
     delete m_sliceSurfaceObj;
+    delete m_preparedSurfaceObj;
     for (int i = 0; i < m_dataArray.size(); i++)
         delete m_dataArray.at(i);
     m_dataArray.clear();
+    m_heightGrid = SurfaceHeightGrid();
+    m_lodPyramid.clear();
+    m_lodLevel = 0;
 
     for (int i = 0; i < m_sliceDataArray.size(); i++)
         delete m_sliceDataArray.at(i);
@@ -19,6 +19,8 @@
 #include "qsurface3dseries_p.h"
 #include "surfaceobject_p.h"
 #include "selectionpointer_p.h"
+#include "surfacelodpyramid_p.h"
+#include "backgroundtask_p.h"
 
 #include <QtGui/QMatrix4x4>
 
@@ -35,6 +37,8 @@ public:
     void populate(bool newSeries) override;
     void cleanup(TextureHelper *texHelper) override;
 
+    void setDataRow(int index, const QSurfaceDataRow &sourceRow);
+
     inline bool surfaceVisible() const { return m_surfaceVisible; }
     inline bool surfaceGridVisible() const { return m_surfaceGridVisible; }
     inline bool isFlatShadingEnabled() const { return m_surfaceFlatShading; }
@@ -42,10 +46,45 @@ public:
     inline void setFlatChangeAllowed(bool allowed) { m_flatChangeAllowed = allowed; }
     inline SurfaceObject *surfaceObject() { return m_surfaceObj; }
     inline SurfaceObject *sliceSurfaceObject() { return m_sliceSurfaceObj; }
+    // The main surface object can be prepared on a worker thread. The mesh is built into a
+    // second object from a snapshot of the data, and swapped with the main object once done.
+    SurfaceObject *preparedSurfaceObject();
+    inline SurfaceDataSnapshot &preparationSnapshot() { return m_preparationSnapshot; }
+    void startPreparation(const std::function<void()> &function);
+    inline bool isPreparing() const { return m_preparation; }
+    inline qint64 preparationTime() const { return m_preparation ? m_preparation->elapsed() : 0; }
+    bool waitForPreparation(int msecs);
+    void finishPreparation(bool discard = false);
     inline const QRect &sampleSpace() const { return m_sampleSpace; }
     inline void setSampleSpace(const QRect &sampleSpace) { m_sampleSpace = sampleSpace; }
     inline QSurface3DSeries *series() const { return static_cast<QSurface3DSeries *>(m_series); }
     inline QSurfaceDataArray &dataArray() { return m_dataArray; }
+    inline bool hasHeightGrid() const { return !m_heightGrid.isNull(); }
+    inline void setHeightGrid(const SurfaceHeightGrid &grid) { m_heightGrid = grid; }
+    inline SurfaceDataView dataView() const
+    {
+        if (hasHeightGrid())
+            return SurfaceDataView(m_heightGrid, m_sampleSpace);
+        return SurfaceDataView(m_dataArray);
+    }
+    // The data drawn by the main surface object, which is a reduced copy of the sampled
+    // data when a level of detail is in use
+    inline SurfaceDataView meshView() const
+    {
+        if (m_lodLevel)
+            return m_lodPyramid.level(m_lodLevel);
+        return dataView();
+    }
+    inline QSurface3DSeries::LevelOfDetail levelOfDetail() const { return m_levelOfDetail; }
+    inline int lodLevel() const { return m_lodLevel; }
+    inline bool isLodDirty() const { return m_lodDirty; }
+    void setLodLevel(int level);
+    void rebuildLod();
+    inline void updateLodRows(int firstRow, int lastRow)
+    {
+        if (m_lodLevel)
+            m_lodPyramid.updateRows(dataView(), firstRow, lastRow);
+    }
     inline QSurfaceDataArray &sliceDataArray() { return m_sliceDataArray; }
     inline bool renderable() const { return m_visible && (m_surfaceVisible ||
                                                           m_surfaceGridVisible); }
@@ -79,8 +118,12 @@ protected:
     bool m_surfaceFlatShading;
     SurfaceObject *m_surfaceObj;
     SurfaceObject *m_sliceSurfaceObj;
+    SurfaceObject *m_preparedSurfaceObj;
+    BackgroundTask *m_preparation;
+    SurfaceDataSnapshot m_preparationSnapshot;
     QRect m_sampleSpace;
     QSurfaceDataArray m_dataArray;
+    SurfaceHeightGrid m_heightGrid; // Used instead of m_dataArray for height grid proxies
     QSurfaceDataArray m_sliceDataArray;
     GLuint m_selectionTexture;
     uint m_selectionIdStart;
@@ -93,6 +136,10 @@ protected:
     bool m_slicePointerActive;
     bool m_mainPointerActive;
     GLuint m_surfaceTexture;
+    QSurface3DSeries::LevelOfDetail m_levelOfDetail;
+    SurfaceLodPyramid m_lodPyramid;
+    int m_lodLevel;
+    bool m_lodDirty;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,40 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "backgroundtask_p.h"
+
+#include <QtCore/QThreadPool>
+
+QT_BEGIN_NAMESPACE
+
+BackgroundTask::BackgroundTask(const std::function<void()> &function)
+    : m_finished(std::make_shared<QSemaphore>())
+{
+    m_timer.start();
+    std::shared_ptr<QSemaphore> finished = m_finished;
+    QThreadPool::globalInstance()->start([finished, function]() {
+        function();
+        finished->release();
+    });
+}
+
+BackgroundTask::~BackgroundTask()
+{
+    wait();
+}
+
+bool BackgroundTask::isFinished() const
+{
+    return m_finished->available() > 0;
+}
+
+bool BackgroundTask::wait(int msecs)
+{
+    if (!m_finished->tryAcquire(1, msecs))
+        return false;
+    // Keep the task finished for later calls
+    m_finished->release();
+    return true;
+}
+
+QT_END_NAMESPACE
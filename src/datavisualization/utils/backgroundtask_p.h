@@ -0,0 +1,49 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef BACKGROUNDTASK_P_H
+#define BACKGROUNDTASK_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSemaphore>
+#include <functional>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+// Runs a function once on the global thread pool. The owner can poll for the function to
+// finish or wait for it. The destructor waits, so the function can use data of the owner.
+class BackgroundTask
+{
+public:
+    explicit BackgroundTask(const std::function<void()> &function);
+    ~BackgroundTask();
+
+    bool isFinished() const;
+    // Returns true if the function finished within msecs, or at all if msecs is negative
+    bool wait(int msecs = -1);
+    // Milliseconds since the task was started
+    inline qint64 elapsed() const { return m_timer.elapsed(); }
+
+private:
+    Q_DISABLE_COPY(BackgroundTask)
+
+    // Shared with the running function, which may still hold it when the waiter returns
+    std::shared_ptr<QSemaphore> m_finished;
+    QElapsedTimer m_timer;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,284 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "barobjectbufferhelper_p.h"
+#include "objecthelper_p.h"
+#include "utils_p.h"
+#include "framestatisticscollector_p.h"
+#include <QtGui/QMatrix4x4>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+const QVector3D BarObjectBufferHelper::hiddenPos(0.0f, 0.0f, 0.0f);
+const int BarObjectBufferHelper::minVerticesPerTask = 32768;
+
+bool BarBufferLayout::operator==(const BarBufferLayout &other) const
+{
+    return rowCount == other.rowCount
+            && columnCount == other.columnCount
+            && seriesPos == other.seriesPos
+            && barSpacing == other.barSpacing
+            && rowWidth == other.rowWidth
+            && columnDepth == other.columnDepth
+            && scaleFactor == other.scaleFactor
+            && scaleX == other.scaleX
+            && scaleZ == other.scaleZ
+            && gradientFraction == other.gradientFraction
+            && seriesRotation == other.seriesRotation
+            && colorStyle == other.colorStyle
+            && meshFileName == other.meshFileName;
+}
+
+BarObjectBufferHelper::BarObjectBufferHelper()
+    : m_selectionUVBuffer(0)
+{
+}
+
+BarObjectBufferHelper::~BarObjectBufferHelper()
+{
+    if (QOpenGLContext::currentContext())
+        glDeleteBuffers(1, &m_selectionUVBuffer);
+}
+
+GLuint BarObjectBufferHelper::selectionUVBuf()
+{
+    if (!m_meshDataLoaded)
+        qFatal("No loaded object");
+    return m_selectionUVBuffer;
+}
+
+void BarObjectBufferHelper::fullLoad(BarSeriesRenderCache *cache, const BarBufferLayout &layout)
+{
+    m_indexCount = 0;
+    m_layout = layout;
+
+    ObjectHelper *barObj = cache->object();
+    const BarRenderItemArray &renderArray = cache->renderArray();
+    const int barCount = layout.rowCount * layout.columnCount;
+
+    if (!barCount || !barObj)
+        return;
+
+    m_meshVertices = barObj->indexedvertices();
+    m_meshNormals = barObj->indexedNormals();
+    m_meshIndices = barObj->indices();
+    const int verticeCount = m_meshVertices.size();
+    const int indicesCount = m_meshIndices.size();
+
+    m_vertices.resize(verticeCount * barCount);
+    m_normals.resize(verticeCount * barCount);
+    m_uvs.resize(verticeCount * barCount);
+    m_selectionUVs.resize(verticeCount * barCount);
+    m_indices.resize(indicesCount * barCount);
+
+    // Every bar gets a fixed slot in row-major order. Zero height bars are kept in the buffers
+    // as degenerate triangles, so item changes only touch their own slot.
+    const int minBarsPerTask = qMax(1, minVerticesPerTask / qMax(1, verticeCount));
+    Utils::parallelFor(barCount, minBarsPerTask, [&](int begin, int end) {
+        for (int slot = begin; slot < end; slot++) {
+            const int row = slot / layout.columnCount;
+            const int column = slot % layout.columnCount;
+            createBar(renderArray, row, column, slot, slot);
+        }
+    });
+
+    m_indexCount = indicesCount * barCount;
+
+    // Existing buffer objects are reused. Respecifying their data store orphans the old
+    // storage, so the driver does not need to synchronize with pending draws.
+    if (!m_meshDataLoaded) {
+        glGenBuffers(1, &m_vertexbuffer);
+        glGenBuffers(1, &m_normalbuffer);
+        glGenBuffers(1, &m_uvbuffer);
+        glGenBuffers(1, &m_selectionUVBuffer);
+        glGenBuffers(1, &m_elementbuffer);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexbuffer);
+    FrameStatisticsCollector::countBufferUpload(m_vertices.size() * sizeof(QVector3D));
+    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(QVector3D),
+                 m_vertices.constData(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_normalbuffer);
+    FrameStatisticsCollector::countBufferUpload(m_normals.size() * sizeof(QVector3D));
+    glBufferData(GL_ARRAY_BUFFER, m_normals.size() * sizeof(QVector3D),
+                 m_normals.constData(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
+    FrameStatisticsCollector::countBufferUpload(m_uvs.size() * sizeof(QVector2D));
+    glBufferData(GL_ARRAY_BUFFER, m_uvs.size() * sizeof(QVector2D),
+                 m_uvs.constData(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_selectionUVBuffer);
+    FrameStatisticsCollector::countBufferUpload(m_selectionUVs.size() * sizeof(QVector2D));
+    glBufferData(GL_ARRAY_BUFFER, m_selectionUVs.size() * sizeof(QVector2D),
+                 m_selectionUVs.constData(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
+    FrameStatisticsCollector::countBufferUpload(m_indices.size() * sizeof(GLuint));
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(GLuint),
+                 m_indices.constData(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    m_meshDataLoaded = true;
+}
+
+void BarObjectBufferHelper::update(BarSeriesRenderCache *cache)
+{
+    QList<int> &updateSlots = cache->updateIndices();
+    if (!m_meshDataLoaded || updateSlots.isEmpty()) {
+        updateSlots.clear();
+        return;
+    }
+
+    std::sort(updateSlots.begin(), updateSlots.end());
+    updateSlots.erase(std::unique(updateSlots.begin(), updateSlots.end()), updateSlots.end());
+
+    const BarRenderItemArray &renderArray = cache->renderArray();
+    const int barCount = m_layout.rowCount * m_layout.columnCount;
+    const int updateSize = updateSlots.size();
+
+    // Changed bars are staged at the start of the staging storage in slot order
+    const int minBarsPerTask = qMax(1, minVerticesPerTask / qMax(1, int(m_meshVertices.size())));
+    Utils::parallelFor(updateSize, minBarsPerTask, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const int slot = updateSlots.at(i);
+            if (slot >= barCount)
+                continue;
+            const int row = slot / m_layout.columnCount;
+            const int column = slot % m_layout.columnCount;
+            createBar(renderArray, row, column, slot, i);
+        }
+    });
+
+    // Patch consecutive slots with a single upload, which covers whole row updates
+    int runStart = 0;
+    for (int i = 1; i <= updateSize; i++) {
+        if (i == updateSize || updateSlots.at(i) != updateSlots.at(i - 1) + 1) {
+            if (updateSlots.at(runStart) < barCount) {
+                const int count = qMin(i - runStart, barCount - updateSlots.at(runStart));
+                uploadSlots(updateSlots.at(runStart), runStart, count);
+            }
+            runStart = i;
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    updateSlots.clear();
+}
+
+void BarObjectBufferHelper::createBar(const BarRenderItemArray &renderArray, int row, int column,
+                                      int slot, int target)
+{
+    const int verticeCount = m_meshVertices.size();
+    const int indicesCount = m_meshIndices.size();
+    const float height = renderArray.height(row, column);
+    QVector3D *vertices = m_vertices.data() + target * verticeCount;
+    QVector3D *normals = m_normals.data() + target * verticeCount;
+    QVector2D *uvs = m_uvs.data() + target * verticeCount;
+    QVector2D *selectionUVs = m_selectionUVs.data() + target * verticeCount;
+    GLuint *indices = m_indices.data() + target * indicesCount;
+
+    if (height == 0.0f) {
+        for (int j = 0; j < verticeCount; j++)
+            vertices[j] = hiddenPos;
+    } else {
+        const float colPos = (column + m_layout.seriesPos) * m_layout.barSpacing.width();
+        const float rowPos = (row + 0.5f) * m_layout.barSpacing.height();
+        const QVector3D modelScaler(m_layout.scaleX, height, m_layout.scaleZ);
+
+        QMatrix4x4 modelMatrix;
+        QMatrix4x4 itModelMatrix;
+        modelMatrix.translate((colPos - m_layout.rowWidth) / m_layout.scaleFactor, height,
+                              (m_layout.columnDepth - rowPos) / m_layout.scaleFactor);
+        const QQuaternion &rotation = renderArray.rotation(row, column);
+        if (!m_layout.seriesRotation.isIdentity() || !rotation.isIdentity()) {
+            QQuaternion totalRotation = m_layout.seriesRotation * rotation;
+            modelMatrix.rotate(totalRotation);
+            itModelMatrix.rotate(totalRotation);
+        }
+        modelMatrix.scale(modelScaler);
+        itModelMatrix.scale(modelScaler);
+
+        Utils::transformVertices(m_meshVertices.constData(), vertices, verticeCount,
+                                 modelMatrix, QVector3D());
+        Utils::transformVertices(m_meshNormals.constData(), normals, verticeCount,
+                                 itModelMatrix.transposed().inverted(), QVector3D());
+    }
+
+    // Gradient positions match the gradient shader mapping of the default path
+    if (m_layout.colorStyle == Q3DTheme::ColorStyleUniform) {
+        for (int j = 0; j < verticeCount; j++)
+            uvs[j] = QVector2D();
+    } else {
+        const float gradientHeight = (m_layout.colorStyle == Q3DTheme::ColorStyleRangeGradient)
+                ? qAbs(height) / m_layout.gradientFraction : 0.5f;
+        for (int j = 0; j < verticeCount; j++)
+            uvs[j] = QVector2D(0.0f, (m_meshVertices.at(j).y() + 1.0f) * gradientHeight);
+    }
+
+    // Selection colors encode row and column, bars without value are not selectable
+    const QVector2D selectionUV = renderArray.value(row, column)
+            ? QVector2D(GLfloat(row) / 255.0f, GLfloat(column) / 255.0f)
+            : QVector2D(-1.0f, -1.0f);
+    for (int j = 0; j < verticeCount; j++)
+        selectionUVs[j] = selectionUV;
+
+    // Negative height mirrors the bar, so flip the winding to keep front faces consistent
+    const GLuint offsetVertice = GLuint(slot * verticeCount);
+    if (height < 0.0f) {
+        for (int j = 0; j + 2 < indicesCount; j += 3) {
+            indices[j] = m_meshIndices.at(j) + offsetVertice;
+            indices[j + 1] = m_meshIndices.at(j + 2) + offsetVertice;
+            indices[j + 2] = m_meshIndices.at(j + 1) + offsetVertice;
+        }
+    } else {
+        for (int j = 0; j < indicesCount; j++)
+            indices[j] = m_meshIndices.at(j) + offsetVertice;
+    }
+}
+
+void BarObjectBufferHelper::uploadSlots(int firstSlot, int firstTarget, int count)
+{
+    const int verticeCount = m_meshVertices.size();
+    const int indicesCount = m_meshIndices.size();
+    const qsizetype vertexOffset = qsizetype(firstSlot) * verticeCount;
+    const qsizetype targetOffset = qsizetype(firstTarget) * verticeCount;
+    const qsizetype vertexSize = qsizetype(count) * verticeCount;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexbuffer);
+    FrameStatisticsCollector::countBufferUpload(vertexSize * sizeof(QVector3D));
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * sizeof(QVector3D),
+                    vertexSize * sizeof(QVector3D), &m_vertices.at(targetOffset));
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_normalbuffer);
+    FrameStatisticsCollector::countBufferUpload(vertexSize * sizeof(QVector3D));
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * sizeof(QVector3D),
+                    vertexSize * sizeof(QVector3D), &m_normals.at(targetOffset));
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
+    FrameStatisticsCollector::countBufferUpload(vertexSize * sizeof(QVector2D));
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * sizeof(QVector2D),
+                    vertexSize * sizeof(QVector2D), &m_uvs.at(targetOffset));
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_selectionUVBuffer);
+    FrameStatisticsCollector::countBufferUpload(vertexSize * sizeof(QVector2D));
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * sizeof(QVector2D),
+                    vertexSize * sizeof(QVector2D), &m_selectionUVs.at(targetOffset));
+
+    // Winding depends on the sign of the height, so indices are patched as well
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
+    FrameStatisticsCollector::countBufferUpload(qsizetype(count) * indicesCount * sizeof(GLuint));
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                    qsizetype(firstSlot) * indicesCount * sizeof(GLuint),
+                    qsizetype(count) * indicesCount * sizeof(GLuint),
+                    &m_indices.at(qsizetype(firstTarget) * indicesCount));
+}
+
+QT_END_NAMESPACE
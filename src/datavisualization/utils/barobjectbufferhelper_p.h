@@ -0,0 +1,85 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef BAROBJECTBUFFERHELPER_P_H
+#define BAROBJECTBUFFERHELPER_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "abstractobjecthelper_p.h"
+#include "barseriesrendercache_p.h"
+#include <QtCore/QSizeF>
+#include <QtGui/QVector2D>
+
+QT_BEGIN_NAMESPACE
+
+// Renderer state that determines where the bars of a series are placed. Buffers baked with
+// a different layout need a full reload.
+struct BarBufferLayout
+{
+    int rowCount = 0;
+    int columnCount = 0;
+    float seriesPos = 0.0f;
+    QSizeF barSpacing;
+    float rowWidth = 0.0f;
+    float columnDepth = 0.0f;
+    float scaleFactor = 1.0f;
+    float scaleX = 0.0f;
+    float scaleZ = 0.0f;
+    float gradientFraction = 1.0f;
+    QQuaternion seriesRotation;
+    Q3DTheme::ColorStyle colorStyle = Q3DTheme::ColorStyleUniform;
+    QString meshFileName;
+
+    bool operator==(const BarBufferLayout &other) const;
+    inline bool operator!=(const BarBufferLayout &other) const { return !(*this == other); }
+};
+
+class BarObjectBufferHelper : public AbstractObjectHelper
+{
+public:
+    BarObjectBufferHelper();
+    virtual ~BarObjectBufferHelper();
+
+    void fullLoad(BarSeriesRenderCache *cache, const BarBufferLayout &layout);
+    void update(BarSeriesRenderCache *cache);
+    inline const BarBufferLayout &layout() const { return m_layout; }
+
+    GLuint selectionUVBuf();
+
+public:
+    GLuint m_selectionUVBuffer;
+
+private:
+    void createBar(const BarRenderItemArray &renderArray, int row, int column, int slot,
+                   int target);
+    void uploadSlots(int firstSlot, int firstTarget, int count);
+
+    BarBufferLayout m_layout;
+    QList<QVector3D> m_meshVertices;
+    QList<QVector3D> m_meshNormals;
+    QList<GLuint> m_meshIndices;
+
+    // Staging storage, kept between loads
+    QList<QVector3D> m_vertices;
+    QList<QVector3D> m_normals;
+    QList<QVector2D> m_uvs;
+    QList<QVector2D> m_selectionUVs;
+    QList<GLuint> m_indices;
+
+    static const QVector3D hiddenPos;
+    static const int minVerticesPerTask;
+};
+
+QT_END_NAMESPACE
+
+#endif
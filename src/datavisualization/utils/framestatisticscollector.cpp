@@ -0,0 +1,157 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "framestatisticscollector_p.h"
+#include "utils_p.h"
+
+#if !QT_CONFIG(opengles2)
+#include <QtOpenGL/QOpenGLTimerQuery>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+thread_local FrameStatisticsCollector *FrameStatisticsCollector::s_active = nullptr;
+
+FrameStatisticsCollector::Scope::Scope(Phase phase)
+    : m_collector(s_active),
+      m_previousActive(s_active),
+      m_previousPhase(PhaseIdle),
+      m_activated(false)
+{
+    if (m_collector) {
+        m_previousPhase = m_collector->m_phase;
+        m_collector->switchPhase(phase);
+    }
+}
+
+FrameStatisticsCollector::Scope::Scope(FrameStatisticsCollector *collector, Phase phase)
+    : m_collector(collector),
+      m_previousActive(s_active),
+      m_previousPhase(PhaseIdle),
+      m_activated(collector != nullptr)
+{
+    if (m_collector) {
+        s_active = m_collector;
+        m_previousPhase = m_collector->m_phase;
+        m_collector->switchPhase(phase);
+    }
+}
+
+FrameStatisticsCollector::Scope::~Scope()
+{
+    if (m_collector)
+        m_collector->switchPhase(m_previousPhase);
+    if (m_activated)
+        s_active = m_previousActive;
+}
+
+FrameStatisticsCollector::FrameStatisticsCollector()
+    : m_phaseStart(0),
+      m_phase(PhaseIdle),
+      m_gpuTimerIndex(0),
+      m_gpuTimersSupported(true),
+      m_gpuTime(-1)
+{
+    m_timer.start();
+    for (int i = 0; i < PhaseCount; i++)
+        m_phaseTimes[i] = 0;
+    for (int i = 0; i < gpuTimerCount; i++) {
+        m_gpuTimers[i] = nullptr;
+        m_gpuTimerPending[i] = false;
+    }
+}
+
+FrameStatisticsCollector::~FrameStatisticsCollector()
+{
+    releaseGpuTimers();
+}
+
+void FrameStatisticsCollector::switchPhase(Phase phase)
+{
+    const qint64 now = m_timer.nsecsElapsed();
+    m_phaseTimes[m_phase] += now - m_phaseStart;
+    m_phaseStart = now;
+    m_phase = phase;
+}
+
+void FrameStatisticsCollector::beginGpuTimer()
+{
+#if !QT_CONFIG(opengles2)
+    if (!m_gpuTimersSupported || Utils::isOpenGLES())
+        return;
+
+    // Collect the results that have arrived without waiting for the others
+    for (int i = 0; i < gpuTimerCount; i++) {
+        const int index = (m_gpuTimerIndex + i) % gpuTimerCount;
+        if (m_gpuTimerPending[index] && m_gpuTimers[index]->isResultAvailable()) {
+            m_gpuTime = qint64(m_gpuTimers[index]->waitForResult()) / 1000;
+            m_gpuTimerPending[index] = false;
+        }
+    }
+
+    QOpenGLTimerQuery *&timer = m_gpuTimers[m_gpuTimerIndex];
+    if (!timer) {
+        timer = new QOpenGLTimerQuery;
+        if (!timer->create()) {
+            // Timer queries are not supported by the context
+            delete timer;
+            timer = nullptr;
+            m_gpuTimersSupported = false;
+            return;
+        }
+    }
+    if (m_gpuTimerPending[m_gpuTimerIndex]) {
+        // All queries are still in flight, skip timing this frame
+        return;
+    }
+    timer->begin();
+#endif
+}
+
+void FrameStatisticsCollector::endGpuTimer()
+{
+#if !QT_CONFIG(opengles2)
+    QOpenGLTimerQuery *timer = m_gpuTimers[m_gpuTimerIndex];
+    if (!m_gpuTimersSupported || !timer || m_gpuTimerPending[m_gpuTimerIndex])
+        return;
+
+    timer->end();
+    m_gpuTimerPending[m_gpuTimerIndex] = true;
+    m_gpuTimerIndex = (m_gpuTimerIndex + 1) % gpuTimerCount;
+#endif
+}
+
+void FrameStatisticsCollector::releaseGpuTimers()
+{
+#if !QT_CONFIG(opengles2)
+    for (int i = 0; i < gpuTimerCount; i++) {
+        delete m_gpuTimers[i];
+        m_gpuTimers[i] = nullptr;
+        m_gpuTimerPending[i] = false;
+    }
+#endif
+}
+
+Q3DFrameStatistics FrameStatisticsCollector::takeStatistics()
+{
+    // Account for the ongoing phase up to now
+    switchPhase(m_phase);
+
+    Q3DFrameStatistics statistics;
+    statistics.swap(m_statistics);
+    Q3DFrameStatisticsPrivate *data = statistics.d_ptr.data();
+    data->m_synchTime = m_phaseTimes[PhaseSynch] / 1000;
+    data->m_updateDataTime = m_phaseTimes[PhaseUpdateData] / 1000;
+    data->m_depthPassTime = m_phaseTimes[PhaseDepthPass] / 1000;
+    data->m_selectionPassTime = m_phaseTimes[PhaseSelectionPass] / 1000;
+    data->m_mainPassTime = m_phaseTimes[PhaseMainPass] / 1000;
+    data->m_labelTime = m_phaseTimes[PhaseLabels] / 1000;
+    data->m_customItemTime = m_phaseTimes[PhaseCustomItems] / 1000;
+    data->m_gpuTime = m_gpuTimersSupported ? m_gpuTime : -1;
+
+    for (int i = 0; i < PhaseCount; i++)
+        m_phaseTimes[i] = 0;
+    return statistics;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,114 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef FRAMESTATISTICSCOLLECTOR_P_H
+#define FRAMESTATISTICSCOLLECTOR_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "q3dframestatistics_p.h"
+#include <QtCore/QElapsedTimer>
+
+QT_BEGIN_NAMESPACE
+
+class QOpenGLTimerQuery;
+
+// Collects statistics of a frame on the render thread. The collector is only active on the thread
+// while a scope given the collector exists, so the static counters are no-ops when statistics
+// are not enabled.
+class FrameStatisticsCollector
+{
+public:
+    enum Phase {
+        PhaseIdle = 0,
+        PhaseSynch,
+        PhaseUpdateData,
+        PhaseDepthPass,
+        PhaseSelectionPass,
+        PhaseMainPass,
+        PhaseLabels,
+        PhaseCustomItems,
+        PhaseCount
+    };
+
+    // Attributes the time until the scope is destroyed to the phase. Nested scopes pause the
+    // enclosing phase, so phase times are exclusive.
+    class Scope
+    {
+    public:
+        explicit Scope(Phase phase);
+        // Activates the collector on this thread for the lifetime of the scope. Null collector
+        // leaves statistics disabled.
+        Scope(FrameStatisticsCollector *collector, Phase phase);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        FrameStatisticsCollector *m_collector;
+        FrameStatisticsCollector *m_previousActive;
+        Phase m_previousPhase;
+        bool m_activated;
+    };
+
+    FrameStatisticsCollector();
+    ~FrameStatisticsCollector();
+
+    static inline void countDrawCalls(int count = 1)
+    {
+        if (s_active)
+            s_active->m_statistics.d_ptr->m_drawCallCount += count;
+    }
+    static inline void countBufferUpload(qint64 bytes)
+    {
+        if (s_active)
+            s_active->m_statistics.d_ptr->m_bufferBytesUploaded += bytes;
+    }
+    static inline void countTextureCreation(qint64 bytes)
+    {
+        if (s_active)
+            s_active->m_statistics.d_ptr->m_textureBytesCreated += bytes;
+    }
+
+    // GPU timing requires a current context
+    void beginGpuTimer();
+    void endGpuTimer();
+    void releaseGpuTimers();
+
+    // Returns the statistics collected since the previous call and starts a new frame
+    Q3DFrameStatistics takeStatistics();
+
+private:
+    Q_DISABLE_COPY(FrameStatisticsCollector)
+
+    void switchPhase(Phase phase);
+
+    static thread_local FrameStatisticsCollector *s_active;
+
+    QElapsedTimer m_timer;
+    qint64 m_phaseStart;
+    Phase m_phase;
+    qint64 m_phaseTimes[PhaseCount];
+    Q3DFrameStatistics m_statistics;
+
+    // Queries are read back a few frames later to avoid stalling
+    static const int gpuTimerCount = 3;
+    QOpenGLTimerQuery *m_gpuTimers[gpuTimerCount];
+    bool m_gpuTimerPending[gpuTimerCount];
+    int m_gpuTimerIndex;
+    bool m_gpuTimersSupported;
+    qint64 m_gpuTime;
+};
+
+QT_END_NAMESPACE
+
+#endif
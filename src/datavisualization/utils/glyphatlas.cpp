@@ -0,0 +1,341 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "glyphatlas_p.h"
+#include "labelitem_p.h"
+#include "framestatisticscollector_p.h"
+
+#include <QtGui/QGlyphRun>
+#include <QtGui/QPainter>
+#include <QtGui/QRawFont>
+#include <QtGui/QTextLayout>
+#include <QtCore/qmath.h>
+
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+QT_BEGIN_NAMESPACE
+
+static const int atlasPageSize = 1024;
+// Smallest mip level sampled from the pages. A texel of level n covers 2^n pixels, and linear
+// filtering reads two neighboring texels.
+static const int atlasMaxMipLevel = 2;
+// Transparent border around glyphs, wide enough that filtering does not pick up the neighbors
+// at any of the mip levels used
+static const int glyphPadding = 2 << atlasMaxMipLevel;
+// Label paddings, same as used when printing labels into images
+static const int labelPadding = 20;
+static const int skewPadding = 10;
+// The rounded corners of the background stay intact, the middle two pixels are stretched
+static const int backgroundCornerSize = labelPadding;
+static const int backgroundTileSize = 2 * backgroundCornerSize + 2;
+
+size_t qHash(const GlyphAtlas::GlyphKey &key, size_t seed)
+{
+    return qHashMulti(seed, key.family, key.style, key.pixelSize, key.index);
+}
+
+// Appends two triangles covering rect, given in label pixels, with texture coordinates from
+// uvRect, given in page pixels. Label pixels map to the -1...1 range of the label plane.
+static void appendQuad(QList<GLfloat> &vertices, const QRectF &rect, const QRectF &uvRect,
+                       const QSize &labelSize, int pageSize)
+{
+    const GLfloat left = GLfloat(2.0 * rect.left() / labelSize.width() - 1.0);
+    const GLfloat right = GLfloat(2.0 * rect.right() / labelSize.width() - 1.0);
+    const GLfloat top = GLfloat(1.0 - 2.0 * rect.top() / labelSize.height());
+    const GLfloat bottom = GLfloat(1.0 - 2.0 * rect.bottom() / labelSize.height());
+    const GLfloat uLeft = GLfloat(uvRect.left() / pageSize);
+    const GLfloat uRight = GLfloat(uvRect.right() / pageSize);
+    const GLfloat vTop = GLfloat(uvRect.top() / pageSize);
+    const GLfloat vBottom = GLfloat(uvRect.bottom() / pageSize);
+
+    vertices << left << top << 0.0f << uLeft << vTop
+             << left << bottom << 0.0f << uLeft << vBottom
+             << right << top << 0.0f << uRight << vTop
+             << left << bottom << 0.0f << uLeft << vBottom
+             << right << bottom << 0.0f << uRight << vBottom
+             << right << top << 0.0f << uRight << vTop;
+}
+
+GlyphAtlasPage::GlyphAtlasPage(int size, const QColor &clearColor)
+    : m_image(size, size, QImage::Format_RGBA8888),
+      m_textureId(0),
+      m_rowX(0),
+      m_rowY(0),
+      m_rowHeight(0),
+      m_dirtyTop(size),
+      m_dirtyBottom(0),
+      m_mipmaps(false)
+{
+    // Clear to the text color, so that filtering at glyph edges does not darken the text
+    m_image.fill(clearColor);
+}
+
+GlyphAtlasPage::~GlyphAtlasPage()
+{
+    if (m_textureId && QOpenGLContext::currentContext())
+        QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
+}
+
+bool GlyphAtlasPage::allocate(const QSize &size, QRect &rect)
+{
+    if (m_rowX + size.width() > m_image.width()) {
+        m_rowX = 0;
+        m_rowY += m_rowHeight;
+        m_rowHeight = 0;
+    }
+    if (size.width() > m_image.width() || m_rowY + size.height() > m_image.height())
+        return false;
+
+    rect = QRect(QPoint(m_rowX, m_rowY), size);
+    m_rowX += size.width();
+    m_rowHeight = qMax(m_rowHeight, size.height());
+    m_dirtyTop = qMin(m_dirtyTop, rect.top());
+    m_dirtyBottom = qMax(m_dirtyBottom, rect.bottom() + 1);
+    return true;
+}
+
+void GlyphAtlasPage::upload()
+{
+    if (m_dirtyTop >= m_dirtyBottom)
+        return;
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    QOpenGLFunctions *funcs = context->functions();
+    if (!m_textureId) {
+        // The mip chain must stop before the glyph padding is used up, which needs the maximum
+        // level that OpenGL ES 2 does not have. There the pages are not mipmapped.
+        m_mipmaps = !context->isOpenGLES() || context->format().majorVersion() >= 3;
+        funcs->glGenTextures(1, &m_textureId);
+        funcs->glBindTexture(GL_TEXTURE_2D, m_textureId);
+        FrameStatisticsCollector::countTextureCreation(m_image.sizeInBytes());
+        funcs->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_image.width(), m_image.height(), 0,
+                            GL_RGBA, GL_UNSIGNED_BYTE, m_image.constBits());
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (m_mipmaps) {
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                                   GL_LINEAR_MIPMAP_LINEAR);
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, atlasMaxMipLevel);
+        } else {
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        }
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        // Whole rows are uploaded, as ES2 has no unpack row length
+        funcs->glBindTexture(GL_TEXTURE_2D, m_textureId);
+        funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_dirtyTop, m_image.width(),
+                               m_dirtyBottom - m_dirtyTop, GL_RGBA, GL_UNSIGNED_BYTE,
+                               m_image.constScanLine(m_dirtyTop));
+    }
+    if (m_mipmaps)
+        funcs->glGenerateMipmap(GL_TEXTURE_2D);
+    funcs->glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_dirtyTop = m_image.height();
+    m_dirtyBottom = 0;
+}
+
+GlyphAtlas::GlyphAtlas()
+    : m_labelBackground(false),
+      m_borders(false)
+{
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+}
+
+void GlyphAtlas::setStyle(const QFont &font, const QColor &bgrColor, const QColor &txtColor,
+                          bool labelBackground, bool borders)
+{
+    QFont textureFont = font;
+    textureFont.setPointSize(textureFontSize);
+
+    if (m_page && m_font == textureFont && m_bgrColor == bgrColor && m_txtColor == txtColor
+            && m_labelBackground == labelBackground && m_borders == borders) {
+        return;
+    }
+
+    m_font = textureFont;
+    m_bgrColor = bgrColor;
+    m_txtColor = txtColor;
+    m_labelBackground = labelBackground;
+    m_borders = borders;
+    resetPage();
+}
+
+void GlyphAtlas::generateLabel(LabelItem &item, const QString &text, int maxLabelWidth)
+{
+    if (!m_page)
+        resetPage();
+
+    QTextLayout layout(text, m_font);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    line.setNumColumns(text.size());
+    layout.endLayout();
+
+    const qreal naturalWidth = line.naturalTextWidth();
+    int textWidth = (maxLabelWidth && m_labelBackground) ? maxLabelWidth : qCeil(naturalWidth);
+    textWidth += skewPadding; // Fix clipping problem with skewed fonts (italic or italic-style)
+    const int textHeight = qCeil(line.height());
+    QSize labelSize(textWidth, textHeight);
+    if (m_labelBackground)
+        labelSize += QSize(2 * labelPadding, 2 * labelPadding);
+    const QPointF textOrigin((labelSize.width() - naturalWidth) / 2.0,
+                             (labelSize.height() - textHeight) / 2.0);
+
+    const QList<QGlyphRun> glyphRuns = layout.glyphRuns();
+    QList<GLfloat> vertices;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool complete = true;
+        vertices.clear();
+
+        if (m_labelBackground) {
+            QRect tile;
+            if (backgroundRect(tile)) {
+                const int c = backgroundCornerSize;
+                const qreal xs[4] = {0.0, qreal(c), qreal(labelSize.width() - c),
+                                     qreal(labelSize.width())};
+                const qreal ys[4] = {0.0, qreal(c), qreal(labelSize.height() - c),
+                                     qreal(labelSize.height())};
+                // Middle segments sample the center of the tile only
+                const qreal uStart[3] = {qreal(tile.left()), qreal(tile.left() + c + 1),
+                                         qreal(tile.left() + c + 2)};
+                const qreal uEnd[3] = {qreal(tile.left() + c), qreal(tile.left() + c + 1),
+                                       qreal(tile.left() + tile.width())};
+                const qreal vStart[3] = {qreal(tile.top()), qreal(tile.top() + c + 1),
+                                         qreal(tile.top() + c + 2)};
+                const qreal vEnd[3] = {qreal(tile.top() + c), qreal(tile.top() + c + 1),
+                                       qreal(tile.top() + tile.height())};
+                for (int row = 0; row < 3; row++) {
+                    for (int column = 0; column < 3; column++) {
+                        appendQuad(vertices,
+                                   QRectF(QPointF(xs[column], ys[row]),
+                                          QPointF(xs[column + 1], ys[row + 1])),
+                                   QRectF(QPointF(uStart[column], vStart[row]),
+                                          QPointF(uEnd[column], vEnd[row])),
+                                   labelSize, m_page->size());
+                    }
+                }
+            } else {
+                complete = false;
+            }
+        }
+
+        for (const QGlyphRun &run : glyphRuns) {
+            const QRawFont rawFont = run.rawFont();
+            const QList<quint32> indexes = run.glyphIndexes();
+            const QList<QPointF> positions = run.positions();
+            for (int i = 0; i < indexes.size(); i++) {
+                Glyph cached;
+                if (!glyph(rawFont, indexes.at(i), cached)) {
+                    complete = false;
+                    continue;
+                }
+                if (cached.rect.isEmpty())
+                    continue;
+                const QPointF topLeft = textOrigin + positions.at(i) + QPointF(cached.offset);
+                appendQuad(vertices, QRectF(topLeft, QSizeF(cached.rect.size())),
+                           QRectF(cached.rect), labelSize, m_page->size());
+            }
+        }
+
+        if (complete)
+            break;
+        if (attempt) {
+            qWarning("Label \"%s\" does not fit on an empty glyph atlas page,"
+                     " some of its glyphs are not drawn.", qPrintable(text));
+            break;
+        }
+
+        // The page is full. Start a new one, labels built from the old page keep it alive.
+        resetPage();
+    }
+
+    m_page->upload();
+
+    item.setSize(labelSize);
+    item.setGlyphData(m_page, vertices);
+}
+
+void GlyphAtlas::resetPage()
+{
+    QColor clearColor = m_txtColor;
+    clearColor.setAlpha(0);
+    m_page = QSharedPointer<GlyphAtlasPage>::create(atlasPageSize, clearColor);
+    m_glyphs.clear();
+    m_backgroundRect = QRect();
+}
+
+bool GlyphAtlas::glyph(const QRawFont &font, quint32 index, Glyph &glyph)
+{
+    const GlyphKey key = {font.familyName(), font.styleName(), font.pixelSize(), index};
+    const auto it = m_glyphs.constFind(key);
+    if (it != m_glyphs.constEnd()) {
+        glyph = it.value();
+        return true;
+    }
+
+    glyph = Glyph();
+    const QRectF bounds = font.boundingRect(index);
+    if (!bounds.isEmpty()) {
+        const QRect inkRect(QPoint(qFloor(bounds.left()), qFloor(bounds.top())),
+                            QPoint(qCeil(bounds.right()), qCeil(bounds.bottom())));
+        const QSize cellSize = inkRect.size() + QSize(2 * glyphPadding, 2 * glyphPadding);
+        if (!m_page->allocate(cellSize, glyph.rect))
+            return false;
+        glyph.offset = inkRect.topLeft() - QPoint(glyphPadding, glyphPadding);
+
+        QGlyphRun run;
+        run.setRawFont(font);
+        run.setGlyphIndexes(QList<quint32>() << index);
+        run.setPositions(QList<QPointF>() << QPointF());
+
+        QPainter painter(&m_page->image());
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.setClipRect(glyph.rect);
+        painter.setPen(m_txtColor);
+        painter.drawGlyphRun(QPointF(glyph.rect.topLeft() - glyph.offset), run);
+    }
+
+    m_glyphs.insert(key, glyph);
+    return true;
+}
+
+bool GlyphAtlas::backgroundRect(QRect &rect)
+{
+    if (m_backgroundRect.isNull()) {
+        const QSize cellSize(backgroundTileSize + 2 * glyphPadding,
+                             backgroundTileSize + 2 * glyphPadding);
+        QRect cell;
+        if (!m_page->allocate(cellSize, cell))
+            return false;
+        m_backgroundRect = cell.adjusted(glyphPadding, glyphPadding,
+                                         -glyphPadding, -glyphPadding);
+
+        QPainter painter(&m_page->image());
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.setClipRect(m_backgroundRect);
+        painter.translate(m_backgroundRect.topLeft());
+        painter.setBrush(QBrush(m_bgrColor));
+        const qreal radius = 10.0;
+        if (m_borders) {
+            painter.setPen(QPen(QBrush(m_txtColor), 5.0, Qt::SolidLine, Qt::SquareCap,
+                                Qt::RoundJoin));
+            painter.drawRoundedRect(5, 5, backgroundTileSize - 10, backgroundTileSize - 10,
+                                    radius, radius);
+        } else {
+            painter.setPen(m_bgrColor);
+            painter.drawRoundedRect(0, 0, backgroundTileSize, backgroundTileSize,
+                                    radius, radius);
+        }
+    }
+    rect = m_backgroundRect;
+    return true;
+}
+
+QT_END_NAMESPACE
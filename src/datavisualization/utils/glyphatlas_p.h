@@ -0,0 +1,109 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef GLYPHATLAS_P_H
+#define GLYPHATLAS_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QHash>
+#include <QtCore/QRect>
+#include <QtCore/QSharedPointer>
+#include <QtGui/QColor>
+#include <QtGui/QFont>
+#include <QtGui/QImage>
+
+QT_BEGIN_NAMESPACE
+
+class LabelItem;
+class QRawFont;
+
+// A single atlas texture, filled in rows. Labels keep the page they were built from alive,
+// so a page outlives the glyph cache that filled it.
+class GlyphAtlasPage
+{
+public:
+    GlyphAtlasPage(int size, const QColor &clearColor);
+    ~GlyphAtlasPage();
+
+    inline GLuint textureId() const { return m_textureId; }
+    inline int size() const { return m_image.width(); }
+    inline QImage &image() { return m_image; }
+
+    bool allocate(const QSize &size, QRect &rect);
+    void upload();
+
+private:
+    Q_DISABLE_COPY(GlyphAtlasPage)
+
+    QImage m_image;
+    GLuint m_textureId;
+    int m_rowX;
+    int m_rowY;
+    int m_rowHeight;
+    int m_dirtyTop;
+    int m_dirtyBottom;
+    bool m_mipmaps;
+};
+
+// Builds label geometry from glyphs cached in an atlas. Glyphs are rasterized once per style,
+// so regenerating a label with known glyphs only lays out the text.
+class GlyphAtlas
+{
+public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    void setStyle(const QFont &font, const QColor &bgrColor, const QColor &txtColor,
+                  bool labelBackground, bool borders);
+    void generateLabel(LabelItem &item, const QString &text, int maxLabelWidth = 0);
+
+private:
+    struct GlyphKey
+    {
+        QString family;
+        QString style;
+        qreal pixelSize;
+        quint32 index;
+
+        inline bool operator==(const GlyphKey &other) const
+        {
+            return index == other.index && pixelSize == other.pixelSize
+                    && family == other.family && style == other.style;
+        }
+    };
+    friend size_t qHash(const GlyphKey &key, size_t seed);
+
+    struct Glyph
+    {
+        QRect rect;     // Location in the page, empty for glyphs without ink
+        QPoint offset;  // From the pen position to the top left corner of the rect
+    };
+
+    void resetPage();
+    bool glyph(const QRawFont &font, quint32 index, Glyph &glyph);
+    bool backgroundRect(QRect &rect);
+
+    QFont m_font;
+    QColor m_bgrColor;
+    QColor m_txtColor;
+    bool m_labelBackground;
+    bool m_borders;
+
+    QSharedPointer<GlyphAtlasPage> m_page;
+    QHash<GlyphKey, Glyph> m_glyphs;
+    QRect m_backgroundRect;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -4,6 +4,7 @@
 #include "meshloader_p.h"
 #include "vertexindexer_p.h"
 #include "objecthelper_p.h"
+#include "framestatisticscollector_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -136,23 +137,27 @@ void ObjectHelper::load()
 
         glGenBuffers(1, &m_vertexbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_vertexbuffer);
+        FrameStatisticsCollector::countBufferUpload(m_indexedVertices.size() * sizeof(QVector3D));
         glBufferData(GL_ARRAY_BUFFER, m_indexedVertices.size() * sizeof(QVector3D),
                      &m_indexedVertices.at(0),
                      GL_STATIC_DRAW);
 
         glGenBuffers(1, &m_normalbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_normalbuffer);
+        FrameStatisticsCollector::countBufferUpload(m_indexedNormals.size() * sizeof(QVector3D));
         glBufferData(GL_ARRAY_BUFFER, m_indexedNormals.size() * sizeof(QVector3D),
                      &m_indexedNormals.at(0),
                      GL_STATIC_DRAW);
 
         glGenBuffers(1, &m_uvbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
+        FrameStatisticsCollector::countBufferUpload(m_indexedUVs.size() * sizeof(QVector2D));
         glBufferData(GL_ARRAY_BUFFER, m_indexedUVs.size() * sizeof(QVector2D),
                      &m_indexedUVs.at(0), GL_STATIC_DRAW);
 
         glGenBuffers(1, &m_elementbuffer);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
+        FrameStatisticsCollector::countBufferUpload(m_indices.size() * sizeof(GLuint));
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(GLuint),
                      &m_indices.at(0), GL_STATIC_DRAW);
 
@@ -0,0 +1,112 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "scatterinstancebufferhelper_p.h"
+#include "framestatisticscollector_p.h"
+
+QT_BEGIN_NAMESPACE
+
+const int ScatterInstanceBufferHelper::positionOffset = 0;
+const int ScatterInstanceBufferHelper::rotationOffset = sizeof(QVector4D);
+const int ScatterInstanceBufferHelper::uvOffset = 2 * sizeof(QVector4D);
+const int ScatterInstanceBufferHelper::indexOffset = 2 * sizeof(QVector4D) + sizeof(QVector2D);
+
+ScatterInstanceBufferHelper::ScatterInstanceBufferHelper()
+    : m_instancebuffer(0),
+      m_scaleY(0.0f)
+{
+}
+
+ScatterInstanceBufferHelper::~ScatterInstanceBufferHelper()
+{
+    if (QOpenGLContext::currentContext())
+        glDeleteBuffers(1, &m_instancebuffer);
+}
+
+GLuint ScatterInstanceBufferHelper::instanceBuf()
+{
+    if (!m_meshDataLoaded)
+        qFatal("No loaded object");
+    return m_instancebuffer;
+}
+
+void ScatterInstanceBufferHelper::load(ScatterSeriesRenderCache *cache)
+{
+    const ScatterRenderItemArray &renderArray = cache->renderArray();
+    const int renderArraySize = renderArray.size();
+    const QQuaternion seriesRotation(cache->meshRotation());
+    const bool rangeGradient = (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient);
+    m_indexCount = 0;
+
+    // Instance slots map directly to render array indices, so hidden items keep their slot
+    // and item updates never need to remap the buffer.
+    m_bufferedInstances.resize(renderArraySize);
+    for (int i = 0; i < renderArraySize; i++)
+        createInstance(renderArray, i, seriesRotation, rangeGradient);
+
+    if (renderArray.hasVisibleItems())
+        m_indexCount = renderArraySize;
+
+    if (m_indexCount > 0) {
+        if (!m_instancebuffer)
+            glGenBuffers(1, &m_instancebuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_instancebuffer);
+        FrameStatisticsCollector::countBufferUpload(renderArraySize * sizeof(ScatterInstanceData));
+        glBufferData(GL_ARRAY_BUFFER, renderArraySize * sizeof(ScatterInstanceData),
+                     &m_bufferedInstances.at(0), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_meshDataLoaded = true;
+    }
+}
+
+void ScatterInstanceBufferHelper::update(ScatterSeriesRenderCache *cache)
+{
+    // If the whole series was hidden on last load, there is no buffer to patch
+    if (m_indexCount == 0) {
+        load(cache);
+        return;
+    }
+
+    const ScatterRenderItemArray &renderArray = cache->renderArray();
+    const int updateSize = cache->updateIndices().size();
+    const QQuaternion seriesRotation(cache->meshRotation());
+    const bool rangeGradient = (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instancebuffer);
+    for (int i = 0; i < updateSize; i++) {
+        int index = cache->updateIndices().at(i);
+        if (index >= m_bufferedInstances.size())
+            continue;
+        createInstance(renderArray, index, seriesRotation, rangeGradient);
+        FrameStatisticsCollector::countBufferUpload(sizeof(ScatterInstanceData));
+        glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(ScatterInstanceData),
+                        sizeof(ScatterInstanceData), &m_bufferedInstances.at(index));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ScatterInstanceBufferHelper::createInstance(const ScatterRenderItemArray &renderArray,
+                                                 int index, const QQuaternion &seriesRotation,
+                                                 bool rangeGradient)
+{
+    ScatterInstanceData &instance = m_bufferedInstances[index];
+    const QVector3D &translation = renderArray.translation(index);
+    if (!renderArray.isVisible(index)) {
+        instance.position = QVector4D();
+        instance.rotation = QVector4D(0.0f, 0.0f, 0.0f, 1.0f);
+    } else {
+        instance.position = QVector4D(translation, 1.0f);
+        QQuaternion totalRotation = seriesRotation * renderArray.rotation(index);
+        instance.rotation = QVector4D(totalRotation.vector(), totalRotation.scalar());
+    }
+    if (rangeGradient) {
+        float y = ((translation.y() + m_scaleY) * 0.5f) / m_scaleY;
+        instance.uv = QVector2D(1.0f, y);
+    } else {
+        instance.uv = QVector2D(0.0f, 0.0f);
+    }
+    instance.index = GLfloat(index);
+}
+
+QT_END_NAMESPACE
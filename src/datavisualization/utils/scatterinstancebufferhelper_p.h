@@ -0,0 +1,64 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SCATTERINSTANCEBUFFERHELPER_P_H
+#define SCATTERINSTANCEBUFFERHELPER_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "abstractobjecthelper_p.h"
+#include "scatterseriesrendercache_p.h"
+#include <QtGui/QVector2D>
+#include <QtGui/QVector4D>
+
+QT_BEGIN_NAMESPACE
+
+// Per-instance attributes of a single scatter item, consumed by the instanced shaders
+struct ScatterInstanceData
+{
+    QVector4D position; // Translation in xyz, w is zero for hidden items to collapse the mesh
+    QVector4D rotation; // Total rotation quaternion as (x, y, z, scalar)
+    QVector2D uv;       // x is range gradient weight, y is range gradient position
+    GLfloat index;      // Item index within series, used for selection colors
+};
+
+class ScatterInstanceBufferHelper : public AbstractObjectHelper
+{
+public:
+    ScatterInstanceBufferHelper();
+    virtual ~ScatterInstanceBufferHelper();
+
+    GLuint instanceBuf();
+
+    void load(ScatterSeriesRenderCache *cache);
+    void update(ScatterSeriesRenderCache *cache);
+    void setScaleY(float scale) { m_scaleY = scale; }
+
+    static const int positionOffset;
+    static const int rotationOffset;
+    static const int uvOffset;
+    static const int indexOffset;
+
+public:
+    GLuint m_instancebuffer;
+
+private:
+    void createInstance(const ScatterRenderItemArray &renderArray, int index,
+                        const QQuaternion &seriesRotation, bool rangeGradient);
+
+    QList<ScatterInstanceData> m_bufferedInstances;
+    float m_scaleY;
+};
+
+QT_END_NAMESPACE
+
+#endif
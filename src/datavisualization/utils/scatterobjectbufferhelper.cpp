@@ -3,6 +3,8 @@
 
 #include "scatterobjectbufferhelper_p.h"
 #include "objecthelper_p.h"
+#include "utils_p.h"
+#include "framestatisticscollector_p.h"
 #include <QtGui/QVector2D>
 #include <QtGui/QMatrix4x4>
 #include <QtCore/qmath.h>
@@ -10,6 +12,8 @@
 QT_BEGIN_NAMESPACE
 
 const GLfloat ScatterObjectBufferHelper::itemScaler = 3.0f;
+const QVector3D ScatterObjectBufferHelper::hiddenPos(0.0f, 0.0f, 0.0f);
+const int ScatterObjectBufferHelper::minVerticesPerTask = 32768;
 
 ScatterObjectBufferHelper::ScatterObjectBufferHelper()
     : m_scaleY(0.0f)
@@ -31,22 +35,8 @@ void ScatterObjectBufferHelper::fullLoad(ScatterSeriesRenderCache *cache, qreal
     if (renderArraySize == 0)
         return;  // No use to go forward
 
-    uint itemCount = 0;
     QQuaternion seriesRotation(cache->meshRotation());
 
-    if (m_meshDataLoaded) {
-        // Delete old data
-        glDeleteBuffers(1, &m_vertexbuffer);
-        glDeleteBuffers(1, &m_uvbuffer);
-        glDeleteBuffers(1, &m_normalbuffer);
-        glDeleteBuffers(1, &m_elementbuffer);
-        m_vertexbuffer = 0;
-        m_uvbuffer = 0;
-        m_normalbuffer = 0;
-        m_elementbuffer = 0;
-        m_meshDataLoaded = false;
-    }
-
     // Index vertices
     const QList<GLuint> indices = dotObj->indices();
     const QList<QVector3D> indexed_vertices = dotObj->indexedvertices();
@@ -62,27 +52,22 @@ void ScatterObjectBufferHelper::fullLoad(ScatterSeriesRenderCache *cache, qreal
         itemSize = dotScale;
     QVector3D modelScaler(itemSize, itemSize, itemSize);
     QMatrix4x4 modelMatrix;
-    if (!seriesRotation.isIdentity()) {
-        QMatrix4x4 matrix;
-        matrix.rotate(seriesRotation);
-        modelMatrix = matrix.transposed();
-    }
+    if (!seriesRotation.isIdentity())
+        modelMatrix.rotate(seriesRotation);
     modelMatrix.scale(modelScaler);
 
     QList<QVector3D> scaled_vertices;
     scaled_vertices.resize(verticeCount);
-    for (int i = 0; i < verticeCount; i++)
-        scaled_vertices[i] = (QVector4D(indexed_vertices[i]) * modelMatrix).toVector3D();
-
-    QList<GLuint> buffered_indices;
-    QList<QVector3D> buffered_vertices;
-    QList<QVector2D> buffered_uvs;
-    QList<QVector3D> buffered_normals;
+    Utils::transformVertices(indexed_vertices.constData(), scaled_vertices.data(), verticeCount,
+                             modelMatrix, QVector3D());
 
-    buffered_indices.resize(indicesCount * renderArraySize);
-    buffered_vertices.resize(verticeCount * renderArraySize);
-    buffered_normals.resize(normalsCount * renderArraySize);
-    buffered_uvs.resize(uvsCount * renderArraySize);
+    // Buffer contents are built in the staging arena of the series, which keeps its storage
+    // between loads
+    ScatterStagingArena &arena = cache->stagingArena();
+    GLuint *buffered_indices = arena.indices(indicesCount * renderArraySize);
+    QVector3D *buffered_vertices = arena.vertices(verticeCount * renderArraySize);
+    QVector3D *buffered_normals = arena.normals(normalsCount * renderArraySize);
+    QVector2D *buffered_uvs = arena.uvs(uvsCount * renderArraySize);
 
     if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
         createRangeGradientUVs(cache, buffered_uvs);
@@ -90,77 +75,88 @@ void ScatterObjectBufferHelper::fullLoad(ScatterSeriesRenderCache *cache, qreal
         createObjectGradientUVs(cache, buffered_uvs, indexed_vertices);
 
     QVector2D dummyUV(0.0f, 0.0f);
+    const bool uniformColor = (cache->colorStyle() == Q3DTheme::ColorStyleUniform);
+
+    // Every item gets a fixed slot matching its render array index. Hidden items are kept in
+    // the buffers as degenerate triangles, so visibility changes only touch their own slot.
+    // As items only write to their own slots, they can be processed in parallel.
+    const int minItemsPerTask = qMax(1, minVerticesPerTask / qMax(1, verticeCount));
+    Utils::parallelFor(renderArraySize, minItemsPerTask, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const QVector3D &translation = renderArray.translation(i);
+            const QQuaternion &rotation = renderArray.rotation(i);
+
+            int offset = i * verticeCount;
+            if (rotation.isIdentity()) {
+                for (int j = 0; j < verticeCount; j++) {
+                    buffered_vertices[j + offset] = scaled_vertices[j] + translation;
+                    buffered_normals[j + offset] = indexed_normals[j];
+                }
+            } else {
+                QMatrix4x4 matrix;
+                matrix.rotate(seriesRotation * rotation);
+                matrix.scale(modelScaler);
+                Utils::transformVertices(indexed_vertices.constData(), &buffered_vertices[offset],
+                                         verticeCount, matrix, translation);
+                Utils::transformVertices(indexed_normals.constData(), &buffered_normals[offset],
+                                         verticeCount, matrix.inverted().transposed(),
+                                         QVector3D());
+            }
 
-    cache->bufferIndices().resize(renderArraySize);
-
-    for (uint i = 0; i < renderArraySize; i++) {
-        const ScatterRenderItem &item = renderArray.at(i);
-        if (!item.isVisible())
-            continue;
-        else
-            cache->bufferIndices()[i] = itemCount;
-
-        int offset = itemCount * verticeCount;
-        if (item.rotation().isIdentity()) {
-            for (int j = 0; j < verticeCount; j++) {
-                buffered_vertices[j + offset] = scaled_vertices[j] + item.translation();
-                buffered_normals[j + offset] = indexed_normals[j];
+            if (!renderArray.isVisible(i)) {
+                for (int j = 0; j < verticeCount; j++)
+                    buffered_vertices[j + offset] = hiddenPos;
             }
-        } else {
-            QMatrix4x4 matrix;
-            QQuaternion totalRotation = seriesRotation * item.rotation();
-            matrix.rotate(totalRotation);
-            matrix.scale(modelScaler);
-            QMatrix4x4 itModelMatrix = matrix.inverted();
-            modelMatrix = matrix.transposed(); // Because of row-column major difference
-
-            for (int j = 0; j < verticeCount; j++) {
-                buffered_vertices[j + offset]
-                        = (QVector4D(indexed_vertices[j]) * modelMatrix).toVector3D()
-                        + item.translation();
-                buffered_normals[j + offset]
-                        = (QVector4D(indexed_normals[j]) * itModelMatrix).toVector3D();
+
+            if (uniformColor) {
+                offset = i * uvsCount;
+                for (int j = 0; j < uvsCount; j++)
+                    buffered_uvs[j + offset] = dummyUV;
             }
-        }
 
-        if (cache->colorStyle() == Q3DTheme::ColorStyleUniform) {
-            offset = itemCount * uvsCount;
-            for (int j = 0; j < uvsCount; j++)
-                buffered_uvs[j + offset] = dummyUV;
+            int offsetVertice = i * verticeCount;
+            offset = i * indicesCount;
+            for (int j = 0; j < indicesCount; j++)
+                buffered_indices[j + offset] = GLuint(indices[j] + offsetVertice);
+        }
+    });
+
+    // Buffers are not created at all if there is nothing to draw, in which case the first
+    // update will do a full load instead.
+    if (renderArray.hasVisibleItems())
+        m_indexCount = indicesCount * renderArraySize;
+
+    if (m_indexCount > 0) {
+        // Existing buffer objects are reused. Respecifying their data store orphans the old
+        // storage, so the driver does not need to synchronize with pending draws.
+        if (!m_meshDataLoaded) {
+            glGenBuffers(1, &m_vertexbuffer);
+            glGenBuffers(1, &m_normalbuffer);
+            glGenBuffers(1, &m_uvbuffer);
+            glGenBuffers(1, &m_elementbuffer);
         }
 
-        int offsetVertice = itemCount * verticeCount;
-        offset = itemCount * indicesCount;
-        for (int j = 0; j < indicesCount; j++)
-            buffered_indices[j + offset] = GLuint(indices[j] + offsetVertice);
-
-        itemCount++;
-    }
-
-    m_indexCount = indicesCount * itemCount;
-
-    if (itemCount > 0) {
-        glGenBuffers(1, &m_vertexbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_vertexbuffer);
-        glBufferData(GL_ARRAY_BUFFER, verticeCount * itemCount * sizeof(QVector3D),
-                     &buffered_vertices.at(0),
-                     GL_STATIC_DRAW);
+        FrameStatisticsCollector::countBufferUpload(
+                    verticeCount * renderArraySize * sizeof(QVector3D));
+        glBufferData(GL_ARRAY_BUFFER, verticeCount * renderArraySize * sizeof(QVector3D),
+                     buffered_vertices, GL_DYNAMIC_DRAW);
 
-        glGenBuffers(1, &m_normalbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_normalbuffer);
-        glBufferData(GL_ARRAY_BUFFER, normalsCount * itemCount * sizeof(QVector3D),
-                     &buffered_normals.at(0),
-                     GL_STATIC_DRAW);
+        FrameStatisticsCollector::countBufferUpload(
+                    normalsCount * renderArraySize * sizeof(QVector3D));
+        glBufferData(GL_ARRAY_BUFFER, normalsCount * renderArraySize * sizeof(QVector3D),
+                     buffered_normals, GL_STATIC_DRAW);
 
-        glGenBuffers(1, &m_uvbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
-        glBufferData(GL_ARRAY_BUFFER, uvsCount * itemCount * sizeof(QVector2D),
-                     &buffered_uvs.at(0), GL_STATIC_DRAW);
+        FrameStatisticsCollector::countBufferUpload(uvsCount * renderArraySize * sizeof(QVector2D));
+        glBufferData(GL_ARRAY_BUFFER, uvsCount * renderArraySize * sizeof(QVector2D),
+                     buffered_uvs, GL_DYNAMIC_DRAW);
 
-        glGenBuffers(1, &m_elementbuffer);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesCount * itemCount * sizeof(GLint),
-                     &buffered_indices.at(0), GL_STATIC_DRAW);
+        FrameStatisticsCollector::countBufferUpload(indicesCount * renderArraySize * sizeof(GLint));
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesCount * renderArraySize * sizeof(GLint),
+                     buffered_indices, GL_STATIC_DRAW);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -171,6 +167,10 @@ void ScatterObjectBufferHelper::fullLoad(ScatterSeriesRenderCache *cache, qreal
 
 void ScatterObjectBufferHelper::updateUVs(ScatterSeriesRenderCache *cache)
 {
+    // Buffers do not exist if the entire series was hidden on last load
+    if (m_indexCount == 0)
+        return;
+
     ObjectHelper *dotObj = cache->object();
     const int uvsCount = dotObj->indexedUVs().size();
     const ScatterRenderItemArray &renderArray = cache->renderArray();
@@ -180,8 +180,7 @@ void ScatterObjectBufferHelper::updateUVs(ScatterSeriesRenderCache *cache)
     if (!updateSize)
         return;
 
-    QList<QVector2D> buffered_uvs;
-    buffered_uvs.resize(uvsCount * updateSize);
+    QVector2D *buffered_uvs = cache->stagingArena().uvs(uvsCount * updateSize);
 
     uint itemCount = 0;
     if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient) {
@@ -194,23 +193,21 @@ void ScatterObjectBufferHelper::updateUVs(ScatterSeriesRenderCache *cache)
     glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
     int itemSize = uvsCount * sizeof(QVector2D);
     if (cache->updateIndices().size()) {
-        int pos = 0;
         for (int i = 0; i < updateSize; i++) {
             int index = cache->updateIndices().at(i);
-            if (renderArray.at(index).isVisible()) {
-                int dataPos = cache->bufferIndices().at(index);
-                glBufferSubData(GL_ARRAY_BUFFER, itemSize * dataPos, itemSize,
-                                &buffered_uvs.at(uvsCount * pos++));
-            }
+            FrameStatisticsCollector::countBufferUpload(itemSize);
+            glBufferSubData(GL_ARRAY_BUFFER, itemSize * index, itemSize,
+                            &buffered_uvs[uvsCount * i]);
         }
     } else {
-        glBufferData(GL_ARRAY_BUFFER, itemSize * itemCount, &buffered_uvs.at(0), GL_STATIC_DRAW);
+        FrameStatisticsCollector::countBufferUpload(itemSize * itemCount);
+        glBufferData(GL_ARRAY_BUFFER, itemSize * itemCount, buffered_uvs, GL_DYNAMIC_DRAW);
     }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 uint ScatterObjectBufferHelper::createRangeGradientUVs(ScatterSeriesRenderCache *cache,
-                                                       QList<QVector2D> &buffered_uvs)
+                                                       QVector2D *buffered_uvs)
 {
     ObjectHelper *dotObj = cache->object();
     const int uvsCount = dotObj->indexedUVs().size();
@@ -220,39 +217,35 @@ uint ScatterObjectBufferHelper::createRangeGradientUVs(ScatterSeriesRenderCache
     const float yAdjustment = 0.1f;
     const float flippedYAdjustment = 0.9f;
 
-    QVector2D uv;
-    uv.setX(0.0f);
-    uint pos = 0;
-    for (int i = 0; i < updateSize; i++) {
-        int index = updateAll ? i : cache->updateIndices().at(i);
-        const ScatterRenderItem &item = renderArray.at(index);
-        if (!item.isVisible())
-            continue;
-
-        float y = ((item.translation().y() + m_scaleY) * 0.5f) / m_scaleY;
-
-        // Avoid values near gradient texel boundary, as this causes artifacts
-        // with some graphics cards.
-        const float floorY = float(qFloor(y * gradientTextureHeight));
-        const float diff = (y * gradientTextureHeight) - floorY;
-        if (diff < yAdjustment)
-            y += yAdjustment / gradientTextureHeight;
-        else if (diff > flippedYAdjustment)
-            y -= yAdjustment / gradientTextureHeight;
-        uv.setY(y);
-
-        int offset = pos * uvsCount;
-        for (int j = 0; j < uvsCount; j++)
-            buffered_uvs[j + offset] = uv;
-
-        pos++;
-    }
+    const int minItemsPerTask = qMax(1, minVerticesPerTask / qMax(1, uvsCount));
+    Utils::parallelFor(updateSize, minItemsPerTask, [&](int begin, int end) {
+        QVector2D uv;
+        uv.setX(0.0f);
+        for (int i = begin; i < end; i++) {
+            int index = updateAll ? i : cache->updateIndices().at(i);
+            float y = ((renderArray.translation(index).y() + m_scaleY) * 0.5f) / m_scaleY;
+
+            // Avoid values near gradient texel boundary, as this causes artifacts
+            // with some graphics cards.
+            const float floorY = float(qFloor(y * gradientTextureHeight));
+            const float diff = (y * gradientTextureHeight) - floorY;
+            if (diff < yAdjustment)
+                y += yAdjustment / gradientTextureHeight;
+            else if (diff > flippedYAdjustment)
+                y -= yAdjustment / gradientTextureHeight;
+            uv.setY(y);
+
+            int offset = i * uvsCount;
+            for (int j = 0; j < uvsCount; j++)
+                buffered_uvs[j + offset] = uv;
+        }
+    });
 
-    return pos;
+    return updateSize;
 }
 
 uint ScatterObjectBufferHelper::createObjectGradientUVs(ScatterSeriesRenderCache *cache,
-                                                        QList<QVector2D> &buffered_uvs,
+                                                        QVector2D *buffered_uvs,
                                                         const QList<QVector3D> &indexed_vertices)
 {
     ObjectHelper *dotObj = cache->object();
@@ -264,10 +257,6 @@ uint ScatterObjectBufferHelper::createObjectGradientUVs(ScatterSeriesRenderCache
     uv.setX(0.0f);
     uint pos = 0;
     for (uint i = 0; i < renderArraySize; i++) {
-        const ScatterRenderItem &item = renderArray.at(i);
-        if (!item.isVisible())
-            continue;
-
         int offset = pos * uvsCount;
         for (int j = 0; j < uvsCount; j++) {
             uv.setY((indexed_vertices.at(j).y() + 1.0f) / 2.0f);
@@ -282,6 +271,13 @@ uint ScatterObjectBufferHelper::createObjectGradientUVs(ScatterSeriesRenderCache
 
 void ScatterObjectBufferHelper::update(ScatterSeriesRenderCache *cache, qreal dotScale)
 {
+    // If the entire series was hidden on last load, there are no buffers to update
+    if (m_indexCount == 0) {
+        cache->updateIndices().clear();
+        fullLoad(cache, dotScale);
+        return;
+    }
+
     ObjectHelper *dotObj = cache->object();
     const ScatterRenderItemArray &renderArray = cache->renderArray();
     const bool updateAll = (cache->updateIndices().size() == 0);
@@ -300,63 +296,53 @@ void ScatterObjectBufferHelper::update(ScatterSeriesRenderCache *cache, qreal do
         itemSize = dotScale;
     QVector3D modelScaler(itemSize, itemSize, itemSize);
     QMatrix4x4 modelMatrix;
-    if (!seriesRotation.isIdentity()) {
-        QMatrix4x4 matrix;
-        matrix.rotate(seriesRotation);
-        modelMatrix = matrix.transposed();
-    }
+    if (!seriesRotation.isIdentity())
+        modelMatrix.rotate(seriesRotation);
     modelMatrix.scale(modelScaler);
 
     QList<QVector3D> scaled_vertices;
     scaled_vertices.resize(verticeCount);
-    for (int i = 0; i < verticeCount; i++)
-        scaled_vertices[i] = (QVector4D(indexed_vertices[i]) * modelMatrix).toVector3D();
-
-    QList<QVector3D> buffered_vertices;
-    buffered_vertices.resize(verticeCount * updateSize);
-
-    int itemCount = 0;
-    for (int i = 0; i < updateSize; i++) {
-        int index = updateAll ? i : cache->updateIndices().at(i);
-        const ScatterRenderItem &item = renderArray.at(index);
-        if (!item.isVisible())
-            continue;
-
-        const int offset = itemCount * verticeCount;
-        if (item.rotation().isIdentity()) {
-            for (int j = 0; j < verticeCount; j++)
-                buffered_vertices[j + offset] = scaled_vertices[j] + item.translation();
-        } else {
-            QMatrix4x4 matrix;
-            matrix.rotate(seriesRotation * item.rotation());
-            modelMatrix = matrix.transposed();
-            modelMatrix.scale(modelScaler);
-
-            for (int j = 0; j < verticeCount; j++) {
-                buffered_vertices[j + offset]
-                        = (QVector4D(indexed_vertices[j]) * modelMatrix).toVector3D()
-                        + item.translation();
+    Utils::transformVertices(indexed_vertices.constData(), scaled_vertices.data(), verticeCount,
+                             modelMatrix, QVector3D());
+
+    QVector3D *buffered_vertices = cache->stagingArena().vertices(verticeCount * updateSize);
+
+    const int minItemsPerTask = qMax(1, minVerticesPerTask / qMax(1, verticeCount));
+    Utils::parallelFor(updateSize, minItemsPerTask, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int index = updateAll ? i : cache->updateIndices().at(i);
+            const QVector3D &translation = renderArray.translation(index);
+            const QQuaternion &rotation = renderArray.rotation(index);
+
+            const int offset = i * verticeCount;
+            if (!renderArray.isVisible(index)) {
+                for (int j = 0; j < verticeCount; j++)
+                    buffered_vertices[j + offset] = hiddenPos;
+            } else if (rotation.isIdentity()) {
+                for (int j = 0; j < verticeCount; j++)
+                    buffered_vertices[j + offset] = scaled_vertices[j] + translation;
+            } else {
+                QMatrix4x4 matrix;
+                matrix.rotate(seriesRotation * rotation);
+                matrix.scale(modelScaler);
+                Utils::transformVertices(indexed_vertices.constData(), &buffered_vertices[offset],
+                                         verticeCount, matrix, translation);
             }
         }
-        itemCount++;
-    }
+    });
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertexbuffer);
     int sizeOfItem = verticeCount * sizeof(QVector3D);
     if (updateAll) {
-        if (itemCount) {
-            glBufferData(GL_ARRAY_BUFFER, itemCount * sizeOfItem,
-                         &buffered_vertices.at(0), GL_STATIC_DRAW);
-        }
+        FrameStatisticsCollector::countBufferUpload(updateSize * sizeOfItem);
+        glBufferData(GL_ARRAY_BUFFER, updateSize * sizeOfItem, buffered_vertices,
+                     GL_DYNAMIC_DRAW);
     } else {
-        itemCount = 0;
         for (int i = 0; i < updateSize; i++) {
-            int index = updateAll ? i : cache->updateIndices().at(i);
-            if (renderArray.at(index).isVisible()) {
-                glBufferSubData(GL_ARRAY_BUFFER, cache->bufferIndices().at(index) * sizeOfItem,
-                                sizeOfItem, &buffered_vertices.at(itemCount * verticeCount));
-                itemCount++;
-            }
+            int index = cache->updateIndices().at(i);
+            FrameStatisticsCollector::countBufferUpload(sizeOfItem);
+            glBufferSubData(GL_ARRAY_BUFFER, index * sizeOfItem, sizeOfItem,
+                            &buffered_vertices[i * verticeCount]);
         }
     }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
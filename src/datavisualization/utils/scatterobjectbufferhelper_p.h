@@ -32,12 +32,14 @@ public:
     void setScaleY(float scale) { m_scaleY = scale; }
 
 private:
-    uint createRangeGradientUVs(ScatterSeriesRenderCache *cache, QList<QVector2D> &buffered_uvs);
-    uint createObjectGradientUVs(ScatterSeriesRenderCache *cache, QList<QVector2D> &buffered_uvs,
+    uint createRangeGradientUVs(ScatterSeriesRenderCache *cache, QVector2D *buffered_uvs);
+    uint createObjectGradientUVs(ScatterSeriesRenderCache *cache, QVector2D *buffered_uvs,
                                  const QList<QVector3D> &indexed_vertices);
 
     float m_scaleY;
     static const GLfloat itemScaler;
+    static const QVector3D hiddenPos;
+    static const int minVerticesPerTask;
 };
 
 QT_END_NAMESPACE
@@ -2,11 +2,14 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "scatterpointbufferhelper_p.h"
+#include "utils_p.h"
+#include "framestatisticscollector_p.h"
 #include <QtGui/QVector2D>
 
 QT_BEGIN_NAMESPACE
 
 const QVector3D hiddenPos(-1000.0f, -1000.0f, -1000.0f);
+const int minPointsPerTask = 65536;
 
 ScatterPointBufferHelper::ScatterPointBufferHelper()
     : m_pointbuffer(0),
@@ -33,10 +36,12 @@ void ScatterPointBufferHelper::pushPoint(uint pointIndex)
 
     // Pop the previous point if it is still pushed
     if (m_oldRemoveIndex >= 0) {
+        FrameStatisticsCollector::countBufferUpload(sizeof(QVector3D));
         glBufferSubData(GL_ARRAY_BUFFER, m_oldRemoveIndex * sizeof(QVector3D),
                         sizeof(QVector3D), &m_bufferedPoints.at(m_oldRemoveIndex));
     }
 
+    FrameStatisticsCollector::countBufferUpload(sizeof(QVector3D));
     glBufferSubData(GL_ARRAY_BUFFER, pointIndex * sizeof(QVector3D),
                     sizeof(QVector3D),
                     &hiddenPos);
@@ -50,6 +55,7 @@ void ScatterPointBufferHelper::popPoint()
 {
     if (m_oldRemoveIndex >= 0) {
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
+        FrameStatisticsCollector::countBufferUpload(sizeof(QVector3D));
         glBufferSubData(GL_ARRAY_BUFFER, m_oldRemoveIndex * sizeof(QVector3D),
                         sizeof(QVector3D), &m_bufferedPoints.at(m_oldRemoveIndex));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -60,7 +66,7 @@ void ScatterPointBufferHelper::popPoint()
 
 void ScatterPointBufferHelper::load(ScatterSeriesRenderCache *cache)
 {
-    ScatterRenderItemArray &renderArray = cache->renderArray();
+    const ScatterRenderItemArray &renderArray = cache->renderArray();
     const int renderArraySize = renderArray.size();
     m_indexCount = 0;
 
@@ -74,20 +80,16 @@ void ScatterPointBufferHelper::load(ScatterSeriesRenderCache *cache)
         m_meshDataLoaded = false;
     }
 
-    bool itemsVisible = false;
     m_bufferedPoints.resize(renderArraySize);
-    for (int i = 0; i < renderArraySize; i++) {
-        const ScatterRenderItem &item = renderArray.at(i);
-        if (!item.isVisible()) {
-            m_bufferedPoints[i] = hiddenPos;
-        } else {
-            itemsVisible = true;
-            m_bufferedPoints[i] = item.translation();
-        }
-    }
+    QVector3D *bufferedPoints = m_bufferedPoints.data();
+    const QVector3D *translations = renderArray.translations();
+    Utils::parallelFor(renderArraySize, minPointsPerTask, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            bufferedPoints[i] = renderArray.isVisible(i) ? translations[i] : hiddenPos;
+    });
 
     QList<QVector2D> buffered_uvs;
-    if (itemsVisible)
+    if (renderArray.hasVisibleItems())
         m_indexCount = renderArraySize;
 
     if (m_indexCount > 0) {
@@ -96,6 +98,7 @@ void ScatterPointBufferHelper::load(ScatterSeriesRenderCache *cache)
 
         glGenBuffers(1, &m_pointbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
+        FrameStatisticsCollector::countBufferUpload(m_bufferedPoints.size() * sizeof(QVector3D));
         glBufferData(GL_ARRAY_BUFFER, m_bufferedPoints.size() * sizeof(QVector3D),
                      &m_bufferedPoints.at(0),
                      GL_DYNAMIC_DRAW);
@@ -103,6 +106,7 @@ void ScatterPointBufferHelper::load(ScatterSeriesRenderCache *cache)
         if (buffered_uvs.size()) {
             glGenBuffers(1, &m_uvbuffer);
             glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
+            FrameStatisticsCollector::countBufferUpload(buffered_uvs.size() * sizeof(QVector2D));
             glBufferData(GL_ARRAY_BUFFER, buffered_uvs.size() * sizeof(QVector2D),
                          &buffered_uvs.at(0), GL_STATIC_DRAW);
         }
@@ -124,13 +128,13 @@ void ScatterPointBufferHelper::update(ScatterSeriesRenderCache *cache)
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
         for (int i = 0; i < updateSize; i++) {
             int index = cache->updateIndices().at(i);
-            const ScatterRenderItem &item = renderArray.at(index);
-            if (!item.isVisible())
+            if (!renderArray.isVisible(index))
                 m_bufferedPoints[index] = hiddenPos;
             else
-                m_bufferedPoints[index] = item.translation();
+                m_bufferedPoints[index] = renderArray.translation(index);
 
             if (index != m_oldRemoveIndex) {
+                FrameStatisticsCollector::countBufferUpload(sizeof(QVector3D));
                 glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(QVector3D),
                                 sizeof(QVector3D), &m_bufferedPoints.at(index));
             }
@@ -156,11 +160,14 @@ void ScatterPointBufferHelper::updateUVs(ScatterSeriesRenderCache *cache)
             if (updateSize) {
                 for (int i = 0; i < updateSize; i++) {
                     int index = cache->updateIndices().at(i);
+                    FrameStatisticsCollector::countBufferUpload(sizeof(QVector2D));
                     glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(QVector2D),
                                     sizeof(QVector2D), &buffered_uvs.at(i));
 
                 }
             } else {
+                FrameStatisticsCollector::countBufferUpload(
+                            buffered_uvs.size() * sizeof(QVector2D));
                 glBufferData(GL_ARRAY_BUFFER, buffered_uvs.size() * sizeof(QVector2D),
                              &buffered_uvs.at(0), GL_STATIC_DRAW);
             }
@@ -178,16 +185,17 @@ void ScatterPointBufferHelper::createRangeGradientUVs(ScatterSeriesRenderCache *
     const int updateSize = updateAll ? renderArray.size() : cache->updateIndices().size();
     buffered_uvs.resize(updateSize);
 
-    QVector2D uv;
-    uv.setX(0.0f);
-    for (int i = 0; i < updateSize; i++) {
-        int index = updateAll ? i : cache->updateIndices().at(i);
-        const ScatterRenderItem &item = renderArray.at(index);
-
-        float y = ((item.translation().y() + m_scaleY) * 0.5f) / m_scaleY;
-        uv.setY(y);
-        buffered_uvs[i] = uv;
-    }
+    QVector2D *uvs = buffered_uvs.data();
+    Utils::parallelFor(updateSize, minPointsPerTask, [&](int begin, int end) {
+        QVector2D uv;
+        uv.setX(0.0f);
+        for (int i = begin; i < end; i++) {
+            int index = updateAll ? i : cache->updateIndices().at(i);
+            float y = ((renderArray.translation(index).y() + m_scaleY) * 0.5f) / m_scaleY;
+            uv.setY(y);
+            uvs[i] = uv;
+        }
+    });
 }
 
 QT_END_NAMESPACE
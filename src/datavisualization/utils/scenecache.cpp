@@ -0,0 +1,151 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "scenecache_p.h"
+#include "utils_p.h"
+
+QT_BEGIN_NAMESPACE
+
+SceneCache::SceneCache()
+    : m_supported(false),
+      m_valid(false),
+      m_samples(0),
+      m_frameBuffer(0),
+      m_colorBuffer(0),
+      m_depthBuffer(0)
+{
+    initializeOpenGLFunctions();
+#if !QT_CONFIG(opengles2)
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    m_supported = !Utils::isOpenGLES() && context->format().version() >= qMakePair(3, 0);
+#endif
+}
+
+SceneCache::~SceneCache()
+{
+    if (QOpenGLContext::currentContext())
+        release();
+}
+
+bool SceneCache::begin(const QRect &area, const QVector4D &clearColor, GLuint defaultFboHandle)
+{
+    m_valid = false;
+    if (!m_supported)
+        return false;
+
+#if !QT_CONFIG(opengles2)
+    // The depth is copied along with the color, so the sample counts must match
+    GLint samples = 0;
+    glGetIntegerv(GL_SAMPLES, &samples);
+    const QSize size(area.x() + area.width(), area.y() + area.height());
+    const bool allocated = size != m_size || samples != m_samples;
+    if (allocated && !allocate(size, samples)) {
+        m_supported = false;
+        release();
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
+        return false;
+    }
+
+    m_area = area;
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glClearColor(clearColor.x(), clearColor.y(), clearColor.z(), 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    if (allocated) {
+        // The formats of the target are not known, so check that the cleared cache can be
+        // copied into the target, which has been cleared to the same color already
+        while (glGetError() != GL_NO_ERROR) {}
+        blit(defaultFboHandle);
+        if (glGetError() != GL_NO_ERROR) {
+            m_supported = false;
+            release();
+            return false;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    }
+    return true;
+#else
+    Q_UNUSED(area);
+    Q_UNUSED(clearColor);
+    Q_UNUSED(defaultFboHandle);
+    return false;
+#endif
+}
+
+void SceneCache::end(GLuint defaultFboHandle)
+{
+    blit(defaultFboHandle);
+    m_valid = true;
+}
+
+void SceneCache::draw(GLuint defaultFboHandle)
+{
+    blit(defaultFboHandle);
+}
+
+bool SceneCache::allocate(const QSize &size, GLint samples)
+{
+    release();
+
+#if !QT_CONFIG(opengles2)
+    glGenRenderbuffers(1, &m_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, size.width(),
+                                     size.height());
+    glGenRenderbuffers(1, &m_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8,
+                                     size.width(), size.height());
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_frameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                              m_colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              m_depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        return false;
+
+    m_size = size;
+    m_samples = samples;
+    return true;
+#else
+    Q_UNUSED(size);
+    Q_UNUSED(samples);
+    return false;
+#endif
+}
+
+void SceneCache::release()
+{
+    if (m_frameBuffer)
+        glDeleteFramebuffers(1, &m_frameBuffer);
+    if (m_colorBuffer)
+        glDeleteRenderbuffers(1, &m_colorBuffer);
+    if (m_depthBuffer)
+        glDeleteRenderbuffers(1, &m_depthBuffer);
+    m_frameBuffer = 0;
+    m_colorBuffer = 0;
+    m_depthBuffer = 0;
+    m_size = QSize();
+    m_samples = 0;
+    m_valid = false;
+}
+
+void SceneCache::blit(GLuint target)
+{
+#if !QT_CONFIG(opengles2)
+    const int x0 = m_area.x();
+    const int y0 = m_area.y();
+    const int x1 = x0 + m_area.width();
+    const int y1 = y0 + m_area.height();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameBuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+    glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,
+                      GL_NEAREST);
+#endif
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,64 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SCENECACHE_P_H
+#define SCENECACHE_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QRect>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QVector4D>
+
+QT_BEGIN_NAMESPACE
+
+// Keeps the color and depth of the rendered scene in a framebuffer of its own, so that frames
+// in which only overlays change can copy the scene instead of drawing it again. Needs
+// framebuffer blits, so the cache is not used on OpenGL ES or before OpenGL 3.0, nor when the
+// target framebuffer cannot be blitted to.
+class SceneCache : protected QOpenGLExtraFunctions
+{
+public:
+    SceneCache();
+    ~SceneCache();
+
+    // Binds the cache for drawing the scene into the area of the target framebuffer. Returns
+    // false if the cache cannot be used, in which case the scene is drawn into the target.
+    bool begin(const QRect &area, const QVector4D &clearColor, GLuint defaultFboHandle);
+    // Copies the drawn scene into the target and binds the target again
+    void end(GLuint defaultFboHandle);
+    // Copies the cached scene into the target
+    void draw(GLuint defaultFboHandle);
+
+    inline void invalidate() { m_valid = false; }
+    inline bool isValid() const { return m_valid; }
+
+private:
+    Q_DISABLE_COPY(SceneCache)
+
+    bool allocate(const QSize &size, GLint samples);
+    void release();
+    void blit(GLuint target);
+
+    bool m_supported;
+    bool m_valid;
+    QRect m_area;
+    QSize m_size;
+    GLint m_samples;
+    GLuint m_frameBuffer;
+    GLuint m_colorBuffer;
+    GLuint m_depthBuffer;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "selectionreadback_p.h"
+#include "utils_p.h"
+
+QT_BEGIN_NAMESPACE
+
+SelectionReadback::SelectionReadback()
+    : m_asynchronous(false),
+      m_pending(false),
+      m_integerBuffer(false),
+      m_pixelBuffer(0),
+      m_fence(0)
+{
+    initializeOpenGLFunctions();
+#if !QT_CONFIG(opengles2)
+    // Same requirement as for instanced drawing, which also guarantees integer textures
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    m_asynchronous = !Utils::isOpenGLES() && context->format().version() >= qMakePair(3, 3);
+    if (m_asynchronous) {
+        glGenBuffers(1, &m_pixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4 * sizeof(GLuint), NULL, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+#endif
+}
+
+SelectionReadback::~SelectionReadback()
+{
+    if (QOpenGLContext::currentContext()) {
+        cancel();
+        if (m_pixelBuffer)
+            glDeleteBuffers(1, &m_pixelBuffer);
+    }
+}
+
+void SelectionReadback::request(const QPoint &position, int height, bool integerBuffer)
+{
+    cancel();
+
+    m_position = position;
+    m_integerBuffer = integerBuffer;
+    m_pending = true;
+
+#if !QT_CONFIG(opengles2)
+    if (m_asynchronous) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+        if (integerBuffer) {
+            glReadPixels(position.x(), height - position.y(), 1, 1, GL_RGBA_INTEGER,
+                         GL_UNSIGNED_INT, NULL);
+        } else {
+            glReadPixels(position.x(), height - position.y(), 1, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                         NULL);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return;
+    }
+#endif
+
+    Q_ASSERT(!integerBuffer);
+    m_color = Utils::getSelection(position, height);
+}
+
+bool SelectionReadback::take(QVector4D &color)
+{
+    if (!m_pending)
+        return false;
+
+#if !QT_CONFIG(opengles2)
+    if (m_asynchronous) {
+        // Only flush, the read is taken on a later frame if the GPU has not got that far yet
+        if (glClientWaitSync(m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+            return false;
+        glDeleteSync(m_fence);
+        m_fence = 0;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+        const GLsizeiptr size = m_integerBuffer ? 4 * sizeof(GLuint) : 4 * sizeof(GLubyte);
+        const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        if (!data) {
+            // Read again on the next request
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            m_pending = false;
+            return false;
+        }
+        if (m_integerBuffer) {
+            const GLuint *pixel = static_cast<const GLuint *>(data);
+            m_color = QVector4D(pixel[0], pixel[1], pixel[2], pixel[3]);
+        } else {
+            const GLubyte *pixel = static_cast<const GLubyte *>(data);
+            m_color = QVector4D(pixel[0], pixel[1], pixel[2], pixel[3]);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+#endif
+
+    m_pending = false;
+    color = m_color;
+    return true;
+}
+
+void SelectionReadback::cancel()
+{
+#if !QT_CONFIG(opengles2)
+    if (m_fence) {
+        glDeleteSync(m_fence);
+        m_fence = 0;
+    }
+#endif
+    m_pending = false;
+}
+
+QT_END_NAMESPACE
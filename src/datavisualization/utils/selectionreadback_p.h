@@ -0,0 +1,61 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SELECTIONREADBACK_P_H
+#define SELECTIONREADBACK_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QPoint>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QVector4D>
+
+QT_BEGIN_NAMESPACE
+
+// Reads the selection buffer texel under the cursor. When pixel buffer objects and fences are
+// available, the texel is read into a pixel buffer and taken on a later frame once the GPU has
+// written it, so that the render thread never waits for the selection pass to finish.
+// Otherwise the texel is read immediately.
+class SelectionReadback : protected QOpenGLExtraFunctions
+{
+public:
+    SelectionReadback();
+    ~SelectionReadback();
+
+    // Integer selection buffers can only be read asynchronously
+    inline bool isAsynchronous() const { return m_asynchronous; }
+
+    // Starts reading the texel at position from the bound framebuffer. The position is in
+    // window coordinates with y axis pointing down.
+    void request(const QPoint &position, int height, bool integerBuffer = false);
+    // Returns true and the texel in color once the requested read has completed
+    bool take(QVector4D &color);
+    void cancel();
+
+    inline bool isPending() const { return m_pending; }
+    inline const QPoint &position() const { return m_position; }
+
+private:
+    Q_DISABLE_COPY(SelectionReadback)
+
+    bool m_asynchronous;
+    bool m_pending;
+    bool m_integerBuffer;
+    QPoint m_position;
+    QVector4D m_color;
+    GLuint m_pixelBuffer;
+    GLsync m_fence;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -3,10 +3,47 @@
 
 #include "shaderhelper_p.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
 #include <QtOpenGL/QOpenGLShader>
 
 QT_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(lcShaderCache, "qt.datavisualization.shadercache")
+
+struct ShaderProgramKey {
+    QOpenGLContextGroup *shareGroup;
+    QThread *thread;
+    QString vertexShaderFile;
+    QString fragmentShaderFile;
+
+    inline bool operator==(const ShaderProgramKey &other) const
+    {
+        return shareGroup == other.shareGroup && thread == other.thread
+                && vertexShaderFile == other.vertexShaderFile
+                && fragmentShaderFile == other.fragmentShaderFile;
+    }
+};
+
+static size_t qHash(const ShaderProgramKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.shareGroup, key.thread, key.vertexShaderFile,
+                      key.fragmentShaderFile);
+}
+
+struct ShaderProgramRef {
+    int refCount;
+    ShaderProgramKey key;
+};
+
+// Programs are also keyed by thread, as threaded Qt Quick windows may render with contexts of the
+// same share group simultaneously, and uniform values would leak between them.
+static QMutex programCacheMutex;
+static QHash<ShaderProgramKey, QOpenGLShaderProgram *> programCache;
+static QHash<QOpenGLShaderProgram *, ShaderProgramRef> programRefs;
+
 void discardDebugMsgs(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
     Q_UNUSED(type);
@@ -22,6 +59,7 @@ ShaderHelper::ShaderHelper(QObject *parent,
                            const QString &depthTexture)
     : m_caller(parent),
       m_program(0),
+      m_programShared(false),
       m_vertexShaderFile(vertexShader),
       m_fragmentShaderFile(fragmentShader),
       m_textureFile(texture),
@@ -29,6 +67,10 @@ ShaderHelper::ShaderHelper(QObject *parent,
       m_positionAttr(0),
       m_uvAttr(0),
       m_normalAttr(0),
+      m_instancePositionAttr(0),
+      m_instanceRotationAttr(0),
+      m_instanceUVAttr(0),
+      m_instanceIndexAttr(0),
       m_colorUniform(0),
       m_viewMatrixUniform(0),
       m_modelMatrixUniform(0),
@@ -55,13 +97,35 @@ ShaderHelper::ShaderHelper(QObject *parent,
       m_minBoundsUniform(0),
       m_maxBoundsUniform(0),
       m_sliceFrameWidthUniform(0),
+      m_modelScaleUniform(0),
+      m_indexOffsetUniform(0),
+      m_brickSamplerUniform(0),
+      m_brickExtentUniform(0),
+      m_brickScaleUniform(0),
       m_initialized(false)
 {
 }
 
 ShaderHelper::~ShaderHelper()
 {
-    delete m_program;
+    releaseProgram();
+}
+
+void ShaderHelper::releaseProgram()
+{
+    if (m_programShared) {
+        QMutexLocker locker(&programCacheMutex);
+        auto it = programRefs.find(m_program);
+        if (it != programRefs.end() && --it->refCount <= 0) {
+            programCache.remove(it->key);
+            programRefs.erase(it);
+            delete m_program;
+        }
+    } else {
+        delete m_program;
+    }
+    m_program = 0;
+    m_programShared = false;
 }
 
 void ShaderHelper::setShaders(const QString &vertexShader,
@@ -80,23 +144,57 @@ void ShaderHelper::setTextures(const QString &texture,
 
 void ShaderHelper::initialize()
 {
-    if (m_program)
-        delete m_program;
-    m_program = new QOpenGLShaderProgram(m_caller);
-    if (!m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, m_vertexShaderFile))
-        qFatal("Compiling Vertex shader failed");
-    if (!m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, m_fragmentShaderFile))
-        qFatal("Compiling Fragment shader failed");
-
-    if (!m_program->link()) {
-        qWarning() << "Unable to link shader program:" <<
-                      m_vertexShaderFile << m_fragmentShaderFile;
-        return;
+    releaseProgram();
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    ShaderProgramKey key = {context ? context->shareGroup() : nullptr, QThread::currentThread(),
+                            m_vertexShaderFile, m_fragmentShaderFile};
+    QMutexLocker locker(&programCacheMutex);
+    m_program = key.shareGroup ? programCache.value(key, nullptr) : nullptr;
+    if (m_program) {
+        programRefs[m_program].refCount++;
+        m_programShared = true;
+        qCDebug(lcShaderCache) << "Reusing program" << m_vertexShaderFile
+                               << m_fragmentShaderFile;
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+        // Cacheable shaders are loaded from the program binary disk cache when possible.
+        // The cache is keyed by the shader sources and the driver.
+        m_program = new QOpenGLShaderProgram(key.shareGroup ? nullptr : m_caller);
+        if (!m_program->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex,
+                                                         m_vertexShaderFile)) {
+            qFatal("Compiling Vertex shader failed");
+        }
+        if (!m_program->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment,
+                                                         m_fragmentShaderFile)) {
+            qFatal("Compiling Fragment shader failed");
+        }
+
+        if (!m_program->link()) {
+            qWarning() << "Unable to link shader program:" <<
+                          m_vertexShaderFile << m_fragmentShaderFile;
+            return;
+        }
+
+        const qint64 linkTime = timer.nsecsElapsed();
+        qCDebug(lcShaderCache) << "Linked program" << m_vertexShaderFile << m_fragmentShaderFile
+                               << "in" << linkTime / 1000 << "us";
+        if (key.shareGroup) {
+            programCache.insert(key, m_program);
+            programRefs.insert(m_program, {1, key});
+            m_programShared = true;
+        }
     }
+    locker.unlock();
 
     m_positionAttr = m_program->attributeLocation("vertexPosition_mdl");
     m_normalAttr = m_program->attributeLocation("vertexNormal_mdl");
     m_uvAttr = m_program->attributeLocation("vertexUV");
+    m_instancePositionAttr = m_program->attributeLocation("instancePosition");
+    m_instanceRotationAttr = m_program->attributeLocation("instanceRotation");
+    m_instanceUVAttr = m_program->attributeLocation("instanceUV");
+    m_instanceIndexAttr = m_program->attributeLocation("instanceIndex");
 
     m_mvpMatrixUniform = m_program->uniformLocation("MVP");
     m_viewMatrixUniform = m_program->uniformLocation("V");
@@ -124,6 +222,11 @@ void ShaderHelper::initialize()
     m_minBoundsUniform = m_program->uniformLocation("minBounds");
     m_maxBoundsUniform = m_program->uniformLocation("maxBounds");
     m_sliceFrameWidthUniform = m_program->uniformLocation("sliceFrameWidth");
+    m_modelScaleUniform = m_program->uniformLocation("modelScale");
+    m_indexOffsetUniform = m_program->uniformLocation("indexOffset");
+    m_brickSamplerUniform = m_program->uniformLocation("brickSampler");
+    m_brickExtentUniform = m_program->uniformLocation("brickExtent");
+    m_brickScaleUniform = m_program->uniformLocation("brickScale");
     m_initialized = true;
 }
 
@@ -133,8 +236,7 @@ bool ShaderHelper::testCompile()
 
     // Discard warnings, we only need the result
     QtMessageHandler handler = qInstallMessageHandler(discardDebugMsgs);
-    if (m_program)
-        delete m_program;
+    releaseProgram();
     m_program = new QOpenGLShaderProgram();
     if (!m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, m_vertexShaderFile))
         result = false;
@@ -374,6 +476,41 @@ GLint ShaderHelper::sliceFrameWidth()
     return m_sliceFrameWidthUniform;
 }
 
+GLint ShaderHelper::modelScale()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_modelScaleUniform;
+}
+
+GLint ShaderHelper::indexOffset()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_indexOffsetUniform;
+}
+
+GLint ShaderHelper::brickSampler()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_brickSamplerUniform;
+}
+
+GLint ShaderHelper::brickExtent()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_brickExtentUniform;
+}
+
+GLint ShaderHelper::brickScale()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_brickScaleUniform;
+}
+
 GLint ShaderHelper::posAtt()
 {
     if (!m_initialized)
@@ -395,4 +532,32 @@ GLint ShaderHelper::normalAtt()
     return m_normalAttr;
 }
 
+GLint ShaderHelper::instancePositionAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instancePositionAttr;
+}
+
+GLint ShaderHelper::instanceRotationAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceRotationAttr;
+}
+
+GLint ShaderHelper::instanceUVAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceUVAttr;
+}
+
+GLint ShaderHelper::instanceIndexAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceIndexAttr;
+}
+
 QT_END_NAMESPACE
@@ -15,11 +15,17 @@
 #define SHADERHELPER_P_H
 
 #include "datavisualizationglobal_p.h"
+#include <QtCore/QLoggingCategory>
 
 QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
 
 QT_BEGIN_NAMESPACE
 
+Q_DECLARE_LOGGING_CATEGORY(lcShaderCache)
+
+// Linked programs are shared between all shader helpers using the same shader files in the same
+// context share group and thread, and their binaries are cached on disk by Qt. As uniform values
+// are program state, users of a shared program must set every uniform they use before drawing.
 class ShaderHelper
 {
     public:
@@ -71,14 +77,26 @@ class ShaderHelper
     GLint maxBounds();
     GLint minBounds();
     GLint sliceFrameWidth();
+    GLint modelScale();
+    GLint indexOffset();
+    GLint brickSampler();
+    GLint brickExtent();
+    GLint brickScale();
 
     GLint posAtt();
     GLint uvAtt();
     GLint normalAtt();
+    GLint instancePositionAtt();
+    GLint instanceRotationAtt();
+    GLint instanceUVAtt();
+    GLint instanceIndexAtt();
 
     private:
+    void releaseProgram();
+
     QObject *m_caller;
     QOpenGLShaderProgram *m_program;
+    bool m_programShared;
 
     QString m_vertexShaderFile;
     QString m_fragmentShaderFile;
@@ -89,6 +107,10 @@ class ShaderHelper
     GLint m_positionAttr;
     GLint m_uvAttr;
     GLint m_normalAttr;
+    GLint m_instancePositionAttr;
+    GLint m_instanceRotationAttr;
+    GLint m_instanceUVAttr;
+    GLint m_instanceIndexAttr;
 
     GLint m_colorUniform;
     GLint m_viewMatrixUniform;
@@ -116,6 +138,11 @@ class ShaderHelper
     GLint m_minBoundsUniform;
     GLint m_maxBoundsUniform;
     GLint m_sliceFrameWidthUniform;
+    GLint m_modelScaleUniform;
+    GLint m_indexOffsetUniform;
+    GLint m_brickSamplerUniform;
+    GLint m_brickExtentUniform;
+    GLint m_brickScaleUniform;
 
     GLboolean m_initialized;
 };
@@ -3,11 +3,42 @@
 
 #include "surfaceobject_p.h"
 #include "surface3drenderer_p.h"
+#include "utils_p.h"
+#include "framestatisticscollector_p.h"
 
+#include <QtCore/QMutex>
+#include <QtCore/QVarLengthArray>
 #include <QtGui/QVector2D>
 
 QT_BEGIN_NAMESPACE
 
+// Minimum number of vertices generated by one parallel task
+static const int minVerticesPerTask = 16384;
+
+void SurfaceObject::AxisMapping::resolve(const AxisRenderCache &cache)
+{
+    linear = cache.linearMapping(origin, multiplier, offset);
+}
+
+// Maps the values in place, using the batched formatter conversion for non-linear axes
+void SurfaceObject::AxisMapping::mapValues(const AxisRenderCache &cache, float *values,
+                                           int count) const
+{
+    if (linear) {
+        for (int i = 0; i < count; i++)
+            values[i] = map(values[i]);
+    } else {
+        cache.positionsAt(values, values, count);
+    }
+}
+
+// Selection texture coordinate of a mesh row or column. The selection texture always covers
+// the full sample space, while reduced meshes skip stride - 1 points between rows and columns.
+static inline GLfloat sampleCoordinate(int index, int stride, int sampleCount)
+{
+    return GLfloat(qMin(index * stride, sampleCount - 1)) / GLfloat(sampleCount - 1);
+}
+
 SurfaceObject::SurfaceObject(Surface3DRenderer *renderer)
     : m_axisCacheX(renderer->m_axisCacheX),
       m_axisCacheY(renderer->m_axisCacheY),
@@ -30,14 +61,13 @@ SurfaceObject::~SurfaceObject()
     }
 }
 
-void SurfaceObject::setUpSmoothData(const QSurfaceDataArray &dataArray, const QRect &space,
-                                    bool changeGeometry, bool polar, bool flipXZ)
+void SurfaceObject::setUpSmoothData(const SurfaceDataView &dataArray, const QRect &space,
+                                    bool changeGeometry, bool polar, bool flipXZ,
+                                    int sampleStride)
 {
-    m_columns = space.width();
-    m_rows = space.height();
+    m_columns = dataArray.columnCount();
+    m_rows = dataArray.rowCount();
     int totalSize = m_rows * m_columns;
-    GLfloat uvX = 1.0f / GLfloat(m_columns - 1);
-    GLfloat uvY = 1.0f / GLfloat(m_rows - 1);
 
     m_surfaceType = SurfaceSmooth;
 
@@ -52,30 +82,19 @@ void SurfaceObject::setUpSmoothData(const QSurfaceDataArray &dataArray, const QR
         m_vertices.resize(totalSize);
 
     QList<QVector2D> uvs;
-    if (changeGeometry)
+    if (changeGeometry) {
         uvs.resize(totalSize);
-    int totalIndex = 0;
-
-    // Init min and max to ridiculous values
-    m_minY = 10000000.0;
-    m_maxY = -10000000.0f;
-
-    for (int i = 0; i < m_rows; i++) {
-        const QSurfaceDataRow &p = *dataArray.at(i);
-        for (int j = 0; j < m_columns; j++) {
-            getNormalizedVertex(p.at(j), m_vertices[totalIndex], polar, flipXZ);
-            if (changeGeometry)
-                uvs[totalIndex] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
-            totalIndex++;
+        int totalIndex = 0;
+        for (int i = 0; i < m_rows; i++) {
+            GLfloat uvY = sampleCoordinate(i, sampleStride, space.height());
+            for (int j = 0; j < m_columns; j++) {
+                uvs[totalIndex++] = QVector2D(sampleCoordinate(j, sampleStride, space.width()),
+                                              uvY);
+            }
         }
     }
 
-    if (flipXZ) {
-        for (int i = 0; i < m_vertices.size(); i++) {
-            m_vertices[i].setX(-m_vertices.at(i).x());
-            m_vertices[i].setZ(-m_vertices.at(i).z());
-        }
-    }
+    createVertices(dataArray, polar, flipXZ, false);
 
     // Create normals
     int rowLimit = m_rows - 1;
@@ -83,17 +102,18 @@ void SurfaceObject::setUpSmoothData(const QSurfaceDataArray &dataArray, const QR
     if (changeGeometry)
         m_normals.resize(totalSize);
 
-    totalIndex = 0;
-
-    if ((m_dataDimension == BothAscending) || (m_dataDimension == XDescending)) {
-        for (int row = 0; row < rowLimit; row++)
-            createSmoothNormalBodyLine(totalIndex, row * m_columns);
-        createSmoothNormalUpperLine(totalIndex);
-    } else { // BothDescending || ZDescending
-        createSmoothNormalUpperLine(totalIndex);
-        for (int row = 1; row < m_rows; row++)
+    // Body lines only read the vertices, so they can be created in parallel
+    bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
+    int firstBodyRow = upwards ? 0 : 1;
+    Utils::parallelFor(rowLimit, qMax(1, minVerticesPerTask / m_columns),
+                       [this, firstBodyRow](int begin, int end) {
+        for (int row = begin + firstBodyRow; row < end + firstBodyRow; row++) {
+            int totalIndex = row * m_columns;
             createSmoothNormalBodyLine(totalIndex, row * m_columns);
-    }
+        }
+    });
+    int totalIndex = upwards ? rowLimit * m_columns : 0;
+    createSmoothNormalUpperLine(totalIndex);
 
     // Create indices table
     if (changeGeometry || indicesDirty)
@@ -109,48 +129,31 @@ void SurfaceObject::setUpSmoothData(const QSurfaceDataArray &dataArray, const QR
 void SurfaceObject::createSmoothNormalBodyLine(int &totalIndex, int column)
 {
     int colLimit = m_columns - 1;
+    const QVector3D *vertices = m_vertices.constData() + column;
+    QVector3D *normals = m_normals.data() + totalIndex;
 
     if (m_dataDimension == BothAscending) {
-        int end = colLimit + column;
-        for (int j = column; j < end; j++) {
-            m_normals[totalIndex++] = normal(m_vertices.at(j),
-                                             m_vertices.at(j + 1),
-                                             m_vertices.at(j + m_columns));
-        }
-        m_normals[totalIndex++] = normal(m_vertices.at(end),
-                                         m_vertices.at(end + m_columns),
-                                         m_vertices.at(end - 1));
+        Utils::calculateNormals(vertices, vertices + 1, vertices + m_columns, 1,
+                                normals, 1, colLimit);
+        normals[colLimit] = normal(vertices[colLimit],
+                                   vertices[colLimit + m_columns],
+                                   vertices[colLimit - 1]);
     } else if (m_dataDimension == XDescending) {
-        m_normals[totalIndex++] = normal(m_vertices.at(column),
-                                         m_vertices.at(column + m_columns),
-                                         m_vertices.at(column + 1));
-        int end = column + m_columns;
-        for (int j = column + 1; j < end; j++) {
-            m_normals[totalIndex++] = normal(m_vertices.at(j),
-                                             m_vertices.at(j - 1),
-                                             m_vertices.at(j + m_columns));
-        }
+        normals[0] = normal(vertices[0], vertices[m_columns], vertices[1]);
+        Utils::calculateNormals(vertices + 1, vertices, vertices + 1 + m_columns, 1,
+                                normals + 1, 1, colLimit);
     } else if (m_dataDimension == ZDescending) {
-        int end = colLimit + column;
-        for (int j = column; j < end; j++) {
-            m_normals[totalIndex++] = normal(m_vertices.at(j),
-                                             m_vertices.at(j + 1),
-                                             m_vertices.at(j - m_columns));
-        }
-        m_normals[totalIndex++] = normal(m_vertices.at(end),
-                                         m_vertices.at(end - m_columns),
-                                         m_vertices.at(end - 1));
+        Utils::calculateNormals(vertices, vertices + 1, vertices - m_columns, 1,
+                                normals, 1, colLimit);
+        normals[colLimit] = normal(vertices[colLimit],
+                                   vertices[colLimit - m_columns],
+                                   vertices[colLimit - 1]);
     } else { // BothDescending
-        m_normals[totalIndex++] = normal(m_vertices.at(column),
-                                         m_vertices.at(column - m_columns),
-                                         m_vertices.at(column + 1));
-        int end = column + m_columns;
-        for (int j = column + 1; j < end; j++) {
-            m_normals[totalIndex++] = normal(m_vertices.at(j),
-                                             m_vertices.at(j - 1),
-                                             m_vertices.at(j - m_columns));
-        }
+        normals[0] = normal(vertices[0], vertices[-m_columns], vertices[1]);
+        Utils::calculateNormals(vertices + 1, vertices, vertices + 1 - m_columns, 1,
+                                normals + 1, 1, colLimit);
     }
+    totalIndex += m_columns;
 }
 
 void SurfaceObject::createSmoothNormalUpperLine(int &totalIndex)
@@ -274,18 +277,18 @@ QVector3D SurfaceObject::createSmoothNormalUpperLineItem(int x, int y)
     }
 }
 
-void SurfaceObject::smoothUVs(const QSurfaceDataArray &dataArray,
-                              const QSurfaceDataArray &modelArray)
+void SurfaceObject::smoothUVs(const SurfaceDataView &dataArray,
+                              const SurfaceDataView &modelArray)
 {
-    if (dataArray.size() == 0 || modelArray.size() == 0)
+    if (dataArray.isEmpty() || modelArray.isEmpty())
         return;
 
-    int columns = dataArray.at(0)->size();
-    int rows = dataArray.size();
-    float xRangeNormalizer = dataArray.at(0)->at(columns - 1).x() - dataArray.at(0)->at(0).x();
-    float zRangeNormalizer = dataArray.at(rows - 1)->at(0).z() - dataArray.at(0)->at(0).z();
-    float xMin = dataArray.at(0)->at(0).x();
-    float zMin = dataArray.at(0)->at(0).z();
+    int columns = dataArray.columnCount();
+    int rows = dataArray.rowCount();
+    float xMin = dataArray.position(0, 0).x();
+    float zMin = dataArray.position(0, 0).z();
+    float xRangeNormalizer = dataArray.position(0, columns - 1).x() - xMin;
+    float zRangeNormalizer = dataArray.position(rows - 1, 0).z() - zMin;
     const bool zDescending = m_dataDimension.testFlag(SurfaceObject::ZDescending);
     const bool xDescending = m_dataDimension.testFlag(SurfaceObject::XDescending);
 
@@ -293,12 +296,11 @@ void SurfaceObject::smoothUVs(const QSurfaceDataArray &dataArray,
     uvs.resize(m_rows * m_columns);
     int index = 0;
     for (int i = 0; i < m_rows; i++) {
-        float y = (modelArray.at(i)->at(0).z() - zMin) / zRangeNormalizer;
+        float y = (modelArray.position(i, 0).z() - zMin) / zRangeNormalizer;
         if (zDescending)
             y = 1.0f - y;
-        const QSurfaceDataRow &p = *modelArray.at(i);
         for (int j = 0; j < m_columns; j++) {
-            float x = (p.at(j).x() - xMin) / xRangeNormalizer;
+            float x = (modelArray.position(i, j).x() - xMin) / xRangeNormalizer;
             if (xDescending)
                 x = 1.0f - x;
             uvs[index] = QVector2D(x, y);
@@ -307,23 +309,18 @@ void SurfaceObject::smoothUVs(const QSurfaceDataArray &dataArray,
     }
 
     if (uvs.size() > 0) {
-        glBindBuffer(GL_ARRAY_BUFFER, m_uvTextureBuffer);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(QVector2D),
-                     &uvs.at(0), GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
+        uploadTextureUVs(uvs);
         m_returnTextureBuffer = true;
     }
 }
 
-void SurfaceObject::updateSmoothRow(const QSurfaceDataArray &dataArray, int rowIndex, bool polar)
+void SurfaceObject::updateSmoothRow(const SurfaceDataView &dataArray, int rowIndex, bool polar)
 {
     // Update vertices
     int p = rowIndex * m_columns;
-    const QSurfaceDataRow &dataRow = *dataArray.at(rowIndex);
 
     for (int j = 0; j < m_columns; j++)
-        getNormalizedVertex(dataRow.at(j), m_vertices[p++], polar, false);
+        getNormalizedVertex(dataArray.position(rowIndex, j), m_vertices[p++], polar, false);
 
     // Create normals
     bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
@@ -349,11 +346,11 @@ void SurfaceObject::updateSmoothRow(const QSurfaceDataArray &dataArray, int rowI
         createSmoothNormalUpperLine(totalIndex);
 }
 
-void SurfaceObject::updateSmoothItem(const QSurfaceDataArray &dataArray, int row, int column,
+void SurfaceObject::updateSmoothItem(const SurfaceDataView &dataArray, int row, int column,
                                      bool polar)
 {
     // Update a vertice
-    getNormalizedVertex(dataArray.at(row)->at(column),
+    getNormalizedVertex(dataArray.position(row, column),
                         m_vertices[row * m_columns + column], polar, false);
 
     // Create normals
@@ -440,11 +437,7 @@ void SurfaceObject::createSmoothIndices(int x, int y, int endX, int endY)
         }
     }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLint),
-                 indices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    uploadIndices(m_elementbuffer, indices, m_indexCount);
 
     delete[] indices;
 }
@@ -478,23 +471,17 @@ void SurfaceObject::createSmoothGridlineIndices(int x, int y, int endX, int endY
         }
     }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gridElementbuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_gridIndexCount * sizeof(GLint),
-                 gridIndices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    uploadIndices(m_gridElementbuffer, gridIndices, m_gridIndexCount);
 
     delete[] gridIndices;
 }
 
-void SurfaceObject::setUpData(const QSurfaceDataArray &dataArray, const QRect &space,
-                              bool changeGeometry, bool polar, bool flipXZ)
+void SurfaceObject::setUpData(const SurfaceDataView &dataArray, const QRect &space,
+                              bool changeGeometry, bool polar, bool flipXZ, int sampleStride)
 {
-    m_columns = space.width();
-    m_rows = space.height();
+    m_columns = dataArray.columnCount();
+    m_rows = dataArray.rowCount();
     int totalSize = m_rows * m_columns * 2;
-    GLfloat uvX = 1.0f / GLfloat(m_columns - 1);
-    GLfloat uvY = 1.0f / GLfloat(m_rows - 1);
 
     checkDirections(dataArray);
     bool indicesDirty = false;
@@ -508,44 +495,30 @@ void SurfaceObject::setUpData(const QSurfaceDataArray &dataArray, const QRect &s
     if (changeGeometry)
         m_vertices.resize(totalSize);
 
-    QList<QVector2D> uvs;
-    if (changeGeometry)
-        uvs.resize(totalSize);
-
-    int totalIndex = 0;
     int rowLimit = m_rows - 1;
     int colLimit = m_columns - 1;
     int doubleColumns = m_columns * 2 - 2;
     int rowColLimit = rowLimit * doubleColumns;
 
-    // Init min and max to ridiculous values
-    m_minY = 10000000.0;
-    m_maxY = -10000000.0f;
-
-    for (int i = 0; i < m_rows; i++) {
-        const QSurfaceDataRow &row = *dataArray.at(i);
-        for (int j = 0; j < m_columns; j++) {
-            getNormalizedVertex(row.at(j), m_vertices[totalIndex], polar, flipXZ);
-            if (changeGeometry)
-                uvs[totalIndex] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
-
-            totalIndex++;
-
-            if (j > 0 && j < colLimit) {
-                m_vertices[totalIndex] = m_vertices[totalIndex - 1];
-                if (changeGeometry)
-                    uvs[totalIndex] = uvs[totalIndex - 1];
+    QList<QVector2D> uvs;
+    if (changeGeometry) {
+        uvs.resize(totalSize);
+        int totalIndex = 0;
+        for (int i = 0; i < m_rows; i++) {
+            GLfloat uvY = sampleCoordinate(i, sampleStride, space.height());
+            for (int j = 0; j < m_columns; j++) {
+                uvs[totalIndex] = QVector2D(sampleCoordinate(j, sampleStride, space.width()),
+                                            uvY);
                 totalIndex++;
+                if (j > 0 && j < colLimit) {
+                    uvs[totalIndex] = uvs[totalIndex - 1];
+                    totalIndex++;
+                }
             }
         }
     }
 
-    if (flipXZ) {
-        for (int i = 0; i < m_vertices.size(); i++) {
-            m_vertices[i].setX(-m_vertices.at(i).x());
-            m_vertices[i].setZ(-m_vertices.at(i).z());
-        }
-    }
+    createVertices(dataArray, polar, flipXZ, true);
 
     // Create normals & indices table
     GLint *indices = 0;
@@ -556,17 +529,19 @@ void SurfaceObject::setUpData(const QSurfaceDataArray &dataArray, const QRect &s
         m_normals.resize(normalCount);
     }
 
-    int p = 0;
-    totalIndex = 0;
-    for (int row = 0, upperRow = doubleColumns;
-         row < rowColLimit;
-         row += doubleColumns, upperRow += doubleColumns) {
-        for (int j = 0; j < doubleColumns; j += 2) {
-            createNormals(totalIndex, row, upperRow, j);
+    Utils::parallelFor(rowLimit, qMax(1, minVerticesPerTask / doubleColumns),
+                       [this, doubleColumns](int begin, int end) {
+        for (int row = begin * doubleColumns; row < end * doubleColumns; row += doubleColumns)
+            createCoarseNormalRow(row, row + doubleColumns);
+    });
 
-            if (changeGeometry || indicesDirty) {
+    if (indices) {
+        int p = 0;
+        for (int row = 0, upperRow = doubleColumns;
+             row < rowColLimit;
+             row += doubleColumns, upperRow += doubleColumns) {
+            for (int j = 0; j < doubleColumns; j += 2)
                 createCoarseIndices(indices, p, row, upperRow, j);
-            }
         }
     }
 
@@ -579,18 +554,18 @@ void SurfaceObject::setUpData(const QSurfaceDataArray &dataArray, const QRect &s
     delete[] indices;
 }
 
-void SurfaceObject::coarseUVs(const QSurfaceDataArray &dataArray,
-                              const QSurfaceDataArray &modelArray)
+void SurfaceObject::coarseUVs(const SurfaceDataView &dataArray,
+                              const SurfaceDataView &modelArray)
 {
-    if (dataArray.size() == 0 || modelArray.size() == 0)
+    if (dataArray.isEmpty() || modelArray.isEmpty())
         return;
 
-    int columns = dataArray.at(0)->size();
-    int rows = dataArray.size();
-    float xRangeNormalizer = dataArray.at(0)->at(columns - 1).x() - dataArray.at(0)->at(0).x();
-    float zRangeNormalizer = dataArray.at(rows - 1)->at(0).z() - dataArray.at(0)->at(0).z();
-    float xMin = dataArray.at(0)->at(0).x();
-    float zMin = dataArray.at(0)->at(0).z();
+    int columns = dataArray.columnCount();
+    int rows = dataArray.rowCount();
+    float xMin = dataArray.position(0, 0).x();
+    float zMin = dataArray.position(0, 0).z();
+    float xRangeNormalizer = dataArray.position(0, columns - 1).x() - xMin;
+    float zRangeNormalizer = dataArray.position(rows - 1, 0).z() - zMin;
     const bool zDescending = m_dataDimension.testFlag(SurfaceObject::ZDescending);
     const bool xDescending = m_dataDimension.testFlag(SurfaceObject::XDescending);
 
@@ -599,12 +574,11 @@ void SurfaceObject::coarseUVs(const QSurfaceDataArray &dataArray,
     int index = 0;
     int colLimit = m_columns - 1;
     for (int i = 0; i < m_rows; i++) {
-        float y = (modelArray.at(i)->at(0).z() - zMin) / zRangeNormalizer;
+        float y = (modelArray.position(i, 0).z() - zMin) / zRangeNormalizer;
         if (zDescending)
             y = 1.0f - y;
-        const QSurfaceDataRow &p = *modelArray.at(i);
         for (int j = 0; j < m_columns; j++) {
-            float x = (p.at(j).x() - xMin) / xRangeNormalizer;
+            float x = (modelArray.position(i, j).x() - xMin) / xRangeNormalizer;
             if (xDescending)
                 x = 1.0f - x;
             uvs[index] = QVector2D(x, y);
@@ -617,25 +591,20 @@ void SurfaceObject::coarseUVs(const QSurfaceDataArray &dataArray,
     }
 
     if (uvs.size() > 0) {
-        glBindBuffer(GL_ARRAY_BUFFER, m_uvTextureBuffer);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(QVector2D),
-                     &uvs.at(0), GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
+        uploadTextureUVs(uvs);
         m_returnTextureBuffer = true;
     }
 }
 
-void SurfaceObject::updateCoarseRow(const QSurfaceDataArray &dataArray, int rowIndex, bool polar)
+void SurfaceObject::updateCoarseRow(const SurfaceDataView &dataArray, int rowIndex, bool polar)
 {
     int colLimit = m_columns - 1;
     int doubleColumns = m_columns * 2 - 2;
 
     int p = rowIndex * doubleColumns;
-    const QSurfaceDataRow &dataRow = *dataArray.at(rowIndex);
 
     for (int j = 0; j < m_columns; j++) {
-        getNormalizedVertex(dataRow.at(j), m_vertices[p++], polar, false);
+        getNormalizedVertex(dataArray.position(rowIndex, j), m_vertices[p++], polar, false);
         if (j > 0 && j < colLimit) {
             m_vertices[p] = m_vertices[p - 1];
             p++;
@@ -657,7 +626,7 @@ void SurfaceObject::updateCoarseRow(const QSurfaceDataArray &dataArray, int rowI
     }
 }
 
-void SurfaceObject::updateCoarseItem(const QSurfaceDataArray &dataArray, int row, int column,
+void SurfaceObject::updateCoarseItem(const SurfaceDataView &dataArray, int row, int column,
                                      bool polar)
 {
     int colLimit = m_columns - 1;
@@ -665,7 +634,7 @@ void SurfaceObject::updateCoarseItem(const QSurfaceDataArray &dataArray, int row
 
     // Update a vertice
     int p = row * doubleColumns + column * 2 - (column > 0);
-    getNormalizedVertex(dataArray.at(row)->at(column), m_vertices[p++], polar, false);
+    getNormalizedVertex(dataArray.position(row, column), m_vertices[p++], polar, false);
 
     if (column > 0 && column < colLimit)
         m_vertices[p] = m_vertices[p - 1];
@@ -716,11 +685,7 @@ void SurfaceObject::createCoarseSubSection(int x, int y, int columns, int rows)
             createCoarseIndices(indices, p, row, upperRow, j);
     }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLint),
-                 indices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    uploadIndices(m_elementbuffer, indices, m_indexCount);
 
     delete[] indices;
 }
@@ -765,11 +730,7 @@ void SurfaceObject::createCoarseGridlineIndices(int x, int y, int endX, int endY
         gridIndices[p++] = i  + doubleColumns;
     }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gridElementbuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_gridIndexCount * sizeof(GLint),
-                 gridIndices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    uploadIndices(m_gridElementbuffer, gridIndices, m_gridIndexCount);
 
     delete[] gridIndices;
 }
@@ -783,23 +744,36 @@ void SurfaceObject::uploadBuffers()
 void SurfaceObject::createBuffers(const QList<QVector3D> &vertices, const QList<QVector2D> &uvs,
                                   const QList<QVector3D> &normals, const GLint *indices)
 {
+    if (m_preparing) {
+        // The vertices and normals are uploaded from the members once prepared
+        m_pendingMesh = true;
+        m_pendingUVs = uvs;
+        if (indices)
+            m_pendingIndices = QList<GLint>(indices, indices + m_indexCount);
+        return;
+    }
+
     // Move to buffers
     glBindBuffer(GL_ARRAY_BUFFER, m_vertexbuffer);
+    FrameStatisticsCollector::countBufferUpload(vertices.size() * sizeof(QVector3D));
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(QVector3D),
                  &vertices.at(0), GL_DYNAMIC_DRAW);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_normalbuffer);
+    FrameStatisticsCollector::countBufferUpload(normals.size() * sizeof(QVector3D));
     glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(QVector3D),
                  &normals.at(0), GL_DYNAMIC_DRAW);
 
     if (uvs.size()) {
         glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
+        FrameStatisticsCollector::countBufferUpload(uvs.size() * sizeof(QVector2D));
         glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(QVector2D),
                      &uvs.at(0), GL_STATIC_DRAW);
     }
 
     if (indices) {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
+        FrameStatisticsCollector::countBufferUpload(m_indexCount * sizeof(GLint));
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLint),
                      indices, GL_STATIC_DRAW);
     }
@@ -810,29 +784,237 @@ void SurfaceObject::createBuffers(const QList<QVector3D> &vertices, const QList<
     m_meshDataLoaded = true;
 }
 
-void SurfaceObject::checkDirections(const QSurfaceDataArray &array)
+// Uploads the indices to the element buffer, or keeps them for finishPreparation()
+void SurfaceObject::uploadIndices(GLuint buffer, const GLint *indices, int count)
+{
+    if (m_preparing) {
+        QList<GLint> &pending = (buffer == m_gridElementbuffer) ? m_pendingGridIndices
+                                                                : m_pendingIndices;
+        pending = QList<GLint>(indices, indices + count);
+        return;
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    FrameStatisticsCollector::countBufferUpload(count * sizeof(GLint));
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLint), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void SurfaceObject::uploadTextureUVs(const QList<QVector2D> &uvs)
+{
+    if (m_preparing) {
+        m_pendingTextureUVs = uvs;
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvTextureBuffer);
+    FrameStatisticsCollector::countBufferUpload(uvs.size() * sizeof(QVector2D));
+    glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(QVector2D), &uvs.at(0), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Captures the axis mappings and defers the buffer uploads, so that the setup functions can be
+// run on a worker thread. Only linear axes can be captured, as other axes map values through
+// the formatters, which change with the axes. Returns false if the axes cannot be captured.
+bool SurfaceObject::beginPreparation()
+{
+    m_preparedMappingX.resolve(m_axisCacheX);
+    m_preparedMappingY.resolve(m_axisCacheY);
+    m_preparedMappingZ.resolve(m_axisCacheZ);
+    if (!m_preparedMappingX.linear || !m_preparedMappingY.linear
+            || !m_preparedMappingZ.linear) {
+        return false;
+    }
+    m_preparedReversedX = m_axisCacheX.reversed();
+    m_preparedReversedZ = m_axisCacheZ.reversed();
+    m_preparing = true;
+    return true;
+}
+
+// Uploads the buffers deferred since beginPreparation() on the render thread
+void SurfaceObject::finishPreparation()
+{
+    m_preparing = false;
+    if (m_pendingMesh) {
+        createBuffers(m_vertices, m_pendingUVs, m_normals,
+                      m_pendingIndices.isEmpty() ? nullptr : m_pendingIndices.constData());
+    } else if (!m_pendingIndices.isEmpty()) {
+        uploadIndices(m_elementbuffer, m_pendingIndices.constData(), m_pendingIndices.size());
+    }
+    if (!m_pendingGridIndices.isEmpty()) {
+        uploadIndices(m_gridElementbuffer, m_pendingGridIndices.constData(),
+                      m_pendingGridIndices.size());
+    }
+    if (!m_pendingTextureUVs.isEmpty())
+        uploadTextureUVs(m_pendingTextureUVs);
+    cancelPreparation();
+}
+
+// Drops the buffers deferred since beginPreparation()
+void SurfaceObject::cancelPreparation()
+{
+    m_preparing = false;
+    m_pendingMesh = false;
+    m_pendingUVs.clear();
+    m_pendingIndices.clear();
+    m_pendingGridIndices.clear();
+    m_pendingTextureUVs.clear();
+}
+
+void SurfaceObject::checkDirections(const SurfaceDataView &array)
 {
     m_dataDimension = BothAscending;
 
-    if (array.at(0)->at(0).x() > array.at(0)->at(array.at(0)->size() - 1).x())
+    if (array.position(0, 0).x() > array.position(0, array.columnCount() - 1).x())
         m_dataDimension |= XDescending;
-    if (m_axisCacheX.reversed())
+    if (m_preparing ? m_preparedReversedX : m_axisCacheX.reversed())
         m_dataDimension ^= XDescending;
 
-    if (array.at(0)->at(0).z() > array.at(array.size() - 1)->at(0).z())
+    if (array.position(0, 0).z() > array.position(array.rowCount() - 1, 0).z())
         m_dataDimension |= ZDescending;
-    if (m_axisCacheZ.reversed())
+    if (m_preparing ? m_preparedReversedZ : m_axisCacheZ.reversed())
         m_dataDimension ^= ZDescending;
 }
 
-void SurfaceObject::getNormalizedVertex(const QSurfaceDataItem &data, QVector3D &vertex,
+// Normalizes all data positions into m_vertices and updates the y limits. For flat surfaces
+// the inner vertices of each row are duplicated. Linear axes skip the formatter and their rows
+// are processed in parallel, other axes convert a whole row at a time on the calling thread.
+// Height grids additionally resolve x and z once per column and row.
+void SurfaceObject::createVertices(const SurfaceDataView &dataArray, bool polar, bool flipXZ,
+                                   bool coarse)
+{
+    const int columns = m_columns;
+    const int colLimit = columns - 1;
+    const int rowStride = coarse ? columns * 2 - 2 : columns;
+    const float flip = flipXZ ? -1.0f : 1.0f;
+    QVector3D *vertices = m_vertices.data();
+
+    AxisRenderCache &axisCacheX = flipXZ ? m_axisCacheZ : m_axisCacheX;
+    AxisRenderCache &axisCacheZ = flipXZ ? m_axisCacheX : m_axisCacheZ;
+    AxisMapping mappingX;
+    AxisMapping mappingY;
+    AxisMapping mappingZ;
+    if (m_preparing) {
+        // The axes may change while preparing, so only the captured linear mappings are used
+        mappingX = flipXZ ? m_preparedMappingZ : m_preparedMappingX;
+        mappingY = m_preparedMappingY;
+        mappingZ = flipXZ ? m_preparedMappingX : m_preparedMappingZ;
+    } else {
+        mappingX.resolve(axisCacheX);
+        mappingY.resolve(m_axisCacheY);
+        mappingZ.resolve(axisCacheZ);
+    }
+
+    const bool grid = dataArray.isHeightGrid() && !polar
+            && mappingX.linear && mappingY.linear && mappingZ.linear;
+    QVarLengthArray<float, 1024> gridX;
+    if (grid) {
+        gridX.resize(columns);
+        for (int j = 0; j < columns; j++)
+            gridX[j] = flip * mappingX.map(dataArray.position(0, j).x());
+    }
+
+    // Init min and max to ridiculous values
+    m_minY = 10000000.0;
+    m_maxY = -10000000.0f;
+    QMutex limitsMutex;
+
+    auto createRows = [&](int begin, int end) {
+        float minY = 10000000.0f;
+        float maxY = -10000000.0f;
+        QVarLengthArray<float, 1024> rowX(grid ? 0 : columns);
+        QVarLengthArray<float, 1024> rowY(columns);
+        QVarLengthArray<float, 1024> rowZ(grid ? 0 : columns);
+        for (int i = begin; i < end; i++) {
+            QVector3D *target = vertices + i * rowStride;
+            auto store = [&](int j, float x, float y, float z) {
+                minY = qMin(y, minY);
+                if (!qIsNaN(y) && !qIsInf(y))
+                    maxY = qMax(y, maxY);
+                *target++ = QVector3D(x, y, z);
+                if (coarse && j > 0 && j < colLimit) {
+                    *target = target[-1];
+                    target++;
+                }
+            };
+
+            if (grid) {
+                // Plain multiply-add over the contiguous row, which the compiler vectorizes
+                const float *heights = dataArray.heightRow(i);
+                float *y = rowY.data();
+                for (int j = 0; j < columns; j++)
+                    y[j] = (heights[j] - mappingY.origin) * mappingY.multiplier + mappingY.offset;
+                const float z = flip * mappingZ.map(dataArray.position(i, 0).z());
+                for (int j = 0; j < columns; j++)
+                    store(j, gridX[j], y[j], z);
+                continue;
+            }
+
+            float *x = rowX.data();
+            float *y = rowY.data();
+            float *z = rowZ.data();
+            for (int j = 0; j < columns; j++) {
+                const QVector3D position = dataArray.position(i, j);
+                x[j] = position.x();
+                y[j] = position.y();
+                z[j] = position.z();
+            }
+            if (polar) {
+                // Slice don't use polar, so don't care about flip
+                m_axisCacheX.formatterPositionsAt(x, x, columns);
+                m_axisCacheZ.formatterPositionsAt(z, z, columns);
+                for (int j = 0; j < columns; j++)
+                    m_renderer->calculatePolarXZ(x[j], z[j], x[j], z[j]);
+            } else {
+                mappingX.mapValues(axisCacheX, x, columns);
+                mappingZ.mapValues(axisCacheZ, z, columns);
+            }
+            mappingY.mapValues(m_axisCacheY, y, columns);
+            for (int j = 0; j < columns; j++)
+                store(j, flip * x[j], y[j], flip * z[j]);
+        }
+
+        QMutexLocker locker(&limitsMutex);
+        m_minY = qMin(minY, m_minY);
+        m_maxY = qMax(maxY, m_maxY);
+    };
+
+    // Non-linear and polar axes call into the formatters, which may be user code, so those
+    // rows are created on the calling thread. Linear mappings are plain arithmetic.
+    if (!polar && mappingX.linear && mappingY.linear && mappingZ.linear)
+        Utils::parallelFor(m_rows, qMax(1, minVerticesPerTask / columns), createRows);
+    else
+        createRows(0, m_rows);
+}
+
+// Creates both triangle normals of each quad between two rows of a flat surface
+void SurfaceObject::createCoarseNormalRow(int row, int upperRow)
+{
+    const QVector3D *vertices = m_vertices.constData();
+    QVector3D *normals = m_normals.data() + row;
+    int colLimit = m_columns - 1;
+
+    if ((m_dataDimension == BothAscending) || (m_dataDimension == BothDescending)) {
+        Utils::calculateNormals(vertices + row, vertices + row + 1, vertices + upperRow, 2,
+                                normals, 2, colLimit);
+        Utils::calculateNormals(vertices + row + 1, vertices + upperRow + 1, vertices + upperRow,
+                                2, normals + 1, 2, colLimit);
+    } else {
+        Utils::calculateNormals(vertices + row, vertices + upperRow, vertices + upperRow + 1, 2,
+                                normals, 2, colLimit);
+        Utils::calculateNormals(vertices + row + 1, vertices + row, vertices + upperRow + 1, 2,
+                                normals + 1, 2, colLimit);
+    }
+}
+
+void SurfaceObject::getNormalizedVertex(const QVector3D &data, QVector3D &vertex,
                                         bool polar, bool flipXZ)
 {
     float normalizedX;
     float normalizedZ;
     if (polar) {
         // Slice don't use polar, so don't care about flip
-        m_renderer->calculatePolarXZ(data.position(), normalizedX, normalizedZ);
+        m_renderer->calculatePolarXZ(data, normalizedX, normalizedZ);
     } else {
         if (flipXZ) {
             normalizedX = m_axisCacheZ.positionAt(data.x());
@@ -15,10 +15,11 @@
 #define SURFACEOBJECT_P_H
 
 #include "abstractobjecthelper_p.h"
-#include "qsurfacedataproxy.h"
+#include "surfacedataview_p.h"
 
 #include <QtCore/QRect>
 #include <QtGui/QColor>
+#include <QtGui/QVector2D>
 
 QT_BEGIN_NAMESPACE
 
@@ -46,16 +47,17 @@ public:
     SurfaceObject(Surface3DRenderer *renderer);
     virtual ~SurfaceObject();
 
-    void setUpData(const QSurfaceDataArray &dataArray, const QRect &space,
-                   bool changeGeometry, bool polar, bool flipXZ = false);
-    void setUpSmoothData(const QSurfaceDataArray &dataArray, const QRect &space,
-                         bool changeGeometry, bool polar, bool flipXZ = false);
-    void smoothUVs(const QSurfaceDataArray &dataArray, const QSurfaceDataArray &modelArray);
-    void coarseUVs(const QSurfaceDataArray &dataArray, const QSurfaceDataArray &modelArray);
-    void updateCoarseRow(const QSurfaceDataArray &dataArray, int rowIndex, bool polar);
-    void updateSmoothRow(const QSurfaceDataArray &dataArray, int startRow, bool polar);
-    void updateSmoothItem(const QSurfaceDataArray &dataArray, int row, int column, bool polar);
-    void updateCoarseItem(const QSurfaceDataArray &dataArray, int row, int column, bool polar);
+    void setUpData(const SurfaceDataView &dataArray, const QRect &space,
+                   bool changeGeometry, bool polar, bool flipXZ = false, int sampleStride = 1);
+    void setUpSmoothData(const SurfaceDataView &dataArray, const QRect &space,
+                         bool changeGeometry, bool polar, bool flipXZ = false,
+                         int sampleStride = 1);
+    void smoothUVs(const SurfaceDataView &dataArray, const SurfaceDataView &modelArray);
+    void coarseUVs(const SurfaceDataView &dataArray, const SurfaceDataView &modelArray);
+    void updateCoarseRow(const SurfaceDataView &dataArray, int rowIndex, bool polar);
+    void updateSmoothRow(const SurfaceDataView &dataArray, int startRow, bool polar);
+    void updateSmoothItem(const SurfaceDataView &dataArray, int row, int column, bool polar);
+    void updateCoarseItem(const SurfaceDataView &dataArray, int row, int column, bool polar);
     void createSmoothIndices(int x, int y, int endX, int endY);
     void createCoarseSubSection(int x, int y, int columns, int rows);
     void createSmoothGridlineIndices(int x, int y, int endX, int endY);
@@ -71,10 +73,27 @@ public:
     inline void activateSurfaceTexture(bool value) { m_returnTextureBuffer = value; }
     inline void setLineColor(const QColor &color) { m_wireframeColor = color; }
     inline const QColor &wireframeColor() const { return m_wireframeColor; }
+    bool beginPreparation();
+    void finishPreparation();
+    void cancelPreparation();
 
 private:
+    // Maps data values to positions. Linear mappings do not depend on the axis afterwards.
+    struct AxisMapping
+    {
+        float origin = 0.0f;
+        float multiplier = 1.0f;
+        float offset = 0.0f;
+        bool linear = false;
+
+        void resolve(const AxisRenderCache &cache);
+        inline float map(float value) const { return (value - origin) * multiplier + offset; }
+        void mapValues(const AxisRenderCache &cache, float *values, int count) const;
+    };
+
     void createCoarseIndices(GLint *indices, int &p, int row, int upperRow, int j);
     void createNormals(int &p, int row, int upperRow, int j);
+    void createCoarseNormalRow(int row, int upperRow);
     void createSmoothNormalBodyLine(int &totalIndex, int column);
     void createSmoothNormalUpperLine(int &totalIndex);
     QVector3D createSmoothNormalBodyLineItem(int x, int y);
@@ -82,8 +101,12 @@ private:
     QVector3D normal(const QVector3D &a, const QVector3D &b, const QVector3D &c);
     void createBuffers(const QList<QVector3D> &vertices, const QList<QVector2D> &uvs,
                        const QList<QVector3D> &normals, const GLint *indices);
-    void checkDirections(const QSurfaceDataArray &array);
-    inline void getNormalizedVertex(const QSurfaceDataItem &data, QVector3D &vertex, bool polar,
+    void uploadIndices(GLuint buffer, const GLint *indices, int count);
+    void uploadTextureUVs(const QList<QVector2D> &uvs);
+    void checkDirections(const SurfaceDataView &array);
+    void createVertices(const SurfaceDataView &dataArray, bool polar, bool flipXZ,
+                        bool coarse);
+    inline void getNormalizedVertex(const QVector3D &data, QVector3D &vertex, bool polar,
                                     bool flipXZ);
 
 private:
@@ -106,6 +129,19 @@ private:
     SurfaceObject::DataDimensions m_dataDimension;
     SurfaceObject::DataDimensions m_oldDataDimension = DataDimensions(-1);
     QColor m_wireframeColor;
+
+    // State of a preparation on a worker thread, see beginPreparation()
+    bool m_preparing = false;
+    AxisMapping m_preparedMappingX;
+    AxisMapping m_preparedMappingY;
+    AxisMapping m_preparedMappingZ;
+    bool m_preparedReversedX = false;
+    bool m_preparedReversedZ = false;
+    bool m_pendingMesh = false;
+    QList<QVector2D> m_pendingUVs;
+    QList<GLint> m_pendingIndices;
+    QList<GLint> m_pendingGridIndices;
+    QList<QVector2D> m_pendingTextureUVs;
 };
 
 QT_END_NAMESPACE
@@ -3,6 +3,7 @@
 
 #include "texturehelper_p.h"
 #include "utils_p.h"
+#include "framestatisticscollector_p.h"
 
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
@@ -65,6 +66,7 @@ GLuint TextureHelper::create2DTexture(const QImage &image, bool useTrilinearFilt
     glBindTexture(GL_TEXTURE_2D, textureId);
     if (convert)
         texImage = convertToGLFormat(texImage);
+    FrameStatisticsCollector::countTextureCreation(texImage.sizeInBytes());
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texImage.width(), texImage.height(),
                  0, GL_RGBA, GL_UNSIGNED_BYTE, texImage.bits());
     if (smoothScale)
@@ -118,6 +120,8 @@ GLuint TextureHelper::create3DTexture(const QList<uchar> *data, int width, int h
         // Align width to 32bits
         width = width + width % 4;
     }
+    FrameStatisticsCollector::countTextureCreation(qint64(width) * height * depth
+                                                   * internalFormat);
     m_openGlFunctions_2_1->glTexImage3D(GL_TEXTURE_3D, 0, internalFormat, width, height, depth, 0,
                                         format, GL_UNSIGNED_BYTE, data->constData());
     status = glGetError();
@@ -130,6 +134,104 @@ GLuint TextureHelper::create3DTexture(const QList<uchar> *data, int width, int h
     return textureId;
 }
 
+void TextureHelper::update3DTexture(GLuint textureId, const QList<uchar> *data, int width,
+                                    int height, QImage::Format dataFormat, int x, int y, int z,
+                                    int boxWidth, int boxHeight, int boxDepth)
+{
+    if (Utils::isOpenGLES() || !textureId || !data)
+        return;
+
+#if QT_CONFIG(opengles2)
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+    Q_UNUSED(dataFormat);
+    Q_UNUSED(x);
+    Q_UNUSED(y);
+    Q_UNUSED(z);
+    Q_UNUSED(boxWidth);
+    Q_UNUSED(boxHeight);
+    Q_UNUSED(boxDepth);
+#else
+    int pixelWidth = 4;
+    GLint format = GL_BGRA;
+    if (dataFormat == QImage::Format_Indexed8) {
+        pixelWidth = 1;
+        format = GL_RED;
+        // Align width to 32bits
+        width = width + width % 4;
+    }
+    qsizetype lineSize = qsizetype(width) * pixelWidth;
+    qsizetype offset = (qsizetype(z) * height + y) * lineSize + qsizetype(x) * pixelWidth;
+
+    glBindTexture(GL_TEXTURE_3D, textureId);
+    // Read the box directly from the whole texture data
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, height);
+    m_openGlFunctions_2_1->glTexSubImage3D(GL_TEXTURE_3D, 0, x, y, z,
+                                           boxWidth, boxHeight, boxDepth,
+                                           format, GL_UNSIGNED_BYTE, data->constData() + offset);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_3D, 0);
+#endif
+}
+
+GLuint TextureHelper::createBrickTexture(const QList<uchar> &bricks, int width, int height,
+                                         int depth)
+{
+    if (Utils::isOpenGLES() || !width || !height || !depth
+            || bricks.size() < qsizetype(width) * height * depth) {
+        return 0;
+    }
+
+    GLuint textureId = 0;
+#if QT_CONFIG(opengles2)
+    Q_UNUSED(bricks);
+#else
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_3D, textureId);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    // Brick grid dimensions are arbitrary, so rows are not aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    FrameStatisticsCollector::countTextureCreation(qint64(width) * height * depth);
+    m_openGlFunctions_2_1->glTexImage3D(GL_TEXTURE_3D, 0, 1, width, height, depth, 0,
+                                        GL_RED, GL_UNSIGNED_BYTE, bricks.constData());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+#endif
+    return textureId;
+}
+
+void TextureHelper::updateBrickTexture(GLuint textureId, const QList<uchar> &bricks, int width,
+                                       int height, int depth)
+{
+    if (Utils::isOpenGLES() || !textureId
+            || bricks.size() < qsizetype(width) * height * depth) {
+        return;
+    }
+
+#if QT_CONFIG(opengles2)
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+    Q_UNUSED(depth);
+#else
+    glBindTexture(GL_TEXTURE_3D, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    m_openGlFunctions_2_1->glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, width, height, depth,
+                                           GL_RED, GL_UNSIGNED_BYTE, bricks.constData());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_3D, 0);
+#endif
+}
+
 GLuint TextureHelper::createCubeMapTexture(const QImage &image, bool useTrilinearFiltering)
 {
     if (image.isNull())
@@ -139,6 +241,8 @@ GLuint TextureHelper::createCubeMapTexture(const QImage &image, bool useTrilinea
     glGenTextures(1, &textureId);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
     QImage glTexture = convertToGLFormat(image);
+    FrameStatisticsCollector::countTextureCreation(qint64(glTexture.width()) * glTexture.height()
+                                                   * 4);
     glTexImage2D(GL_TEXTURE_CUBE_MAP, 0, GL_RGBA, glTexture.width(), glTexture.height(),
                  0, GL_RGBA, GL_UNSIGNED_BYTE, glTexture.bits());
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -153,17 +257,35 @@ GLuint TextureHelper::createCubeMapTexture(const QImage &image, bool useTrilinea
 }
 
 GLuint TextureHelper::createSelectionTexture(const QSize &size, GLuint &frameBuffer,
-                                             GLuint &depthBuffer)
+                                             GLuint &depthBuffer, bool integerIds)
 {
     GLuint textureid;
 
     // Create texture for the selection buffer
     glGenTextures(1, &textureid);
     glBindTexture(GL_TEXTURE_2D, textureid);
+    GLint internalFormat = GL_RGBA;
+    GLenum format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    GLint magFilter = GL_LINEAR;
+    qint64 texelSize = 4;
+#if !QT_CONFIG(opengles2)
+    if (integerIds) {
+        internalFormat = GL_RGBA32UI;
+        format = GL_RGBA_INTEGER;
+        type = GL_UNSIGNED_INT;
+        magFilter = GL_NEAREST; // Integer textures cannot be filtered
+        texelSize = 4 * sizeof(GLuint);
+    }
+#else
+    Q_UNUSED(integerIds);
+#endif
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.width(), size.height(), 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+    FrameStatisticsCollector::countTextureCreation(qint64(size.width()) * size.height()
+                                                   * texelSize);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.width(), size.height(), 0, format, type,
+                 NULL);
     glBindTexture(GL_TEXTURE_2D, 0);
 
     // Create render buffer
@@ -219,6 +341,7 @@ GLuint TextureHelper::createCursorPositionTexture(const QSize &size, GLuint &fra
     GLuint textureid;
     glGenTextures(1, &textureid);
     glBindTexture(GL_TEXTURE_2D, textureid);
+    FrameStatisticsCollector::countTextureCreation(qint64(size.width()) * size.height() * 4);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.width(), size.height(), 0, GL_RGBA,
                  GL_UNSIGNED_BYTE, NULL);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -280,6 +403,8 @@ GLuint TextureHelper::createDepthTexture(const QSize &size, GLuint textureSize)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE_ARB, GL_COMPARE_R_TO_TEXTURE_ARB);
+        FrameStatisticsCollector::countTextureCreation(qint64(size.width()) * textureSize
+                                                       * size.height() * textureSize * 4);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, size.width() * textureSize,
                      size.height() * textureSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -35,9 +35,18 @@ class TextureHelper : protected QOpenGLFunctions
                            bool convert = true, bool smoothScale = true, bool clampY = false);
     GLuint create3DTexture(const QList<uchar> *data, int width, int height, int depth,
                            QImage::Format dataFormat);
+    void update3DTexture(GLuint textureId, const QList<uchar> *data, int width, int height,
+                         QImage::Format dataFormat, int x, int y, int z, int boxWidth,
+                         int boxHeight, int boxDepth);
+    // Single channel texture with one texel per volume brick, nonzero for nonempty bricks
+    GLuint createBrickTexture(const QList<uchar> &bricks, int width, int height, int depth);
+    void updateBrickTexture(GLuint textureId, const QList<uchar> &bricks, int width, int height,
+                            int depth);
     GLuint createCubeMapTexture(const QImage &image, bool useTrilinearFiltering = false);
-    // Returns selection texture and inserts generated framebuffers to framebuffer parameters
-    GLuint createSelectionTexture(const QSize &size, GLuint &frameBuffer, GLuint &depthBuffer);
+    // Returns selection texture and inserts generated framebuffers to framebuffer parameters.
+    // Integer id textures hold 32-bit unsigned integers and need OpenGL 3.0.
+    GLuint createSelectionTexture(const QSize &size, GLuint &frameBuffer, GLuint &depthBuffer,
+                                  bool integerIds = false);
     GLuint createCursorPositionTexture(const QSize &size, GLuint &frameBuffer);
     GLuint createUniformTexture(const QColor &color);
     GLuint createGradientTexture(const QLinearGradient &gradient);
@@ -6,10 +6,25 @@
 #include <QtGui/QPainter>
 #include <QtGui/QOpenGLContext>
 #include <QtGui/QOffscreenSurface>
+#include <QtGui/QMatrix4x4>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <QtCore/qmath.h>
 #include <QLocale>
 
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DATAVIS_SSE_TRANSFORM
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DATAVIS_SSE_LOG
+#endif
+
 QT_BEGIN_NAMESPACE
 
 #define NUM_IN_POWER(y, x) for (;y<x;y<<=1)
@@ -363,4 +378,157 @@ void Utils::resolveStatics()
     staticsResolved = true;
 }
 
+// Calculates target = matrix * source + translation for count vertices. Only the upper 3x4
+// part of the matrix is used.
+void Utils::transformVertices(const QVector3D *source, QVector3D *target, int count,
+                              const QMatrix4x4 &matrix, const QVector3D &translation)
+{
+    const float *m = matrix.constData();
+#ifdef DATAVIS_SSE_TRANSFORM
+    const __m128 col0 = _mm_setr_ps(m[0], m[1], m[2], 0.0f);
+    const __m128 col1 = _mm_setr_ps(m[4], m[5], m[6], 0.0f);
+    const __m128 col2 = _mm_setr_ps(m[8], m[9], m[10], 0.0f);
+    const __m128 col3 = _mm_setr_ps(m[12] + translation.x(), m[13] + translation.y(),
+                                    m[14] + translation.z(), 0.0f);
+    for (int i = 0; i < count; i++) {
+        const QVector3D &v = source[i];
+        __m128 result = _mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(v.x())), col3);
+        result = _mm_add_ps(result, _mm_mul_ps(col1, _mm_set1_ps(v.y())));
+        result = _mm_add_ps(result, _mm_mul_ps(col2, _mm_set1_ps(v.z())));
+        float *out = reinterpret_cast<float *>(&target[i]);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out), result);
+        _mm_store_ss(out + 2, _mm_movehl_ps(result, result));
+    }
+#else
+    const float tx = m[12] + translation.x();
+    const float ty = m[13] + translation.y();
+    const float tz = m[14] + translation.z();
+    for (int i = 0; i < count; i++) {
+        const QVector3D &v = source[i];
+        target[i] = QVector3D(m[0] * v.x() + m[4] * v.y() + m[8] * v.z() + tx,
+                              m[1] * v.x() + m[5] * v.y() + m[9] * v.z() + ty,
+                              m[2] * v.x() + m[6] * v.y() + m[10] * v.z() + tz);
+    }
+#endif
+}
+
+// Calculates count unnormalized triangle normals, cross(b - a, c - a). Each source pointer
+// advances by sourceStride vectors and the target by targetStride vectors per normal.
+void Utils::calculateNormals(const QVector3D *a, const QVector3D *b, const QVector3D *c,
+                             int sourceStride, QVector3D *target, int targetStride, int count)
+{
+    int i = 0;
+#ifdef DATAVIS_SSE_TRANSFORM
+    // Loads read one float past each vector, so the last normal is done without SSE
+    for (; i < count - 1; i++) {
+        const int s = i * sourceStride;
+        const __m128 va = _mm_loadu_ps(reinterpret_cast<const float *>(a + s));
+        const __m128 u = _mm_sub_ps(_mm_loadu_ps(reinterpret_cast<const float *>(b + s)), va);
+        const __m128 v = _mm_sub_ps(_mm_loadu_ps(reinterpret_cast<const float *>(c + s)), va);
+        const __m128 result = _mm_sub_ps(
+                    _mm_mul_ps(_mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 0, 2, 1)),
+                               _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2))),
+                    _mm_mul_ps(_mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 1, 0, 2)),
+                               _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1))));
+        float *out = reinterpret_cast<float *>(target + i * targetStride);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out), result);
+        _mm_store_ss(out + 2, _mm_movehl_ps(result, result));
+    }
+#endif
+    for (; i < count; i++) {
+        const int s = i * sourceStride;
+        target[i * targetStride] = QVector3D::crossProduct(b[s] - a[s], c[s] - a[s]);
+    }
+}
+
+// Calculates the natural logarithm of count values. Groups of four positive, normal, and finite
+// values use a polynomial approximation (from Cephes logf) with single precision accuracy,
+// other values use qLn().
+void Utils::logValues(const float *values, float *logs, qsizetype count)
+{
+    qsizetype i = 0;
+#ifdef DATAVIS_SSE_LOG
+    const __m128 minNormal = _mm_set1_ps(std::numeric_limits<float>::min());
+    const __m128 maxFinite = _mm_set1_ps(std::numeric_limits<float>::max());
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sqrtHalf = _mm_set1_ps(0.707106781186547524f);
+    const __m128i exponentBias = _mm_set1_epi32(0x7f);
+    const __m128i mantissaMask = _mm_set1_epi32(0x007fffff);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        const __m128 valid = _mm_and_ps(_mm_cmpge_ps(x, minNormal), _mm_cmple_ps(x, maxFinite));
+        if (_mm_movemask_ps(valid) != 0xf) {
+            for (qsizetype j = i; j < i + 4; j++)
+                logs[j] = float(qLn(qreal(values[j])));
+            continue;
+        }
+
+        // Split into exponent e and mantissa x in [sqrt(0.5), sqrt(2))
+        const __m128i bits = _mm_castps_si128(x);
+        __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), exponentBias));
+        x = _mm_or_ps(_mm_castsi128_ps(_mm_and_si128(bits, mantissaMask)), half);
+        e = _mm_add_ps(e, one);
+        const __m128 small = _mm_cmplt_ps(x, sqrtHalf);
+        e = _mm_sub_ps(e, _mm_and_ps(one, small));
+        x = _mm_add_ps(_mm_sub_ps(x, one), _mm_and_ps(x, small));
+
+        const __m128 z = _mm_mul_ps(x, x);
+        __m128 y = _mm_set1_ps(7.0376836292e-2f);
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993e-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174e-1f));
+        y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+        y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+        y = _mm_sub_ps(y, _mm_mul_ps(z, half));
+        x = _mm_add_ps(x, y);
+        x = _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+        _mm_storeu_ps(logs + i, x);
+    }
+#endif
+    for (; i < count; i++)
+        logs[i] = float(qLn(qreal(values[i])));
+}
+
+// Splits range [0, count) into chunks of at least minChunkSize and calls function(begin, end)
+// for each chunk using the global thread pool. Returns when all chunks are done. Chunks that
+// cannot get a free pool thread are run on the calling thread, so this never blocks waiting
+// for pool capacity.
+void Utils::parallelFor(int count, int minChunkSize,
+                        const std::function<void(int, int)> &function)
+{
+    if (count <= 0)
+        return;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int chunkCount = qBound(1, count / qMax(1, minChunkSize), pool->maxThreadCount() + 1);
+    if (chunkCount == 1) {
+        function(0, count);
+        return;
+    }
+
+    const int chunkSize = (count + chunkCount - 1) / chunkCount;
+    QSemaphore finished;
+    int started = 0;
+    for (int begin = chunkSize; begin < count; begin += chunkSize) {
+        const int end = qMin(begin + chunkSize, count);
+        auto task = [&function, &finished, begin, end]() {
+            function(begin, end);
+            finished.release();
+        };
+        if (pool->tryStart(task))
+            started++;
+        else
+            function(begin, end);
+    }
+    function(0, chunkSize);
+    finished.acquire(started);
+}
+
 QT_END_NAMESPACE
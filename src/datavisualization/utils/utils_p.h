@@ -15,8 +15,10 @@
 #define UTILS_P_H
 
 #include "datavisualizationglobal_p.h"
+#include <functional>
 
 QT_FORWARD_DECLARE_CLASS(QLinearGradient)
+QT_FORWARD_DECLARE_CLASS(QMatrix4x4)
 
 QT_BEGIN_NAMESPACE
 
@@ -57,6 +59,15 @@ public:
     static bool isOpenGLES();
     static void resolveStatics();
 
+    static void transformVertices(const QVector3D *source, QVector3D *target, int count,
+                                  const QMatrix4x4 &matrix, const QVector3D &translation);
+    static void calculateNormals(const QVector3D *a, const QVector3D *b, const QVector3D *c,
+                                 int sourceStride, QVector3D *target, int targetStride,
+                                 int count);
+    static void logValues(const float *values, float *logs, qsizetype count);
+    static void parallelFor(int count, int minChunkSize,
+                            const std::function<void(int, int)> &function);
+
 private:
     static ParamType mapFormatCharToParamType(char formatSpec);
 };
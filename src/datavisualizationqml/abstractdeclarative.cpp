@@ -335,6 +335,19 @@ void AbstractDeclarative::setSharedController(Abstract3DController *controller)
                      &AbstractDeclarative::queriedGraphPositionChanged);
     QObject::connect(m_controller.data(), &Abstract3DController::marginChanged, this,
                      &AbstractDeclarative::marginChanged);
+    QObject::connect(m_controller.data(), &Abstract3DController::frameStatisticsEnabledChanged,
+                     this, &AbstractDeclarative::frameStatisticsEnabledChanged);
+    QObject::connect(m_controller.data(), &Abstract3DController::frameStatisticsChanged, this,
+                     &AbstractDeclarative::frameStatisticsChanged);
+    QObject::connect(m_controller.data(),
+                     &Abstract3DController::asynchronousDataPreparationChanged, this,
+                     &AbstractDeclarative::asynchronousDataPreparationChanged);
+    QObject::connect(m_controller.data(), &Abstract3DController::maxDataLatencyChanged, this,
+                     &AbstractDeclarative::maxDataLatencyChanged);
+    QObject::connect(m_controller.data(), &Abstract3DController::dataReady, this,
+                     &AbstractDeclarative::dataReady);
+    QObject::connect(m_controller.data(), &Abstract3DController::shadowMapSizeChanged, this,
+                     &AbstractDeclarative::shadowMapSizeChanged);
 }
 
 void AbstractDeclarative::activateOpenGLContext(QQuickWindow *window)
@@ -788,6 +801,51 @@ qreal AbstractDeclarative::margin() const
     return m_controller->margin();
 }
 
+void AbstractDeclarative::setFrameStatisticsEnabled(bool enable)
+{
+    m_controller->setFrameStatisticsEnabled(enable);
+}
+
+bool AbstractDeclarative::isFrameStatisticsEnabled() const
+{
+    return m_controller->isFrameStatisticsEnabled();
+}
+
+Q3DFrameStatistics AbstractDeclarative::frameStatistics() const
+{
+    return m_controller->frameStatistics();
+}
+
+void AbstractDeclarative::setAsynchronousDataPreparation(bool enable)
+{
+    m_controller->setAsynchronousDataPreparation(enable);
+}
+
+bool AbstractDeclarative::asynchronousDataPreparation() const
+{
+    return m_controller->asynchronousDataPreparation();
+}
+
+void AbstractDeclarative::setMaxDataLatency(int msecs)
+{
+    m_controller->setMaxDataLatency(msecs);
+}
+
+int AbstractDeclarative::maxDataLatency() const
+{
+    return m_controller->maxDataLatency();
+}
+
+void AbstractDeclarative::setShadowMapSize(int size)
+{
+    m_controller->setShadowMapSize(size);
+}
+
+int AbstractDeclarative::shadowMapSize() const
+{
+    return m_controller->shadowMapSize();
+}
+
 void AbstractDeclarative::windowDestroyed(QObject *obj)
 {
     // Remove destroyed window from window lists
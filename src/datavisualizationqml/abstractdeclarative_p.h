@@ -56,6 +56,11 @@ class AbstractDeclarative : public QQuickItem, public AbstractDeclarativeInterfa
     Q_PROPERTY(QLocale locale READ locale WRITE setLocale NOTIFY localeChanged REVISION(1, 2))
     Q_PROPERTY(QVector3D queriedGraphPosition READ queriedGraphPosition NOTIFY queriedGraphPositionChanged REVISION(1, 2))
     Q_PROPERTY(qreal margin READ margin WRITE setMargin NOTIFY marginChanged REVISION(1, 2))
+    Q_PROPERTY(bool frameStatisticsEnabled READ isFrameStatisticsEnabled WRITE setFrameStatisticsEnabled NOTIFY frameStatisticsEnabledChanged REVISION(6, 6))
+    Q_PROPERTY(Q3DFrameStatistics frameStatistics READ frameStatistics NOTIFY frameStatisticsChanged REVISION(6, 6))
+    Q_PROPERTY(bool asynchronousDataPreparation READ asynchronousDataPreparation WRITE setAsynchronousDataPreparation NOTIFY asynchronousDataPreparationChanged REVISION(6, 6))
+    Q_PROPERTY(int maxDataLatency READ maxDataLatency WRITE setMaxDataLatency NOTIFY maxDataLatencyChanged REVISION(6, 6))
+    Q_PROPERTY(int shadowMapSize READ shadowMapSize WRITE setShadowMapSize NOTIFY shadowMapSizeChanged REVISION(6, 6))
 
     QML_NAMED_ELEMENT(AbstractGraph3D)
     QML_ADDED_IN_VERSION(1, 0)
@@ -103,7 +108,8 @@ public:
 
     enum OptimizationHint {
         OptimizationDefault = 0,
-        OptimizationStatic  = 1
+        OptimizationStatic  = 1,
+        OptimizationCachedScene = 2
     };
     Q_DECLARE_FLAGS(OptimizationHints, OptimizationHint)
 
@@ -214,6 +220,18 @@ public:
     void setMargin(qreal margin);
     qreal margin() const;
 
+    void setFrameStatisticsEnabled(bool enable);
+    bool isFrameStatisticsEnabled() const;
+    Q3DFrameStatistics frameStatistics() const;
+
+    void setAsynchronousDataPreparation(bool enable);
+    bool asynchronousDataPreparation() const;
+    void setMaxDataLatency(int msecs);
+    int maxDataLatency() const;
+
+    void setShadowMapSize(int size);
+    int shadowMapSize() const;
+
     QMutex *mutex() { return &m_mutex; }
 
     bool isReady() const override { return isComponentComplete(); }
@@ -266,6 +284,12 @@ Q_SIGNALS:
     Q_REVISION(1, 2) void localeChanged(const QLocale &locale);
     Q_REVISION(1, 2) void queriedGraphPositionChanged(const QVector3D &data);
     Q_REVISION(1, 2) void marginChanged(qreal margin);
+    Q_REVISION(6, 6) void frameStatisticsEnabledChanged(bool enabled);
+    Q_REVISION(6, 6) void frameStatisticsChanged(const Q3DFrameStatistics &statistics);
+    Q_REVISION(6, 6) void asynchronousDataPreparationChanged(bool enabled);
+    Q_REVISION(6, 6) void maxDataLatencyChanged(int msecs);
+    Q_REVISION(6, 6) void dataReady();
+    Q_REVISION(6, 6) void shadowMapSizeChanged(int size);
 
 protected:
     QSharedPointer<QMutex> m_nodeMutex;
@@ -19,6 +19,7 @@
 #include <QtCore/qabstractitemmodel.h>
 
 #include <QtDataVisualization/q3dcamera.h>
+#include <QtDataVisualization/q3dframestatistics.h>
 #include <QtDataVisualization/q3dinputhandler.h>
 #include <QtDataVisualization/q3dlight.h>
 #include <QtDataVisualization/q3dobject.h>
@@ -84,6 +85,14 @@ struct Q3DSceneForeign
     QML_FOREIGN(Q3DScene)
 };
 
+struct Q3DFrameStatisticsForeign
+{
+    Q_GADGET
+    QML_VALUE_TYPE(frameStatistics3D)
+    QML_ADDED_IN_VERSION(6, 6)
+    QML_FOREIGN(Q3DFrameStatistics)
+};
+
 DEFINE_FOREIGN_CREATABLE_TYPE(Q3DCamera, Camera3D, 0)
 DEFINE_FOREIGN_CREATABLE_TYPE(Q3DLight, Light3D, 0)
 DEFINE_FOREIGN_CREATABLE_TYPE(QCategory3DAxis, CategoryAxis3D, 0)
@@ -4,6 +4,9 @@
 #ifndef CPPTESTUTIL_H
 #define CPPTESTUTIL_H
 
+#include <QtCore/QAbstractListModel>
+#include <QtDataVisualization/QAbstract3DGraph>
+#include <QtGui/QImage>
 #include <QtGui/private/qguiapplication_p.h>
 #include <QtGui/qpa/qplatformintegration.h>
 
@@ -16,9 +19,134 @@ static bool isOpenGLSupported()
     return QGuiApplicationPrivate::platformIntegration()->hasCapability(QPlatformIntegration::OpenGL);
 }
 
+// Returns true if the graph can be rendered into images on this platform
+inline bool canRenderToImage(QAbstract3DGraph *graph)
+{
+    if (!isOpenGLSupported() || !graph->hasContext())
+        return false;
+    const QImage image = graph->renderToImage(0, QSize(16, 16));
+    return image.size() == QSize(16, 16);
+}
+
+// Returns the fraction of pixels that clearly differ between the images
+inline qreal differingPixels(const QImage &image1, const QImage &image2)
+{
+    const QImage a = image1.convertToFormat(QImage::Format_ARGB32);
+    const QImage b = image2.convertToFormat(QImage::Format_ARGB32);
+    if (a.isNull() || a.size() != b.size())
+        return 1.0;
+
+    const int tolerance = 24;
+    int count = 0;
+    for (int y = 0; y < a.height(); y++) {
+        const QRgb *lineA = reinterpret_cast<const QRgb *>(a.constScanLine(y));
+        const QRgb *lineB = reinterpret_cast<const QRgb *>(b.constScanLine(y));
+        for (int x = 0; x < a.width(); x++) {
+            if (qAbs(qRed(lineA[x]) - qRed(lineB[x])) > tolerance
+                    || qAbs(qGreen(lineA[x]) - qGreen(lineB[x])) > tolerance
+                    || qAbs(qBlue(lineA[x]) - qBlue(lineB[x])) > tolerance) {
+                count++;
+            }
+        }
+    }
+    return qreal(count) / qreal(a.width() * a.height());
+}
+
+// A graph under test and a reference graph of the same type, for checking that the graph
+// renders like the reference when both are given the same data. Shadows are disabled, as
+// they vary the most between implementations.
+template <typename Graph>
+class GraphComparison
+{
+public:
+    static const int graphCount = 2;
+
+    explicit GraphComparison(Graph *graph, const QSize &imageSize = QSize(256, 256))
+        : m_imageSize(imageSize)
+    {
+        m_graphs[0] = graph;
+        m_graphs[1] = &m_reference;
+        for (Graph *g : m_graphs)
+            g->setShadowQuality(QAbstract3DGraph::ShadowQualityNone);
+    }
+
+    // Index 0 is the graph under test and 1 the reference graph
+    inline Graph *graph(int index) const { return m_graphs[index]; }
+    inline Graph *reference() { return &m_reference; }
+
+    inline QImage render() const { return m_graphs[0]->renderToImage(0, m_imageSize); }
+    // Returns true if the image of the graph under test matches the reference graph
+    bool matchesReference(const QImage &image)
+    {
+        return differingPixels(image, m_reference.renderToImage(0, m_imageSize)) < 0.005;
+    }
+    inline bool matchesReference() { return matchesReference(render()); }
+
+private:
+    Graph m_reference;
+    Graph *m_graphs[graphCount];
+    QSize m_imageSize;
+};
+
+// List model whose items hold the data of the given roles, from Qt::UserRole + 1 on. Unlike
+// QStandardItemModel, it can move rows.
+class ItemListModel : public QAbstractListModel
+{
+public:
+    explicit ItemListModel(const QList<QByteArray> &roles) : m_roles(roles) {}
+
+    void appendItem(const QVariantList &data)
+    {
+        beginInsertRows(QModelIndex(), m_items.size(), m_items.size());
+        m_items.append(data);
+        endInsertRows();
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_items.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        const int roleIndex = role - Qt::UserRole - 1;
+        if (!index.isValid() || roleIndex < 0 || roleIndex >= m_roles.size())
+            return QVariant();
+        return m_items.at(index.row()).value(roleIndex);
+    }
+
+    QHash<int, QByteArray> roleNames() const override
+    {
+        QHash<int, QByteArray> names;
+        for (int i = 0; i < m_roles.size(); i++)
+            names.insert(Qt::UserRole + 1 + i, m_roles.at(i));
+        return names;
+    }
+
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) override
+    {
+        if (!beginMoveRows(sourceParent, sourceRow, sourceRow + count - 1, destinationParent,
+                           destinationChild)) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            if (destinationChild > sourceRow)
+                m_items.move(sourceRow, destinationChild - 1);
+            else
+                m_items.move(sourceRow + i, destinationChild + i);
+        }
+        endMoveRows();
+        return true;
+    }
+
+private:
+    QList<QByteArray> m_roles;
+    QList<QVariantList> m_items;
+};
+
 } // CpptestUtil namespace
 
 QT_END_NAMESPACE
 
 #endif
-
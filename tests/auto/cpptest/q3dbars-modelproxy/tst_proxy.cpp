@@ -5,6 +5,7 @@
 
 #include <QtDataVisualization/QItemModelBarDataProxy>
 #include <QtDataVisualization/Q3DBars>
+#include <QtGui/QStandardItemModel>
 #include <QtWidgets/QTableWidget>
 
 #include "cpptestutil.h"
@@ -25,6 +26,7 @@ private slots:
     void initializeProperties();
 
     void multiMatch();
+    void rowChanges();
 
 private:
     QItemModelBarDataProxy *m_proxy;
@@ -254,5 +256,103 @@ void tst_proxy::multiMatch()
     m_proxy = 0; // Proxy gets deleted as graph gets deleted
 }
 
+static void insertBarItem(QStandardItemModel *model, int modelRow, const QString &row,
+                          const QString &column, float value)
+{
+    QStandardItem *item = new QStandardItem;
+    item->setData(row, Qt::UserRole + 1);
+    item->setData(column, Qt::UserRole + 2);
+    item->setData(value, Qt::UserRole + 3);
+    model->insertRow(modelRow, item);
+}
+
+static void appendBarItem(QStandardItemModel *model, const QString &row, const QString &column,
+                          float value)
+{
+    insertBarItem(model, model->rowCount(), row, column, value);
+}
+
+void tst_proxy::rowChanges()
+{
+    QStandardItemModel model;
+    model.setItemRoleNames({{Qt::UserRole + 1, "row"}, {Qt::UserRole + 2, "column"},
+                            {Qt::UserRole + 3, "value"}});
+    appendBarItem(&model, "a", "x", 1.0f);
+    appendBarItem(&model, "a", "y", 2.0f);
+    appendBarItem(&model, "b", "x", 3.0f);
+
+    m_proxy->setItemModel(&model);
+    m_proxy->setRowRole("row");
+    m_proxy->setColumnRole("column");
+    m_proxy->setValueRole("value");
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->itemAt(1, 1)->value(), 0.0f);
+
+    // Row changes in the model are applied without resolving the whole model
+    QSignalSpy resetSpy(m_proxy, &QBarDataProxy::arrayReset);
+
+    appendBarItem(&model, "c", "y", 4.0f);
+    QCOMPARE(m_proxy->rowCount(), 3);
+    QCOMPARE(m_proxy->rowLabels(), QStringList({"a", "b", "c"}));
+    QCOMPARE(m_proxy->itemAt(2, 1)->value(), 4.0f);
+
+    appendBarItem(&model, "b", "y", 5.0f);
+    QCOMPARE(m_proxy->rowCount(), 3);
+    QCOMPARE(m_proxy->itemAt(1, 1)->value(), 5.0f);
+
+    model.item(0)->setData(6.0f, Qt::UserRole + 3);
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 6.0f);
+
+    model.removeRow(3);
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->rowLabels(), QStringList({"a", "b"}));
+    QCOMPARE(m_proxy->itemAt(1, 1)->value(), 5.0f);
+
+    m_proxy->setMultiMatchBehavior(QItemModelBarDataProxy::MMBCumulative);
+    QCoreApplication::processEvents();
+    resetSpy.clear();
+    appendBarItem(&model, "a", "x", 1.0f);
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 7.0f);
+    model.removeRow(model.rowCount() - 1);
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 6.0f);
+
+    // Items inserted in the middle of the model can add categories anywhere
+    insertBarItem(&model, 1, "b", "x", 1.0f);
+    QCOMPARE(m_proxy->itemAt(1, 0)->value(), 4.0f);
+    insertBarItem(&model, 2, "c", "x", 2.0f);
+    QCOMPARE(m_proxy->rowLabels(), QStringList({"a", "b", "c"}));
+    QCOMPARE(m_proxy->itemAt(2, 0)->value(), 2.0f);
+    QCOMPARE(m_proxy->itemAt(2, 1)->value(), 0.0f);
+    insertBarItem(&model, 0, "d", "x", 3.0f);
+    QCOMPARE(m_proxy->rowLabels(), QStringList({"d", "a", "b", "c"}));
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 3.0f);
+    QCOMPARE(m_proxy->itemAt(1, 0)->value(), 6.0f);
+
+    QCOMPARE(resetSpy.count(), 0);
+
+    // Moving items changes the first item of their cells
+    CpptestUtil::ItemListModel listModel({"row", "column", "value"});
+    listModel.appendItem({"a", "x", 1.0f});
+    listModel.appendItem({"a", "y", 2.0f});
+    listModel.appendItem({"b", "x", 3.0f});
+    listModel.appendItem({"a", "x", 4.0f});
+    m_proxy->setItemModel(&listModel);
+    m_proxy->setMultiMatchBehavior(QItemModelBarDataProxy::MMBFirst);
+    QCoreApplication::processEvents();
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 1.0f);
+    resetSpy.clear();
+
+    QVERIFY(listModel.moveRow(QModelIndex(), 3, QModelIndex(), 0));
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 4.0f);
+    QVERIFY(listModel.moveRow(QModelIndex(), 0, QModelIndex(), 4));
+    QCOMPARE(m_proxy->itemAt(0, 0)->value(), 1.0f);
+    QCOMPARE(m_proxy->itemAt(0, 1)->value(), 2.0f);
+    QCOMPARE(m_proxy->itemAt(1, 0)->value(), 3.0f);
+
+    QCOMPARE(resetSpy.count(), 0);
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
@@ -44,6 +44,9 @@ private slots:
     void removeCustomItem();
 
     void renderToImage();
+    void staticOptimization();
+    void frameStatistics();
+    void shadowMapSize();
 
 private:
     Q3DBars *m_graph;
@@ -124,6 +127,10 @@ void tst_bars::initialProperties()
     QCOMPARE(m_graph->locale(), QLocale("C"));
     QCOMPARE(m_graph->queriedGraphPosition(), QVector3D(0, 0, 0));
     QCOMPARE(m_graph->margin(), -1.0);
+    QCOMPARE(m_graph->isFrameStatisticsEnabled(), false);
+    QCOMPARE(m_graph->asynchronousDataPreparation(), false);
+    QCOMPARE(m_graph->maxDataLatency(), -1);
+    QCOMPARE(m_graph->shadowMapSize(), 0);
 }
 
 void tst_bars::initializeProperties()
@@ -160,6 +167,10 @@ void tst_bars::initializeProperties()
     m_graph->setReflectivity(0.1);
     m_graph->setLocale(QLocale("FI"));
     m_graph->setMargin(1.0);
+    m_graph->setFrameStatisticsEnabled(true);
+    m_graph->setAsynchronousDataPreparation(true);
+    m_graph->setMaxDataLatency(50);
+    m_graph->setShadowMapSize(2048);
 
     QCOMPARE(m_graph->activeTheme()->type(), Q3DTheme::ThemeDigia);
     QCOMPARE(m_graph->selectionMode(), QAbstract3DGraph::SelectionItem | QAbstract3DGraph::SelectionRow | QAbstract3DGraph::SelectionSlice);
@@ -175,6 +186,10 @@ void tst_bars::initializeProperties()
     QCOMPARE(m_graph->reflectivity(), 0.1);
     QCOMPARE(m_graph->locale(), QLocale("FI"));
     QCOMPARE(m_graph->margin(), 1.0);
+    QCOMPARE(m_graph->isFrameStatisticsEnabled(), true);
+    QCOMPARE(m_graph->asynchronousDataPreparation(), true);
+    QCOMPARE(m_graph->maxDataLatency(), 50);
+    QCOMPARE(m_graph->shadowMapSize(), 2048);
 }
 
 void tst_bars::invalidProperties()
@@ -405,5 +420,119 @@ void tst_bars::renderToImage()
     */
 }
 
+static QBarDataRow *staticRow(float first, float step, int count)
+{
+    QBarDataRow *row = new QBarDataRow(count);
+    for (int i = 0; i < count; i++)
+        (*row)[i].setValue(first + step * float(i));
+    return row;
+}
+
+void tst_bars::staticOptimization()
+{
+    if (!CpptestUtil::canRenderToImage(m_graph))
+        QSKIP("Rendering to images is not supported on this platform");
+
+    // Static bars are patched in place on item and row changes, so they must keep rendering
+    // the same as default bars with the same data
+    using Comparison = CpptestUtil::GraphComparison<Q3DBars>;
+    Comparison comparison(m_graph);
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationStatic);
+    QBar3DSeries *series[Comparison::graphCount];
+    for (int i = 0; i < Comparison::graphCount; i++) {
+        comparison.graph(i)->valueAxis()->setRange(0.0f, 10.0f);
+        series[i] = new QBar3DSeries;
+        QBarDataArray *array = new QBarDataArray;
+        for (int row = 0; row < 3; row++)
+            array->append(staticRow(1.0f + row, 1.5f, 4));
+        series[i]->dataProxy()->resetArray(array);
+        comparison.graph(i)->addSeries(series[i]);
+    }
+    QVERIFY(comparison.matchesReference());
+
+    // Neighboring items changed within one frame
+    for (QBar3DSeries *s : series) {
+        s->dataProxy()->setItem(1, 1, QBarDataItem(9.0f));
+        s->dataProxy()->setItem(1, 2, QBarDataItem(8.0f));
+    }
+    QVERIFY(comparison.matchesReference());
+
+    // Zero height bars
+    for (QBar3DSeries *s : series) {
+        s->dataProxy()->setRow(0, staticRow(0.0f, 0.0f, 4));
+        s->dataProxy()->setItem(2, 3, QBarDataItem(0.0f));
+    }
+    QVERIFY(comparison.matchesReference());
+
+    // Back from zero height
+    for (QBar3DSeries *s : series)
+        s->dataProxy()->setRow(0, staticRow(2.0f, 2.0f, 4));
+    QVERIFY(comparison.matchesReference());
+
+    // Different dimensions
+    for (QBar3DSeries *s : series) {
+        QBarDataArray *array = new QBarDataArray;
+        for (int row = 0; row < 5; row++)
+            array->append(staticRow(0.5f * row, 1.0f, 2));
+        s->dataProxy()->resetArray(array);
+    }
+    QVERIFY(comparison.matchesReference());
+}
+
+void tst_bars::frameStatistics()
+{
+    if (!CpptestUtil::canRenderToImage(m_graph))
+        QSKIP("Rendering to images is not supported on this platform");
+
+    m_graph->addSeries(newSeries());
+    m_graph->setFrameStatisticsEnabled(true);
+    QSignalSpy spy(m_graph, &QAbstract3DGraph::frameStatisticsChanged);
+
+    m_graph->renderToImage(0, QSize(128, 128));
+
+    QCOMPARE(spy.size(), 1);
+    const Q3DFrameStatistics statistics = spy.at(0).at(0).value<Q3DFrameStatistics>();
+    QVERIFY(statistics.drawCallCount() > 0);
+    QVERIFY(statistics.mainPassTime() >= 0);
+    QCOMPARE(m_graph->frameStatistics().drawCallCount(), statistics.drawCallCount());
+
+    // No statistics are reported while disabled
+    m_graph->setFrameStatisticsEnabled(false);
+    m_graph->renderToImage(0, QSize(128, 128));
+    QCOMPARE(spy.size(), 1);
+}
+
+void tst_bars::shadowMapSize()
+{
+    QSignalSpy spy(m_graph, &QAbstract3DGraph::shadowMapSizeChanged);
+
+    m_graph->setShadowMapSize(1024);
+    QCOMPARE(m_graph->shadowMapSize(), 1024);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), 1024);
+
+    // Setting the same size again is not a change
+    m_graph->setShadowMapSize(1024);
+    QCOMPARE(spy.size(), 1);
+
+    m_graph->setShadowMapSize(1000000);
+    QCOMPARE(m_graph->shadowMapSize(), 16384);
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(spy.at(1).at(0).toInt(), 16384);
+
+    // Clamps to the current size
+    m_graph->setShadowMapSize(20000);
+    QCOMPARE(m_graph->shadowMapSize(), 16384);
+    QCOMPARE(spy.size(), 2);
+
+    m_graph->setShadowMapSize(-1);
+    QCOMPARE(m_graph->shadowMapSize(), 0);
+    QCOMPARE(spy.size(), 3);
+    QCOMPARE(spy.at(2).at(0).toInt(), 0);
+
+    m_graph->setShadowMapSize(-100);
+    QCOMPARE(spy.size(), 3);
+}
+
 QTEST_MAIN(tst_bars)
 #include "tst_bars.moc"
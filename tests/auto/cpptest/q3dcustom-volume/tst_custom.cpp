@@ -21,6 +21,8 @@ private slots:
     void initializeProperties();
     void invalidProperties();
 
+    void subTextureData();
+
 private:
     QCustom3DVolume *m_custom;
 };
@@ -183,5 +185,39 @@ void tst_custom::invalidProperties()
     QCOMPARE(m_custom->textureFormat(), QImage::Format_ARGB32);
 }
 
+void tst_custom::subTextureData()
+{
+    // 5 x 4 x 3 texels of indexed data, with lines padded to 6 bytes
+    m_custom->setTextureFormat(QImage::Format_Indexed8);
+    m_custom->setTextureDimensions(5, 4, 3);
+    QCOMPARE(m_custom->textureDataWidth(), 6);
+    m_custom->setTextureData(new QList<uchar>(6 * 4 * 3, 0));
+
+    QSignalSpy spy(m_custom, &QCustom3DVolume::textureDataChanged);
+
+    const uchar box[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    m_custom->setSubTextureData(1, 2, 1, 2, 2, 2, box);
+    QCOMPARE(spy.size(), 1);
+
+    const QList<uchar> &data = *m_custom->textureData();
+    QCOMPARE(data.at(1 * 24 + 2 * 6 + 1), uchar(1));
+    QCOMPARE(data.at(1 * 24 + 2 * 6 + 2), uchar(2));
+    QCOMPARE(data.at(1 * 24 + 3 * 6 + 1), uchar(3));
+    QCOMPARE(data.at(1 * 24 + 3 * 6 + 2), uchar(4));
+    QCOMPARE(data.at(2 * 24 + 2 * 6 + 1), uchar(5));
+    QCOMPARE(data.at(2 * 24 + 3 * 6 + 2), uchar(8));
+    QCOMPARE(data.at(1 * 24 + 2 * 6 + 0), uchar(0));
+    QCOMPARE(data.at(1 * 24 + 2 * 6 + 3), uchar(0));
+    QCOMPARE(data.at(0 * 24 + 2 * 6 + 1), uchar(0));
+
+    // Boxes outside the volume are rejected
+    m_custom->setSubTextureData(4, 0, 0, 2, 1, 1, box);
+    m_custom->setSubTextureData(0, 0, 2, 1, 1, 2, box);
+    m_custom->setSubTextureData(-1, 0, 0, 1, 1, 1, box);
+    m_custom->setSubTextureData(0, 0, 0, 0, 1, 1, box);
+    m_custom->setSubTextureData(0, 0, 0, 1, 1, 1, nullptr);
+    QCOMPARE(spy.size(), 1);
+}
+
 QTEST_MAIN(tst_custom)
 #include "tst_custom.moc"
@@ -4,6 +4,7 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/Q3DScatter>
+#include <QtDataVisualization/QValue3DAxisFormatter>
 
 #include "cpptestutil.h"
 
@@ -30,10 +31,30 @@ private slots:
     void removeMultipleSeries();
     void hasSeries();
 
+    void scalarFormatter();
+
 private:
     Q3DScatter *m_graph;
 };
 
+// Reimplements only the scalar positionAt() and has no Q_OBJECT macro, so its meta object is
+// the one of QValue3DAxisFormatter
+class ScalarFormatter : public QValue3DAxisFormatter
+{
+public:
+    static int positionCount;
+
+protected:
+    QValue3DAxisFormatter *createNewInstance() const override { return new ScalarFormatter; }
+    float positionAt(float value) const override
+    {
+        positionCount++;
+        return QValue3DAxisFormatter::positionAt(value);
+    }
+};
+
+int ScalarFormatter::positionCount = 0;
+
 QScatter3DSeries *newSeries()
 {
     QScatter3DSeries *series = new QScatter3DSeries;
@@ -102,6 +123,10 @@ void tst_scatter::initialProperties()
     QCOMPARE(m_graph->locale(), QLocale("C"));
     QCOMPARE(m_graph->queriedGraphPosition(), QVector3D(0, 0, 0));
     QCOMPARE(m_graph->margin(), -1.0);
+    QCOMPARE(m_graph->isFrameStatisticsEnabled(), false);
+    QCOMPARE(m_graph->asynchronousDataPreparation(), false);
+    QCOMPARE(m_graph->maxDataLatency(), -1);
+    QCOMPARE(m_graph->shadowMapSize(), 0);
 }
 
 void tst_scatter::initializeProperties()
@@ -122,6 +147,10 @@ void tst_scatter::initializeProperties()
     m_graph->setReflectivity(0.1);
     m_graph->setLocale(QLocale("FI"));
     m_graph->setMargin(1.0);
+    m_graph->setFrameStatisticsEnabled(true);
+    m_graph->setAsynchronousDataPreparation(true);
+    m_graph->setMaxDataLatency(50);
+    m_graph->setShadowMapSize(2048);
 
     QCOMPARE(m_graph->activeTheme()->type(), Q3DTheme::ThemeDigia);
     QCOMPARE(m_graph->selectionMode(), QAbstract3DGraph::SelectionNone);
@@ -137,6 +166,10 @@ void tst_scatter::initializeProperties()
     QCOMPARE(m_graph->reflectivity(), 0.1);
     QCOMPARE(m_graph->locale(), QLocale("FI"));
     QCOMPARE(m_graph->margin(), 1.0);
+    QCOMPARE(m_graph->isFrameStatisticsEnabled(), true);
+    QCOMPARE(m_graph->asynchronousDataPreparation(), true);
+    QCOMPARE(m_graph->maxDataLatency(), 50);
+    QCOMPARE(m_graph->shadowMapSize(), 2048);
 }
 
 void tst_scatter::invalidProperties()
@@ -237,5 +270,19 @@ void tst_scatter::hasSeries()
     QCOMPARE(m_graph->hasSeries(series2), false);
 }
 
+void tst_scatter::scalarFormatter()
+{
+    QValue3DAxis *axis = new QValue3DAxis;
+    axis->setFormatter(new ScalarFormatter);
+    m_graph->setAxisX(axis);
+    QScatter3DSeries *series = newSeries();
+    m_graph->addSeries(series);
+
+    // The item positions must be resolved with the reimplemented positionAt()
+    ScalarFormatter::positionCount = 0;
+    m_graph->renderToImage(0, QSize(64, 64));
+    QVERIFY(ScalarFormatter::positionCount >= series->dataProxy()->itemCount());
+}
+
 QTEST_MAIN(tst_scatter)
 #include "tst_scatter.moc"
@@ -0,0 +1,181 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include <QtDataVisualization/private/surfacelodpyramid_p.h>
+
+class tst_lod: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void buildMaximum();
+    void buildAverage();
+    void evenDimensions();
+    void holes();
+    void updateRows_data();
+    void updateRows();
+};
+
+// Grid where the height of each point is its index in the grid
+static SurfaceHeightGrid sequentialGrid(int rowCount, int columnCount)
+{
+    SurfaceHeightGrid grid;
+    grid.rowCount = rowCount;
+    grid.columnCount = columnCount;
+    grid.maxX = float(columnCount - 1);
+    grid.maxZ = float(rowCount - 1);
+    for (int i = 0; i < rowCount * columnCount; i++)
+        grid.heights.append(float(i));
+    return grid;
+}
+
+static bool sameViews(const SurfaceDataView &view1, const SurfaceDataView &view2)
+{
+    if (view1.rowCount() != view2.rowCount() || view1.columnCount() != view2.columnCount())
+        return false;
+    for (int i = 0; i < view1.rowCount(); i++) {
+        for (int j = 0; j < view1.columnCount(); j++) {
+            if (view1.position(i, j) != view2.position(i, j))
+                return false;
+        }
+    }
+    return true;
+}
+
+void tst_lod::buildMaximum()
+{
+    const SurfaceHeightGrid grid = sequentialGrid(5, 5);
+    SurfaceLodPyramid pyramid;
+
+    // Reduction stops at 2 x 2 points
+    QCOMPARE(pyramid.build(SurfaceDataView(grid), 5), 2);
+    QCOMPARE(pyramid.levelCount(), 2);
+
+    const SurfaceDataView level1 = pyramid.level(1);
+    QCOMPARE(level1.rowCount(), 3);
+    QCOMPARE(level1.columnCount(), 3);
+    QCOMPARE(level1.position(0, 0), QVector3D(0.0f, 6.0f, 0.0f));
+    QCOMPARE(level1.position(1, 1), QVector3D(2.0f, 18.0f, 2.0f));
+    // Blocks on the last odd row and column are partial, and stay at the range limits
+    QCOMPARE(level1.position(0, 2), QVector3D(4.0f, 9.0f, 0.0f));
+    QCOMPARE(level1.position(2, 0), QVector3D(0.0f, 21.0f, 4.0f));
+    QCOMPARE(level1.position(2, 2), QVector3D(4.0f, 24.0f, 4.0f));
+
+    const SurfaceDataView level2 = pyramid.level(2);
+    QCOMPARE(level2.rowCount(), 2);
+    QCOMPARE(level2.columnCount(), 2);
+    QCOMPARE(level2.position(0, 0), QVector3D(0.0f, 18.0f, 0.0f));
+    QCOMPARE(level2.position(1, 1), QVector3D(4.0f, 24.0f, 4.0f));
+
+    // Building again with fewer levels keeps the existing ones
+    QCOMPARE(pyramid.build(SurfaceDataView(grid), 1), 2);
+
+    pyramid.clear();
+    QCOMPARE(pyramid.levelCount(), 0);
+    QCOMPARE(pyramid.build(SurfaceDataView(grid), 1), 1);
+}
+
+void tst_lod::buildAverage()
+{
+    const SurfaceHeightGrid grid = sequentialGrid(5, 5);
+    SurfaceLodPyramid pyramid;
+    pyramid.build(SurfaceDataView(grid), 1);
+
+    // Changing the reduction drops the levels
+    pyramid.setReduction(QSurface3DSeries::LevelOfDetailAverage);
+    QCOMPARE(pyramid.levelCount(), 0);
+    QCOMPARE(pyramid.build(SurfaceDataView(grid), 2), 2);
+
+    const SurfaceDataView level1 = pyramid.level(1);
+    QCOMPARE(level1.position(0, 0).y(), 3.0f);
+    QCOMPARE(level1.position(1, 1).y(), 15.0f);
+    QCOMPARE(level1.position(0, 2).y(), 6.5f);
+    QCOMPARE(level1.position(2, 0).y(), 20.5f);
+    QCOMPARE(level1.position(2, 2).y(), 24.0f);
+
+    // Averages of averages of the partial blocks
+    QCOMPARE(pyramid.level(2).position(0, 0).y(), 9.0f);
+}
+
+void tst_lod::evenDimensions()
+{
+    const SurfaceHeightGrid grid = sequentialGrid(4, 6);
+    SurfaceLodPyramid pyramid;
+    QCOMPARE(pyramid.build(SurfaceDataView(grid), 1), 1);
+
+    // The last row and column of the level are at the last row and column of the data
+    const SurfaceDataView level1 = pyramid.level(1);
+    QCOMPARE(level1.rowCount(), 3);
+    QCOMPARE(level1.columnCount(), 4);
+    QCOMPARE(level1.position(1, 2), QVector3D(4.0f, 23.0f, 2.0f));
+    QCOMPARE(level1.position(2, 3), QVector3D(5.0f, 23.0f, 3.0f));
+    QCOMPARE(level1.position(0, 3), QVector3D(5.0f, 11.0f, 0.0f));
+}
+
+void tst_lod::holes()
+{
+    SurfaceHeightGrid grid = sequentialGrid(4, 4);
+    grid.heights[5] = qQNaN();
+    grid.heights[2] = qQNaN();
+    grid.heights[3] = qQNaN();
+    grid.heights[6] = qQNaN();
+    grid.heights[7] = qQNaN();
+
+    SurfaceLodPyramid pyramid;
+    pyramid.setReduction(QSurface3DSeries::LevelOfDetailAverage);
+    pyramid.build(SurfaceDataView(grid), 1);
+
+    // Holes are skipped, unless the whole block is a hole
+    const SurfaceDataView level1 = pyramid.level(1);
+    QCOMPARE(level1.position(0, 0).y(), 5.0f / 3.0f);
+    QVERIFY(qIsNaN(level1.position(0, 1).y()));
+}
+
+void tst_lod::updateRows_data()
+{
+    QTest::addColumn<int>("rowCount");
+    QTest::addColumn<int>("firstRow");
+    QTest::addColumn<int>("lastRow");
+    QTest::addColumn<int>("reduction");
+
+    const int maximum = QSurface3DSeries::LevelOfDetailMaximum;
+    const int average = QSurface3DSeries::LevelOfDetailAverage;
+    QTest::newRow("first row") << 9 << 0 << 0 << maximum;
+    QTest::newRow("middle rows") << 9 << 3 << 5 << maximum;
+    QTest::newRow("last odd row") << 9 << 8 << 8 << maximum;
+    QTest::newRow("last even row") << 10 << 9 << 9 << maximum;
+    QTest::newRow("middle rows average") << 10 << 4 << 6 << average;
+    QTest::newRow("all rows average") << 9 << 0 << 8 << average;
+}
+
+void tst_lod::updateRows()
+{
+    QFETCH(int, rowCount);
+    QFETCH(int, firstRow);
+    QFETCH(int, lastRow);
+    QFETCH(int, reduction);
+
+    SurfaceHeightGrid grid = sequentialGrid(rowCount, 7);
+    SurfaceLodPyramid pyramid;
+    pyramid.setReduction(QSurface3DSeries::LevelOfDetail(reduction));
+    const int levelCount = pyramid.build(SurfaceDataView(grid), 3);
+    QCOMPARE(levelCount, 3);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = 0; column < grid.columnCount; column++)
+            grid.heights[row * grid.columnCount + column] = float(100 + row - column);
+    }
+    pyramid.updateRows(SurfaceDataView(grid), firstRow, lastRow);
+
+    // The updated levels must match levels built from scratch
+    SurfaceLodPyramid reference;
+    reference.setReduction(QSurface3DSeries::LevelOfDetail(reduction));
+    QCOMPARE(reference.build(SurfaceDataView(grid), 3), levelCount);
+    for (int i = 1; i <= levelCount; i++)
+        QVERIFY2(sameViews(pyramid.level(i), reference.level(i)), qPrintable(QString::number(i)));
+}
+
+QTEST_MAIN(tst_lod)
+#include "tst_lod.moc"
@@ -5,6 +5,7 @@
 
 #include <QtDataVisualization/QItemModelSurfaceDataProxy>
 #include <QtDataVisualization/Q3DSurface>
+#include <QtGui/QStandardItemModel>
 #include <QtWidgets/QTableWidget>
 
 #include "cpptestutil.h"
@@ -25,6 +26,7 @@ private slots:
     void initializeProperties();
 
     void multiMatch();
+    void rowChanges();
 
 private:
     QItemModelSurfaceDataProxy *m_proxy;
@@ -270,5 +272,87 @@ void tst_proxy::multiMatch()
     m_proxy = 0; // Graph deletes proxy
 }
 
+static void insertSurfaceItem(QStandardItemModel *model, int modelRow, const QString &row,
+                              const QString &column, float y)
+{
+    QStandardItem *item = new QStandardItem;
+    item->setData(row, Qt::UserRole + 1);
+    item->setData(column, Qt::UserRole + 2);
+    item->setData(y, Qt::UserRole + 3);
+    model->insertRow(modelRow, item);
+}
+
+static void appendSurfaceItem(QStandardItemModel *model, const QString &row,
+                              const QString &column, float y)
+{
+    insertSurfaceItem(model, model->rowCount(), row, column, y);
+}
+
+void tst_proxy::rowChanges()
+{
+    QStandardItemModel model;
+    model.setItemRoleNames({{Qt::UserRole + 1, "row"}, {Qt::UserRole + 2, "column"},
+                            {Qt::UserRole + 3, "y"}});
+    appendSurfaceItem(&model, "1", "1", 1.0f);
+    appendSurfaceItem(&model, "1", "2", 2.0f);
+    appendSurfaceItem(&model, "2", "1", 3.0f);
+    appendSurfaceItem(&model, "2", "2", 4.0f);
+
+    m_proxy->setItemModel(&model);
+    m_proxy->setRowRole("row");
+    m_proxy->setColumnRole("column");
+    m_proxy->setYPosRole("y");
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->columnCount(), 2);
+
+    // Row changes in the model are applied without resolving the whole model
+    QSignalSpy resetSpy(m_proxy, &QSurfaceDataProxy::arrayReset);
+
+    appendSurfaceItem(&model, "3", "1", 5.0f);
+    appendSurfaceItem(&model, "3", "2", 6.0f);
+    QCOMPARE(m_proxy->rowCount(), 3);
+    QCOMPARE(m_proxy->itemAt(2, 1)->position(), QVector3D(2.0f, 6.0f, 3.0f));
+
+    model.item(1)->setData(7.0f, Qt::UserRole + 3);
+    QCOMPARE(m_proxy->itemAt(0, 1)->y(), 7.0f);
+
+    model.removeRows(0, 2);
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->itemAt(0, 0)->position(), QVector3D(1.0f, 3.0f, 2.0f));
+
+    // Rows inserted in the middle of the model become rows in the middle of the array
+    insertSurfaceItem(&model, 2, "2.5", "1", 8.0f);
+    insertSurfaceItem(&model, 3, "2.5", "2", 9.0f);
+    QCOMPARE(m_proxy->rowCount(), 3);
+    QCOMPARE(m_proxy->itemAt(1, 0)->position(), QVector3D(1.0f, 8.0f, 2.5f));
+    QCOMPARE(m_proxy->itemAt(1, 1)->position(), QVector3D(2.0f, 9.0f, 2.5f));
+    QCOMPARE(m_proxy->itemAt(2, 0)->position(), QVector3D(1.0f, 5.0f, 3.0f));
+
+    QCOMPARE(resetSpy.count(), 0);
+
+    // Moving items changes the first item of their cells
+    CpptestUtil::ItemListModel listModel({"row", "column", "y"});
+    listModel.appendItem({"1", "1", 1.0f});
+    listModel.appendItem({"1", "2", 2.0f});
+    listModel.appendItem({"2", "1", 3.0f});
+    listModel.appendItem({"2", "2", 4.0f});
+    listModel.appendItem({"1", "1", 5.0f});
+    m_proxy->setItemModel(&listModel);
+    m_proxy->setMultiMatchBehavior(QItemModelSurfaceDataProxy::MMBFirst);
+    QCoreApplication::processEvents();
+    QCOMPARE(m_proxy->itemAt(0, 0)->y(), 1.0f);
+    resetSpy.clear();
+
+    QVERIFY(listModel.moveRow(QModelIndex(), 4, QModelIndex(), 0));
+    QCOMPARE(m_proxy->itemAt(0, 0)->position(), QVector3D(1.0f, 5.0f, 1.0f));
+    QVERIFY(listModel.moveRow(QModelIndex(), 0, QModelIndex(), 5));
+    QCOMPARE(m_proxy->itemAt(0, 0)->position(), QVector3D(1.0f, 1.0f, 1.0f));
+    QCOMPARE(m_proxy->itemAt(1, 1)->position(), QVector3D(2.0f, 4.0f, 2.0f));
+
+    QCOMPARE(resetSpy.count(), 0);
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
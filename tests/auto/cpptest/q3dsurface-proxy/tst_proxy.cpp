@@ -20,6 +20,7 @@ private slots:
     void initialProperties();
     void initializeProperties();
     void initialRow();
+    void resetArrayFromHeights();
 
 private:
     QSurfaceDataProxy *m_proxy;
@@ -87,5 +88,29 @@ void tst_proxy::initialRow()
     proxy.addRow(new QSurfaceDataRow(row));
 }
 
+void tst_proxy::resetArrayFromHeights()
+{
+    QList<float> heights{0.1f, 0.5f, 1.8f, 1.2f, 0.7f, 0.3f, 2.0f};
+    m_proxy->resetArrayFromHeights(heights, 2, 0.0f, 1.0f, 0.5f, 1.5f);
+
+    // Heights after the last complete row are ignored
+    QCOMPARE(m_proxy->columnCount(), 2);
+    QCOMPARE(m_proxy->rowCount(), 3);
+    QCOMPARE(m_proxy->itemAt(0, 0)->position(), QVector3D(0.0f, 0.1f, 0.5f));
+    QCOMPARE(m_proxy->itemAt(1, 1)->position(), QVector3D(1.0f, 1.2f, 1.0f));
+    QCOMPARE(m_proxy->itemAt(2, 1)->position(), QVector3D(1.0f, 0.3f, 1.5f));
+    QCOMPARE(m_proxy->array()->size(), 3);
+
+    // Modifying the data converts it to rows
+    m_proxy->setItem(0, 0, QSurfaceDataItem(QVector3D(0.0f, 2.0f, 0.5f)));
+    QCOMPARE(m_proxy->rowCount(), 3);
+    QCOMPARE(m_proxy->itemAt(0, 0)->y(), 2.0f);
+    QCOMPARE(m_proxy->itemAt(2, 1)->position(), QVector3D(1.0f, 0.3f, 1.5f));
+
+    m_proxy->resetArrayFromHeights(heights, 0, 0.0f, 1.0f, 0.5f, 1.5f);
+    QCOMPARE(m_proxy->columnCount(), 0);
+    QCOMPARE(m_proxy->rowCount(), 0);
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
@@ -67,6 +67,7 @@ void tst_series::initialProperties()
     QCOMPARE(m_series->isFlatShadingSupported(), true);
     QCOMPARE(m_series->selectedPoint(), m_series->invalidSelectionPosition());
     QCOMPARE(m_series->wireframeColor(), QColor(Qt::black));
+    QCOMPARE(m_series->levelOfDetail(), QSurface3DSeries::LevelOfDetailNone);
     // Common properties. The ones identical between different series are tested in QBar3DSeries tests
     QCOMPARE(m_series->itemLabelFormat(), QString("@xLabel, @yLabel, @zLabel"));
     QCOMPARE(m_series->mesh(), QAbstract3DSeries::MeshSphere);
@@ -82,11 +83,13 @@ void tst_series::initializeProperties()
     m_series->setFlatShadingEnabled(false);
     m_series->setSelectedPoint(QPoint(0, 0));
     m_series->setWireframeColor(QColor(Qt::red));
+    m_series->setLevelOfDetail(QSurface3DSeries::LevelOfDetailAverage);
 
     QCOMPARE(m_series->drawMode(), QSurface3DSeries::DrawWireframe);
     QCOMPARE(m_series->isFlatShadingEnabled(), false);
     QCOMPARE(m_series->selectedPoint(), QPoint(0, 0));
     QCOMPARE(m_series->wireframeColor(), QColor(Qt::red));
+    QCOMPARE(m_series->levelOfDetail(), QSurface3DSeries::LevelOfDetailAverage);
 
     // Common properties. The ones identical between different series are tested in QBar3DSeries tests
     m_series->setMesh(QAbstract3DSeries::MeshPyramid);
@@ -2,8 +2,11 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include <QtTest/QtTest>
+#include <QtCore/QThread>
+#include <QtGui/QOpenGLContext>
 
 #include <QtDataVisualization/Q3DSurface>
+#include <QtDataVisualization/QValue3DAxisFormatter>
 
 #include "cpptestutil.h"
 
@@ -30,10 +33,36 @@ private slots:
     void removeMultipleSeries();
     void hasSeries();
 
+    void scalarFormatter();
+    void asynchronousDataPreparation();
+    void cachedScene();
+
 private:
     Q3DSurface *m_graph;
 };
 
+// Reimplements only the scalar positionAt() and has no Q_OBJECT macro, so its meta object is
+// the one of QValue3DAxisFormatter
+class ScalarFormatter : public QValue3DAxisFormatter
+{
+public:
+    static int positionCount;
+    static int otherThreadCount;
+
+protected:
+    QValue3DAxisFormatter *createNewInstance() const override { return new ScalarFormatter; }
+    float positionAt(float value) const override
+    {
+        positionCount++;
+        if (QThread::currentThread() != qApp->thread())
+            otherThreadCount++;
+        return QValue3DAxisFormatter::positionAt(value);
+    }
+};
+
+int ScalarFormatter::positionCount = 0;
+int ScalarFormatter::otherThreadCount = 0;
+
 QSurface3DSeries *newSeries()
 {
     QSurface3DSeries *series = new QSurface3DSeries;
@@ -48,6 +77,33 @@ QSurface3DSeries *newSeries()
     return series;
 }
 
+static QSurfaceDataArray *slopedArray(float base, float slope)
+{
+    QSurfaceDataArray *array = new QSurfaceDataArray;
+    for (int row = 0; row < 20; row++) {
+        QSurfaceDataRow *dataRow = new QSurfaceDataRow(20);
+        for (int column = 0; column < 20; column++)
+            (*dataRow)[column].setPosition(QVector3D(column, base + slope * row, row));
+        array->append(dataRow);
+    }
+    return array;
+}
+
+using SurfaceComparison = CpptestUtil::GraphComparison<Q3DSurface>;
+
+// Adds a series of sloped data to both graphs of the comparison, with a fixed y-axis range so
+// that changes in the data show in the images
+static void addComparedSeries(SurfaceComparison &comparison,
+                              QSurface3DSeries *series[SurfaceComparison::graphCount])
+{
+    for (int i = 0; i < SurfaceComparison::graphCount; i++) {
+        comparison.graph(i)->axisY()->setRange(0.0f, 10.0f);
+        series[i] = new QSurface3DSeries;
+        series[i]->dataProxy()->resetArray(slopedArray(1.0f, 0.2f));
+        comparison.graph(i)->addSeries(series[i]);
+    }
+}
+
 void tst_surface::initTestCase()
 {
     if (!CpptestUtil::isOpenGLSupported())
@@ -108,6 +164,10 @@ void tst_surface::initialProperties()
     QCOMPARE(m_graph->locale(), QLocale("C"));
     QCOMPARE(m_graph->queriedGraphPosition(), QVector3D(0, 0, 0));
     QCOMPARE(m_graph->margin(), -1.0);
+    QCOMPARE(m_graph->isFrameStatisticsEnabled(), false);
+    QCOMPARE(m_graph->asynchronousDataPreparation(), false);
+    QCOMPARE(m_graph->maxDataLatency(), -1);
+    QCOMPARE(m_graph->shadowMapSize(), 0);
 }
 
 void tst_surface::initializeProperties()
@@ -124,7 +184,8 @@ void tst_surface::initializeProperties()
     m_graph->setMeasureFps(true);
     m_graph->setOrthoProjection(true);
     m_graph->setAspectRatio(1.0);
-    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationStatic);
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationStatic
+                                  | QAbstract3DGraph::OptimizationCachedScene);
     m_graph->setPolar(true);
     m_graph->setRadialLabelOffset(0.1f);
     m_graph->setHorizontalAspectRatio(1.0);
@@ -132,6 +193,10 @@ void tst_surface::initializeProperties()
     m_graph->setReflectivity(0.1);
     m_graph->setLocale(QLocale("FI"));
     m_graph->setMargin(1.0);
+    m_graph->setFrameStatisticsEnabled(true);
+    m_graph->setAsynchronousDataPreparation(true);
+    m_graph->setMaxDataLatency(50);
+    m_graph->setShadowMapSize(2048);
 
     QCOMPARE(m_graph->activeTheme()->type(), Q3DTheme::ThemeDigia);
     QCOMPARE(m_graph->selectionMode(), QAbstract3DGraph::SelectionItem | QAbstract3DGraph::SelectionRow | QAbstract3DGraph::SelectionSlice);
@@ -139,7 +204,8 @@ void tst_surface::initializeProperties()
     QCOMPARE(m_graph->measureFps(), true);
     QCOMPARE(m_graph->isOrthoProjection(), true);
     QCOMPARE(m_graph->aspectRatio(), 1.0);
-    QCOMPARE(m_graph->optimizationHints(), QAbstract3DGraph::OptimizationStatic);
+    QCOMPARE(m_graph->optimizationHints(), QAbstract3DGraph::OptimizationStatic
+             | QAbstract3DGraph::OptimizationCachedScene);
     QCOMPARE(m_graph->isPolar(), true);
     QCOMPARE(m_graph->radialLabelOffset(), 0.1f);
     QCOMPARE(m_graph->horizontalAspectRatio(), 1.0);
@@ -147,6 +213,10 @@ void tst_surface::initializeProperties()
     QCOMPARE(m_graph->reflectivity(), 0.1);
     QCOMPARE(m_graph->locale(), QLocale("FI"));
     QCOMPARE(m_graph->margin(), 1.0);
+    QCOMPARE(m_graph->isFrameStatisticsEnabled(), true);
+    QCOMPARE(m_graph->asynchronousDataPreparation(), true);
+    QCOMPARE(m_graph->maxDataLatency(), 50);
+    QCOMPARE(m_graph->shadowMapSize(), 2048);
 }
 
 void tst_surface::invalidProperties()
@@ -247,5 +317,110 @@ void tst_surface::hasSeries()
     QCOMPARE(m_graph->hasSeries(series2), false);
 }
 
+void tst_surface::scalarFormatter()
+{
+    QValue3DAxis *axis = new QValue3DAxis;
+    axis->setFormatter(new ScalarFormatter);
+    m_graph->setAxisX(axis);
+    m_graph->addSeries(newSeries());
+
+    // The vertices must be mapped with the reimplemented positionAt(), and formatter code must
+    // only be called on the render thread
+    ScalarFormatter::positionCount = 0;
+    ScalarFormatter::otherThreadCount = 0;
+    m_graph->renderToImage(0, QSize(64, 64));
+    QVERIFY(ScalarFormatter::positionCount >= 4);
+    QCOMPARE(ScalarFormatter::otherThreadCount, 0);
+}
+
+void tst_surface::asynchronousDataPreparation()
+{
+    if (!CpptestUtil::canRenderToImage(m_graph))
+        QSKIP("Rendering to images is not supported on this platform");
+
+    // Asynchronously prepared data must end up rendered the same as synchronously prepared data
+    SurfaceComparison comparison(m_graph);
+    QSurface3DSeries *series[SurfaceComparison::graphCount];
+    addComparedSeries(comparison, series);
+    m_graph->setAsynchronousDataPreparation(true);
+    m_graph->setMaxDataLatency(-1);
+
+    QSignalSpy spy(m_graph, &QAbstract3DGraph::dataReady);
+    // Renders until the prepared data has been taken into use
+    auto renderReady = [&]() {
+        spy.clear();
+        for (int i = 0; i < 100 && spy.isEmpty(); i++) {
+            comparison.render();
+            QTest::qWait(10);
+        }
+        return !spy.isEmpty();
+    };
+
+    QVERIFY(renderReady());
+    const QImage oldImage = comparison.render();
+    QVERIFY(comparison.matchesReference(oldImage));
+
+    for (QSurface3DSeries *s : series)
+        s->dataProxy()->resetArray(slopedArray(6.0f, 0.1f));
+    QVERIFY(renderReady());
+    const QImage newImage = comparison.render();
+    QVERIFY(comparison.matchesReference(newImage));
+    QVERIFY(CpptestUtil::differingPixels(newImage, oldImage) > 0.01);
+}
+
+// Scene caching needs framebuffer blits, see SceneCache
+static bool isSceneCacheSupported(const QAbstract3DGraph *graph)
+{
+    QOpenGLContext context;
+    context.setFormat(graph->requestedFormat());
+    if (!context.create())
+        return false;
+    return !context.isOpenGLES() && context.format().version() >= qMakePair(3, 0);
+}
+
+void tst_surface::cachedScene()
+{
+    if (!CpptestUtil::canRenderToImage(m_graph))
+        QSKIP("Rendering to images is not supported on this platform");
+    if (!isSceneCacheSupported(m_graph))
+        QSKIP("Scene caching requires desktop OpenGL 3.0 or later");
+
+    // A graph without the cached scene is the reference for the images of the cached one
+    SurfaceComparison comparison(m_graph);
+    QSurface3DSeries *series[SurfaceComparison::graphCount];
+    addComparedSeries(comparison, series);
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationCachedScene);
+    m_graph->setFrameStatisticsEnabled(true);
+
+    QImage image;
+    auto render = [&]() {
+        image = comparison.render();
+        return m_graph->frameStatistics().drawCallCount();
+    };
+
+    const int sceneDrawCalls = render();
+    QVERIFY(sceneDrawCalls > 0);
+    // Nothing has changed, so the cached scene is drawn
+    QVERIFY(render() < sceneDrawCalls);
+    QVERIFY(comparison.matchesReference(image));
+
+    // Selection only changes draw just the selection over the cached scene
+    for (QSurface3DSeries *s : series)
+        s->setSelectedPoint(QPoint(10, 10));
+    QVERIFY(render() < sceneDrawCalls);
+    QVERIFY(comparison.matchesReference(image));
+
+    // Data changes render the whole scene again
+    for (QSurface3DSeries *s : series)
+        s->dataProxy()->setItem(5, 5, QSurfaceDataItem(QVector3D(5.0f, 9.0f, 5.0f)));
+    QVERIFY(render() >= sceneDrawCalls);
+    QVERIFY(comparison.matchesReference(image));
+
+    for (QSurface3DSeries *s : series)
+        s->setSelectedPoint(QPoint(12, 12));
+    QVERIFY(render() < sceneDrawCalls);
+    QVERIFY(comparison.matchesReference(image));
+}
+
 QTEST_MAIN(tst_surface)
 #include "tst_surface.moc"
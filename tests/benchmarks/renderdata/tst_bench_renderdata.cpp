@@ -0,0 +1,311 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include <QtDataVisualization/Q3DBars>
+#include <QtDataVisualization/Q3DScatter>
+#include <QtDataVisualization/Q3DSurface>
+#include <QtDataVisualization/QItemModelScatterDataProxy>
+#include <QtGui/QStandardItemModel>
+
+#include "cpptestutil.h"
+
+// Measures the renderer data paths by rendering offscreen with renderToImage, and the data
+// proxy paths, which do not need OpenGL. Run with one of
+// the machine readable QTest loggers, for example "-o results.json,json" or "-o results.csv,csv",
+// to track the results.
+class tst_bench_renderdata : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scatterUpdateData_data();
+    void scatterUpdateData();
+    void surfaceSetUpSmoothData_data();
+    void surfaceSetUpSmoothData();
+    void barsUpdateData_data();
+    void barsUpdateData();
+
+    void scatterResetArray_data();
+    void scatterResetArray();
+    void scatterAddItems_data();
+    void scatterAddItems();
+    void barAddRows_data();
+    void barAddRows();
+
+    void itemModelResolve_data();
+    void itemModelResolve();
+
+    void labelGeneration_data();
+    void labelGeneration();
+};
+
+static const QSize imageSize(256, 256);
+
+static QScatterDataArray scatterArray(int count)
+{
+    QScatterDataArray array;
+    array.resize(count);
+    for (int i = 0; i < count; i++) {
+        const float angle = float(i) * 0.01f;
+        array[i].setPosition(QVector3D(qCos(angle) * float(i % 1000),
+                                       float(i % 97),
+                                       qSin(angle) * float(i % 1000)));
+    }
+    return array;
+}
+
+static QSurfaceDataArray *surfaceArray(int rowCount, int columnCount)
+{
+    QSurfaceDataArray *array = new QSurfaceDataArray;
+    array->reserve(rowCount);
+    for (int i = 0; i < rowCount; i++) {
+        QSurfaceDataRow *row = new QSurfaceDataRow(columnCount);
+        for (int j = 0; j < columnCount; j++) {
+            (*row)[j].setPosition(QVector3D(float(j), qSin(float(i) * 0.1f) * qCos(float(j) * 0.1f),
+                                            float(i)));
+        }
+        array->append(row);
+    }
+    return array;
+}
+
+static QBarDataArray barArray(int rowCount, int columnCount)
+{
+    QBarDataArray array;
+    array.reserve(rowCount);
+    for (int i = 0; i < rowCount; i++) {
+        QBarDataRow *row = new QBarDataRow(columnCount);
+        for (int j = 0; j < columnCount; j++)
+            (*row)[j].setValue(float((i * columnCount + j) % 100));
+        array.append(row);
+    }
+    return array;
+}
+
+static void addCountRows()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+void tst_bench_renderdata::scatterUpdateData_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("staticOptimization");
+
+    QTest::newRow("1k") << 1000 << false;
+    QTest::newRow("10k") << 10000 << false;
+    QTest::newRow("100k") << 100000 << false;
+    QTest::newRow("1k static") << 1000 << true;
+    QTest::newRow("10k static") << 10000 << true;
+    QTest::newRow("100k static") << 100000 << true;
+}
+
+void tst_bench_renderdata::scatterUpdateData()
+{
+    if (!CpptestUtil::isOpenGLSupported())
+        QSKIP("OpenGL not supported on this platform");
+
+    QFETCH(int, count);
+    QFETCH(bool, staticOptimization);
+
+    Q3DScatter graph;
+    if (staticOptimization)
+        graph.setOptimizationHints(QAbstract3DGraph::OptimizationStatic);
+    QScatter3DSeries *series = new QScatter3DSeries;
+    graph.addSeries(series);
+    graph.renderToImage(0, imageSize);
+
+    const QScatterDataArray data = scatterArray(count);
+    QBENCHMARK {
+        series->dataProxy()->resetArray(new QScatterDataArray(data));
+        graph.renderToImage(0, imageSize);
+    }
+}
+
+void tst_bench_renderdata::surfaceSetUpSmoothData_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("64x64") << 64;
+    QTest::newRow("256x256") << 256;
+    QTest::newRow("512x512") << 512;
+}
+
+void tst_bench_renderdata::surfaceSetUpSmoothData()
+{
+    if (!CpptestUtil::isOpenGLSupported())
+        QSKIP("OpenGL not supported on this platform");
+
+    QFETCH(int, count);
+
+    Q3DSurface graph;
+    QSurface3DSeries *series = new QSurface3DSeries;
+    series->setFlatShadingEnabled(false);
+    graph.addSeries(series);
+    graph.renderToImage(0, imageSize);
+
+    QBENCHMARK {
+        series->dataProxy()->resetArray(surfaceArray(count, count));
+        graph.renderToImage(0, imageSize);
+    }
+}
+
+void tst_bench_renderdata::barsUpdateData_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10x10") << 10;
+    QTest::newRow("100x100") << 100;
+    QTest::newRow("300x300") << 300;
+}
+
+void tst_bench_renderdata::barsUpdateData()
+{
+    if (!CpptestUtil::isOpenGLSupported())
+        QSKIP("OpenGL not supported on this platform");
+
+    QFETCH(int, count);
+
+    Q3DBars graph;
+    QBar3DSeries *series = new QBar3DSeries;
+    graph.addSeries(series);
+    graph.renderToImage(0, imageSize);
+
+    QBENCHMARK {
+        QBarDataArray *array = new QBarDataArray(barArray(count, count));
+        series->dataProxy()->resetArray(array);
+        graph.renderToImage(0, imageSize);
+    }
+}
+
+void tst_bench_renderdata::scatterResetArray_data()
+{
+    addCountRows();
+}
+
+void tst_bench_renderdata::scatterResetArray()
+{
+    QFETCH(int, count);
+
+    QScatterDataProxy proxy;
+    const QScatterDataArray data = scatterArray(count);
+    QBENCHMARK {
+        proxy.resetArray(new QScatterDataArray(data));
+    }
+}
+
+void tst_bench_renderdata::scatterAddItems_data()
+{
+    addCountRows();
+}
+
+void tst_bench_renderdata::scatterAddItems()
+{
+    QFETCH(int, count);
+
+    QScatterDataProxy proxy;
+    const QScatterDataArray data = scatterArray(count);
+    QBENCHMARK {
+        proxy.resetArray(nullptr);
+        proxy.addItems(data);
+    }
+}
+
+void tst_bench_renderdata::barAddRows_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10x10") << 10;
+    QTest::newRow("100x100") << 100;
+    QTest::newRow("300x300") << 300;
+}
+
+void tst_bench_renderdata::barAddRows()
+{
+    QFETCH(int, count);
+
+    QBarDataProxy proxy;
+    QBENCHMARK {
+        proxy.resetArray();
+        proxy.addRows(barArray(count, count));
+    }
+}
+
+void tst_bench_renderdata::itemModelResolve_data()
+{
+    addCountRows();
+}
+
+void tst_bench_renderdata::itemModelResolve()
+{
+    QFETCH(int, count);
+
+    QStandardItemModel model(count, 1);
+    model.setItemRoleNames({{Qt::UserRole + 1, "x"}, {Qt::UserRole + 2, "y"},
+                            {Qt::UserRole + 3, "z"}});
+    for (int i = 0; i < count; i++) {
+        QStandardItem *item = new QStandardItem;
+        item->setData(float(i % 1000), Qt::UserRole + 1);
+        item->setData(float(i % 97), Qt::UserRole + 2);
+        item->setData(float(i / 1000), Qt::UserRole + 3);
+        model.setItem(i, 0, item);
+    }
+
+    QItemModelScatterDataProxy proxy(nullptr, QStringLiteral("x"), QStringLiteral("y"),
+                                     QStringLiteral("z"));
+    QSignalSpy spy(&proxy, &QScatterDataProxy::arrayReset);
+    QBENCHMARK {
+        proxy.setItemModel(nullptr);
+        spy.clear();
+        // Resolving is queued, so wait for the reset
+        proxy.setItemModel(&model);
+        QVERIFY(spy.wait());
+    }
+    QCOMPARE(proxy.itemCount(), count);
+}
+
+void tst_bench_renderdata::labelGeneration_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("5") << 5;
+    QTest::newRow("50") << 50;
+    QTest::newRow("500") << 500;
+}
+
+void tst_bench_renderdata::labelGeneration()
+{
+    if (!CpptestUtil::isOpenGLSupported())
+        QSKIP("OpenGL not supported on this platform");
+
+    QFETCH(int, count);
+
+    Q3DScatter graph;
+    QScatter3DSeries *series = new QScatter3DSeries;
+    series->dataProxy()->addItems(scatterArray(100));
+    graph.addSeries(series);
+    graph.axisX()->setSegmentCount(count);
+    graph.axisY()->setSegmentCount(count);
+    graph.axisZ()->setSegmentCount(count);
+    graph.renderToImage(0, imageSize);
+
+    // Alternate between formats so that the labels are regenerated on every render
+    const QString formats[] = {QStringLiteral("%.1f"), QStringLiteral("%.2f")};
+    int i = 0;
+    QBENCHMARK {
+        const QString &format = formats[i++ % 2];
+        graph.axisX()->setLabelFormat(format);
+        graph.axisY()->setLabelFormat(format);
+        graph.axisZ()->setLabelFormat(format);
+        graph.renderToImage(0, imageSize);
+    }
+}
+
+QTEST_MAIN(tst_bench_renderdata)
+#include "tst_bench_renderdata.moc"